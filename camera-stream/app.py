@@ -12,6 +12,8 @@ import numpy as np
 import threading
 from queue import Queue
 
+from mjpeg_stream import MjpegStreamParser, parse_capture_us
+
 # AI imports (will be conditionally loaded)
 try:
     from ultralytics import YOLO
@@ -57,7 +59,6 @@ STATIC_FRAME_HEIGHT = 480
 STATIC_FRAME_COUNT = 10
 STATIC_FPS = 10 # Target FPS for the fallback animation (lowered for consistency)
 FRAME_STALL_TIMEOUT = 2.5  # Seconds without a decoded frame before falling back
-MAX_STREAM_BUFFER = 1024 * 1024  # Cap buffer growth when parsing MJPEG
 
 STREAM_ROTATE = int(os.getenv("STREAM_ROTATE", "0"))
 STREAM_FORCE_LANDSCAPE = os.getenv("STREAM_FORCE_LANDSCAPE", "false").lower() in ("1", "true", "yes", "on")
@@ -118,6 +119,9 @@ class AIStreamProcessor:
         self.detection_fps = 2  # Will be adjusted per model
         self.latest_detections = []
         self.latest_detection_ts = 0.0
+        # Capture time of the frame the detections came from, in the motor
+        # controller's clock (X-Capture-Us); 0 when the camera is not synced
+        self.latest_detection_capture_us = 0
         self.last_detection_time = 0
         
         # Threading for async AI processing
@@ -220,6 +224,7 @@ class AIStreamProcessor:
         # Clear previous detections when switching models
         self.latest_detections = []
         self.latest_detection_ts = 0.0
+        self.latest_detection_capture_us = 0
         
         print(f"🔄 Switched from {self.model_configs[old_model]['name']} to {self.model_configs[model_name]['name']}")
         print(f"   FPS: {self.detection_fps}")
@@ -286,6 +291,7 @@ class AIStreamProcessor:
                 
                 self.latest_detections = scaled_detections
                 self.latest_detection_ts = time.time()
+                self.latest_detection_capture_us = frame_data['capture_us']
                 if len(scaled_detections) > 0:
                     print(f"🎯 {self.model_configs[self.current_model]['name']} detected {len(scaled_detections)} person(s)")
         except Exception as e:
@@ -318,7 +324,7 @@ class AIStreamProcessor:
             print(f"MobileNet detection error: {e}")
             return []
     
-    def queue_frame_for_processing(self, img):
+    def queue_frame_for_processing(self, img, capture_us=0):
         """Queue a frame for async AI processing with optimized resizing"""
         if self.enabled and self.current_model in self.models:
             try:
@@ -335,7 +341,8 @@ class AIStreamProcessor:
                     'original_shape': original_shape,
                     'ai_input_size': ai_input_size,
                     'scale': scale,
-                    'offset': offset
+                    'offset': offset,
+                    'capture_us': capture_us
                 }
                 
                 # Drop frame if queue is full (prevent backlog)
@@ -418,7 +425,7 @@ class AIStreamProcessor:
                         cv2.FONT_HERSHEY_SIMPLEX, 0.5, (0, 0, 0), 2)
         return img
     
-    def process_frame(self, frame_bytes):
+    def process_frame(self, frame_bytes, capture_us=0):
         """Process frame in real-time (non-blocking)"""
         transform_enabled = (
             STREAM_ROTATE_CODE is not None
@@ -441,7 +448,7 @@ class AIStreamProcessor:
             
             if ai_enabled:
                 # Queue frame for async AI processing (non-blocking)
-                self.queue_frame_for_processing(img.copy())
+                self.queue_frame_for_processing(img.copy(), capture_us)
                 
                 # Always draw latest detections (even if from previous frames)
                 img = self.draw_detections(img, self.latest_detections)
@@ -598,32 +605,17 @@ def stream_generator():
                 raise StreamUnavailable(f"Unexpected Content-Type: {content_type}")
             print("✅ Camera stream connected.")
             
-            byte_buffer = b""
+            parser = MjpegStreamParser()
             last_frame_time = time.time()
 
-            for chunk in r.iter_content(chunk_size=4096):
+            for chunk in r.iter_content(chunk_size=16384):
                 if not chunk:
                     if time.time() - last_frame_time > FRAME_STALL_TIMEOUT:
                         raise StreamUnavailable("Camera stream stalled")
                     continue
 
-                byte_buffer += chunk
-                while True:
-                    jpg_start = byte_buffer.find(b"\xff\xd8")
-                    if jpg_start == -1:
-                        if len(byte_buffer) > MAX_STREAM_BUFFER:
-                            byte_buffer = byte_buffer[-(MAX_STREAM_BUFFER // 2):]
-                        break
-
-                    jpg_end = byte_buffer.find(b"\xff\xd9", jpg_start + 2)
-                    if jpg_end == -1:
-                        if jpg_start > 0:
-                            byte_buffer = byte_buffer[jpg_start:]
-                        break
-
-                    jpg_frame = byte_buffer[jpg_start:jpg_end + 2]
-                    byte_buffer = byte_buffer[jpg_end + 2:]
-                    processed_frame = ai_processor.process_frame(jpg_frame)
+                for jpg_frame, headers in parser.feed(chunk):
+                    processed_frame = ai_processor.process_frame(jpg_frame, parse_capture_us(headers))
                     last_frame_time = time.time()
                     yield format_mjpeg_frame(processed_frame)
 
@@ -717,6 +709,7 @@ def toggle_ai():
         if not ai_processor.enabled:
             ai_processor.latest_detections = []
             ai_processor.latest_detection_ts = 0.0
+            ai_processor.latest_detection_capture_us = 0
         
         # Start or stop the processing thread based on state
         if ai_processor.enabled and ai_processor.current_model in ai_processor.models:
@@ -750,7 +743,8 @@ def get_detections():
         "ai_enabled": ai_processor.enabled,
         "current_model": ai_processor.current_model,
         "model_info": ai_processor.model_configs[ai_processor.current_model],
-        "timestamp": ai_processor.latest_detection_ts
+        "timestamp": ai_processor.latest_detection_ts,
+        "captureUs": ai_processor.latest_detection_capture_us
     })
 
 @app.route("/api/models")
@@ -0,0 +1,89 @@
+"""Parsing for the camera's multipart MJPEG stream."""
+
+MAX_STREAM_BUFFER = 1024 * 1024  # Cap buffer growth when parsing MJPEG
+MAX_PART_HEADER = 1024  # Longest multipart part header before resyncing
+
+
+class MjpegStreamParser:
+    """Incremental parser for the camera's multipart MJPEG stream.
+
+    Parts that carry Content-Length are read as exactly that many bytes, so the
+    JPEG payload is never scanned. Parts without it (older camera firmware) fall
+    back to searching for the JPEG SOI/EOI markers.
+    """
+
+    def __init__(self, max_buffer=MAX_STREAM_BUFFER):
+        self.max_buffer = max_buffer
+        self.buffer = bytearray()
+        self.part_length = None  # Set while reading a part body of known size
+        self.part_headers = {}
+
+    def feed(self, chunk):
+        """Adds received bytes and returns a list of (jpeg_bytes, headers) tuples."""
+        self.buffer += chunk
+        frames = []
+        while True:
+            if self.part_length is not None:
+                if len(self.buffer) < self.part_length:
+                    break
+                frame = bytes(self.buffer[:self.part_length])
+                del self.buffer[:self.part_length]
+                frames.append((frame, self.part_headers))
+                self.part_length = None
+                continue
+
+            if not self._read_part_header():
+                frame = self._scan_for_jpeg()
+                if frame is None:
+                    break
+                frames.append((frame, {}))
+
+        if self.part_length is None and len(self.buffer) > self.max_buffer:
+            del self.buffer[:len(self.buffer) - self.max_buffer // 2]
+        return frames
+
+    def _read_part_header(self):
+        boundary = self.buffer.find(b"--", 0, MAX_PART_HEADER)
+        if boundary == -1:
+            return False
+        header_end = self.buffer.find(b"\r\n\r\n", boundary, boundary + MAX_PART_HEADER)
+        if header_end == -1:
+            return False
+
+        headers = {}
+        for line in bytes(self.buffer[boundary:header_end]).split(b"\r\n")[1:]:
+            name, sep, value = line.partition(b":")
+            if sep:
+                headers[name.strip().lower().decode("latin-1")] = value.strip().decode("latin-1")
+        try:
+            length = int(headers.get("content-length", ""))
+        except ValueError:
+            return False
+        if length < 0 or length > self.max_buffer:
+            return False
+
+        del self.buffer[:header_end + 4]
+        self.part_length = length
+        self.part_headers = headers
+        return True
+
+    def _scan_for_jpeg(self):
+        jpg_start = self.buffer.find(b"\xff\xd8")
+        if jpg_start == -1:
+            return None
+        jpg_end = self.buffer.find(b"\xff\xd9", jpg_start + 2)
+        if jpg_end == -1:
+            if jpg_start > 0:
+                del self.buffer[:jpg_start]
+            return None
+        frame = bytes(self.buffer[jpg_start:jpg_end + 2])
+        del self.buffer[:jpg_end + 2]
+        return frame
+
+
+def parse_capture_us(headers):
+    """Motor-clock capture time from a part's X-Capture-Us header, or 0"""
+    try:
+        return int(headers.get("x-capture-us", "0"))
+    except ValueError:
+        return 0
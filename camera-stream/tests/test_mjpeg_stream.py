@@ -0,0 +1,116 @@
+"""MjpegStreamParser against stream bytes in the camera firmware's formats.
+
+Parts are built exactly as firmware/cam/src/main.cpp writes them
+(FRAME_HEADER_FORMAT), and as the firmware did before parts carried
+Content-Length. Run from camera-stream/ with `python -m pytest tests`.
+"""
+
+import os
+import random
+
+from mjpeg_stream import MjpegStreamParser, parse_capture_us
+
+FALLBACK_JPEG = os.path.join(os.path.dirname(__file__), "..", "fallback.jpg")
+
+
+def load_jpeg():
+    with open(FALLBACK_JPEG, "rb") as f:
+        return f.read()
+
+
+def synthetic_jpeg(rng, size):
+    """SOI, random payload without markers, EOI"""
+    body = bytes(rng.randrange(0, 0xFF) for _ in range(size))
+    return b"\xff\xd8" + body + b"\xff\xd9"
+
+
+def tricky_jpeg():
+    """Payload holding a boundary, a header terminator and a stray EOI, which
+    only the Content-Length path can read without scanning"""
+    return b"\xff\xd8" + b"\r\n--frame\r\nContent-Length: 5\r\n\r\n" + b"\xff\xd9\x00\x01" + b"\xff\xd9"
+
+
+def content_length_part(jpeg, seq, capture_us):
+    header = (
+        "\r\n--frame\r\n"
+        "Content-Type: image/jpeg\r\n"
+        f"Content-Length: {len(jpeg)}\r\n"
+        f"X-Timestamp: {1000 + seq * 66}\r\n"
+        f"X-Frame-Seq: {seq}\r\n"
+        f"X-Capture-Us: {capture_us}\r\n\r\n"
+    )
+    return header.encode("ascii") + jpeg
+
+
+def legacy_part(jpeg):
+    return b"\r\n--frame\r\nContent-Type: image/jpeg\r\n\r\n" + jpeg
+
+
+def feed_in_chunks(parser, stream, rng, max_chunk=16384):
+    frames = []
+    pos = 0
+    while pos < len(stream):
+        size = rng.randint(1, max_chunk)
+        frames.extend(parser.feed(stream[pos:pos + size]))
+        pos += size
+    return frames
+
+
+def test_content_length_frames_are_byte_exact():
+    rng = random.Random(1)
+    jpegs = [load_jpeg(), tricky_jpeg()] + [synthetic_jpeg(rng, rng.randint(100, 20000)) for _ in range(20)]
+    stream = b"".join(content_length_part(j, i, 5000000 + i * 66000) for i, j in enumerate(jpegs))
+
+    for seed in range(20):
+        frames = feed_in_chunks(MjpegStreamParser(), stream, random.Random(seed), max_chunk=rng.choice([7, 512, 16384]))
+        assert [f for f, _ in frames] == jpegs
+        for i, (_, headers) in enumerate(frames):
+            assert headers["x-frame-seq"] == str(i)
+            assert parse_capture_us(headers) == 5000000 + i * 66000
+
+
+def test_legacy_stream_falls_back_to_markers():
+    rng = random.Random(2)
+    jpegs = [load_jpeg()] + [synthetic_jpeg(rng, rng.randint(100, 20000)) for _ in range(20)]
+    stream = b"".join(legacy_part(j) for j in jpegs)
+
+    for seed in range(20):
+        frames = feed_in_chunks(MjpegStreamParser(), stream, random.Random(seed))
+        assert [f for f, _ in frames] == jpegs
+        assert all(headers == {} for _, headers in frames)
+        assert parse_capture_us(frames[0][1]) == 0
+
+
+def test_joining_mid_stream_resyncs():
+    rng = random.Random(3)
+    jpegs = [synthetic_jpeg(rng, rng.randint(1000, 5000)) for _ in range(10)]
+    parts = [content_length_part(j, i, 0) for i, j in enumerate(jpegs)]
+    stream = b"".join(parts)
+
+    for start in [1, 17, len(parts[0]) // 2, len(parts[0]) - 3]:
+        frames = feed_in_chunks(MjpegStreamParser(), stream[start:], random.Random(start))
+        got = [f for f, _ in frames]
+        # Whatever came before the first whole part is skipped; everything after arrives intact
+        assert got[-9:] == jpegs[1:]
+        assert all(f.startswith(b"\xff\xd8") for f in got)
+
+
+def test_bad_content_length_is_not_trusted():
+    rng = random.Random(4)
+    jpeg = synthetic_jpeg(rng, 3000)
+    bad = b"\r\n--frame\r\nContent-Type: image/jpeg\r\nContent-Length: lots\r\n\r\n" + jpeg
+    huge = b"\r\n--frame\r\nContent-Type: image/jpeg\r\nContent-Length: 999999999\r\n\r\n" + jpeg
+    for part in (bad, huge):
+        parser = MjpegStreamParser(max_buffer=64 * 1024)
+        frames = parser.feed(part + content_length_part(jpeg, 1, 0))
+        assert [f for f, _ in frames] == [jpeg, jpeg]
+
+
+def test_garbage_does_not_grow_the_buffer():
+    parser = MjpegStreamParser(max_buffer=64 * 1024)
+    rng = random.Random(5)
+    for _ in range(50):
+        assert parser.feed(bytes(rng.choice(b"abc\r\n") for _ in range(8192))) == []
+        assert len(parser.buffer) <= 64 * 1024
+    jpeg = synthetic_jpeg(rng, 2000)
+    assert [f for f, _ in parser.feed(content_length_part(jpeg, 0, 0))] == [jpeg]
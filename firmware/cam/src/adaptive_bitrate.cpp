@@ -0,0 +1,123 @@
+#include "adaptive_bitrate.h"
+
+void AdaptiveBitrate::configure(const AbrConfig &next, const AbrLevel *nextLevels, uint8_t nextCount, uint32_t nowMs)
+{
+  config = next;
+  count = nextCount < 1 ? 1 : (nextCount > ABR_MAX_LEVELS ? ABR_MAX_LEVELS : nextCount);
+  for (uint8_t i = 0; i < count; i++)
+  {
+    levels[i] = nextLevels[i];
+  }
+  levelValue = 0;
+  for (uint8_t i = 0; i < ABR_MAX_STREAMS; i++)
+  {
+    streams[i].active = false;
+    streams[i].latencyMs = 0;
+  }
+  throughputBytesPerMs = 0;
+  high = false;
+  low = false;
+  stateSinceMs = nowMs;
+  lastChangeMs = nowMs;
+  upgraded = false;
+  backoffMs = config.upgradeBackoffMs;
+}
+
+bool AdaptiveBitrate::addSample(uint8_t stream, const AbrSample &sample, uint32_t nowMs)
+{
+  if (stream >= ABR_MAX_STREAMS)
+  {
+    return false;
+  }
+
+  // Only a send that waited on the socket says anything about link speed
+  float latency = sample.ageMs;
+  if (sample.sendMs >= config.minBlockedSendMs && sample.sendMs > 0)
+  {
+    float rate = (float)sample.bytes / sample.sendMs;
+    throughputBytesPerMs = throughputBytesPerMs > 0
+                               ? throughputBytesPerMs + config.smoothing * (rate - throughputBytesPerMs)
+                               : rate;
+    latency += config.socketBufferBytes / throughputBytesPerMs;
+  }
+
+  StreamState &state = streams[stream];
+  state.latencyMs = state.active ? state.latencyMs + config.smoothing * (latency - state.latencyMs) : latency;
+  state.active = true;
+
+  if (nowMs - lastChangeMs < config.settleMs)
+  {
+    return false;
+  }
+
+  uint32_t worst = latencyMs();
+  bool nowHigh = worst * 100 > config.targetLatencyMs * config.highPercent;
+  bool nowLow = worst * 100 < config.targetLatencyMs * config.lowPercent;
+  if (nowHigh != high || nowLow != low)
+  {
+    high = nowHigh;
+    low = nowLow;
+    stateSinceMs = nowMs;
+  }
+
+  if (high && nowMs - stateSinceMs >= config.degradeHoldMs && levelValue + 1 < count)
+  {
+    // Falling straight back after a climb means the link could not take it;
+    // a climb that held through the probe window resets the backoff
+    if (upgraded && nowMs - lastChangeMs < config.probeWindowMs)
+    {
+      backoffMs = backoffMs * 2 > config.maxUpgradeBackoffMs ? config.maxUpgradeBackoffMs : backoffMs * 2;
+    }
+    else if (upgraded)
+    {
+      backoffMs = config.upgradeBackoffMs;
+    }
+    // One level per doubling of the target, so a collapsed link is not
+    // chased down one settle period at a time
+    uint8_t steps = 1;
+    for (uint32_t limit = config.targetLatencyMs * 2; worst > limit && steps < 3; limit *= 2)
+    {
+      steps++;
+    }
+    changeLevel(levelValue + steps < count ? levelValue + steps : count - 1, nowMs);
+    upgraded = false;
+    return true;
+  }
+  if (low && nowMs - stateSinceMs >= config.upgradeHoldMs && nowMs - lastChangeMs >= backoffMs && levelValue > 0)
+  {
+    changeLevel(levelValue - 1, nowMs);
+    upgraded = true;
+    return true;
+  }
+  return false;
+}
+
+void AdaptiveBitrate::removeStream(uint8_t stream)
+{
+  if (stream < ABR_MAX_STREAMS)
+  {
+    streams[stream].active = false;
+  }
+}
+
+uint32_t AdaptiveBitrate::latencyMs() const
+{
+  float worst = 0;
+  for (uint8_t i = 0; i < ABR_MAX_STREAMS; i++)
+  {
+    if (streams[i].active && streams[i].latencyMs > worst)
+    {
+      worst = streams[i].latencyMs;
+    }
+  }
+  return (uint32_t)worst;
+}
+
+void AdaptiveBitrate::changeLevel(uint8_t next, uint32_t nowMs)
+{
+  levelValue = next;
+  lastChangeMs = nowMs;
+  high = false;
+  low = false;
+  stateSinceMs = nowMs;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+
+// Latency-driven quality control for the MJPEG stream.
+// Each stream task reports how long its last frame took to send and how old
+// the frame was by then. A write that blocks means the TCP send buffer is
+// full, so that buffer's worth of bytes is still queued ahead of the viewer;
+// the controller adds it at the measured throughput to estimate latency at
+// the viewer. The worst stream drives a ladder of (frame size, quality)
+// levels, best first. A level drops after latency stays high briefly (further
+// the more it overshoots), and it climbs back only after a long quiet spell.
+// Each climb that fails soon after doubles the wait before the next try, so a
+// marginal link does not oscillate.
+
+const uint8_t ABR_MAX_STREAMS = 4;
+const uint8_t ABR_MAX_LEVELS = 16;
+
+struct AbrLevel
+{
+  int framesize; // framesize_t
+  int quality;
+};
+
+struct AbrConfig
+{
+  uint32_t targetLatencyMs;
+  uint16_t highPercent;       // Degrade above targetLatencyMs * highPercent / 100
+  uint16_t lowPercent;        // Upgrade below targetLatencyMs * lowPercent / 100
+  uint32_t degradeHoldMs;     // Latency must stay high this long
+  uint32_t upgradeHoldMs;     // Latency must stay low this long
+  uint32_t settleMs;          // Ignore latency this long after any change
+  uint32_t upgradeBackoffMs;  // Minimum time at a level before climbing
+  uint32_t maxUpgradeBackoffMs;
+  uint32_t probeWindowMs;     // A degrade this soon after a climb doubles the backoff
+  uint32_t minBlockedSendMs;  // Shorter sends did not wait on the socket
+  uint32_t socketBufferBytes; // TCP send buffer, queued whenever a write blocks
+  float smoothing;            // Weight of each new sample, 0-1
+};
+
+struct AbrSample
+{
+  uint32_t bytes;  // Part header plus JPEG
+  uint32_t sendMs; // First byte to last byte handed to the socket
+  uint32_t ageMs;  // Capture to last byte handed to the socket
+};
+
+class AdaptiveBitrate
+{
+public:
+  // levels[0] is the best allowed; count is capped at ABR_MAX_LEVELS
+  void configure(const AbrConfig &config, const AbrLevel *levels, uint8_t count, uint32_t nowMs);
+
+  // Returns true when the sample moved the level
+  bool addSample(uint8_t stream, const AbrSample &sample, uint32_t nowMs);
+  void removeStream(uint8_t stream);
+
+  uint8_t level() const { return levelValue; }
+  uint8_t levelCount() const { return count; }
+  const AbrLevel &current() const { return levels[levelValue]; }
+  uint32_t latencyMs() const; // Smoothed estimate for the worst stream
+  uint32_t throughputKbps() const { return (uint32_t)(throughputBytesPerMs * 8.0f); }
+  uint32_t upgradeBackoffMs() const { return backoffMs; }
+
+private:
+  struct StreamState
+  {
+    bool active;
+    float latencyMs;
+  };
+
+  void changeLevel(uint8_t next, uint32_t nowMs);
+
+  AbrConfig config = {};
+  AbrLevel levels[ABR_MAX_LEVELS] = {};
+  uint8_t count = 1;
+  uint8_t levelValue = 0;
+  StreamState streams[ABR_MAX_STREAMS] = {};
+  float throughputBytesPerMs = 0;
+  bool high = false;
+  bool low = false;
+  uint32_t stateSinceMs = 0;
+  uint32_t lastChangeMs = 0;
+  bool upgraded = false; // Last change was a climb
+  uint32_t backoffMs = 0;
+};
@@ -0,0 +1,111 @@
+#include "clock_sync.h"
+
+namespace
+{
+  void putU32(uint8_t *p, uint32_t v)
+  {
+    for (uint8_t i = 0; i < 4; i++)
+    {
+      p[i] = (uint8_t)(v >> (8 * i));
+    }
+  }
+
+  void putU64(uint8_t *p, uint64_t v)
+  {
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      p[i] = (uint8_t)(v >> (8 * i));
+    }
+  }
+
+  uint32_t getU32(const uint8_t *p)
+  {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  }
+
+  uint64_t getU64(const uint8_t *p)
+  {
+    return (uint64_t)getU32(p) | ((uint64_t)getU32(p + 4) << 32);
+  }
+}
+
+size_t encodeClockSyncRequest(uint32_t sequence, uint64_t sendUs, uint8_t *out, size_t capacity)
+{
+  if (!out || capacity < CLOCK_SYNC_REQUEST_SIZE)
+  {
+    return 0;
+  }
+  out[0] = CLOCK_SYNC_MAGIC;
+  out[1] = CLOCK_SYNC_VERSION;
+  out[2] = CLOCK_SYNC_REQUEST;
+  out[3] = 0;
+  putU32(out + 4, sequence);
+  putU64(out + 8, sendUs);
+  return CLOCK_SYNC_REQUEST_SIZE;
+}
+
+bool decodeClockSyncResponse(const uint8_t *data, size_t len, ClockSyncReply &reply)
+{
+  if (!data || len != CLOCK_SYNC_RESPONSE_SIZE || data[0] != CLOCK_SYNC_MAGIC ||
+      data[1] != CLOCK_SYNC_VERSION || data[2] != CLOCK_SYNC_RESPONSE)
+  {
+    return false;
+  }
+  reply.sequence = getU32(data + 4);
+  reply.clientSendUs = getU64(data + 8);
+  reply.serverReceiveUs = getU64(data + 16);
+  reply.serverSendUs = getU64(data + 24);
+  return true;
+}
+
+bool ClockSyncEstimator::addExchange(const ClockSyncReply &reply, uint64_t receiveUs)
+{
+  uint64_t localUs = receiveUs - reply.clientSendUs;
+  uint64_t remoteUs = reply.serverSendUs - reply.serverReceiveUs;
+  if (receiveUs < reply.clientSendUs || reply.serverSendUs < reply.serverReceiveUs || remoteUs > localUs ||
+      localUs - remoteUs > CLOCK_SYNC_MAX_RTT_US)
+  {
+    return false;
+  }
+
+  Exchange exchange;
+  exchange.roundTripUs = (uint32_t)(localUs - remoteUs);
+  exchange.offsetUs = ((int64_t)(reply.serverReceiveUs - reply.clientSendUs) +
+                       (int64_t)(reply.serverSendUs - receiveUs)) /
+                      2;
+
+  int64_t step = best >= 0 ? exchange.offsetUs - window[best].offsetUs : 0;
+  if (step > (int64_t)CLOCK_SYNC_STEP_US || step < -(int64_t)CLOCK_SYNC_STEP_US)
+  {
+    reset();
+  }
+
+  window[next] = exchange;
+  next = (next + 1) % CLOCK_SYNC_WINDOW;
+  if (count < CLOCK_SYNC_WINDOW)
+  {
+    count++;
+  }
+  best = 0;
+  for (uint8_t i = 1; i < count; i++)
+  {
+    if (window[i].roundTripUs < window[best].roundTripUs)
+    {
+      best = i;
+    }
+  }
+  lastExchangeUs = receiveUs;
+  return true;
+}
+
+void ClockSyncEstimator::reset()
+{
+  count = 0;
+  next = 0;
+  best = -1;
+}
+
+bool ClockSyncEstimator::synced(uint64_t nowUs) const
+{
+  return best >= 0 && nowUs - lastExchangeUs < CLOCK_SYNC_STALE_US;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// NTP-style clock sync to the motor controller, over UDP, so frames can be
+// stamped in the clock its pose history uses. The camera sends its send time
+// t0, the reply carries the motor controller's receive time t1 and send time
+// t2, and the camera notes its receive time t3. All times are esp_timer
+// microseconds since boot, little-endian.
+//
+//   REQUEST   magic, version, type, reserved, uint32 sequence, uint64 t0
+//   RESPONSE  the request's 16 bytes followed by uint64 t1, uint64 t2
+//
+// firmware/motors/src/clock_sync.h carries the same layout and the responder.
+
+const uint16_t CLOCK_SYNC_PORT = 4211;
+const uint8_t CLOCK_SYNC_MAGIC = 0xC5;
+const uint8_t CLOCK_SYNC_VERSION = 1;
+const size_t CLOCK_SYNC_REQUEST_SIZE = 16;
+const size_t CLOCK_SYNC_RESPONSE_SIZE = 32;
+
+enum ClockSyncType : uint8_t
+{
+  CLOCK_SYNC_REQUEST = 0x01,
+  CLOCK_SYNC_RESPONSE = 0x02,
+};
+
+// Offset filter: the exchange with the shortest round trip in the window has
+// the least room for path asymmetry, so its offset is the one used
+const uint8_t CLOCK_SYNC_WINDOW = 8;
+const uint32_t CLOCK_SYNC_MAX_RTT_US = 50000;   // Slower exchanges are ignored
+const uint32_t CLOCK_SYNC_STEP_US = 100000;     // A jump this large means the motor controller rebooted
+const uint64_t CLOCK_SYNC_STALE_US = 30000000;  // Unsynced after this long without an exchange
+
+struct ClockSyncReply
+{
+  uint32_t sequence;
+  uint64_t clientSendUs;    // t0
+  uint64_t serverReceiveUs; // t1
+  uint64_t serverSendUs;    // t2
+};
+
+size_t encodeClockSyncRequest(uint32_t sequence, uint64_t sendUs, uint8_t *out, size_t capacity);
+bool decodeClockSyncResponse(const uint8_t *data, size_t len, ClockSyncReply &reply);
+
+class ClockSyncEstimator
+{
+public:
+  // receiveUs is t3. Returns false when the exchange was not used.
+  bool addExchange(const ClockSyncReply &reply, uint64_t receiveUs);
+  void reset();
+
+  bool synced(uint64_t nowUs) const;
+  int64_t offsetUs() const { return best >= 0 ? window[best].offsetUs : 0; } // Reference minus local
+  uint32_t roundTripUs() const { return best >= 0 ? window[best].roundTripUs : 0; }
+  uint64_t toReference(uint64_t localUs) const { return localUs + offsetUs(); }
+  uint8_t samples() const { return count; }
+
+private:
+  struct Exchange
+  {
+    int64_t offsetUs;
+    uint32_t roundTripUs;
+  };
+
+  Exchange window[CLOCK_SYNC_WINDOW] = {};
+  uint8_t count = 0;
+  uint8_t next = 0;
+  int best = -1;
+  uint64_t lastExchangeUs = 0;
+};
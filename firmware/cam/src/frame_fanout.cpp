@@ -0,0 +1,223 @@
+#include "frame_fanout.h"
+
+FrameFanout::FrameFanout() : publishedCount(0)
+{
+  for (uint8_t i = 0; i < FANOUT_MAX_FRAMES; i++)
+  {
+    frames[i].handle = nullptr;
+    frames[i].data = nullptr;
+    frames[i].len = 0;
+    frames[i].sequence = 0;
+    frames[i].timestampMs = 0;
+    frames[i].captureUs = 0;
+    frames[i].refs.store(0, std::memory_order_relaxed);
+  }
+  for (uint8_t i = 0; i < FANOUT_MAX_SUBSCRIBERS; i++)
+  {
+    subscribers[i].state.store(SLOT_FREE, std::memory_order_relaxed);
+    subscribers[i].pending.store(nullptr, std::memory_order_relaxed);
+    subscribers[i].delivered.store(0, std::memory_order_relaxed);
+    subscribers[i].dropped.store(0, std::memory_order_relaxed);
+  }
+}
+
+void FrameFanout::begin(ReleaseFn release, uint8_t maxFrames)
+{
+  releaseFn = release;
+  frameLimit = maxFrames < 1 ? 1 : (maxFrames > FANOUT_MAX_FRAMES ? FANOUT_MAX_FRAMES : maxFrames);
+}
+
+int FrameFanout::subscribe()
+{
+  for (uint8_t i = 0; i < FANOUT_MAX_SUBSCRIBERS; i++)
+  {
+    Subscriber &sub = subscribers[i];
+    uint8_t expected = SLOT_FREE;
+    // Claim the slot before resetting it so the publisher never sees stale counters as live
+    if (sub.state.compare_exchange_strong(expected, SLOT_CLOSING, std::memory_order_acquire))
+    {
+      sub.delivered.store(0, std::memory_order_relaxed);
+      sub.dropped.store(0, std::memory_order_relaxed);
+      sub.state.store(SLOT_ACTIVE, std::memory_order_release);
+      return i;
+    }
+  }
+  return -1;
+}
+
+void FrameFanout::unsubscribe(int id)
+{
+  if (id < 0 || id >= FANOUT_MAX_SUBSCRIBERS)
+  {
+    return;
+  }
+  Subscriber &sub = subscribers[id];
+  sub.state.store(SLOT_CLOSING, std::memory_order_seq_cst);
+  drop(sub);
+  sub.state.store(SLOT_FREE, std::memory_order_release);
+}
+
+uint8_t FrameFanout::subscriberCount() const
+{
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < FANOUT_MAX_SUBSCRIBERS; i++)
+  {
+    if (subscribers[i].state.load(std::memory_order_relaxed) == SLOT_ACTIVE)
+    {
+      count++;
+    }
+  }
+  return count;
+}
+
+bool FrameFanout::subscribed(int id) const
+{
+  return id >= 0 && id < FANOUT_MAX_SUBSCRIBERS &&
+         subscribers[id].state.load(std::memory_order_relaxed) == SLOT_ACTIVE;
+}
+
+// Only the publisher moves a slot off zero, so a zero count stays free for it
+int FrameFanout::freeFrameIndex() const
+{
+  int index = -1;
+  uint8_t inUse = 0;
+  for (uint8_t i = 0; i < FANOUT_MAX_FRAMES; i++)
+  {
+    if (frames[i].refs.load(std::memory_order_acquire) != 0)
+    {
+      inUse++;
+    }
+    else if (index < 0)
+    {
+      index = i;
+    }
+  }
+  return inUse < frameLimit ? index : -1;
+}
+
+bool FrameFanout::hasFreeSlot()
+{
+  if (freeFrameIndex() >= 0)
+  {
+    return true;
+  }
+  for (uint8_t i = 0; i < FANOUT_MAX_SUBSCRIBERS; i++)
+  {
+    Subscriber &sub = subscribers[i];
+    if (sub.pending.load(std::memory_order_acquire))
+    {
+      drop(sub, true);
+    }
+  }
+  return freeFrameIndex() >= 0;
+}
+
+uint8_t FrameFanout::framesHeld() const
+{
+  uint8_t held = 0;
+  for (uint8_t i = 0; i < FANOUT_MAX_FRAMES; i++)
+  {
+    if (frames[i].refs.load(std::memory_order_acquire) != 0)
+    {
+      held++;
+    }
+  }
+  return held;
+}
+
+bool FrameFanout::publish(void *handle, const uint8_t *data, size_t len, uint32_t timestampMs, uint64_t captureUs)
+{
+  int index = freeFrameIndex();
+  if (index < 0)
+  {
+    return false;
+  }
+
+  FanoutFrame *frame = &frames[index];
+  frame->handle = handle;
+  frame->data = data;
+  frame->len = len;
+  frame->sequence = nextSequence++;
+  frame->timestampMs = timestampMs;
+  frame->captureUs = captureUs;
+  frame->refs.store(1, std::memory_order_release); // Held by the publisher until the loop ends
+
+  for (uint8_t i = 0; i < FANOUT_MAX_SUBSCRIBERS; i++)
+  {
+    Subscriber &sub = subscribers[i];
+    if (sub.state.load(std::memory_order_acquire) != SLOT_ACTIVE)
+    {
+      continue;
+    }
+    frame->refs.fetch_add(1, std::memory_order_relaxed);
+    FanoutFrame *replaced = sub.pending.exchange(frame, std::memory_order_acq_rel);
+    if (replaced)
+    {
+      sub.dropped.fetch_add(1, std::memory_order_relaxed);
+      release(replaced);
+    }
+    // The subscriber may have left between the state check and the exchange;
+    // whichever side empties the mailbox last releases what is in it
+    if (sub.state.load(std::memory_order_seq_cst) != SLOT_ACTIVE)
+    {
+      drop(sub);
+    }
+  }
+
+  publishedCount.fetch_add(1, std::memory_order_relaxed);
+  release(frame);
+  return true;
+}
+
+FanoutFrame *FrameFanout::take(int id)
+{
+  if (id < 0 || id >= FANOUT_MAX_SUBSCRIBERS)
+  {
+    return nullptr;
+  }
+  Subscriber &sub = subscribers[id];
+  FanoutFrame *frame = sub.pending.exchange(nullptr, std::memory_order_acq_rel);
+  if (frame)
+  {
+    sub.delivered.fetch_add(1, std::memory_order_relaxed);
+  }
+  return frame;
+}
+
+void FrameFanout::release(FanoutFrame *frame)
+{
+  if (!frame)
+  {
+    return;
+  }
+  // Read before dropping the reference: at zero the publisher may reuse the slot
+  void *handle = frame->handle;
+  if (frame->refs.fetch_sub(1, std::memory_order_acq_rel) == 1 && releaseFn)
+  {
+    releaseFn(handle);
+  }
+}
+
+FanoutSubscriberStats FrameFanout::stats(int id) const
+{
+  FanoutSubscriberStats result = {0, 0};
+  if (id >= 0 && id < FANOUT_MAX_SUBSCRIBERS)
+  {
+    result.delivered = subscribers[id].delivered.load(std::memory_order_relaxed);
+    result.dropped = subscribers[id].dropped.load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+void FrameFanout::drop(Subscriber &sub, bool skipped)
+{
+  FanoutFrame *frame = sub.pending.exchange(nullptr, std::memory_order_acq_rel);
+  if (frame)
+  {
+    if (skipped)
+    {
+      sub.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    release(frame);
+  }
+}
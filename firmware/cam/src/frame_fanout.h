@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// One-producer, many-consumer frame distribution for the MJPEG stream.
+// The capture task publishes each camera frame once; every subscriber gets a
+// reference to the same buffer and the frame goes back to the camera driver
+// when the last reference is released. Each subscriber has a one-frame
+// mailbox: publishing replaces a frame the subscriber has not taken yet, so a
+// slow viewer skips frames instead of holding up capture or other viewers.
+// A subscriber pins only the frame it is currently sending, which keeps the
+// buffers held at once to (subscribers sending + 1), and begin() can cap that
+// further so the driver always keeps a buffer to capture into.
+
+const uint8_t FANOUT_MAX_SUBSCRIBERS = 4;
+const uint8_t FANOUT_MAX_FRAMES = FANOUT_MAX_SUBSCRIBERS + 1;
+
+struct FanoutFrame
+{
+  void *handle; // Owner's buffer handle, e.g. camera_fb_t
+  const uint8_t *data;
+  size_t len;
+  uint32_t sequence;
+  uint32_t timestampMs;
+  uint64_t captureUs; // Capture time in the motor controller's clock, 0 when unknown
+  std::atomic<uint8_t> refs;
+};
+
+struct FanoutSubscriberStats
+{
+  uint32_t delivered; // Frames taken by the subscriber
+  uint32_t dropped;   // Frames replaced before the subscriber took them
+};
+
+class FrameFanout
+{
+public:
+  typedef void (*ReleaseFn)(void *handle);
+
+  FrameFanout();
+  // maxFrames limits how many frames may be referenced at once (1..FANOUT_MAX_FRAMES)
+  void begin(ReleaseFn release, uint8_t maxFrames = FANOUT_MAX_FRAMES);
+
+  // Any task. Returns a subscriber id, or -1 when all slots are taken.
+  int subscribe();
+  // Subscriber's own task; drops its pending frame. Frames it has taken must
+  // still be released.
+  void unsubscribe(int id);
+  uint8_t subscriberCount() const;
+  bool subscribed(int id) const;
+
+  // Capture task only. When maxFrames frames are referenced, frames still
+  // waiting in a mailbox are dropped first, as the next publish would replace
+  // them anyway; otherwise a viewer busy sending one frame pins a second in
+  // its mailbox and holds up capture for everyone. publish() returns false
+  // when the limit is still reached; the caller keeps ownership of handle then.
+  bool hasFreeSlot();
+  bool publish(void *handle, const uint8_t *data, size_t len, uint32_t timestampMs, uint64_t captureUs = 0);
+  // Frames still referenced by a subscriber, taken or pending; 0 once every
+  // buffer is back with the owner
+  uint8_t framesHeld() const;
+
+  // Subscriber task: the newest frame not yet taken, or null. Release it when done.
+  FanoutFrame *take(int id);
+  void release(FanoutFrame *frame);
+
+  uint32_t published() const { return publishedCount.load(std::memory_order_relaxed); }
+  FanoutSubscriberStats stats(int id) const;
+
+private:
+  enum SlotState : uint8_t
+  {
+    SLOT_FREE,
+    SLOT_ACTIVE,
+    SLOT_CLOSING
+  };
+
+  struct Subscriber
+  {
+    std::atomic<uint8_t> state;
+    std::atomic<FanoutFrame *> pending;
+    std::atomic<uint32_t> delivered;
+    std::atomic<uint32_t> dropped;
+  };
+
+  void drop(Subscriber &sub, bool skipped = false);
+  int freeFrameIndex() const;
+
+  ReleaseFn releaseFn = nullptr;
+  uint8_t frameLimit = FANOUT_MAX_FRAMES;
+  FanoutFrame frames[FANOUT_MAX_FRAMES];
+  Subscriber subscribers[FANOUT_MAX_SUBSCRIBERS];
+  std::atomic<uint32_t> publishedCount;
+  uint32_t nextSequence = 0;
+};
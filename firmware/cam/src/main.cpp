@@ -1,7 +1,14 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <WebServer.h>
+#include <AsyncUDP.h>
+#include <ESPmDNS.h>
 #include "esp_camera.h"
+#include <esp_timer.h>
+#include <atomic>
+#include "frame_fanout.h"
+#include "adaptive_bitrate.h"
+#include "clock_sync.h"
 
 const char *ssid = "Apt 210";
 const char *password = "mistycanoe3";
@@ -28,8 +35,743 @@ WebServer server(80);
 
 // Boundary for multipart stream
 const char *STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=frame";
-const char *FRAME_BOUNDARY = "\r\n--frame\r\n";
-const char *FRAME_CONTENT_TYPE = "Content-Type: image/jpeg\r\n\r\n";
+// Each part says how long its JPEG is, so readers take exactly that many bytes
+// instead of scanning for JPEG markers. Timestamp is millis() at capture;
+// X-Capture-Us is the capture time in the motor controller's clock, for
+// looking up the turret pose, and 0 until the clocks are synced.
+const char *FRAME_HEADER_FORMAT = "\r\n--frame\r\n"
+                                  "Content-Type: image/jpeg\r\n"
+                                  "Content-Length: %u\r\n"
+                                  "X-Timestamp: %lu\r\n"
+                                  "X-Frame-Seq: %lu\r\n"
+                                  "X-Capture-Us: %llu\r\n\r\n";
+const size_t FRAME_HEADER_MAX = 192;
+const size_t STREAM_CHUNK_SIZE = 4096; // Multiple of the 4-byte PSRAM access width
+// Single-frame /capture response. Exposure is the sensor's AEC value in line
+// periods and gain the AGC multiplier, both sampled near capture time.
+const char *SNAPSHOT_HEADER_FORMAT = "HTTP/1.1 200 OK\r\n"
+                                     "Content-Type: image/jpeg\r\n"
+                                     "Content-Length: %u\r\n"
+                                     "X-Frame-Seq: %lu\r\n"
+                                     "X-Timestamp: %lu\r\n"
+                                     "X-Capture-Us: %llu\r\n"
+                                     "X-Exposure: %lu\r\n"
+                                     "X-Gain: %u.%02u\r\n"
+                                     "X-Auto-Exposure: %d\r\n"
+                                     "X-Auto-Gain: %d\r\n"
+                                     "X-Framesize: %d\r\n"
+                                     "X-Quality: %d\r\n"
+                                     "Cache-Control: no-store\r\n"
+                                     "Access-Control-Allow-Origin: *\r\n"
+                                     "Access-Control-Expose-Headers: X-Frame-Seq, X-Timestamp, X-Capture-Us, X-Exposure, X-Gain, "
+                                     "X-Auto-Exposure, X-Auto-Gain, X-Framesize, X-Quality\r\n"
+                                     "Connection: close\r\n\r\n";
+const size_t SNAPSHOT_HEADER_MAX = 512;
+
+// Capture/send pipeline: a capture task on one core publishes frames, each
+// /stream client has its own sender task on the WiFi core. At most
+// CAMERA_FB_COUNT - 1 frames are held at once (one being sent, one ready),
+// so the driver always has a buffer to fill while the network is busy.
+const int CAMERA_FB_COUNT = 3;
+const BaseType_t CAPTURE_TASK_CORE = 1;
+const BaseType_t STREAM_TASK_CORE = 0; // Same core as the WiFi stack
+const uint32_t CAPTURE_TASK_STACK = 4096;
+const uint32_t STREAM_TASK_STACK = 4096;
+const uint32_t CAPTURE_IDLE_MS = 50;     // Poll interval while nobody is watching; a new subscriber wakes it early
+const uint32_t STREAM_FRAME_WAIT_MS = 100;
+const uint32_t SNAPSHOT_TASK_STACK = 4096;
+const uint32_t SNAPSHOT_WAIT_MS = 2000;      // /capture gives up on a stalled camera after this
+const uint32_t SNAPSHOT_LONG_POLL_MS = 10000; // /capture?since=N answers 204 if nothing newer by then
+const uint32_t EXPOSURE_SAMPLE_MS = 200;
+
+// Clock sync with the motor controller, found over mDNS. Requests go out
+// quickly until the filter window is full, then once a second.
+const char *MDNS_HOSTNAME = "turret-cam";
+const char *MOTORS_MDNS_HOSTNAME = "turret-motors";
+const uint32_t CLOCK_SYNC_TASK_STACK = 3072;
+const uint32_t CLOCK_SYNC_FAST_INTERVAL_MS = 100;
+const uint32_t CLOCK_SYNC_INTERVAL_MS = 1000;
+const uint32_t CLOCK_SYNC_RESOLVE_MS = 2000;    // mDNS query timeout, and the wait between failed queries
+const uint32_t CLOCK_SYNC_LOST_MS = 10000;      // Resolve again after this long without a usable reply
+AsyncUDP clockSyncUdp;
+ClockSyncEstimator clockSync;
+SemaphoreHandle_t clockSyncLock;
+std::atomic<uint32_t> clockSyncReplyMs(0); // millis() of the last reply the filter used
+TaskHandle_t captureTaskHandle = NULL;
+FrameFanout frameFanout;
+SemaphoreHandle_t frameReady[FANOUT_MAX_SUBSCRIBERS]; // Given by capture, taken by that subscriber's task
+
+// Pipeline counters, written by the capture and stream tasks and read by /stats
+const uint32_t FPS_WINDOW_MS = 1000;
+std::atomic<uint32_t> capturedFrames(0);
+std::atomic<uint32_t> captureFailures(0);
+std::atomic<uint32_t> captureWaits(0);     // Capture found every pipeline buffer in use
+std::atomic<uint32_t> captureFpsTenths(0); // Over the last FPS_WINDOW_MS
+std::atomic<uint32_t> closedSentFrames(0); // Totals from clients that have disconnected
+std::atomic<uint32_t> closedSkippedFrames(0);
+std::atomic<uint32_t> captureKbps(0); // JPEG bytes captured over the last FPS_WINDOW_MS, per viewer
+// Sensor exposure state, sampled by the capture task for /capture headers
+std::atomic<uint32_t> sensorExposure(0);        // OV2640 AEC, in sensor line periods
+std::atomic<uint32_t> sensorGainSixteenths(16); // AGC gain x16
+
+// Runtime camera settings. /control edits requestedSettings; the capture task
+// is the only task that talks to the sensor and applies changes between
+// frames, so SCCB writes never race a capture. Every field is an int so the
+// control table below can address it by name.
+struct CameraSettings
+{
+  int framesize; // framesize_t
+  int quality;   // JPEG quality, lower is better and larger
+  int brightness;
+  int contrast;
+  int saturation;
+  int aec;      // Auto exposure
+  int aeLevel;  // Auto exposure bias
+  int aecValue; // Manual exposure, used while aec is off
+  int agc;      // Auto gain
+  int agcGain;  // Manual gain, used while agc is off
+  int gainCeiling;
+  int hmirror;
+  int vflip;
+  int grabMode;   // camera_grab_mode_t; changing it re-initializes the driver
+  int targetFps;  // 0 = as fast as the pipeline allows
+  int targetKbps; // 0 = fixed quality, otherwise quality follows this budget
+  int targetLatencyMs; // 0 = off, otherwise frame size and quality follow stream latency
+};
+
+struct CameraSettingField
+{
+  const char *name;
+  int CameraSettings::*field;
+  int minValue;
+  int maxValue;
+};
+
+// Frame buffers are sized for this at init, so /control can switch to any
+// size up to it without re-allocating
+const framesize_t CAMERA_MAX_FRAMESIZE = FRAMESIZE_UXGA;
+const int CAMERA_MIN_QUALITY = 4;
+const int CAMERA_MAX_QUALITY = 63;
+
+// Names follow the esp32-camera example's /control?var=...&val=...
+const CameraSettingField CAMERA_SETTING_FIELDS[] = {
+    {"framesize", &CameraSettings::framesize, 0, CAMERA_MAX_FRAMESIZE},
+    {"quality", &CameraSettings::quality, CAMERA_MIN_QUALITY, CAMERA_MAX_QUALITY},
+    {"brightness", &CameraSettings::brightness, -2, 2},
+    {"contrast", &CameraSettings::contrast, -2, 2},
+    {"saturation", &CameraSettings::saturation, -2, 2},
+    {"aec", &CameraSettings::aec, 0, 1},
+    {"ae_level", &CameraSettings::aeLevel, -2, 2},
+    {"aec_value", &CameraSettings::aecValue, 0, 1200},
+    {"agc", &CameraSettings::agc, 0, 1},
+    {"agc_gain", &CameraSettings::agcGain, 0, 30},
+    {"gainceiling", &CameraSettings::gainCeiling, 0, 6},
+    {"hmirror", &CameraSettings::hmirror, 0, 1},
+    {"vflip", &CameraSettings::vflip, 0, 1},
+    {"grab_mode", &CameraSettings::grabMode, CAMERA_GRAB_WHEN_EMPTY, CAMERA_GRAB_LATEST},
+    {"target_fps", &CameraSettings::targetFps, 0, 30},
+    {"target_kbps", &CameraSettings::targetKbps, 0, 20000},
+    {"target_latency_ms", &CameraSettings::targetLatencyMs, 0, 5000},
+};
+const size_t CAMERA_SETTING_COUNT = sizeof(CAMERA_SETTING_FIELDS) / sizeof(CAMERA_SETTING_FIELDS[0]);
+
+const CameraSettings DEFAULT_CAMERA_SETTINGS = {
+    FRAMESIZE_HVGA, 20, 0, 0, 0, 1, 0, 300, 1, 0, 0, 0, 0, CAMERA_GRAB_LATEST, 0, 0, 0};
+
+// Bitrate target: quality moves only when the measured rate leaves the
+// deadband, and steps down faster than it climbs back
+const int BITRATE_OVER_PERCENT = 110;
+const int BITRATE_UNDER_PERCENT = 80;
+const int BITRATE_QUALITY_UP_STEP = 2; // Coarser JPEG when over budget
+const int BITRATE_QUALITY_DOWN_STEP = 1;
+const int BITRATE_MIN_QUALITY = 10; // Auto mode never goes finer than this
+const uint32_t CAMERA_REINIT_DRAIN_MS = 2000;
+
+// Latency target: the requested frame size and quality are the best the
+// controller may use, and it steps down this ladder from there
+const AbrLevel LATENCY_LADDER[] = {
+    {FRAMESIZE_VGA, 12}, {FRAMESIZE_VGA, 20}, {FRAMESIZE_VGA, 30},
+    {FRAMESIZE_HVGA, 15}, {FRAMESIZE_HVGA, 20}, {FRAMESIZE_HVGA, 28}, {FRAMESIZE_HVGA, 36},
+    {FRAMESIZE_QVGA, 24}, {FRAMESIZE_QVGA, 32}, {FRAMESIZE_QVGA, 45},
+    {FRAMESIZE_QQVGA, 30}, {FRAMESIZE_QQVGA, 45}};
+const size_t LATENCY_LADDER_COUNT = sizeof(LATENCY_LADDER) / sizeof(LATENCY_LADDER[0]);
+const AbrConfig LATENCY_CONTROL_CONFIG = {
+    0,     // targetLatencyMs, from target_latency_ms
+    130,   // highPercent
+    60,    // lowPercent
+    300,   // degradeHoldMs
+    3000,  // upgradeHoldMs
+    1000,  // settleMs, covers the frames lost to a sensor frame size switch
+    2000,  // upgradeBackoffMs
+    30000, // maxUpgradeBackoffMs
+    5000,  // probeWindowMs
+    5,     // minBlockedSendMs
+    5744,  // socketBufferBytes, lwIP TCP_SND_BUF in the Arduino core
+    0.25f  // smoothing
+};
+
+camera_config_t cameraConfig;
+SemaphoreHandle_t settingsLock;
+CameraSettings requestedSettings = DEFAULT_CAMERA_SETTINGS; // Guarded by settingsLock
+CameraSettings activeSettings = DEFAULT_CAMERA_SETTINGS;    // What the sensor has; guarded by settingsLock
+std::atomic<uint32_t> settingsVersion(0);                   // Bumped on every accepted /control change
+std::atomic<uint32_t> appliedSettingsVersion(0);            // Last version the capture task applied
+
+// Latency controller: fed by every stream task, followed by the capture task
+AdaptiveBitrate latencyController;
+SemaphoreHandle_t latencyLock;
+std::atomic<bool> latencyControlActive(false);
+AbrLevel latencyCeiling = {}; // Capture task only
+
+struct StreamClient
+{
+  WiFiClient client; // Copy keeps the socket open after the WebServer lets go of it
+  int subscriber;
+};
+
+struct SnapshotRequest
+{
+  WiFiClient client;
+  int subscriber;
+  bool longPoll;
+  uint32_t since; // Only frames with a later sequence qualify when longPoll is set
+};
+
+void returnFrameBuffer(void *handle)
+{
+  esp_camera_fb_return((camera_fb_t *)handle);
+}
+
+// Settings the /control API does not expose
+void applyFixedSensorSettings(sensor_t *s)
+{
+  s->set_special_effect(s, 0); // 0-6 (0 - no effect)
+  s->set_whitebal(s, 1);       // 0 = disable, 1 = enable
+  s->set_awb_gain(s, 1);       // 0 = disable, 1 = enable
+  s->set_wb_mode(s, 0);        // 0-4 (0 - auto)
+  s->set_aec2(s, 0);           // 0 = disable, 1 = enable
+  s->set_bpc(s, 0);            // 0 = disable, 1 = enable
+  s->set_wpc(s, 1);            // 0 = disable, 1 = enable
+  s->set_raw_gma(s, 1);        // 0 = disable, 1 = enable
+  s->set_lenc(s, 1);           // 0 = disable, 1 = enable
+  s->set_dcw(s, 1);            // 0 = disable, 1 = enable
+  s->set_colorbar(s, 0);       // 0 = disable, 1 = enable
+}
+
+// Writes the fields that differ from current, or all of them when current is null
+void applySensorSettings(sensor_t *s, const CameraSettings &next, const CameraSettings *current)
+{
+  if (!current || next.framesize != current->framesize)
+  {
+    s->set_framesize(s, (framesize_t)next.framesize);
+  }
+  if (!current || next.quality != current->quality)
+  {
+    s->set_quality(s, next.quality);
+  }
+  if (!current || next.brightness != current->brightness)
+  {
+    s->set_brightness(s, next.brightness);
+  }
+  if (!current || next.contrast != current->contrast)
+  {
+    s->set_contrast(s, next.contrast);
+  }
+  if (!current || next.saturation != current->saturation)
+  {
+    s->set_saturation(s, next.saturation);
+  }
+  if (!current || next.aec != current->aec)
+  {
+    s->set_exposure_ctrl(s, next.aec);
+  }
+  if (!current || next.aeLevel != current->aeLevel)
+  {
+    s->set_ae_level(s, next.aeLevel);
+  }
+  if (!current || next.aecValue != current->aecValue)
+  {
+    s->set_aec_value(s, next.aecValue);
+  }
+  if (!current || next.agc != current->agc)
+  {
+    s->set_gain_ctrl(s, next.agc);
+  }
+  if (!current || next.agcGain != current->agcGain)
+  {
+    s->set_agc_gain(s, next.agcGain);
+  }
+  if (!current || next.gainCeiling != current->gainCeiling)
+  {
+    s->set_gainceiling(s, (gainceiling_t)next.gainCeiling);
+  }
+  if (!current || next.hmirror != current->hmirror)
+  {
+    s->set_hmirror(s, next.hmirror);
+  }
+  if (!current || next.vflip != current->vflip)
+  {
+    s->set_vflip(s, next.vflip);
+  }
+}
+
+// Grab mode is fixed at esp_camera_init(), so switching it means a full
+// re-init. Waits for the stream tasks to hand back every buffer first; the
+// driver must not be torn down under a frame that is still being sent.
+bool reinitCamera(const CameraSettings &next)
+{
+  uint32_t start = millis();
+  while (frameFanout.framesHeld() > 0)
+  {
+    if (millis() - start >= CAMERA_REINIT_DRAIN_MS)
+    {
+      Serial.println("Camera re-init skipped: frames still in use.");
+      return false;
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+
+  esp_camera_deinit();
+  cameraConfig.grab_mode = (camera_grab_mode_t)next.grabMode;
+  esp_err_t err = esp_camera_init(&cameraConfig);
+  if (err != ESP_OK)
+  {
+    Serial.printf("Camera re-init failed with error 0x%x\n", err);
+    return false;
+  }
+  sensor_t *s = esp_camera_sensor_get();
+  if (!s)
+  {
+    Serial.println("Error: Could not get camera sensor handle");
+    return false;
+  }
+  applyFixedSensorSettings(s);
+  applySensorSettings(s, next, nullptr);
+  return true;
+}
+
+// Capture task only. Restarts the latency controller with the requested
+// frame size and quality as its best level.
+void startLatencyControl(const CameraSettings &requested)
+{
+  AbrLevel levels[ABR_MAX_LEVELS];
+  uint8_t count = 0;
+  latencyCeiling.framesize = requested.framesize;
+  latencyCeiling.quality = requested.quality;
+  levels[count++] = latencyCeiling;
+  for (size_t i = 0; i < LATENCY_LADDER_COUNT && count < ABR_MAX_LEVELS; i++)
+  {
+    const AbrLevel &level = LATENCY_LADDER[i];
+    if (level.framesize < requested.framesize ||
+        (level.framesize == requested.framesize && level.quality > requested.quality))
+    {
+      levels[count++] = level;
+    }
+  }
+
+  AbrConfig config = LATENCY_CONTROL_CONFIG;
+  config.targetLatencyMs = requested.targetLatencyMs;
+  xSemaphoreTake(latencyLock, portMAX_DELAY);
+  latencyController.configure(config, levels, count, millis());
+  xSemaphoreGive(latencyLock);
+  latencyControlActive.store(true, std::memory_order_relaxed);
+}
+
+// Capture task only. Follows the latency controller once it changes level.
+void applyLatencyLevel()
+{
+  if (activeSettings.targetLatencyMs <= 0) // Only this task writes it
+  {
+    return;
+  }
+  xSemaphoreTake(latencyLock, portMAX_DELAY);
+  AbrLevel level = latencyController.current();
+  xSemaphoreGive(latencyLock);
+  if (level.framesize == activeSettings.framesize && level.quality == activeSettings.quality)
+  {
+    return;
+  }
+
+  sensor_t *s = esp_camera_sensor_get();
+  if (!s)
+  {
+    return;
+  }
+  if (level.framesize != activeSettings.framesize)
+  {
+    s->set_framesize(s, (framesize_t)level.framesize);
+  }
+  if (level.quality != activeSettings.quality)
+  {
+    s->set_quality(s, level.quality);
+  }
+  xSemaphoreTake(settingsLock, portMAX_DELAY);
+  activeSettings.framesize = level.framesize;
+  activeSettings.quality = level.quality;
+  xSemaphoreGive(settingsLock);
+  Serial.printf("Stream latency control: framesize %d, quality %d\n", level.framesize, level.quality);
+}
+
+// Capture task only. Picks up the latest /control request and applies it.
+void applyRequestedSettings()
+{
+  uint32_t version = settingsVersion.load(std::memory_order_acquire);
+  if (version == appliedSettingsVersion.load(std::memory_order_relaxed))
+  {
+    return;
+  }
+
+  xSemaphoreTake(settingsLock, portMAX_DELAY);
+  CameraSettings next = requestedSettings;
+  CameraSettings current = activeSettings;
+  xSemaphoreGive(settingsLock);
+
+  // While a latency target is active it owns frame size and quality, and a
+  // bitrate target owns quality. A new target or ceiling starts from the
+  // requested values.
+  if (next.targetLatencyMs > 0)
+  {
+    if (next.targetLatencyMs != current.targetLatencyMs || next.framesize != latencyCeiling.framesize ||
+        next.quality != latencyCeiling.quality)
+    {
+      startLatencyControl(next);
+    }
+    xSemaphoreTake(latencyLock, portMAX_DELAY);
+    AbrLevel level = latencyController.current();
+    xSemaphoreGive(latencyLock);
+    next.framesize = level.framesize;
+    next.quality = level.quality;
+  }
+  else
+  {
+    latencyControlActive.store(false, std::memory_order_relaxed);
+    if (next.targetKbps > 0 && current.targetKbps > 0)
+    {
+      next.quality = current.quality;
+    }
+  }
+
+  // A failed re-init keeps the old grab mode and still applies the rest
+  if (next.grabMode != current.grabMode && !reinitCamera(next))
+  {
+    next.grabMode = current.grabMode;
+  }
+  if (next.grabMode == current.grabMode)
+  {
+    sensor_t *s = esp_camera_sensor_get();
+    if (s)
+    {
+      applySensorSettings(s, next, &current);
+    }
+  }
+
+  xSemaphoreTake(settingsLock, portMAX_DELAY);
+  activeSettings = next;
+  xSemaphoreGive(settingsLock);
+  appliedSettingsVersion.store(version, std::memory_order_release);
+  Serial.printf("Camera settings applied: framesize %d, quality %d, grab mode %d\n",
+                next.framesize, next.quality, next.grabMode);
+}
+
+// Called once per FPS window with the JPEG rate actually captured
+void adjustQualityForBitrate(uint32_t kbps)
+{
+  xSemaphoreTake(settingsLock, portMAX_DELAY);
+  CameraSettings current = activeSettings;
+  xSemaphoreGive(settingsLock);
+  if (current.targetKbps <= 0 || current.targetLatencyMs > 0 || kbps == 0)
+  {
+    return;
+  }
+
+  uint32_t target = current.targetKbps;
+  int quality = current.quality;
+  if (kbps * 100 > target * BITRATE_OVER_PERCENT)
+  {
+    quality += BITRATE_QUALITY_UP_STEP;
+  }
+  else if (kbps * 100 < target * BITRATE_UNDER_PERCENT)
+  {
+    quality -= BITRATE_QUALITY_DOWN_STEP;
+  }
+  quality = constrain(quality, BITRATE_MIN_QUALITY, CAMERA_MAX_QUALITY);
+  if (quality == current.quality)
+  {
+    return;
+  }
+
+  sensor_t *s = esp_camera_sensor_get();
+  if (!s)
+  {
+    return;
+  }
+  s->set_quality(s, quality);
+  xSemaphoreTake(settingsLock, portMAX_DELAY);
+  activeSettings.quality = quality;
+  xSemaphoreGive(settingsLock);
+}
+
+// OV2640 sensor bank (0x100) registers; other sensors keep their last value
+void sampleSensorExposure()
+{
+  sensor_t *s = esp_camera_sensor_get();
+  if (!s || s->id.PID != OV2640_PID)
+  {
+    return;
+  }
+  int aecHigh = s->get_reg(s, 0x145, 0x3F); // REG45 AEC[15:10]
+  int aecMid = s->get_reg(s, 0x110, 0xFF);  // AEC   AEC[9:2]
+  int aecLow = s->get_reg(s, 0x104, 0x03);  // REG04 AEC[1:0]
+  int gain = s->get_reg(s, 0x100, 0xFF);    // GAIN
+  if (aecHigh < 0 || aecMid < 0 || aecLow < 0 || gain < 0)
+  {
+    return;
+  }
+  sensorExposure.store(((uint32_t)aecHigh << 10) | ((uint32_t)aecMid << 2) | aecLow, std::memory_order_relaxed);
+  // Each of bits 7-4 doubles the gain, bits 3-0 add sixteenths
+  uint32_t sixteenths = 16 + (gain & 0x0F);
+  for (uint8_t bit = 4; bit < 8; bit++)
+  {
+    if (gain & (1 << bit))
+    {
+      sixteenths *= 2;
+    }
+  }
+  sensorGainSixteenths.store(sixteenths, std::memory_order_relaxed);
+}
+
+// Runs on the UDP task; the receive time is taken before anything else
+void onClockSyncReply(AsyncUDPPacket &packet)
+{
+  uint64_t receiveUs = esp_timer_get_time();
+  ClockSyncReply reply;
+  if (!decodeClockSyncResponse(packet.data(), packet.length(), reply))
+  {
+    return;
+  }
+  xSemaphoreTake(clockSyncLock, portMAX_DELAY);
+  bool used = clockSync.addExchange(reply, receiveUs);
+  xSemaphoreGive(clockSyncLock);
+  if (used)
+  {
+    clockSyncReplyMs.store(millis(), std::memory_order_relaxed);
+  }
+}
+
+void clockSyncTask(void *parameter)
+{
+  IPAddress motors;
+  uint32_t sequence = 0;
+  while (true)
+  {
+    uint32_t sinceReply = millis() - clockSyncReplyMs.load(std::memory_order_relaxed);
+    if (motors == IPAddress() || (sequence > 0 && sinceReply > CLOCK_SYNC_LOST_MS))
+    {
+      // The motor controller may have come back on another address
+      motors = MDNS.queryHost(MOTORS_MDNS_HOSTNAME, CLOCK_SYNC_RESOLVE_MS);
+      if (motors == IPAddress())
+      {
+        vTaskDelay(pdMS_TO_TICKS(CLOCK_SYNC_RESOLVE_MS));
+        continue;
+      }
+      Serial.printf("Clock sync: %s.local is %s\n", MOTORS_MDNS_HOSTNAME, motors.toString().c_str());
+      clockSyncReplyMs.store(millis(), std::memory_order_relaxed);
+    }
+
+    uint8_t request[CLOCK_SYNC_REQUEST_SIZE];
+    size_t len = encodeClockSyncRequest(sequence++, esp_timer_get_time(), request, sizeof(request));
+    clockSyncUdp.writeTo(request, len, motors, CLOCK_SYNC_PORT);
+
+    xSemaphoreTake(clockSyncLock, portMAX_DELAY);
+    bool filling = clockSync.samples() < CLOCK_SYNC_WINDOW;
+    xSemaphoreGive(clockSyncLock);
+    vTaskDelay(pdMS_TO_TICKS(filling ? CLOCK_SYNC_FAST_INTERVAL_MS : CLOCK_SYNC_INTERVAL_MS));
+  }
+}
+
+void startClockSync()
+{
+  if (!MDNS.begin(MDNS_HOSTNAME))
+  {
+    Serial.println("mDNS start failed; frames will not carry motor clock timestamps");
+    return;
+  }
+  if (!clockSyncUdp.listen(CLOCK_SYNC_PORT))
+  {
+    Serial.println("Clock sync UDP listen failed");
+    return;
+  }
+  clockSyncUdp.onPacket(onClockSyncReply);
+  xTaskCreatePinnedToCore(clockSyncTask, "clockSync", CLOCK_SYNC_TASK_STACK, NULL, 1, NULL, STREAM_TASK_CORE);
+}
+
+// The driver stamps each frame buffer with esp_timer at VSYNC, which is
+// closer to the exposure than anything this task can read after fb_get
+uint64_t captureTimeUs(const camera_fb_t *fb)
+{
+  uint64_t localUs = (uint64_t)fb->timestamp.tv_sec * 1000000ULL + fb->timestamp.tv_usec;
+  xSemaphoreTake(clockSyncLock, portMAX_DELAY);
+  uint64_t referenceUs = clockSync.synced(esp_timer_get_time()) ? clockSync.toReference(localUs) : 0;
+  xSemaphoreGive(clockSyncLock);
+  return referenceUs;
+}
+
+void captureTask(void *parameter)
+{
+  uint32_t windowStartMs = millis();
+  uint32_t windowFrames = 0;
+  uint32_t windowBytes = 0;
+  uint32_t lastCaptureMs = 0;
+  uint32_t lastExposureSampleMs = 0;
+
+  for (;;)
+  {
+    applyRequestedSettings();
+    applyLatencyLevel();
+
+    uint32_t now = millis();
+    if (now - windowStartMs >= FPS_WINDOW_MS)
+    {
+      uint32_t elapsed = now - windowStartMs;
+      uint32_t kbps = (uint32_t)((uint64_t)windowBytes * 8 / elapsed);
+      captureFpsTenths.store(windowFrames * 10000 / elapsed, std::memory_order_relaxed);
+      captureKbps.store(kbps, std::memory_order_relaxed);
+      adjustQualityForBitrate(kbps);
+      windowStartMs = now;
+      windowFrames = 0;
+      windowBytes = 0;
+    }
+
+    if (frameFanout.subscriberCount() == 0)
+    {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CAPTURE_IDLE_MS));
+      continue;
+    }
+    if (now - lastExposureSampleMs >= EXPOSURE_SAMPLE_MS)
+    {
+      sampleSensorExposure();
+      lastExposureSampleMs = now;
+    }
+    if (!frameFanout.hasFreeSlot())
+    {
+      captureWaits.fetch_add(1, std::memory_order_relaxed);
+      vTaskDelay(1);
+      continue;
+    }
+
+    // Frame rate target: with CAMERA_GRAB_LATEST the driver keeps filling its
+    // buffers meanwhile, so the frame taken after the wait is still fresh
+    int targetFps = activeSettings.targetFps; // Only this task writes it
+    if (targetFps > 0)
+    {
+      uint32_t interval = 1000 / targetFps;
+      uint32_t sinceLast = millis() - lastCaptureMs;
+      if (sinceLast < interval)
+      {
+        vTaskDelay(pdMS_TO_TICKS(interval - sinceLast));
+        continue;
+      }
+    }
+
+    camera_fb_t *fb = esp_camera_fb_get();
+    if (!fb)
+    {
+      captureFailures.fetch_add(1, std::memory_order_relaxed);
+      Serial.println("Camera capture failed");
+      // A short delay to prevent a tight loop of failures
+      vTaskDelay(pdMS_TO_TICKS(100));
+      continue;
+    }
+
+    size_t len = fb->len; // fb may be back with the driver as soon as publish() returns
+    if (!frameFanout.publish(fb, fb->buf, len, millis(), captureTimeUs(fb)))
+    {
+      esp_camera_fb_return(fb);
+      continue;
+    }
+    capturedFrames.fetch_add(1, std::memory_order_relaxed);
+    windowFrames++;
+    windowBytes += len;
+    lastCaptureMs = millis();
+    for (uint8_t i = 0; i < FANOUT_MAX_SUBSCRIBERS; i++)
+    {
+      if (frameFanout.subscribed(i))
+      {
+        xSemaphoreGive(frameReady[i]);
+      }
+    }
+  }
+}
+
+// Sends straight from the frame buffer in STREAM_CHUNK_SIZE pieces;
+// false once the client stops taking data
+bool writeFrameData(WiFiClient &client, const uint8_t *data, size_t len)
+{
+  while (len > 0)
+  {
+    size_t chunk = len < STREAM_CHUNK_SIZE ? len : STREAM_CHUNK_SIZE;
+    size_t written = client.write(data, chunk);
+    if (written == 0)
+    {
+      return false;
+    }
+    data += written;
+    len -= written;
+  }
+  return true;
+}
+
+void streamTask(void *parameter)
+{
+  StreamClient *stream = (StreamClient *)parameter;
+  WiFiClient &client = stream->client;
+  int id = stream->subscriber;
+
+  while (client.connected())
+  {
+    FanoutFrame *frame = frameFanout.take(id);
+    if (!frame)
+    {
+      xSemaphoreTake(frameReady[id], pdMS_TO_TICKS(STREAM_FRAME_WAIT_MS));
+      continue;
+    }
+
+    // Part header in one write, then the JPEG; drop our reference to the frame buffer after
+    char header[FRAME_HEADER_MAX];
+    int headerLen = snprintf(header, sizeof(header), FRAME_HEADER_FORMAT, (unsigned)frame->len,
+                             (unsigned long)frame->timestampMs, (unsigned long)frame->sequence,
+                             (unsigned long long)frame->captureUs);
+    uint32_t sendStart = millis();
+    bool sent = client.write((const uint8_t *)header, headerLen) == (size_t)headerLen &&
+                writeFrameData(client, frame->data, frame->len);
+    uint32_t sentAt = millis();
+    AbrSample sample = {(uint32_t)(headerLen + frame->len), sentAt - sendStart, sentAt - frame->timestampMs};
+    frameFanout.release(frame);
+    if (!sent)
+    {
+      break;
+    }
+    if (latencyControlActive.load(std::memory_order_relaxed))
+    {
+      xSemaphoreTake(latencyLock, portMAX_DELAY);
+      latencyController.addSample(id, sample, sentAt);
+      xSemaphoreGive(latencyLock);
+    }
+  }
+
+  FanoutSubscriberStats stats = frameFanout.stats(id);
+  closedSentFrames.fetch_add(stats.delivered, std::memory_order_relaxed);
+  closedSkippedFrames.fetch_add(stats.dropped, std::memory_order_relaxed);
+  frameFanout.unsubscribe(id);
+  xSemaphoreTake(latencyLock, portMAX_DELAY);
+  latencyController.removeStream(id);
+  xSemaphoreGive(latencyLock);
+  client.stop();
+  Serial.printf("Stream client %d disconnected: %lu frames sent, %lu skipped\n",
+                id, (unsigned long)stats.delivered, (unsigned long)stats.dropped);
+  delete stream;
+  vTaskDelete(NULL);
+}
 
 void handleJPGStream()
 {
@@ -40,6 +782,14 @@ void handleJPGStream()
     return;
   }
 
+  int subscriber = frameFanout.subscribe();
+  if (subscriber < 0)
+  {
+    server.send(503, "text/plain", "Too many stream clients");
+    Serial.println("Stream rejected: all subscriber slots in use.");
+    return;
+  }
+
   // Send the initial HTTP header for the MJPEG stream
   String response = "HTTP/1.1 200 OK\r\n";
   response += "Content-Type: " + String(STREAM_CONTENT_TYPE) + "\r\n";
@@ -48,31 +798,256 @@ void handleJPGStream()
 
   server.sendContent(response);
 
-  Serial.println("Started streaming to client.");
+  // Hand the connection to its own task so loop() keeps serving other requests
+  StreamClient *stream = new StreamClient{client, subscriber};
+  if (xTaskCreatePinnedToCore(streamTask, "stream", STREAM_TASK_STACK, stream, 1, NULL, STREAM_TASK_CORE) != pdPASS)
+  {
+    Serial.println("Could not start stream task.");
+    frameFanout.unsubscribe(subscriber);
+    delete stream;
+    return;
+  }
 
-  while (client.connected())
+  xTaskNotifyGive(captureTaskHandle);
+  Serial.printf("Started streaming to client %d (%u active).\n", subscriber, frameFanout.subscriberCount());
+}
+
+// Waits for a qualifying frame on a temporary subscription and answers with
+// that single JPEG. Runs on the WiFi core like the stream tasks, so a long
+// poll never holds up loop().
+void snapshotTask(void *parameter)
+{
+  SnapshotRequest *request = (SnapshotRequest *)parameter;
+  WiFiClient &client = request->client;
+  int id = request->subscriber;
+  uint32_t timeoutMs = request->longPoll ? SNAPSHOT_LONG_POLL_MS : SNAPSHOT_WAIT_MS;
+  uint32_t start = millis();
+
+  FanoutFrame *frame = nullptr;
+  while (client.connected() && millis() - start < timeoutMs)
   {
-    camera_fb_t *fb = esp_camera_fb_get();
-    if (!fb)
+    frame = frameFanout.take(id);
+    if (frame && (!request->longPoll || (int32_t)(frame->sequence - request->since) > 0))
+    {
+      break;
+    }
+    if (frame)
+    {
+      frameFanout.release(frame);
+      frame = nullptr;
+    }
+    xSemaphoreTake(frameReady[id], pdMS_TO_TICKS(STREAM_FRAME_WAIT_MS));
+  }
+  // Nothing else is needed from the fanout, so the slot is free while we send
+  frameFanout.unsubscribe(id);
+
+  char header[SNAPSHOT_HEADER_MAX];
+  if (frame)
+  {
+    xSemaphoreTake(settingsLock, portMAX_DELAY);
+    CameraSettings current = activeSettings;
+    xSemaphoreGive(settingsLock);
+    uint32_t gain = sensorGainSixteenths.load(std::memory_order_relaxed);
+    int headerLen = snprintf(header, sizeof(header), SNAPSHOT_HEADER_FORMAT, (unsigned)frame->len,
+                             (unsigned long)frame->sequence, (unsigned long)frame->timestampMs,
+                             (unsigned long long)frame->captureUs,
+                             (unsigned long)sensorExposure.load(std::memory_order_relaxed),
+                             (unsigned)(gain / 16), (unsigned)(gain % 16 * 100 / 16),
+                             current.aec, current.agc, current.framesize, current.quality);
+    if (client.write((const uint8_t *)header, headerLen) == (size_t)headerLen)
+    {
+      writeFrameData(client, frame->data, frame->len);
+    }
+    frameFanout.release(frame);
+  }
+  else if (client.connected())
+  {
+    int status = request->longPoll ? 204 : 503;
+    int headerLen = snprintf(header, sizeof(header),
+                             "HTTP/1.1 %d %s\r\nContent-Length: 0\r\nAccess-Control-Allow-Origin: *\r\n"
+                             "Connection: close\r\n\r\n",
+                             status, request->longPoll ? "No Content" : "Service Unavailable");
+    client.write((const uint8_t *)header, headerLen);
+  }
+
+  client.stop();
+  delete request;
+  vTaskDelete(NULL);
+}
+
+// /capture returns the next frame the camera produces; /capture?since=N waits
+// up to SNAPSHOT_LONG_POLL_MS for one newer than sequence N.
+void handleCapture()
+{
+  WiFiClient client = server.client();
+  if (!client.connected())
+  {
+    return;
+  }
+
+  bool longPoll = false;
+  uint32_t since = 0;
+  if (server.hasArg("since"))
+  {
+    String text = server.arg("since");
+    char *end;
+    since = strtoul(text.c_str(), &end, 10);
+    if (text.length() == 0 || *end != '\0')
+    {
+      server.send(400, "text/plain", "since must be a frame sequence number");
+      return;
+    }
+    // A sequence from before a reboot would never come up; answer with the next frame instead
+    uint32_t latest = frameFanout.published() - 1;
+    longPoll = (int32_t)(since - latest) <= 0;
+  }
+
+  int subscriber = frameFanout.subscribe();
+  if (subscriber < 0)
+  {
+    server.send(503, "text/plain", "All subscriber slots in use");
+    return;
+  }
+
+  SnapshotRequest *request = new SnapshotRequest{client, subscriber, longPoll, since};
+  if (xTaskCreatePinnedToCore(snapshotTask, "snapshot", SNAPSHOT_TASK_STACK, request, 1, NULL, STREAM_TASK_CORE) != pdPASS)
+  {
+    frameFanout.unsubscribe(subscriber);
+    delete request;
+    server.send(503, "text/plain", "Could not start capture task");
+    return;
+  }
+  xTaskNotifyGive(captureTaskHandle);
+}
+
+void handleStats()
+{
+  char body[512];
+  size_t len = snprintf(body, sizeof(body),
+                        "{\"captured\":%lu,\"captureFailures\":%lu,\"captureWaits\":%lu,\"captureFps\":%.1f,\"clients\":[",
+                        (unsigned long)capturedFrames.load(), (unsigned long)captureFailures.load(),
+                        (unsigned long)captureWaits.load(), captureFpsTenths.load() / 10.0f);
+  uint32_t sent = closedSentFrames.load();
+  uint32_t skipped = closedSkippedFrames.load();
+  bool first = true;
+  for (uint8_t i = 0; i < FANOUT_MAX_SUBSCRIBERS && len < sizeof(body); i++)
+  {
+    if (!frameFanout.subscribed(i))
     {
-      Serial.println("Camera capture failed");
-      // A short delay to prevent a tight loop of failures
-      delay(100);
       continue;
     }
+    FanoutSubscriberStats stats = frameFanout.stats(i);
+    sent += stats.delivered;
+    skipped += stats.dropped;
+    len += snprintf(body + len, sizeof(body) - len, "%s{\"id\":%u,\"sent\":%lu,\"skipped\":%lu}",
+                    first ? "" : ",", i, (unsigned long)stats.delivered, (unsigned long)stats.dropped);
+    first = false;
+  }
+  if (len < sizeof(body))
+  {
+    snprintf(body + len, sizeof(body) - len, "],\"sent\":%lu,\"skipped\":%lu}",
+             (unsigned long)sent, (unsigned long)skipped);
+  }
+  server.send(200, "application/json", body);
+}
 
-    // Write the frame boundary and content type directly to the client
-    client.write(FRAME_BOUNDARY, strlen(FRAME_BOUNDARY));
-    client.write(FRAME_CONTENT_TYPE, strlen(FRAME_CONTENT_TYPE));
+void handleStatus()
+{
+  xSemaphoreTake(settingsLock, portMAX_DELAY);
+  CameraSettings current = activeSettings;
+  xSemaphoreGive(settingsLock);
+  bool pending = settingsVersion.load() != appliedSettingsVersion.load();
+  xSemaphoreTake(latencyLock, portMAX_DELAY);
+  uint32_t latencyMs = latencyController.latencyMs();
+  uint32_t linkKbps = latencyController.throughputKbps();
+  xSemaphoreGive(latencyLock);
+  xSemaphoreTake(clockSyncLock, portMAX_DELAY);
+  bool clockSynced = clockSync.synced(esp_timer_get_time());
+  int64_t clockOffsetUs = clockSync.offsetUs();
+  uint32_t clockRttUs = clockSync.roundTripUs();
+  xSemaphoreGive(clockSyncLock);
 
-    // Write the JPEG image data
-    client.write(fb->buf, fb->len);
+  char body[768];
+  size_t len = snprintf(body, sizeof(body), "{");
+  for (size_t i = 0; i < CAMERA_SETTING_COUNT && len < sizeof(body); i++)
+  {
+    const CameraSettingField &setting = CAMERA_SETTING_FIELDS[i];
+    len += snprintf(body + len, sizeof(body) - len, "\"%s\":%d,", setting.name, current.*setting.field);
+  }
+  if (len < sizeof(body))
+  {
+    snprintf(body + len, sizeof(body) - len,
+             "\"pending\":%s,\"fps\":%.1f,\"kbps\":%lu,\"latencyMs\":%lu,\"linkKbps\":%lu,"
+             "\"clockSynced\":%s,\"clockOffsetUs\":%lld,\"clockRttUs\":%lu}",
+             pending ? "true" : "false", captureFpsTenths.load() / 10.0f, (unsigned long)captureKbps.load(),
+             (unsigned long)latencyMs, (unsigned long)linkKbps, clockSynced ? "true" : "false",
+             (long long)clockOffsetUs, (unsigned long)clockRttUs);
+  }
+  server.send(200, "application/json", body);
+}
 
-    // Return the frame buffer to be reused
-    esp_camera_fb_return(fb);
+// Returns an error message, or null once settings has been updated
+const char *setCameraSetting(CameraSettings &settings, const String &name, const String &text)
+{
+  for (size_t i = 0; i < CAMERA_SETTING_COUNT; i++)
+  {
+    const CameraSettingField &setting = CAMERA_SETTING_FIELDS[i];
+    if (name != setting.name)
+    {
+      continue;
+    }
+    char *end;
+    long value = strtol(text.c_str(), &end, 10);
+    if (text.length() == 0 || *end != '\0')
+    {
+      return "Value must be an integer";
+    }
+    if (value < setting.minValue || value > setting.maxValue)
+    {
+      return "Value out of range";
+    }
+    settings.*setting.field = (int)value;
+    return nullptr;
+  }
+  return "Unknown setting";
+}
+
+// /control?var=quality&val=12, or several at once as /control?quality=12&framesize=8.
+// Changes are applied by the capture task before its next frame; the reply
+// is the /status document with "pending" set until then.
+void handleControl()
+{
+  xSemaphoreTake(settingsLock, portMAX_DELAY);
+  CameraSettings next = requestedSettings;
+  xSemaphoreGive(settingsLock);
+
+  const char *error = nullptr;
+  if (server.hasArg("var"))
+  {
+    error = setCameraSetting(next, server.arg("var"), server.arg("val"));
+  }
+  else if (server.args() == 0)
+  {
+    error = "No settings given";
+  }
+  else
+  {
+    for (int i = 0; i < server.args() && !error; i++)
+    {
+      error = setCameraSetting(next, server.argName(i), server.arg(i));
+    }
+  }
+  if (error)
+  {
+    server.send(400, "text/plain", error);
+    return;
   }
 
-  Serial.println("Client disconnected.");
+  xSemaphoreTake(settingsLock, portMAX_DELAY);
+  requestedSettings = next;
+  xSemaphoreGive(settingsLock);
+  settingsVersion.fetch_add(1, std::memory_order_release);
+  handleStatus();
 }
 
 void handleRoot()
@@ -84,6 +1059,10 @@ void startCameraServer()
 {
   server.on("/", HTTP_GET, handleRoot);
   server.on("/stream", HTTP_GET, handleJPGStream);
+  server.on("/capture", HTTP_GET, handleCapture);
+  server.on("/stats", HTTP_GET, handleStats);
+  server.on("/status", HTTP_GET, handleStatus);
+  server.on("/control", HTTP_GET, handleControl);
   server.begin();
   Serial.println("HTTP server started.");
 }
@@ -95,7 +1074,10 @@ void setup()
   Serial.println();
   Serial.println("ESP32 AI Turret Cam Starting...");
 
-  camera_config_t config;
+  settingsLock = xSemaphoreCreateMutex();
+  latencyLock = xSemaphoreCreateMutex();
+
+  camera_config_t &config = cameraConfig;
   config.ledc_channel = LEDC_CHANNEL_0;
   config.ledc_timer = LEDC_TIMER_0;
   config.pin_d0 = Y2_GPIO_NUM;
@@ -117,11 +1099,11 @@ void setup()
   config.xclk_freq_hz = 10000000;
   config.pixel_format = PIXFORMAT_JPEG;
 
-  config.frame_size = FRAMESIZE_HVGA;
-  config.jpeg_quality = 20;
-  config.fb_count = 3;
+  config.frame_size = CAMERA_MAX_FRAMESIZE; // Sizes the buffers; the working size is set below
+  config.jpeg_quality = DEFAULT_CAMERA_SETTINGS.quality;
+  config.fb_count = CAMERA_FB_COUNT;
   config.fb_location = CAMERA_FB_IN_PSRAM;
-  config.grab_mode = CAMERA_GRAB_LATEST;
+  config.grab_mode = (camera_grab_mode_t)DEFAULT_CAMERA_SETTINGS.grabMode;
 
   esp_err_t err = esp_camera_init(&config);
   if (err != ESP_OK)
@@ -138,40 +1120,9 @@ void setup()
   {
     Serial.println("Configuring camera sensor settings...");
 
-    // Apply correct orientation settings - Mode 0 works for this camera
-    Serial.println("Applying camera orientation settings...");
-    Serial.println("Using Mode 0: Normal orientation (no flip, no mirror)");
-
-    s->set_vflip(s, 0);
-    s->set_hmirror(s, 0);
-    delay(100);
-
-    Serial.println("Camera orientation configured successfully");
-
-    // Give sensor time to apply settings
-    delay(500);
-
-    // Apply other sensor settings
-    s->set_brightness(s, 0);                 // -2 to 2
-    s->set_contrast(s, 0);                   // -2 to 2
-    s->set_saturation(s, 0);                 // -2 to 2
-    s->set_special_effect(s, 0);             // 0-6 (0 - no effect)
-    s->set_whitebal(s, 1);                   // 0 = disable, 1 = enable
-    s->set_awb_gain(s, 1);                   // 0 = disable, 1 = enable
-    s->set_wb_mode(s, 0);                    // 0-4 (0 - auto)
-    s->set_exposure_ctrl(s, 1);              // 0 = disable, 1 = enable
-    s->set_aec2(s, 0);                       // 0 = disable, 1 = enable
-    s->set_ae_level(s, 0);                   // -2 to 2
-    s->set_aec_value(s, 300);                // 0-1200
-    s->set_gain_ctrl(s, 1);                  // 0 = disable, 1 = enable
-    s->set_agc_gain(s, 0);                   // 0-30
-    s->set_gainceiling(s, (gainceiling_t)0); // 0-6
-    s->set_bpc(s, 0);                        // 0 = disable, 1 = enable
-    s->set_wpc(s, 1);                        // 0 = disable, 1 = enable
-    s->set_raw_gma(s, 1);                    // 0 = disable, 1 = enable
-    s->set_lenc(s, 1);                       // 0 = disable, 1 = enable
-    s->set_dcw(s, 1);                        // 0 = disable, 1 = enable
-    s->set_colorbar(s, 0);                   // 0 = disable, 1 = enable
+    // Mode 0 orientation (no flip, no mirror) works for this camera
+    applyFixedSensorSettings(s);
+    applySensorSettings(s, DEFAULT_CAMERA_SETTINGS, nullptr);
 
     Serial.println("Camera sensor configuration complete");
   }
@@ -192,6 +1143,16 @@ void setup()
   Serial.print("Camera Stream available at: http://");
   Serial.println(WiFi.localIP());
 
+  clockSyncLock = xSemaphoreCreateMutex();
+  startClockSync();
+
+  frameFanout.begin(returnFrameBuffer, CAMERA_FB_COUNT - 1);
+  for (uint8_t i = 0; i < FANOUT_MAX_SUBSCRIBERS; i++)
+  {
+    frameReady[i] = xSemaphoreCreateBinary();
+  }
+  xTaskCreatePinnedToCore(captureTask, "capture", CAPTURE_TASK_STACK, NULL, 2, &captureTaskHandle, CAPTURE_TASK_CORE);
+
   startCameraServer();
 }
 
@@ -0,0 +1,245 @@
+#include <unity.h>
+
+#include <stdio.h>
+
+#include "adaptive_bitrate.h"
+
+// Replays bandwidth traces through the latency controller. A simulated stream
+// task sends the newest 15 fps frame into a TCP send buffer drained at the
+// trace's rate, blocking while the buffer is full, and reports each frame the
+// way the firmware's sender does. Frame sizes follow the controller's level.
+
+const uint32_t TARGET_LATENCY_MS = 300;
+const float FRAME_PERIOD_MS = 1000.0f / 15.0f;
+const uint32_t PART_HEADER_BYTES = 150;
+
+// Settings from main.cpp's LATENCY_CONTROL_CONFIG
+const AbrConfig CONFIG = {TARGET_LATENCY_MS, 130, 60, 300, 3000, 1000, 2000, 30000, 5000, 5, 5744, 0.25f};
+
+// A VGA-down ladder as startLatencyControl() builds it, with typical JPEG sizes
+const AbrLevel LEVELS[] = {{8, 12}, {8, 20}, {8, 30}, {7, 15}, {7, 20}, {7, 28}, {7, 36}, {5, 24}, {5, 32}, {5, 45}, {3, 30}, {3, 45}};
+const uint32_t LEVEL_BYTES[] = {42000, 30000, 22000, 17000, 14000, 11000, 9000, 6500, 5200, 4000, 2200, 1600};
+const uint8_t LEVEL_COUNT = sizeof(LEVELS) / sizeof(LEVELS[0]);
+
+struct TraceStep
+{
+  uint32_t untilMs;
+  uint32_t kbps;
+};
+
+struct ReplayStats
+{
+  uint32_t changes;
+  uint32_t frames;
+  uint32_t framesOverTarget; // Viewer latency above 130% of the target
+  uint32_t worstLatencyMs;
+  float sumLevel;
+};
+
+class LinkReplay
+{
+public:
+  LinkReplay(const TraceStep *trace, size_t steps) : trace(trace), steps(steps)
+  {
+    abr.configure(CONFIG, LEVELS, LEVEL_COUNT, 0);
+  }
+
+  // Runs until endMs; stats cover frames sent from fromMs on
+  ReplayStats run(uint32_t endMs, uint32_t fromMs = 0)
+  {
+    ReplayStats stats = {};
+    while (nowMs < endMs)
+    {
+      // The newest frame not sent yet, captured at the level then in force
+      uint32_t frame = (uint32_t)(nowMs / FRAME_PERIOD_MS);
+      if ((int64_t)frame <= lastFrame)
+      {
+        advance(1.0f);
+        continue;
+      }
+      lastFrame = frame;
+      float capturedMs = frame * FRAME_PERIOD_MS;
+      uint32_t bytes = LEVEL_BYTES[abr.level()] + PART_HEADER_BYTES;
+
+      float sendStartMs = nowMs;
+      float remaining = (float)bytes;
+      while (remaining > 0.0f)
+      {
+        float space = CONFIG.socketBufferBytes - queued;
+        float put = space < remaining ? space : remaining;
+        queued += put;
+        remaining -= put;
+        if (remaining > 0.0f)
+        {
+          advance(1.0f);
+        }
+      }
+
+      AbrSample sample = {bytes, (uint32_t)(nowMs - sendStartMs), (uint32_t)(nowMs - capturedMs)};
+      uint8_t before = abr.level();
+      abr.addSample(0, sample, (uint32_t)nowMs);
+      if (nowMs >= fromMs)
+      {
+        stats.changes += abr.level() != before ? 1 : 0;
+        uint32_t viewerLatency = (uint32_t)(nowMs - capturedMs + queued / rate());
+        stats.frames++;
+        stats.framesOverTarget += viewerLatency * 100 > TARGET_LATENCY_MS * CONFIG.highPercent ? 1 : 0;
+        stats.worstLatencyMs = viewerLatency > stats.worstLatencyMs ? viewerLatency : stats.worstLatencyMs;
+        stats.sumLevel += abr.level();
+      }
+    }
+    return stats;
+  }
+
+  AdaptiveBitrate abr;
+
+private:
+  float rate() const // bytes/ms
+  {
+    for (size_t i = 0; i < steps; i++)
+    {
+      if (nowMs < trace[i].untilMs)
+      {
+        return trace[i].kbps / 8.0f;
+      }
+    }
+    return trace[steps - 1].kbps / 8.0f;
+  }
+
+  void advance(float ms)
+  {
+    queued -= rate() * ms;
+    queued = queued < 0.0f ? 0.0f : queued;
+    nowMs += ms;
+  }
+
+  const TraceStep *trace;
+  size_t steps;
+  float nowMs = 0.0f;
+  float queued = 0.0f;
+  int64_t lastFrame = -1;
+};
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void report(const char *name, const ReplayStats &s)
+{
+  char line[160];
+  snprintf(line, sizeof(line), "%s: %u changes, %u/%u frames over target, worst %u ms, mean level %.1f",
+           name, s.changes, s.framesOverTarget, s.frames, s.worstLatencyMs, s.frames ? s.sumLevel / s.frames : 0.0f);
+  TEST_MESSAGE(line);
+}
+
+static void test_ample_link_keeps_best_level(void)
+{
+  const TraceStep trace[] = {{UINT32_MAX, 12000}};
+  LinkReplay replay(trace, 1);
+  ReplayStats s = replay.run(60000);
+  report("ample", s);
+  TEST_ASSERT_EQUAL(0, s.changes);
+  TEST_ASSERT_EQUAL(0, replay.abr.level());
+  TEST_ASSERT_EQUAL(0, s.framesOverTarget);
+}
+
+// The link drops to a thirtieth. Sends then block for most of a second, so
+// samples are sparse, but within 10 s latency holds near the target; the best
+// level returns once the link does.
+static void test_step_down_and_recovery(void)
+{
+  const TraceStep trace[] = {{20000, 12000}, {60000, 400}, {UINT32_MAX, 12000}};
+  LinkReplay replay(trace, 3);
+  replay.run(20000);
+  TEST_ASSERT_EQUAL(0, replay.abr.level());
+
+  ReplayStats adapting = replay.run(30000, 20000);
+  report("step down, first 10 s", adapting);
+  TEST_ASSERT_GREATER_THAN(2, replay.abr.level());
+  ReplayStats degraded = replay.run(60000, 30000);
+  report("step down, settled", degraded);
+  TEST_ASSERT_LESS_THAN(TARGET_LATENCY_MS * 3 / 2, degraded.worstLatencyMs);
+  // Not starved either: it settles well above the bottom of the ladder
+  TEST_ASSERT_TRUE(degraded.sumLevel / degraded.frames < LEVEL_COUNT / 2);
+
+  ReplayStats recovered = replay.run(150000, 60000);
+  report("recovery", recovered);
+  TEST_ASSERT_EQUAL(0, replay.abr.level());
+  TEST_ASSERT_EQUAL(0, recovered.framesOverTarget);
+}
+
+// A link that flaps between good and marginal every few seconds: failed
+// climbs double the backoff, so the level settles instead of oscillating
+static void test_flapping_link_backs_off(void)
+{
+  TraceStep trace[60];
+  for (size_t i = 0; i < 60; i++)
+  {
+    trace[i] = {(uint32_t)(i + 1) * 4000, i % 2 ? 500u : 4000u};
+  }
+  LinkReplay replay(trace, 60);
+  ReplayStats early = replay.run(60000);
+  ReplayStats late = replay.run(240000, 120000);
+  report("flapping, first minute", early);
+  report("flapping, minutes 2-4", late);
+  TEST_ASSERT_EQUAL(CONFIG.maxUpgradeBackoffMs, replay.abr.upgradeBackoffMs());
+  // Later on it changes level less in two minutes than it did in the first one
+  TEST_ASSERT_LESS_THAN(early.changes, late.changes);
+  TEST_ASSERT_TRUE(late.framesOverTarget * 5 < late.frames);
+}
+
+// Throughput and latency come from blocked sends only; a fast link with
+// small frames never degrades on queueing it does not have
+static void test_unblocked_sends_do_not_degrade(void)
+{
+  AdaptiveBitrate abr;
+  abr.configure(CONFIG, LEVELS, LEVEL_COUNT, 0);
+  for (uint32_t ms = 0; ms < 20000; ms += 66)
+  {
+    AbrSample sample = {5000, 2, 40};
+    abr.addSample(0, sample, ms);
+  }
+  TEST_ASSERT_EQUAL(0, abr.level());
+  TEST_ASSERT_EQUAL(40, abr.latencyMs());
+}
+
+// The worst stream drives the level, and a stream that leaves stops counting
+static void test_worst_stream_drives_level(void)
+{
+  AdaptiveBitrate abr;
+  abr.configure(CONFIG, LEVELS, LEVEL_COUNT, 0);
+  AbrSample good = {5000, 0, 60};
+  AbrSample bad = {5000, 0, 900};
+  uint32_t ms = 0;
+  for (; ms < 3000; ms += 66)
+  {
+    abr.addSample(0, good, ms);
+    abr.addSample(1, bad, ms);
+  }
+  TEST_ASSERT_GREATER_THAN(0, abr.level());
+  uint8_t degraded = abr.level();
+  abr.removeStream(1);
+  TEST_ASSERT_TRUE(abr.latencyMs() < 100);
+  for (; ms < 12000; ms += 66)
+  {
+    abr.addSample(0, good, ms);
+  }
+  TEST_ASSERT_LESS_THAN(degraded, abr.level());
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_ample_link_keeps_best_level);
+  RUN_TEST(test_step_down_and_recovery);
+  RUN_TEST(test_flapping_link_backs_off);
+  RUN_TEST(test_unblocked_sends_do_not_degrade);
+  RUN_TEST(test_worst_stream_drives_level);
+  return UNITY_END();
+}
@@ -0,0 +1,221 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "clock_sync.h"
+
+// Runs ClockSyncEstimator against a local stand-in for the motor controller:
+// a clock some offset ahead of the camera's that answers each request after
+// its own processing time. Each exchange sets the two path delays, so the
+// filter's choice among asymmetric exchanges can be checked exactly.
+
+const int64_t MOTOR_OFFSET_US = 12345678; // Motor controller clock minus camera clock
+const uint32_t PROCESSING_US = 40;        // Between the responder's t1 and t2
+
+class MotorStandIn
+{
+public:
+  int64_t offsetUs = MOTOR_OFFSET_US;
+
+  // Builds the response the motor firmware sends for request bytes arriving at
+  // local time arriveUs
+  size_t answer(const uint8_t *request, uint64_t arriveUs, uint8_t *out)
+  {
+    memcpy(out, request, CLOCK_SYNC_REQUEST_SIZE);
+    out[2] = CLOCK_SYNC_RESPONSE;
+    putU64(out + 16, arriveUs + offsetUs);
+    putU64(out + 24, arriveUs + offsetUs + PROCESSING_US);
+    return CLOCK_SYNC_RESPONSE_SIZE;
+  }
+
+private:
+  static void putU64(uint8_t *p, uint64_t v)
+  {
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      p[i] = (uint8_t)(v >> (8 * i));
+    }
+  }
+};
+
+static MotorStandIn motor;
+static uint32_t sequence = 0;
+static uint64_t nowUs = 0;
+
+void setUp(void)
+{
+  motor = MotorStandIn();
+  sequence = 0;
+  nowUs = 1000000;
+}
+
+void tearDown(void)
+{
+}
+
+// One request/response round trip sent at nowUs; returns what addExchange did
+static bool exchange(ClockSyncEstimator &sync, uint32_t upUs, uint32_t downUs)
+{
+  uint8_t request[CLOCK_SYNC_REQUEST_SIZE];
+  uint8_t response[CLOCK_SYNC_RESPONSE_SIZE];
+  TEST_ASSERT_EQUAL(CLOCK_SYNC_REQUEST_SIZE, encodeClockSyncRequest(++sequence, nowUs, request, sizeof(request)));
+  motor.answer(request, nowUs + upUs, response);
+  uint64_t receiveUs = nowUs + upUs + PROCESSING_US + downUs;
+
+  ClockSyncReply reply;
+  TEST_ASSERT_TRUE(decodeClockSyncResponse(response, sizeof(response), reply));
+  TEST_ASSERT_EQUAL_UINT32(sequence, reply.sequence);
+  bool used = sync.addExchange(reply, receiveUs);
+  nowUs += 1000000;
+  return used;
+}
+
+static void test_unsynced_until_first_exchange(void)
+{
+  ClockSyncEstimator sync;
+  TEST_ASSERT_FALSE(sync.synced(nowUs));
+  TEST_ASSERT_EQUAL_INT64(0, sync.offsetUs());
+  TEST_ASSERT_EQUAL_UINT64(nowUs, sync.toReference(nowUs));
+
+  TEST_ASSERT_TRUE(exchange(sync, 800, 800));
+  TEST_ASSERT_TRUE(sync.synced(nowUs));
+  TEST_ASSERT_EQUAL_INT64(MOTOR_OFFSET_US, sync.offsetUs());
+  TEST_ASSERT_EQUAL_UINT32(1600, sync.roundTripUs());
+  TEST_ASSERT_EQUAL_UINT64(nowUs + MOTOR_OFFSET_US, sync.toReference(nowUs));
+}
+
+// An asymmetric path skews the offset by half the difference; the exchange
+// with the shortest round trip wins even when it is not the newest
+static void test_min_rtt_exchange_wins(void)
+{
+  ClockSyncEstimator sync;
+  TEST_ASSERT_TRUE(exchange(sync, 9000, 1000));
+  TEST_ASSERT_EQUAL_INT64(MOTOR_OFFSET_US + 4000, sync.offsetUs());
+
+  TEST_ASSERT_TRUE(exchange(sync, 1500, 700));
+  TEST_ASSERT_TRUE(exchange(sync, 400, 15000));
+  TEST_ASSERT_TRUE(exchange(sync, 20000, 3000));
+  TEST_ASSERT_EQUAL(4, sync.samples());
+  TEST_ASSERT_EQUAL_UINT32(2200, sync.roundTripUs());
+  TEST_ASSERT_EQUAL_INT64(MOTOR_OFFSET_US + 400, sync.offsetUs());
+}
+
+// The best exchange stops counting once CLOCK_SYNC_WINDOW newer ones replace it
+static void test_window_forgets_old_exchanges(void)
+{
+  ClockSyncEstimator sync;
+  TEST_ASSERT_TRUE(exchange(sync, 300, 300));
+  for (uint8_t i = 0; i < CLOCK_SYNC_WINDOW - 1; i++)
+  {
+    TEST_ASSERT_TRUE(exchange(sync, 3000 + i * 100, 1000));
+    TEST_ASSERT_EQUAL_UINT32(600, sync.roundTripUs());
+  }
+  TEST_ASSERT_EQUAL(CLOCK_SYNC_WINDOW, sync.samples());
+
+  TEST_ASSERT_TRUE(exchange(sync, 5000, 1000));
+  TEST_ASSERT_EQUAL(CLOCK_SYNC_WINDOW, sync.samples());
+  TEST_ASSERT_EQUAL_UINT32(4000, sync.roundTripUs());
+  TEST_ASSERT_EQUAL_INT64(MOTOR_OFFSET_US + 1000, sync.offsetUs());
+}
+
+static void test_slow_exchanges_are_ignored(void)
+{
+  ClockSyncEstimator sync;
+  TEST_ASSERT_TRUE(exchange(sync, 1000, 1000));
+  TEST_ASSERT_FALSE(exchange(sync, CLOCK_SYNC_MAX_RTT_US, 1000));
+  TEST_ASSERT_EQUAL(1, sync.samples());
+  TEST_ASSERT_EQUAL_INT64(MOTOR_OFFSET_US, sync.offsetUs());
+
+  // Exactly at the limit still counts
+  TEST_ASSERT_TRUE(exchange(sync, CLOCK_SYNC_MAX_RTT_US - 1000, 1000));
+  TEST_ASSERT_EQUAL(2, sync.samples());
+}
+
+// Replies that cannot be a real round trip (answered before they were asked,
+// or a responder that spent longer than the whole exchange) are dropped
+static void test_impossible_replies_are_ignored(void)
+{
+  ClockSyncEstimator sync;
+  ClockSyncReply reply = {1, 5000, 9000, 9100};
+  TEST_ASSERT_FALSE(sync.addExchange(reply, 4000));
+  reply = {1, 5000, 9000, 8000};
+  TEST_ASSERT_FALSE(sync.addExchange(reply, 6000));
+  reply = {1, 5000, 9000, 12000};
+  TEST_ASSERT_FALSE(sync.addExchange(reply, 6000));
+  TEST_ASSERT_EQUAL(0, sync.samples());
+  TEST_ASSERT_FALSE(sync.synced(6000));
+}
+
+// The motor controller reboots: its clock restarts near zero, far from the
+// old offset, and the old window (whose round trips are shorter) must not win
+static void test_reboot_resets_the_window(void)
+{
+  ClockSyncEstimator sync;
+  for (int i = 0; i < 5; i++)
+  {
+    TEST_ASSERT_TRUE(exchange(sync, 300, 300));
+  }
+  TEST_ASSERT_EQUAL(5, sync.samples());
+
+  motor.offsetUs = -(int64_t)nowUs + 2000000;
+  TEST_ASSERT_TRUE(exchange(sync, 2000, 2000));
+  TEST_ASSERT_EQUAL(1, sync.samples());
+  TEST_ASSERT_EQUAL_INT64(motor.offsetUs, sync.offsetUs());
+
+  // A small drift is not a reboot
+  motor.offsetUs += CLOCK_SYNC_STEP_US / 2;
+  TEST_ASSERT_TRUE(exchange(sync, 1000, 1000));
+  TEST_ASSERT_EQUAL(2, sync.samples());
+  TEST_ASSERT_EQUAL_INT64(motor.offsetUs, sync.offsetUs());
+}
+
+static void test_goes_stale_without_exchanges(void)
+{
+  ClockSyncEstimator sync;
+  TEST_ASSERT_TRUE(exchange(sync, 500, 500));
+  uint64_t lastUs = nowUs - 1000000 + 500 + PROCESSING_US + 500;
+  TEST_ASSERT_TRUE(sync.synced(lastUs + CLOCK_SYNC_STALE_US - 1));
+  TEST_ASSERT_FALSE(sync.synced(lastUs + CLOCK_SYNC_STALE_US));
+  // Stale keeps the last offset for stamping, and one exchange revives it
+  TEST_ASSERT_EQUAL_INT64(MOTOR_OFFSET_US, sync.offsetUs());
+  nowUs = lastUs + CLOCK_SYNC_STALE_US;
+  TEST_ASSERT_TRUE(exchange(sync, 500, 500));
+  TEST_ASSERT_TRUE(sync.synced(nowUs));
+}
+
+static void test_decode_rejects_bad_responses(void)
+{
+  uint8_t request[CLOCK_SYNC_REQUEST_SIZE];
+  uint8_t response[CLOCK_SYNC_RESPONSE_SIZE];
+  TEST_ASSERT_EQUAL(0, encodeClockSyncRequest(1, 0, request, sizeof(request) - 1));
+  encodeClockSyncRequest(7, 123456789, request, sizeof(request));
+  motor.answer(request, 123460000, response);
+
+  ClockSyncReply reply;
+  TEST_ASSERT_TRUE(decodeClockSyncResponse(response, sizeof(response), reply));
+  TEST_ASSERT_EQUAL_UINT64(123456789, reply.clientSendUs);
+  TEST_ASSERT_EQUAL_UINT64(123460000 + MOTOR_OFFSET_US, reply.serverReceiveUs);
+  TEST_ASSERT_FALSE(decodeClockSyncResponse(response, sizeof(response) - 1, reply));
+  TEST_ASSERT_FALSE(decodeClockSyncResponse(request, sizeof(request), reply));
+  response[0] ^= 0xFF;
+  TEST_ASSERT_FALSE(decodeClockSyncResponse(response, sizeof(response), reply));
+  response[0] ^= 0xFF;
+  response[2] = CLOCK_SYNC_REQUEST;
+  TEST_ASSERT_FALSE(decodeClockSyncResponse(response, sizeof(response), reply));
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_unsynced_until_first_exchange);
+  RUN_TEST(test_min_rtt_exchange_wins);
+  RUN_TEST(test_window_forgets_old_exchanges);
+  RUN_TEST(test_slow_exchanges_are_ignored);
+  RUN_TEST(test_impossible_replies_are_ignored);
+  RUN_TEST(test_reboot_resets_the_window);
+  RUN_TEST(test_goes_stale_without_exchanges);
+  RUN_TEST(test_decode_rejects_bad_responses);
+  return UNITY_END();
+}
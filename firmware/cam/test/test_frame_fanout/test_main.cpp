@@ -0,0 +1,339 @@
+#include <unity.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "frame_fanout.h"
+
+// Drives FrameFanout with a fake frame source standing in for the camera
+// driver: a fixed pool of buffers that the capture thread takes from and the
+// release callback returns to, as esp_camera_fb_get/esp_camera_fb_return do.
+
+const int CAMERA_FB_COUNT = 3; // As configured in main.cpp
+const size_t FRAME_BYTES = 64;
+
+struct FakeBuffer
+{
+  uint8_t data[FRAME_BYTES];
+  bool out; // Handed to the fanout and not yet returned
+};
+
+static FakeBuffer pool[CAMERA_FB_COUNT];
+static std::mutex poolLock;
+static std::atomic<uint32_t> doubleReturns(0);
+
+static void returnBuffer(void *handle)
+{
+  std::lock_guard<std::mutex> guard(poolLock);
+  FakeBuffer *buffer = (FakeBuffer *)handle;
+  if (!buffer->out)
+  {
+    doubleReturns++;
+  }
+  buffer->out = false;
+}
+
+// The camera driver's side: null when every buffer is out
+static FakeBuffer *getBuffer(uint32_t sequence)
+{
+  std::lock_guard<std::mutex> guard(poolLock);
+  for (FakeBuffer &buffer : pool)
+  {
+    if (!buffer.out)
+    {
+      buffer.out = true;
+      for (size_t i = 0; i < FRAME_BYTES; i++)
+      {
+        buffer.data[i] = (uint8_t)(sequence + i);
+      }
+      return &buffer;
+    }
+  }
+  return nullptr;
+}
+
+static int buffersOut()
+{
+  std::lock_guard<std::mutex> guard(poolLock);
+  int out = 0;
+  for (FakeBuffer &buffer : pool)
+  {
+    out += buffer.out ? 1 : 0;
+  }
+  return out;
+}
+
+// Captures one frame the way the capture task does; false when it had to skip
+static bool capture(FrameFanout &fanout, uint32_t sequence)
+{
+  if (!fanout.hasFreeSlot())
+  {
+    return false;
+  }
+  FakeBuffer *buffer = getBuffer(sequence);
+  if (!buffer)
+  {
+    return false;
+  }
+  if (!fanout.publish(buffer, buffer->data, FRAME_BYTES, sequence))
+  {
+    returnBuffer(buffer);
+    return false;
+  }
+  return true;
+}
+
+void setUp(void)
+{
+  for (FakeBuffer &buffer : pool)
+  {
+    buffer.out = false;
+  }
+  doubleReturns = 0;
+}
+
+void tearDown(void)
+{
+}
+
+static void test_every_subscriber_sees_the_same_buffer(void)
+{
+  FrameFanout fanout;
+  fanout.begin(returnBuffer, CAMERA_FB_COUNT - 1);
+  int a = fanout.subscribe();
+  int b = fanout.subscribe();
+  TEST_ASSERT_EQUAL(2, fanout.subscriberCount());
+  TEST_ASSERT_TRUE(capture(fanout, 0));
+
+  FanoutFrame *fa = fanout.take(a);
+  FanoutFrame *fb = fanout.take(b);
+  TEST_ASSERT_NOT_NULL(fa);
+  TEST_ASSERT_TRUE(fa == fb);
+  TEST_ASSERT_NULL(fanout.take(a)); // Nothing newer yet
+  TEST_ASSERT_EQUAL(FRAME_BYTES, fa->len);
+  fanout.release(fa);
+  TEST_ASSERT_EQUAL(1, buffersOut());
+  fanout.release(fb);
+  TEST_ASSERT_EQUAL(0, buffersOut());
+  TEST_ASSERT_EQUAL(0, fanout.framesHeld());
+}
+
+// A newer frame replaces one the subscriber has not taken, and the replaced
+// buffer goes straight back to the driver
+static void test_slow_subscriber_skips_frames(void)
+{
+  FrameFanout fanout;
+  fanout.begin(returnBuffer, CAMERA_FB_COUNT - 1);
+  int slow = fanout.subscribe();
+  for (uint32_t i = 0; i < 10; i++)
+  {
+    TEST_ASSERT_TRUE(capture(fanout, i));
+    TEST_ASSERT_EQUAL(1, buffersOut());
+  }
+  FanoutFrame *frame = fanout.take(slow);
+  TEST_ASSERT_EQUAL(9, frame->sequence);
+  FanoutSubscriberStats stats = fanout.stats(slow);
+  TEST_ASSERT_EQUAL(1, stats.delivered);
+  TEST_ASSERT_EQUAL(9, stats.dropped);
+  fanout.release(frame);
+  TEST_ASSERT_EQUAL(0, buffersOut());
+}
+
+// Frames being sent plus the one waiting never take the driver's last buffer
+static void test_frame_limit_leaves_a_capture_buffer(void)
+{
+  FrameFanout fanout;
+  fanout.begin(returnBuffer, CAMERA_FB_COUNT - 1);
+  int a = fanout.subscribe();
+  int b = fanout.subscribe();
+  TEST_ASSERT_TRUE(capture(fanout, 0));
+  FanoutFrame *sendingA = fanout.take(a);
+  TEST_ASSERT_TRUE(capture(fanout, 1));
+  FanoutFrame *sendingB = fanout.take(b);
+  TEST_ASSERT_EQUAL(2, fanout.framesHeld());
+  TEST_ASSERT_FALSE(fanout.hasFreeSlot());
+  TEST_ASSERT_FALSE(capture(fanout, 2));
+  TEST_ASSERT_EQUAL(CAMERA_FB_COUNT - 1, buffersOut());
+
+  fanout.release(sendingA);
+  TEST_ASSERT_TRUE(capture(fanout, 2));
+  fanout.release(sendingB);
+  fanout.release(fanout.take(a));
+  fanout.release(fanout.take(b));
+  TEST_ASSERT_EQUAL(0, buffersOut());
+}
+
+// A slow viewer's waiting frame is dropped for a fresh capture instead of
+// pinning the last free buffer while it is still sending
+static void test_waiting_frame_yields_to_capture(void)
+{
+  FrameFanout fanout;
+  fanout.begin(returnBuffer, CAMERA_FB_COUNT - 1);
+  int slow = fanout.subscribe();
+  int fast = fanout.subscribe();
+  TEST_ASSERT_TRUE(capture(fanout, 0));
+  FanoutFrame *sending = fanout.take(slow);
+  fanout.release(fanout.take(fast));
+  TEST_ASSERT_TRUE(capture(fanout, 1));
+  fanout.release(fanout.take(fast));
+  TEST_ASSERT_EQUAL(2, fanout.framesHeld()); // Slow viewer's frame 0 and its waiting frame 1
+
+  TEST_ASSERT_TRUE(capture(fanout, 2));
+  TEST_ASSERT_EQUAL(1, fanout.stats(slow).dropped); // Frame 1, never sent
+  FanoutFrame *frame = fanout.take(fast);
+  TEST_ASSERT_EQUAL(2, frame->sequence);
+  fanout.release(frame);
+  fanout.release(sending);
+  frame = fanout.take(slow);
+  TEST_ASSERT_EQUAL(2, frame->sequence);
+  fanout.release(frame);
+  TEST_ASSERT_EQUAL(0, buffersOut());
+}
+
+static void test_subscriber_slots(void)
+{
+  FrameFanout fanout;
+  fanout.begin(returnBuffer, CAMERA_FB_COUNT - 1);
+  int ids[FANOUT_MAX_SUBSCRIBERS];
+  for (int &id : ids)
+  {
+    id = fanout.subscribe();
+    TEST_ASSERT_TRUE(id >= 0);
+  }
+  TEST_ASSERT_EQUAL(-1, fanout.subscribe());
+
+  // Leaving drops the pending frame; a frame already taken is still released by its owner
+  TEST_ASSERT_TRUE(capture(fanout, 0));
+  FanoutFrame *taken = fanout.take(ids[0]);
+  fanout.unsubscribe(ids[0]);
+  fanout.unsubscribe(ids[1]);
+  TEST_ASSERT_FALSE(fanout.subscribed(ids[0]));
+  TEST_ASSERT_EQUAL(FANOUT_MAX_SUBSCRIBERS - 2, fanout.subscriberCount());
+  fanout.unsubscribe(ids[2]);
+  fanout.unsubscribe(ids[3]);
+  TEST_ASSERT_EQUAL(1, buffersOut());
+  fanout.release(taken);
+  TEST_ASSERT_EQUAL(0, buffersOut());
+
+  // A reused slot starts with fresh counters
+  int again = fanout.subscribe();
+  TEST_ASSERT_EQUAL(0, fanout.stats(again).delivered);
+  TEST_ASSERT_EQUAL(0, fanout.stats(again).dropped);
+}
+
+struct ViewerResult
+{
+  uint32_t frames;
+  uint32_t outOfOrder;
+  uint32_t corrupt;
+};
+
+// A stream task: takes the newest frame, "sends" it for sendUs and releases it
+static void view(FrameFanout &fanout, int id, uint32_t sendUs, std::atomic<bool> &stop, ViewerResult &result)
+{
+  bool first = true;
+  uint32_t last = 0;
+  while (!stop)
+  {
+    FanoutFrame *frame = fanout.take(id);
+    if (!frame)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    if (!first && frame->sequence <= last)
+    {
+      result.outOfOrder++;
+    }
+    if (frame->data[0] != (uint8_t)frame->sequence || frame->data[FRAME_BYTES - 1] != (uint8_t)(frame->sequence + FRAME_BYTES - 1))
+    {
+      result.corrupt++;
+    }
+    first = false;
+    last = frame->sequence;
+    result.frames++;
+    std::this_thread::sleep_for(std::chrono::microseconds(sendUs));
+    fanout.release(frame);
+  }
+}
+
+// Capture at ~1 kHz with a fast viewer, a slow one, and one that comes and
+// goes. Buffers must never be returned twice or leak, viewers must see frames
+// newest-first and intact, and the slow viewer must not hold up the others.
+static void test_capture_with_concurrent_viewers(void)
+{
+  FrameFanout fanout;
+  fanout.begin(returnBuffer, CAMERA_FB_COUNT - 1);
+  std::atomic<bool> stop(false);
+  ViewerResult fast = {}, slow = {}, churn = {};
+  int fastId = fanout.subscribe();
+  int slowId = fanout.subscribe();
+  std::thread fastViewer(view, std::ref(fanout), fastId, 100, std::ref(stop), std::ref(fast));
+  std::thread slowViewer(view, std::ref(fanout), slowId, 20000, std::ref(stop), std::ref(slow));
+  std::thread churnViewer([&]()
+                          {
+                            while (!stop)
+                            {
+                              int id = fanout.subscribe();
+                              std::atomic<bool> leave(false);
+                              std::thread t(view, std::ref(fanout), id, 300, std::ref(leave), std::ref(churn));
+                              std::this_thread::sleep_for(std::chrono::milliseconds(7));
+                              leave = true;
+                              t.join();
+                              fanout.unsubscribe(id);
+                            }
+                          });
+
+  uint32_t published = 0;
+  uint32_t skipped = 0;
+  int worstOut = 0;
+  for (uint32_t i = 0; i < 1500; i++)
+  {
+    if (capture(fanout, published))
+    {
+      published++;
+    }
+    else
+    {
+      skipped++;
+    }
+    worstOut = std::max(worstOut, buffersOut());
+    std::this_thread::sleep_for(std::chrono::microseconds(1000));
+  }
+  stop = true;
+  fastViewer.join();
+  slowViewer.join();
+  churnViewer.join();
+  fanout.unsubscribe(fastId);
+  fanout.unsubscribe(slowId);
+
+  TEST_ASSERT_EQUAL(0, doubleReturns.load());
+  TEST_ASSERT_EQUAL(0, buffersOut());
+  TEST_ASSERT_EQUAL(0, fanout.framesHeld());
+  TEST_ASSERT_LESS_OR_EQUAL(CAMERA_FB_COUNT - 1, worstOut);
+  TEST_ASSERT_EQUAL(published, fanout.published());
+  TEST_ASSERT_EQUAL(0, fast.outOfOrder + slow.outOfOrder + churn.outOfOrder);
+  TEST_ASSERT_EQUAL(0, fast.corrupt + slow.corrupt + churn.corrupt);
+  TEST_ASSERT_GREATER_THAN(0, slow.frames);
+  TEST_ASSERT_GREATER_THAN(0, churn.frames);
+  // The slow viewer pins one buffer at most; the fast one keeps up with capture
+  TEST_ASSERT_GREATER_THAN(slow.frames * 5, fast.frames);
+  TEST_ASSERT_GREATER_THAN(published / 2, fast.frames);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_every_subscriber_sees_the_same_buffer);
+  RUN_TEST(test_slow_subscriber_skips_frames);
+  RUN_TEST(test_frame_limit_leaves_a_capture_buffer);
+  RUN_TEST(test_waiting_frame_yields_to_capture);
+  RUN_TEST(test_subscriber_slots);
+  RUN_TEST(test_capture_with_concurrent_viewers);
+  return UNITY_END();
+}
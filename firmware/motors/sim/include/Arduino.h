@@ -0,0 +1,229 @@
+#pragma once
+
+// Host stand-in for the ESP32 Arduino core, just large enough for src/main.cpp.
+// Time is virtual: delay() and vTaskDelay() advance the simulation clock and run
+// the step timer ISR at its alarm times, so a run goes much faster than real time.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define digitalPinToInterrupt(p) (p)
+
+using std::max;
+using std::min;
+
+// glibc only gained strlcpy in 2.38
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+inline size_t strlcpy(char *dst, const char *src, size_t size)
+{
+  size_t len = strlen(src);
+  if (size > 0)
+  {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+#endif
+
+class String
+{
+public:
+  String() {}
+  String(const char *text) : value(text ? text : "") {}
+  String(const std::string &text) : value(text) {}
+  String(char c) : value(1, c) {}
+  String(int number) : value(std::to_string(number)) {}
+  String(unsigned int number) : value(std::to_string(number)) {}
+  String(long number) : value(std::to_string(number)) {}
+  String(unsigned long number) : value(std::to_string(number)) {}
+  String(float number, unsigned int decimals = 2);
+
+  String &operator=(const char *text)
+  {
+    value = text ? text : "";
+    return *this;
+  }
+
+  const char *c_str() const { return value.c_str(); }
+  unsigned int length() const { return (unsigned int)value.size(); }
+  bool isEmpty() const { return value.empty(); }
+  void reserve(unsigned int size) { value.reserve(size); }
+
+  bool concat(const char *text)
+  {
+    if (text)
+    {
+      value += text;
+    }
+    return true;
+  }
+  bool concat(const char *text, unsigned int len)
+  {
+    value.append(text, len);
+    return true;
+  }
+  bool concat(const String &text)
+  {
+    value += text.value;
+    return true;
+  }
+
+  String &operator+=(const String &text)
+  {
+    value += text.value;
+    return *this;
+  }
+  String &operator+=(const char *text)
+  {
+    concat(text);
+    return *this;
+  }
+  String &operator+=(char c)
+  {
+    value += c;
+    return *this;
+  }
+
+  bool operator==(const String &other) const { return value == other.value; }
+  bool operator==(const char *other) const { return value == (other ? other : ""); }
+  bool operator!=(const String &other) const { return value != other.value; }
+  bool operator!=(const char *other) const { return !(*this == other); }
+  char operator[](unsigned int index) const { return index < value.size() ? value[index] : '\0'; }
+
+  bool startsWith(const String &prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+  int indexOf(char c) const
+  {
+    size_t pos = value.find(c);
+    return pos == std::string::npos ? -1 : (int)pos;
+  }
+
+private:
+  std::string value;
+};
+
+// Arduino cores derive this from String for chained concatenation
+class StringSumHelper : public String
+{
+public:
+  StringSumHelper(const String &text) : String(text) {}
+};
+
+inline StringSumHelper operator+(const String &lhs, const String &rhs)
+{
+  StringSumHelper sum(lhs);
+  sum += rhs;
+  return sum;
+}
+inline StringSumHelper operator+(const String &lhs, const char *rhs)
+{
+  StringSumHelper sum(lhs);
+  sum += rhs;
+  return sum;
+}
+inline StringSumHelper operator+(const char *lhs, const String &rhs)
+{
+  StringSumHelper sum{String(lhs)};
+  sum += rhs;
+  return sum;
+}
+
+// Serial output goes to stdout when SIM_VERBOSE is set, otherwise it is dropped
+class HardwareSerial
+{
+public:
+  void begin(unsigned long baud) { (void)baud; }
+
+  size_t print(const char *text);
+  size_t print(const String &text) { return print(text.c_str()); }
+  size_t print(char c);
+  size_t print(int number);
+  size_t print(unsigned int number);
+  size_t print(long number);
+  size_t print(unsigned long number);
+  size_t print(double number, int decimals = 2);
+
+  size_t println() { return print("\n"); }
+  template <typename T>
+  size_t println(const T &value)
+  {
+    return print(value) + println();
+  }
+  size_t println(double number, int decimals) { return print(number, decimals) + println(); }
+
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HardwareSerial Serial;
+
+// Clock
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// CPU cycle counter derived from the virtual clock
+class EspClass
+{
+public:
+  uint32_t getCpuFreqMHz() const { return 240; }
+  uint32_t getCycleCount() const;
+};
+
+extern EspClass ESP;
+
+// GPIO, routed to the virtual turret
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void detachInterrupt(uint8_t pin);
+
+// esp32-hal-timer (Arduino core 2.x API)
+struct hw_timer_t;
+hw_timer_t *timerBegin(uint8_t timer, uint16_t divider, bool countUp);
+void timerAttachInterrupt(hw_timer_t *timer, void (*isr)(), bool edge);
+void timerAlarmWrite(hw_timer_t *timer, uint64_t alarmValue, bool autoreload);
+void timerAlarmEnable(hw_timer_t *timer);
+void timerAlarmDisable(hw_timer_t *timer);
+
+// FreeRTOS
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+#define portTICK_PERIOD_MS ((TickType_t)1)
+#define pdPASS 1
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stackDepth,
+                                   void *parameter, UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+// The host stack is not measured; reports the whole stack the task asked for as unused
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+// 0 while the scenario is delivering WebSocket events, 1 for firmware code
+BaseType_t xPortGetCoreID();
@@ -0,0 +1,3 @@
+#pragma once
+
+// Nothing to stub: the simulated WebSocket server does not open sockets.
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+// In-process stand-in for AsyncUDP. The scenario hands the listener a
+// datagram directly and reads back whatever the firmware replied with.
+
+class AsyncUDPPacket
+{
+public:
+  AsyncUDPPacket(const uint8_t *data, size_t len) : payload(data, data + len) {}
+
+  uint8_t *data() { return payload.data(); }
+  size_t length() const { return payload.size(); }
+  // Replies to the sender
+  size_t write(const uint8_t *data, size_t len)
+  {
+    replies.emplace_back(data, data + len);
+    return len;
+  }
+
+  std::vector<uint8_t> payload;
+  std::vector<std::vector<uint8_t>> replies;
+};
+
+typedef std::function<void(AsyncUDPPacket &packet)> AuPacketHandlerFunction;
+
+class AsyncUDP
+{
+public:
+  AsyncUDP();
+
+  bool listen(uint16_t port)
+  {
+    listenPort = port;
+    return true;
+  }
+  void onPacket(AuPacketHandlerFunction handler) { packetHandler = handler; }
+
+  // The most recently constructed instance, i.e. main.cpp's global
+  static AsyncUDP *instance();
+
+  // Scenario side: delivers one datagram to the listener and returns its replies
+  std::vector<std::vector<uint8_t>> simReceive(const uint8_t *data, size_t len);
+  uint16_t port() const { return listenPort; }
+
+private:
+  uint16_t listenPort = 0;
+  AuPacketHandlerFunction packetHandler;
+};
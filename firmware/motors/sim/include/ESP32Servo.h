@@ -0,0 +1,19 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Servo writes are forwarded to the virtual turret's trigger model.
+class Servo
+{
+public:
+  void setPeriodHertz(int hz) { (void)hz; }
+  int attach(int pin, int minUs = 544, int maxUs = 2400);
+  void detach() { attachedPin = -1; }
+  void write(int angle);
+  int read() const { return lastAngle; }
+  bool attached() const { return attachedPin >= 0; }
+
+private:
+  int attachedPin = -1;
+  int lastAngle = 0;
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// In-process stand-in for ESPAsyncWebServer's WebSocket. There is no network:
+// the scenario connects clients and feeds them frames directly, and everything
+// the firmware sends is kept in the client's outbox for the scenario to read.
+
+class AsyncWebSocket;
+class AsyncWebSocketClient;
+
+enum AwsEventType
+{
+  WS_EVT_CONNECT,
+  WS_EVT_DISCONNECT,
+  WS_EVT_PONG,
+  WS_EVT_ERROR,
+  WS_EVT_DATA
+};
+
+enum AwsFrameType
+{
+  WS_CONTINUATION = 0x00,
+  WS_TEXT = 0x01,
+  WS_BINARY = 0x02,
+  WS_DISCONNECT = 0x08,
+  WS_PING = 0x09,
+  WS_PONG = 0x0A
+};
+
+struct AwsFrameInfo
+{
+  uint8_t message_opcode;
+  uint32_t num;
+  uint8_t final;
+  uint8_t masked;
+  uint8_t opcode;
+  uint64_t len;
+  uint8_t mask[4];
+  uint64_t index;
+};
+
+typedef std::function<void(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type,
+                           void *arg, uint8_t *data, size_t len)>
+    AwsEventHandler;
+
+struct SimWsMessage
+{
+  bool binary;
+  std::string payload;
+  unsigned long timeMs;
+};
+
+const size_t SIM_WS_QUEUE_LIMIT = 32;
+
+class AsyncWebSocketClient
+{
+public:
+  AsyncWebSocketClient(AsyncWebSocket *server, uint32_t id) : owner(server), clientId(id) {}
+
+  uint32_t id() const { return clientId; }
+  AsyncWebSocket *server() const { return owner; }
+
+  void text(const char *message, size_t len);
+  void text(const char *message) { text(message, strlen(message)); }
+  void text(const String &message) { text(message.c_str(), message.length()); }
+  void binary(const uint8_t *data, size_t len);
+  void binary(const char *data, size_t len) { binary((const uint8_t *)data, len); }
+
+  // Messages count as queued until the scenario takes them, so a reader that
+  // stops draining fills up like a slow network peer
+  bool queueIsFull() const { return outbox.size() >= SIM_WS_QUEUE_LIMIT; }
+  bool canSend() const { return !queueIsFull(); }
+
+  // Scenario side
+  std::vector<SimWsMessage> takeMessages();
+  std::vector<SimWsMessage> outbox;
+  size_t dropped = 0; // Sends refused because the queue was full
+
+private:
+  AsyncWebSocket *owner;
+  uint32_t clientId;
+};
+
+class AsyncWebHandler
+{
+public:
+  virtual ~AsyncWebHandler() {}
+};
+
+class AsyncWebSocket : public AsyncWebHandler
+{
+public:
+  explicit AsyncWebSocket(const char *url);
+
+  void onEvent(AwsEventHandler handler) { eventHandler = handler; }
+  size_t count() const { return clients.size(); }
+  AsyncWebSocketClient *client(uint32_t id);
+  void textAll(const char *message, size_t len);
+  void textAll(const char *message) { textAll(message, strlen(message)); }
+  void textAll(const String &message) { textAll(message.c_str(), message.length()); }
+  void binaryAll(const uint8_t *data, size_t len);
+  void cleanupClients() {}
+
+  // Scenario side: each call runs the firmware's handler as the AsyncTCP task would
+  AsyncWebSocketClient *simConnect();
+  void simDisconnect(AsyncWebSocketClient *client);
+  void simReceive(AsyncWebSocketClient *client, const uint8_t *data, size_t len, bool binary);
+  void simReceiveText(AsyncWebSocketClient *client, const char *json)
+  {
+    simReceive(client, (const uint8_t *)json, strlen(json), false);
+  }
+
+  // The most recently constructed instance, i.e. main.cpp's global ws
+  static AsyncWebSocket *instance();
+
+private:
+  AwsEventHandler eventHandler;
+  std::vector<std::unique_ptr<AsyncWebSocketClient>> clients;
+  uint32_t nextClientId = 1;
+};
+
+class AsyncWebServer
+{
+public:
+  explicit AsyncWebServer(uint16_t port) { (void)port; }
+  void addHandler(AsyncWebHandler *handler) { (void)handler; }
+  void begin() {}
+};
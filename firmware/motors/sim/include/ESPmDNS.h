@@ -0,0 +1,15 @@
+#pragma once
+
+// Name lookups do not exist in the simulation; registering always succeeds.
+
+class SimMDNS
+{
+public:
+  bool begin(const char *hostname)
+  {
+    (void)hostname;
+    return true;
+  }
+};
+
+extern SimMDNS MDNS;
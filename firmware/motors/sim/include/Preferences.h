@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// In-memory stand-in for the ESP32 Preferences (NVS) library. All instances
+// share one store, which sim::loadNvs()/saveNvs() carry across runs so a
+// second run boots the way a power cycle would.
+
+class Preferences
+{
+public:
+  bool begin(const char *name, bool readOnly = false);
+  void end() { opened = false; }
+
+  size_t putBytes(const char *key, const void *value, size_t len);
+  size_t getBytes(const char *key, void *buf, size_t maxLen);
+  size_t getBytesLength(const char *key);
+  bool remove(const char *key);
+  bool isKey(const char *key);
+
+private:
+  std::string fullKey(const char *key) const { return space + "/" + key; }
+
+  std::string space;
+  bool opened = false;
+  bool readOnlyMode = false;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+// The simulated network is always up; clients are injected through the
+// AsyncWebSocket stub instead.
+
+#define WL_CONNECTED 3
+
+class SimWiFi
+{
+public:
+  void begin(const char *ssid, const char *password)
+  {
+    (void)ssid;
+    (void)password;
+  }
+  int status() const { return WL_CONNECTED; }
+  String localIP() const { return String("127.0.0.1"); }
+};
+
+extern SimWiFi WiFi;
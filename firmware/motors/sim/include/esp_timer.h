@@ -0,0 +1,6 @@
+#pragma once
+
+#include <stdint.h>
+
+// 64-bit microseconds since boot, on the virtual clock
+int64_t esp_timer_get_time();
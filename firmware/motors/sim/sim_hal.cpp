@@ -0,0 +1,586 @@
+#include "sim_hal.h"
+
+#include <Arduino.h>
+#include <ESP32Servo.h>
+#include <ESPAsyncWebServer.h>
+#include <AsyncUDP.h>
+#include <ESPmDNS.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <esp_timer.h>
+#include <stdarg.h>
+#include <map>
+#include "virtual_turret.h"
+
+HardwareSerial Serial;
+SimWiFi WiFi;
+SimMDNS MDNS;
+EspClass ESP;
+
+struct hw_timer_t
+{
+  void (*isr)();
+  uint64_t periodUs;
+  uint64_t nextAlarmUs;
+  uint64_t lastReloadUs;
+  bool enabled;
+};
+
+namespace
+{
+uint64_t clockUs = 0;
+bool verboseOutput = false;
+bool inIsr = false;
+bool inIdleHook = false;
+hw_timer_t stepTimer = {};
+void (*idleHook)(uint64_t) = nullptr;
+TaskFunction_t pendingTask = nullptr;
+void *pendingTaskParameter = nullptr;
+uint32_t pendingTaskStackDepth = 0;
+bool taskStarted = false;
+AsyncWebSocket *webSocket = nullptr;
+AsyncUDP *udp = nullptr;
+std::map<std::string, std::vector<uint8_t>> nvs; // "namespace/key" to value
+
+// Moves the clock forward, running the timer ISR at each alarm on the way
+void advance(uint64_t us)
+{
+  uint64_t untilUs = clockUs + us;
+  while (stepTimer.enabled && stepTimer.isr && stepTimer.nextAlarmUs <= untilUs)
+  {
+    if (stepTimer.nextAlarmUs > clockUs)
+    {
+      clockUs = stepTimer.nextAlarmUs;
+    }
+    // Auto-reload: the counter restarts at the alarm, so the next alarm value
+    // the ISR writes is relative to now
+    stepTimer.lastReloadUs = clockUs;
+    stepTimer.nextAlarmUs = clockUs + stepTimer.periodUs;
+    inIsr = true;
+    stepTimer.isr();
+    inIsr = false;
+  }
+  if (untilUs > clockUs)
+  {
+    clockUs = untilUs;
+  }
+}
+
+void idle(uint64_t us)
+{
+  advance(us);
+  if (idleHook)
+  {
+    inIdleHook = true;
+    idleHook(clockUs);
+    inIdleHook = false;
+  }
+}
+}
+
+namespace sim
+{
+uint64_t nowUs()
+{
+  return clockUs;
+}
+
+void setVerbose(bool verbose)
+{
+  verboseOutput = verbose;
+}
+
+void setIdleHook(void (*hook)(uint64_t nowUs))
+{
+  idleHook = hook;
+}
+
+void runTasks()
+{
+  if (!pendingTask)
+  {
+    fprintf(stderr, "sim: setup() did not start a task\n");
+    exit(2);
+  }
+  taskStarted = true;
+  pendingTask(pendingTaskParameter);
+  fprintf(stderr, "sim: task returned\n");
+  exit(2);
+}
+
+bool tasksRunning()
+{
+  return taskStarted;
+}
+}
+
+// Serial
+
+size_t HardwareSerial::print(const char *text)
+{
+  if (verboseOutput)
+  {
+    fputs(text, stdout);
+  }
+  return strlen(text);
+}
+
+size_t HardwareSerial::print(char c)
+{
+  char text[2] = {c, '\0'};
+  return print(text);
+}
+
+size_t HardwareSerial::print(int number)
+{
+  return print((long)number);
+}
+
+size_t HardwareSerial::print(unsigned int number)
+{
+  return print((unsigned long)number);
+}
+
+size_t HardwareSerial::print(long number)
+{
+  char text[24];
+  snprintf(text, sizeof(text), "%ld", number);
+  return print(text);
+}
+
+size_t HardwareSerial::print(unsigned long number)
+{
+  char text[24];
+  snprintf(text, sizeof(text), "%lu", number);
+  return print(text);
+}
+
+size_t HardwareSerial::print(double number, int decimals)
+{
+  char text[48];
+  snprintf(text, sizeof(text), "%.*f", decimals, number);
+  return print(text);
+}
+
+size_t HardwareSerial::printf(const char *format, ...)
+{
+  char text[512];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  print(text);
+  return len > 0 ? (size_t)len : 0;
+}
+
+String::String(float number, unsigned int decimals)
+{
+  char text[48];
+  snprintf(text, sizeof(text), "%.*f", (int)decimals, number);
+  value = text;
+}
+
+// Clock
+
+unsigned long millis()
+{
+  return (unsigned long)(clockUs / 1000);
+}
+
+unsigned long micros()
+{
+  // 32-bit like the ESP32, so wraparound handling gets exercised on long runs
+  return (unsigned long)(uint32_t)clockUs;
+}
+
+int64_t esp_timer_get_time()
+{
+  return (int64_t)clockUs;
+}
+
+void delay(uint32_t ms)
+{
+  idle((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+  // Pulse-width busy waits inside the ISR just pass time
+  if (inIsr)
+  {
+    clockUs += us;
+    return;
+  }
+  idle(us);
+}
+
+void yield()
+{
+}
+
+uint32_t EspClass::getCycleCount() const
+{
+  return (uint32_t)(clockUs * getCpuFreqMHz());
+}
+
+// GPIO
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  virtualTurret().pinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+  virtualTurret().write(pin, level);
+}
+
+int digitalRead(uint8_t pin)
+{
+  return virtualTurret().read(pin);
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode)
+{
+  virtualTurret().attachInterrupt(pin, isr, mode);
+}
+
+void detachInterrupt(uint8_t pin)
+{
+  virtualTurret().detachInterrupt(pin);
+}
+
+// Timer: one simulated timer with 1 us ticks, which is how main.cpp sets it up
+
+hw_timer_t *timerBegin(uint8_t timer, uint16_t divider, bool countUp)
+{
+  (void)timer;
+  (void)divider;
+  (void)countUp;
+  stepTimer = {};
+  stepTimer.lastReloadUs = clockUs;
+  return &stepTimer;
+}
+
+void timerAttachInterrupt(hw_timer_t *timer, void (*isr)(), bool edge)
+{
+  (void)edge;
+  timer->isr = isr;
+}
+
+void timerAlarmWrite(hw_timer_t *timer, uint64_t alarmValue, bool autoreload)
+{
+  (void)autoreload;
+  timer->periodUs = alarmValue > 0 ? alarmValue : 1;
+  timer->nextAlarmUs = timer->lastReloadUs + timer->periodUs;
+}
+
+void timerAlarmEnable(hw_timer_t *timer)
+{
+  timer->enabled = true;
+  timer->lastReloadUs = clockUs;
+  timer->nextAlarmUs = clockUs + timer->periodUs;
+}
+
+void timerAlarmDisable(hw_timer_t *timer)
+{
+  timer->enabled = false;
+}
+
+// FreeRTOS
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stackDepth,
+                                   void *parameter, UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core)
+{
+  (void)priority;
+  (void)core;
+  if (pendingTask)
+  {
+    fprintf(stderr, "sim: only one task is supported, ignoring %s\n", name);
+    return 0;
+  }
+  pendingTask = task;
+  pendingTaskParameter = parameter;
+  pendingTaskStackDepth = stackDepth;
+  if (handle)
+  {
+    *handle = (TaskHandle_t)&pendingTask;
+  }
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+  idle((uint64_t)(ticks > 0 ? ticks : 1) * portTICK_PERIOD_MS * 1000);
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+  (void)task;
+  return pendingTaskStackDepth;
+}
+
+BaseType_t xPortGetCoreID()
+{
+  return inIdleHook ? 0 : 1;
+}
+
+// Servo
+
+int Servo::attach(int pin, int minUs, int maxUs)
+{
+  (void)minUs;
+  (void)maxUs;
+  attachedPin = pin;
+  return 0;
+}
+
+void Servo::write(int angle)
+{
+  lastAngle = constrain(angle, 0, 180);
+  if (attachedPin == SIM_SERVO_PIN)
+  {
+    virtualTurret().servoWrite(lastAngle, millis());
+  }
+}
+
+// WebSocket
+
+void AsyncWebSocketClient::text(const char *message, size_t len)
+{
+  if (queueIsFull())
+  {
+    dropped++;
+    return;
+  }
+  outbox.push_back({false, std::string(message, len), millis()});
+}
+
+void AsyncWebSocketClient::binary(const uint8_t *data, size_t len)
+{
+  if (queueIsFull())
+  {
+    dropped++;
+    return;
+  }
+  outbox.push_back({true, std::string((const char *)data, len), millis()});
+}
+
+std::vector<SimWsMessage> AsyncWebSocketClient::takeMessages()
+{
+  std::vector<SimWsMessage> messages;
+  messages.swap(outbox);
+  return messages;
+}
+
+AsyncWebSocket::AsyncWebSocket(const char *url)
+{
+  (void)url;
+  webSocket = this;
+}
+
+AsyncWebSocket *AsyncWebSocket::instance()
+{
+  return webSocket;
+}
+
+AsyncWebSocketClient *AsyncWebSocket::client(uint32_t id)
+{
+  for (auto &client : clients)
+  {
+    if (client->id() == id)
+    {
+      return client.get();
+    }
+  }
+  return nullptr;
+}
+
+void AsyncWebSocket::textAll(const char *message, size_t len)
+{
+  for (auto &client : clients)
+  {
+    client->text(message, len);
+  }
+}
+
+void AsyncWebSocket::binaryAll(const uint8_t *data, size_t len)
+{
+  for (auto &client : clients)
+  {
+    client->binary(data, len);
+  }
+}
+
+AsyncWebSocketClient *AsyncWebSocket::simConnect()
+{
+  clients.emplace_back(new AsyncWebSocketClient(this, nextClientId++));
+  AsyncWebSocketClient *client = clients.back().get();
+  if (eventHandler)
+  {
+    eventHandler(this, client, WS_EVT_CONNECT, nullptr, nullptr, 0);
+  }
+  return client;
+}
+
+void AsyncWebSocket::simDisconnect(AsyncWebSocketClient *client)
+{
+  if (eventHandler)
+  {
+    eventHandler(this, client, WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+  }
+  for (auto it = clients.begin(); it != clients.end(); ++it)
+  {
+    if (it->get() == client)
+    {
+      clients.erase(it);
+      break;
+    }
+  }
+}
+
+void AsyncWebSocket::simReceive(AsyncWebSocketClient *client, const uint8_t *data, size_t len, bool binary)
+{
+  if (!eventHandler)
+  {
+    return;
+  }
+  AwsFrameInfo info = {};
+  info.final = 1;
+  info.index = 0;
+  info.len = len;
+  info.opcode = binary ? WS_BINARY : WS_TEXT;
+  info.message_opcode = info.opcode;
+  std::string copy((const char *)data, len);
+  eventHandler(this, client, WS_EVT_DATA, &info, (uint8_t *)&copy[0], len);
+}
+
+// UDP
+
+AsyncUDP::AsyncUDP()
+{
+  udp = this;
+}
+
+AsyncUDP *AsyncUDP::instance()
+{
+  return udp;
+}
+
+std::vector<std::vector<uint8_t>> AsyncUDP::simReceive(const uint8_t *data, size_t len)
+{
+  AsyncUDPPacket packet(data, len);
+  if (packetHandler)
+  {
+    packetHandler(packet);
+  }
+  return packet.replies;
+}
+
+// NVS
+
+bool Preferences::begin(const char *name, bool readOnly)
+{
+  space = name;
+  readOnlyMode = readOnly;
+  opened = true;
+  if (!readOnly)
+  {
+    return true;
+  }
+  // Like NVS, a namespace that was never written cannot be opened read-only
+  for (auto &entry : nvs)
+  {
+    if (entry.first.compare(0, space.size() + 1, space + "/") == 0)
+    {
+      return true;
+    }
+  }
+  opened = false;
+  return false;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len)
+{
+  if (!opened || readOnlyMode)
+  {
+    return 0;
+  }
+  const uint8_t *bytes = (const uint8_t *)value;
+  nvs[fullKey(key)].assign(bytes, bytes + len);
+  return len;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen)
+{
+  auto it = nvs.find(fullKey(key));
+  if (!opened || it == nvs.end() || it->second.size() > maxLen)
+  {
+    return 0;
+  }
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+  auto it = nvs.find(fullKey(key));
+  return opened && it != nvs.end() ? it->second.size() : 0;
+}
+
+bool Preferences::remove(const char *key)
+{
+  return opened && !readOnlyMode && nvs.erase(fullKey(key)) > 0;
+}
+
+bool Preferences::isKey(const char *key)
+{
+  return opened && nvs.count(fullKey(key)) > 0;
+}
+
+// One entry per line: key, a space, then the value in hex
+bool sim::loadNvs(const char *path)
+{
+  nvs.clear();
+  FILE *file = fopen(path, "r");
+  if (!file)
+  {
+    return true;
+  }
+  char key[64];
+  char hex[1024];
+  while (fscanf(file, "%63s %1023s", key, hex) == 2)
+  {
+    std::vector<uint8_t> value;
+    for (size_t i = 0; hex[i] && hex[i + 1]; i += 2)
+    {
+      unsigned int byte = 0;
+      sscanf(hex + i, "%2x", &byte);
+      value.push_back((uint8_t)byte);
+    }
+    nvs[key] = value;
+  }
+  fclose(file);
+  return true;
+}
+
+bool sim::saveNvs(const char *path)
+{
+  FILE *file = fopen(path, "w");
+  if (!file)
+  {
+    return false;
+  }
+  for (auto &entry : nvs)
+  {
+    fprintf(file, "%s ", entry.first.c_str());
+    for (uint8_t byte : entry.second)
+    {
+      fprintf(file, "%02x", byte);
+    }
+    fprintf(file, "\n");
+  }
+  fclose(file);
+  return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+// Virtual clock and scheduler behind the stub Arduino core.
+// The firmware only ever waits in delay()/vTaskDelay(); each wait advances the
+// clock, fires the step timer ISR at every alarm in between and then hands
+// control to the scenario's idle hook, which plays the part of the network
+// and of Arduino's loopTask.
+
+namespace sim
+{
+uint64_t nowUs();
+void setVerbose(bool verbose);
+
+// Called after every delay()/vTaskDelay() with the current time
+void setIdleHook(void (*hook)(uint64_t nowUs));
+
+// Runs the task handed to xTaskCreatePinnedToCore(); never returns, the
+// scenario ends the run with exit()
+void runTasks();
+bool tasksRunning();
+
+// Preferences (NVS) contents, kept in a file between runs. A missing file
+// loads as empty NVS, like a fresh flash.
+bool loadNvs(const char *path);
+bool saveNvs(const char *path);
+}
@@ -0,0 +1,936 @@
+// Host simulation entry point.
+// Boots the unmodified firmware against the stub HAL and a virtual turret,
+// then plays a short scenario over a simulated WebSocket client and checks
+// where the mechanism physically ended up. Exit status is non-zero when a
+// check fails, so the run can gate changes to motion code.
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ESPAsyncWebServer.h>
+#include <AsyncUDP.h>
+#include <Preferences.h>
+#include "sim_hal.h"
+#include "virtual_turret.h"
+#include "../src/clock_sync.h"
+#include "../src/latency_metrics.h"
+#include "../src/pose_history.h"
+#include "../src/turret_protocol.h"
+
+void setup();
+void loop();
+unsigned long computeTriggerMoveTimeMs();
+extern LatencyMetrics latencyMetrics;
+extern PoseHistory poseHistory;
+extern long yawDriftTotalSteps;
+extern long tiltDriftTotalSteps;
+unsigned long computeTriggerCycleMs();
+
+namespace
+{
+const float POSITION_TOLERANCE_DEG = 0.5f;
+const float TILT_CENTER_TOLERANCE_DEG = 1.0f;
+const uint32_t JOYSTICK_RESEND_MS = 100;
+const uint32_t JOYSTICK_HOLD_MS = 2000;
+const uint32_t SETTLE_TIMEOUT_MS = 1000;
+const uint32_t POSE_PROBE_MS = 400;          // Into the long move, while both axes are moving
+const uint64_t CAMERA_CLOCK_AHEAD_US = 5000000; // The simulated camera booted 5 s earlier
+const uint64_t POSE_EXPORT_SPAN_US = 1000000;   // History exported around the probe
+const uint32_t POSE_EXPORT_MAX_GAP_US = 2000;   // Recorded every motor cycle
+// Synthetic target for the intercept step, in firmware angles relative to
+// where the turret is when the step starts. Updates arrive like detections:
+// every 100 ms, describing where the target was 50 ms earlier.
+const float INTERCEPT_OFFSET_DEG[2] = {40.0f, 5.0f};
+const float INTERCEPT_RATE_DPS[2] = {15.0f, 2.0f};
+const uint32_t INTERCEPT_UPDATE_MS = 100;
+const uint32_t INTERCEPT_AGE_MS = 50;
+const uint32_t INTERCEPT_RUN_MS = 3000;
+const uint32_t INTERCEPT_RATE_WINDOW_MS = 1000; // Turret rate is measured over the end of the run
+const float INTERCEPT_RATE_TOLERANCE_DPS = 0.5f;
+const uint16_t INTERCEPT_FLIGHT_MS = 100;        // Lead is the trigger travel plus this
+const float INTERCEPT_LEAD_TOLERANCE_MS = 20.0f; // About a yaw step at the target's rate
+const uint16_t FIRE_PATTERN_INTERVAL_MS = 1500;
+const uint8_t FIRE_PATTERN_SHOTS = 3;
+const uint32_t FIRE_PATTERN_PULLS = FIRE_PATTERN_SHOTS + 1; // The pattern, then a single queued behind it
+const uint16_t FIRE_ARRIVAL_SETTLE_MS = 40;                  // fireOnArrival settle time asked for
+const uint32_t FIRE_ARRIVAL_SLACK_MS = 2;                    // Motor cycles between the last step and the pull
+// The fire-on-arrival move is sent as the frame ui/src/lib/turretProtocol.js encodes for
+// {"moveToAngle": {"horizontal": 30, "vertical": -10, "fireOnArrival": true, "settleMs": 40}};
+// turretProtocol.test.mjs checks the UI encoder against the same bytes
+const float FIRE_ARRIVAL_TARGET_DEG[2] = {30.0f, -10.0f};
+const uint8_t UI_FIRE_ON_ARRIVAL_FRAME[] = {0xA5, 0x01, 0x0A, 0x00, 0x00, 0xF0, 0x41, 0x00, 0x00, 0x20, 0xC1, 0x28, 0x00};
+const uint32_t DISARM_WATCH_MS = 500;                        // Idle time an armed shot would have fired in
+const uint32_t VERIFIED_BOOT_MAX_MS = 10000; // setup() with a stored calibration to check
+// Re-homes from these yaw angles (0° starts inside the sensor window); the
+// physical zero must land on the same microstep every time
+const float HOME_REPEAT_FROM_DEG[] = {60.0f, -150.0f, 0.0f, 175.0f};
+const size_t HOME_REPEAT_RUNS = sizeof(HOME_REPEAT_FROM_DEG) / sizeof(HOME_REPEAT_FROM_DEG[0]);
+// Missed steps: both axes drop pulses on one move, the next crosses the yaw
+// magnet and runs tilt into its up limit, correcting the references on the
+// way, and must land on target itself, as must the last
+struct DriftStage
+{
+  float yawDeg;
+  float tiltDeg;
+  uint32_t yawSkip;
+  uint32_t tiltSkip;
+};
+const DriftStage DRIFT_STAGES[] = {
+    {-90.0f, -20.0f, 12, 10},
+    {60.0f, 34.0f, 0, 0},
+    {60.0f, 0.0f, 0, 0},
+};
+const size_t DRIFT_STAGE_COUNT = sizeof(DRIFT_STAGES) / sizeof(DRIFT_STAGES[0]);
+const size_t DRIFT_CROSSING_STAGE = 1;
+
+struct ScenarioStep
+{
+  const char *name;
+  void (*start)();
+  bool (*done)(uint32_t elapsedMs); // Polled every simulated millisecond
+  void (*check)(uint32_t elapsedMs);
+  uint32_t timeoutMs;
+};
+
+AsyncWebSocketClient *client = nullptr;
+TurretStatus lastStatus = {};
+bool haveStatus = false;
+uint32_t statusFrames = 0;
+uint16_t eventFlags = 0; // Event bits seen since the step started
+float yawZeroDeg = 0.0f; // Physical angle of the firmware's 0°
+float tiltZeroDeg = 0.0f;
+float targetYawDeg = 0.0f;
+float targetTiltDeg = 0.0f;
+float jogStartYawDeg = 0.0f;
+uint32_t lastJoystickMs = 0;
+uint32_t pullsAtStart = 0;
+uint32_t pullsSeen = 0;
+uint32_t pullMs[FIRE_PATTERN_PULLS] = {}; // Step-relative
+float pullErrorDeg = 0.0f; // Largest aim error at a pull
+uint32_t arrivalGapUs = 0;  // Last step to the first trigger pull
+uint32_t disarmIdleMs = 0; // Step-relative time the replacing move was seen finished, 0 = not yet
+uint64_t poseProbeUs = 0;
+float poseProbeYawDeg = 0.0f; // Physical angles at poseProbeUs
+float poseProbeTiltDeg = 0.0f;
+float interceptStart[2] = {};
+uint64_t interceptStartUs = 0;
+uint32_t lastInterceptMs = 0;
+float interceptRateYawDeg = 0.0f; // Physical yaw at the start of the rate window
+float interceptRateTiltDeg = 0.0f;
+size_t homeRepeatRun = 0;
+bool homeRepeatHoming = false;    // Homing, rather than moving to the run's start angle
+uint32_t homeRepeatStageMs = 0;   // Step-relative time the current move or home was sent
+long homeRepeatZeroMin = 0;       // Physical zero, in yaw microsteps from power-on
+long homeRepeatZeroMax = 0;
+size_t driftStage = 0;
+uint32_t driftStageMs = 0;
+float driftCrossingErrorDeg[2] = {}; // Where the move that found the drift landed
+std::vector<std::vector<uint8_t>> clockReplies;
+uint64_t clockRequestUs = 0;
+const char *nvsPath = nullptr; // --nvs FILE
+int failures = 0;
+
+size_t stepIndex = 0;
+bool stepStarted = false;
+uint32_t stepStartMs = 0;
+
+float wrapDegrees(float angle)
+{
+  angle = fmodf(angle, 360.0f);
+  if (angle > 180.0f)
+  {
+    angle -= 360.0f;
+  }
+  else if (angle < -180.0f)
+  {
+    angle += 360.0f;
+  }
+  return angle;
+}
+
+void report(const char *step, bool ok, const char *format, ...) __attribute__((format(printf, 3, 4)));
+void report(const char *step, bool ok, const char *format, ...)
+{
+  char detail[256];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(detail, sizeof(detail), format, args);
+  va_end(args);
+  printf("[%8.3fs] %-4s %-22s %s\n", sim::nowUs() / 1e6, ok ? "ok" : "FAIL", step, detail);
+  if (!ok)
+  {
+    failures++;
+  }
+}
+
+void sendFrame(const TurretCommand &cmd)
+{
+  uint8_t frame[PROTOCOL_MAX_FRAME_SIZE];
+  size_t len = encodeCommand(cmd, frame, sizeof(frame));
+  AsyncWebSocket::instance()->simReceive(client, frame, len, true);
+}
+
+void sendJoystick(float x, float y)
+{
+  TurretCommand cmd = {};
+  cmd.type = FRAME_JOYSTICK;
+  cmd.x = x;
+  cmd.y = y;
+  sendFrame(cmd);
+  lastJoystickMs = millis();
+}
+
+void sendMoveToAngle(float horizontal, float vertical)
+{
+  TurretCommand cmd = {};
+  cmd.type = FRAME_MOVE_TO_ANGLE;
+  cmd.horizontal = horizontal;
+  cmd.vertical = vertical;
+  sendFrame(cmd);
+  targetYawDeg = horizontal;
+  targetTiltDeg = vertical;
+}
+
+void readStatusMessage(const SimWsMessage &message)
+{
+  TurretStatus status;
+  if (message.binary &&
+      decodeStatus((const uint8_t *)message.payload.data(), message.payload.size(), status) == DECODE_OK)
+  {
+    lastStatus = status;
+    haveStatus = true;
+    statusFrames++;
+    eventFlags |= status.flags;
+  }
+}
+
+void readStatus()
+{
+  for (const SimWsMessage &message : client->takeMessages())
+  {
+    readStatusMessage(message);
+  }
+}
+
+// One page of the binary pose export; false if no pose history frame came back
+bool requestPoseHistory(uint64_t afterUs, PoseSample *samples, size_t capacity, size_t &count, uint8_t &flags)
+{
+  TurretCommand cmd = {};
+  cmd.type = FRAME_POSE_HISTORY_REQUEST;
+  cmd.afterUs = afterUs;
+  cmd.maxSamples = (uint16_t)capacity;
+  sendFrame(cmd);
+  bool received = false;
+  for (const SimWsMessage &message : client->takeMessages())
+  {
+    if (message.binary && decodePoseHistory((const uint8_t *)message.payload.data(), message.payload.size(), flags,
+                                            count, samples, capacity) == DECODE_OK)
+    {
+      received = true;
+    }
+    else
+    {
+      readStatusMessage(message);
+    }
+  }
+  return received && count <= capacity;
+}
+
+bool idleStatus()
+{
+  return haveStatus && !(lastStatus.flags & (STATUS_ANGULAR_IN_PROGRESS | STATUS_IS_MOVING | STATUS_CALIBRATING));
+}
+
+float yawErrorDeg()
+{
+  return wrapDegrees(virtualTurret().yawDeg() - yawZeroDeg - targetYawDeg);
+}
+
+float tiltErrorDeg()
+{
+  return virtualTurret().tiltDeg() - tiltZeroDeg - targetTiltDeg;
+}
+
+// Steps
+
+void connectStart()
+{
+  client = AsyncWebSocket::instance()->simConnect();
+  sendJoystick(0.0f, 0.0f); // First binary frame switches the client to binary status
+}
+
+bool connectDone(uint32_t elapsedMs)
+{
+  return haveStatus && elapsedMs >= 100;
+}
+
+void connectCheck(uint32_t)
+{
+  const VirtualTurretConfig &cfg = virtualTurret().config();
+  yawZeroDeg = wrapDegrees(virtualTurret().yawDeg() - lastStatus.horizontalAngle);
+  tiltZeroDeg = virtualTurret().tiltDeg() - lastStatus.verticalAngle;
+  float homeError = wrapDegrees(yawZeroDeg - cfg.homeMagnetDeg);
+  float tiltCenter = (cfg.tiltDownLimitDeg + cfg.tiltUpLimitDeg) * 0.5f;
+  bool calibrated = (lastStatus.flags & STATUS_CALIBRATED) != 0;
+  report("startup calibration", calibrated && fabsf(homeError) <= 1.0f / virtualTurret().yawStepsPerDeg(),
+         "yaw 0° is %.2f° from the magnet center, tilt 0° is %.2f° (limits center %.2f°)",
+         homeError, tiltZeroDeg, tiltCenter);
+  report("tilt center", fabsf(tiltZeroDeg - tiltCenter) <= TILT_CENTER_TOLERANCE_DEG,
+         "error %.2f°", tiltZeroDeg - tiltCenter);
+
+  Preferences prefs;
+  size_t stored = prefs.begin("turret", true) ? prefs.getBytesLength("calibration") : 0;
+  report("calibration stored", stored > 0, "%zu byte record in NVS", stored);
+}
+
+bool moveDone(uint32_t elapsedMs)
+{
+  return elapsedMs >= 100 && idleStatus();
+}
+
+void moveCheck(uint32_t elapsedMs)
+{
+  char name[32];
+  snprintf(name, sizeof(name), "moveTo(%.0f, %.0f)", targetYawDeg, targetTiltDeg);
+  report(name, fabsf(yawErrorDeg()) <= POSITION_TOLERANCE_DEG && fabsf(tiltErrorDeg()) <= POSITION_TOLERANCE_DEG,
+         "%u ms, physical error yaw %.3f° tilt %.3f°, reported %.2f°/%.2f°",
+         elapsedMs, yawErrorDeg(), tiltErrorDeg(), lastStatus.horizontalAngle, lastStatus.verticalAngle);
+}
+
+void clockSyncStart()
+{
+  // What the camera sends: its own clock in t0
+  uint8_t request[CLOCK_SYNC_REQUEST_SIZE] = {CLOCK_SYNC_MAGIC, CLOCK_SYNC_VERSION, CLOCK_SYNC_REQUEST, 0, 7, 0, 0, 0};
+  clockRequestUs = sim::nowUs();
+  uint64_t cameraUs = clockRequestUs + CAMERA_CLOCK_AHEAD_US;
+  for (uint8_t i = 0; i < 8; i++)
+  {
+    request[8 + i] = (uint8_t)(cameraUs >> (8 * i));
+  }
+  clockReplies = AsyncUDP::instance()->simReceive(request, sizeof(request));
+}
+
+bool clockSyncDone(uint32_t)
+{
+  return true;
+}
+
+void clockSyncCheck(uint32_t)
+{
+  if (clockReplies.size() != 1 || clockReplies[0].size() != CLOCK_SYNC_RESPONSE_SIZE)
+  {
+    report("clock sync", false, "%u replies on UDP port %u", (unsigned)clockReplies.size(), AsyncUDP::instance()->port());
+    return;
+  }
+  const uint8_t *reply = clockReplies[0].data();
+  uint64_t t[3] = {};
+  for (uint8_t field = 0; field < 3; field++)
+  {
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      t[field] |= (uint64_t)reply[8 + field * 8 + i] << (8 * i);
+    }
+  }
+  // No network delay here, so t3 == t0 and the offset is exact
+  int64_t offsetUs = (int64_t)(t[1] - t[0]);
+  report("clock sync", reply[2] == CLOCK_SYNC_RESPONSE && reply[4] == 7 && t[1] == clockRequestUs &&
+                           offsetUs == -(int64_t)CAMERA_CLOCK_AHEAD_US,
+         "camera offset %.3f s, reply in %lu us", offsetUs / 1e6, (unsigned long)(t[2] - t[1]));
+}
+
+void moveRightStart()
+{
+  sendMoveToAngle(90.0f, 10.0f);
+}
+
+void moveAcrossStart()
+{
+  // Shortest path from +90° to -120° runs through 180°
+  sendMoveToAngle(-120.0f, -15.0f);
+  poseProbeUs = 0;
+}
+
+bool moveAcrossDone(uint32_t elapsedMs)
+{
+  if (poseProbeUs == 0 && elapsedMs >= POSE_PROBE_MS)
+  {
+    poseProbeUs = sim::nowUs();
+    poseProbeYawDeg = virtualTurret().yawDeg();
+    poseProbeTiltDeg = virtualTurret().tiltDeg();
+  }
+  return moveDone(elapsedMs);
+}
+
+// Looks up the mid-move probe time after the fact and compares it with where
+// the mechanism physically was then
+void moveAcrossCheck(uint32_t elapsedMs)
+{
+  moveCheck(elapsedMs);
+  const VirtualTurretConfig &cfg = virtualTurret().config();
+  float yawStepsPerDeg = cfg.stepsPerRevolution * cfg.microsteps * cfg.yawGearRatio / 360.0f;
+  float tiltStepsPerDeg = cfg.stepsPerRevolution * cfg.microsteps * cfg.tiltGearRatio / 360.0f;
+  PoseEstimate pose;
+  PoseLookup lookup = poseHistory.poseAt(poseProbeUs, pose);
+  float yawError = wrapDegrees(poseProbeYawDeg - yawZeroDeg - pose.yawSteps / yawStepsPerDeg);
+  float tiltError = poseProbeTiltDeg - tiltZeroDeg - pose.tiltSteps / tiltStepsPerDeg;
+  report("pose history", lookup == POSE_INTERPOLATED && fabsf(yawError) <= POSITION_TOLERANCE_DEG &&
+                             fabsf(tiltError) <= POSITION_TOLERANCE_DEG,
+         "%s %u ms back, error yaw %.3f° tilt %.3f°", poseLookupName(lookup),
+         (unsigned)((sim::nowUs() - poseProbeUs) / 1000), yawError, tiltError);
+
+  // Page through the binary export around the probe; it must be gap-free and
+  // agree with the lookup
+  PoseSample page[200];
+  size_t total = 0;
+  uint32_t frames = 0;
+  uint64_t maxGapUs = 0;
+  uint64_t lastUs = poseProbeUs - POSE_EXPORT_SPAN_US / 2;
+  bool ordered = true;
+  bool matched = false;
+  uint8_t flags = POSE_HISTORY_MORE;
+  while ((flags & POSE_HISTORY_MORE) && lastUs < poseProbeUs + POSE_EXPORT_SPAN_US / 2)
+  {
+    size_t count = 0;
+    if (!requestPoseHistory(lastUs, page, sizeof(page) / sizeof(page[0]), count, flags) || count == 0)
+    {
+      break;
+    }
+    frames++;
+    for (size_t i = 0; i < count; i++)
+    {
+      ordered = ordered && page[i].timeUs > lastUs;
+      if (total > 0 && page[i].timeUs - lastUs > maxGapUs)
+      {
+        maxGapUs = page[i].timeUs - lastUs;
+      }
+      if (i > 0 && page[i - 1].timeUs <= poseProbeUs && page[i].timeUs > poseProbeUs)
+      {
+        float t = (float)(poseProbeUs - page[i - 1].timeUs) / (float)(page[i].timeUs - page[i - 1].timeUs);
+        float yaw = page[i - 1].yawSteps + t * (page[i].yawSteps - page[i - 1].yawSteps);
+        matched = fabsf(yaw - pose.yawSteps) < 0.01f && page[i].yawStepsPerSec != 0;
+      }
+      lastUs = page[i].timeUs;
+      total++;
+    }
+  }
+  report("pose export", ordered && matched && total > 0 && maxGapUs <= POSE_EXPORT_MAX_GAP_US,
+         "%u samples in %u frames, largest gap %u us, probe %s", (unsigned)total, frames, (unsigned)maxGapUs,
+         matched ? "matches the lookup" : "not matched");
+}
+
+float interceptTarget(uint8_t axis, uint64_t timeUs)
+{
+  return interceptStart[axis] + INTERCEPT_RATE_DPS[axis] * (int64_t)(timeUs - interceptStartUs) / 1e6f;
+}
+
+void sendInterceptUpdate()
+{
+  uint64_t seenUs = sim::nowUs() - INTERCEPT_AGE_MS * 1000ULL;
+  TurretCommand cmd = {};
+  cmd.type = FRAME_INTERCEPT;
+  cmd.horizontal = wrapDegrees(interceptTarget(0, seenUs));
+  cmd.vertical = interceptTarget(1, seenUs);
+  cmd.horizontalRate = INTERCEPT_RATE_DPS[0];
+  cmd.verticalRate = INTERCEPT_RATE_DPS[1];
+  cmd.targetUs = seenUs;
+  cmd.flightMs = INTERCEPT_FLIGHT_MS;
+  sendFrame(cmd);
+  lastInterceptMs = millis();
+}
+
+void interceptStartStep()
+{
+  interceptStartUs = sim::nowUs();
+  interceptStart[0] = lastStatus.horizontalAngle + INTERCEPT_OFFSET_DEG[0];
+  interceptStart[1] = lastStatus.verticalAngle + INTERCEPT_OFFSET_DEG[1];
+  sendInterceptUpdate();
+}
+
+bool interceptDone(uint32_t elapsedMs)
+{
+  if (elapsedMs >= INTERCEPT_RUN_MS)
+  {
+    return true;
+  }
+  if (elapsedMs == INTERCEPT_RUN_MS - INTERCEPT_RATE_WINDOW_MS)
+  {
+    interceptRateYawDeg = virtualTurret().yawDeg();
+    interceptRateTiltDeg = virtualTurret().tiltDeg();
+  }
+  if (millis() - lastInterceptMs >= INTERCEPT_UPDATE_MS)
+  {
+    sendInterceptUpdate();
+  }
+  return false;
+}
+
+// The turret should ride the lead ahead of the target at the target's rate:
+// the trigger's travel time plus the flight time, the same on both axes
+void interceptCheck(uint32_t elapsedMs)
+{
+  uint64_t nowUs = sim::nowUs();
+  float windowS = INTERCEPT_RATE_WINDOW_MS / 1000.0f;
+  float yawRate = wrapDegrees(virtualTurret().yawDeg() - interceptRateYawDeg) / windowS;
+  float tiltRate = (virtualTurret().tiltDeg() - interceptRateTiltDeg) / windowS;
+  float leadS = (computeTriggerMoveTimeMs() + INTERCEPT_FLIGHT_MS) / 1000.0f;
+  // Yaw moves fastest, so it measures the lead best
+  float yawLeadS = wrapDegrees(virtualTurret().yawDeg() - yawZeroDeg - interceptTarget(0, nowUs)) / INTERCEPT_RATE_DPS[0];
+  float tiltError = virtualTurret().tiltDeg() - tiltZeroDeg - interceptTarget(1, nowUs) - INTERCEPT_RATE_DPS[1] * leadS;
+  report("intercept", fabsf(yawRate - INTERCEPT_RATE_DPS[0]) <= INTERCEPT_RATE_TOLERANCE_DPS &&
+                          fabsf(tiltRate - INTERCEPT_RATE_DPS[1]) <= INTERCEPT_RATE_TOLERANCE_DPS &&
+                          fabsf(yawLeadS - leadS) * 1000.0f <= INTERCEPT_LEAD_TOLERANCE_MS &&
+                          fabsf(tiltError) <= POSITION_TOLERANCE_DEG,
+         "rate %.2f/%.2f°/s, %.0f ms ahead (lead %.0f ms), tilt %.2f° off the lead, after %u ms", yawRate, tiltRate,
+         yawLeadS * 1000.0f, leadS * 1000.0f, tiltError, elapsedMs);
+}
+
+void jogStart()
+{
+  jogStartYawDeg = virtualTurret().yawDeg();
+  sendJoystick(1.0f, 0.0f);
+}
+
+bool jogDone(uint32_t elapsedMs)
+{
+  if (elapsedMs >= JOYSTICK_HOLD_MS)
+  {
+    return true;
+  }
+  if (millis() - lastJoystickMs >= JOYSTICK_RESEND_MS)
+  {
+    sendJoystick(1.0f, 0.0f);
+  }
+  return false;
+}
+
+void jogCheck(uint32_t elapsedMs)
+{
+  float travelled = virtualTurret().yawDeg() - jogStartYawDeg;
+  report("joystick yaw", travelled > 0.0f, "%.1f° in %u ms (%.1f°/s average)",
+         travelled, elapsedMs, travelled * 1000.0f / elapsedMs);
+  jogStartYawDeg = virtualTurret().yawDeg();
+  sendJoystick(0.0f, 0.0f);
+}
+
+bool releaseDone(uint32_t elapsedMs)
+{
+  return elapsedMs >= 100 && idleStatus();
+}
+
+void releaseCheck(uint32_t elapsedMs)
+{
+  report("joystick release", elapsedMs < SETTLE_TIMEOUT_MS, "stopped after %u ms, %.2f° past release",
+         elapsedMs, virtualTurret().yawDeg() - jogStartYawDeg);
+}
+
+void fireStart()
+{
+  pullsAtStart = virtualTurret().stats().triggerPulls;
+  TurretCommand cmd = {};
+  cmd.type = FRAME_FIRE;
+  cmd.fireMode = FIRE_SINGLE;
+  sendFrame(cmd);
+}
+
+bool fireDone(uint32_t elapsedMs)
+{
+  return elapsedMs >= 100 && virtualTurret().stats().triggerPulls > pullsAtStart &&
+         virtualTurret().servoAngle() < 45 && !(lastStatus.flags & STATUS_TRIGGER_ACTIVE);
+}
+
+void fireCheck(uint32_t elapsedMs)
+{
+  uint32_t pulls = virtualTurret().stats().triggerPulls - pullsAtStart;
+  report("fire single", pulls == 1, "%u trigger pull(s), servo back at rest after %u ms", pulls, elapsedMs);
+}
+
+void firePatternStart()
+{
+  pullsAtStart = virtualTurret().stats().triggerPulls;
+  pullsSeen = 0;
+  pullErrorDeg = 0.0f;
+  sendMoveToAngle(-60.0f, 5.0f);
+  TurretCommand cmd = {};
+  cmd.type = FRAME_FIRE_PATTERN;
+  cmd.firePattern.shots = FIRE_PATTERN_SHOTS;
+  cmd.firePattern.intervalMs = FIRE_PATTERN_INTERVAL_MS;
+  cmd.firePattern.onTarget = true;
+  sendFrame(cmd);
+  // Sent while nothing has fired yet; it must wait behind the pattern, not be dropped
+  cmd = TurretCommand();
+  cmd.type = FRAME_FIRE;
+  cmd.fireMode = FIRE_SINGLE;
+  sendFrame(cmd);
+}
+
+bool firePatternDone(uint32_t)
+{
+  // Polled every millisecond, so each pull is seen on its own
+  const VirtualTurretStats &stats = virtualTurret().stats();
+  uint32_t pulls = stats.triggerPulls - pullsAtStart;
+  if (pulls > pullsSeen && pulls <= FIRE_PATTERN_PULLS)
+  {
+    pullsSeen = pulls;
+    pullMs[pulls - 1] = stats.lastTriggerMs - stepStartMs;
+    if (pulls == 1)
+    {
+      arrivalGapUs = stats.lastTriggerUs - stats.lastStepUs;
+    }
+    float error = fmaxf(fabsf(yawErrorDeg()), fabsf(tiltErrorDeg()));
+    pullErrorDeg = fmaxf(pullErrorDeg, pulls <= FIRE_PATTERN_SHOTS ? error : 0.0f);
+  }
+  return pulls >= FIRE_PATTERN_PULLS && virtualTurret().servoAngle() < 45 &&
+         !(lastStatus.flags & STATUS_TRIGGER_ACTIVE);
+}
+
+void firePatternCheck(uint32_t)
+{
+  uint32_t pulls = virtualTurret().stats().triggerPulls - pullsAtStart;
+  uint32_t minGap = UINT32_MAX;
+  for (uint32_t i = 1; i < FIRE_PATTERN_SHOTS; i++)
+  {
+    minGap = std::min(minGap, pullMs[i] - pullMs[i - 1]);
+  }
+  uint32_t queuedGap = pullMs[FIRE_PATTERN_SHOTS] - pullMs[FIRE_PATTERN_SHOTS - 1];
+  // The move's last step comes before the first pull, so a gated shot waited for it
+  report("fire pattern", pulls == FIRE_PATTERN_PULLS && arrivalGapUs <= FIRE_ARRIVAL_SLACK_MS * 1000 &&
+                             pullErrorDeg <= POSITION_TOLERANCE_DEG && minGap >= FIRE_PATTERN_INTERVAL_MS &&
+                             queuedGap >= computeTriggerCycleMs(),
+         "%u pulls, first %.1f ms after the last step, aim error %.3f°, %u ms apart, queued single %u ms later",
+         pulls, arrivalGapUs / 1000.0f, pullErrorDeg, minGap, queuedGap);
+}
+
+void sendMoveToAngleAndFire(float horizontal, float vertical, uint16_t settleMs)
+{
+  TurretCommand cmd = {};
+  cmd.type = FRAME_MOVE_TO_ANGLE_AND_FIRE;
+  cmd.horizontal = horizontal;
+  cmd.vertical = vertical;
+  cmd.firePattern.settleMs = settleMs;
+  sendFrame(cmd);
+  targetYawDeg = horizontal;
+  targetTiltDeg = vertical;
+}
+
+void fireOnArrivalStart()
+{
+  pullsAtStart = virtualTurret().stats().triggerPulls;
+  pullsSeen = 0;
+  pullErrorDeg = 0.0f;
+
+  // The firmware's encoder must agree with the UI's before the UI's frame is sent
+  TurretCommand cmd = {};
+  cmd.type = FRAME_MOVE_TO_ANGLE_AND_FIRE;
+  cmd.horizontal = FIRE_ARRIVAL_TARGET_DEG[0];
+  cmd.vertical = FIRE_ARRIVAL_TARGET_DEG[1];
+  cmd.firePattern.settleMs = FIRE_ARRIVAL_SETTLE_MS;
+  uint8_t frame[PROTOCOL_MAX_FRAME_SIZE];
+  size_t len = encodeCommand(cmd, frame, sizeof(frame));
+  if (len != sizeof(UI_FIRE_ON_ARRIVAL_FRAME) || memcmp(frame, UI_FIRE_ON_ARRIVAL_FRAME, len) != 0)
+  {
+    report("fire on arrival", false, "firmware encodes a different frame than the UI for the arrival move");
+  }
+  AsyncWebSocket::instance()->simReceive(client, UI_FIRE_ON_ARRIVAL_FRAME, sizeof(UI_FIRE_ON_ARRIVAL_FRAME), true);
+  targetYawDeg = FIRE_ARRIVAL_TARGET_DEG[0];
+  targetTiltDeg = FIRE_ARRIVAL_TARGET_DEG[1];
+}
+
+bool fireOnArrivalDone(uint32_t)
+{
+  const VirtualTurretStats &stats = virtualTurret().stats();
+  if (stats.triggerPulls - pullsAtStart > pullsSeen)
+  {
+    pullsSeen = stats.triggerPulls - pullsAtStart;
+    arrivalGapUs = stats.lastTriggerUs - stats.lastStepUs;
+    pullErrorDeg = fmaxf(fabsf(yawErrorDeg()), fabsf(tiltErrorDeg()));
+  }
+  return pullsSeen > 0 && virtualTurret().servoAngle() < 45 && !(lastStatus.flags & STATUS_TRIGGER_ACTIVE);
+}
+
+void fireOnArrivalCheck(uint32_t)
+{
+  uint32_t gapMs = arrivalGapUs / 1000;
+  report("fire on arrival", pullsSeen == 1 && pullErrorDeg <= POSITION_TOLERANCE_DEG &&
+                                gapMs >= FIRE_ARRIVAL_SETTLE_MS && gapMs <= FIRE_ARRIVAL_SETTLE_MS + FIRE_ARRIVAL_SLACK_MS,
+         "%u pull(s), %.1f ms after the last step (settle %u ms), aim error %.3f°", pullsSeen, arrivalGapUs / 1000.0f,
+         FIRE_ARRIVAL_SETTLE_MS, pullErrorDeg);
+}
+
+// A new move replaces the armed one before it arrives; its shot must not fire at the new target
+void fireDisarmStart()
+{
+  pullsAtStart = virtualTurret().stats().triggerPulls;
+  disarmIdleMs = 0;
+  sendMoveToAngleAndFire(0.0f, 0.0f, 0);
+  sendMoveToAngle(-30.0f, 0.0f);
+}
+
+bool fireDisarmDone(uint32_t elapsedMs)
+{
+  if (disarmIdleMs == 0 && elapsedMs >= 100 && idleStatus())
+  {
+    disarmIdleMs = elapsedMs;
+  }
+  return disarmIdleMs > 0 && elapsedMs - disarmIdleMs >= DISARM_WATCH_MS;
+}
+
+void fireDisarmCheck(uint32_t)
+{
+  uint32_t pulls = virtualTurret().stats().triggerPulls - pullsAtStart;
+  report("arrival shot disarm", pulls == 0 && fabsf(yawErrorDeg()) <= POSITION_TOLERANCE_DEG,
+         "%u pull(s) after the armed move was replaced, replacing move error %.3f°", pulls, yawErrorDeg());
+}
+
+void homeStart()
+{
+  eventFlags = 0;
+  TurretCommand cmd = {};
+  cmd.type = FRAME_HOME;
+  sendFrame(cmd);
+}
+
+bool homeDone(uint32_t elapsedMs)
+{
+  return elapsedMs >= 100 && (eventFlags & STATUS_YAW_HOMED) && idleStatus();
+}
+
+void homeCheck(uint32_t elapsedMs)
+{
+  float homeShift = wrapDegrees(virtualTurret().yawDeg() - lastStatus.horizontalAngle - yawZeroDeg);
+  float tiltShift = virtualTurret().tiltDeg() - lastStatus.verticalAngle - tiltZeroDeg;
+  report("home", fabsf(homeShift) <= POSITION_TOLERANCE_DEG && fabsf(tiltShift) <= POSITION_TOLERANCE_DEG,
+         "%u ms, yaw zero moved %.3f°, tilt zero moved %.3f°", elapsedMs, homeShift, tiltShift);
+}
+
+// Physical yaw of the firmware's 0°, in microsteps within one turn
+long yawZeroMicrosteps()
+{
+  const VirtualTurret &turret = virtualTurret();
+  float stepsPerDeg = turret.yawStepsPerDeg();
+  long turn = lroundf(360.0f * stepsPerDeg);
+  long zero = lroundf((turret.yawDeg() - turret.config().startYawDeg - lastStatus.horizontalAngle) * stepsPerDeg);
+  return ((zero % turn) + turn) % turn;
+}
+
+void homeRepeatStart()
+{
+  homeRepeatRun = 0;
+  homeRepeatHoming = false;
+  homeRepeatStageMs = 0;
+  sendMoveToAngle(HOME_REPEAT_FROM_DEG[0], 0.0f);
+}
+
+bool homeRepeatDone(uint32_t elapsedMs)
+{
+  if (elapsedMs < homeRepeatStageMs + 100 || !idleStatus() ||
+      (homeRepeatHoming && !(eventFlags & STATUS_YAW_HOMED)))
+  {
+    return false;
+  }
+  homeRepeatStageMs = elapsedMs;
+  if (!homeRepeatHoming)
+  {
+    homeRepeatHoming = true;
+    homeStart();
+    return false;
+  }
+
+  long zero = yawZeroMicrosteps();
+  if (homeRepeatRun == 0 || zero < homeRepeatZeroMin)
+  {
+    homeRepeatZeroMin = zero;
+  }
+  if (homeRepeatRun == 0 || zero > homeRepeatZeroMax)
+  {
+    homeRepeatZeroMax = zero;
+  }
+  if (++homeRepeatRun == HOME_REPEAT_RUNS)
+  {
+    return true;
+  }
+  homeRepeatHoming = false;
+  sendMoveToAngle(HOME_REPEAT_FROM_DEG[homeRepeatRun], 0.0f);
+  return false;
+}
+
+void homeRepeatCheck(uint32_t elapsedMs)
+{
+  // One microstep is the resolution of the position itself, so "under one" means the same microstep
+  long spread = homeRepeatZeroMax - homeRepeatZeroMin;
+  report("home repeatability", spread == 0,
+         "%zu homes in %u ms, physical zero spread %ld microstep(s), %.3f° from the magnet center", HOME_REPEAT_RUNS,
+         elapsedMs, spread,
+         wrapDegrees(homeRepeatZeroMin / virtualTurret().yawStepsPerDeg() + virtualTurret().config().startYawDeg -
+                     virtualTurret().config().homeMagnetDeg));
+}
+
+void startDriftStage()
+{
+  const DriftStage &stage = DRIFT_STAGES[driftStage];
+  virtualTurret().skipSteps(true, stage.yawSkip);
+  virtualTurret().skipSteps(false, stage.tiltSkip);
+  sendMoveToAngle(stage.yawDeg, stage.tiltDeg);
+}
+
+void driftStart()
+{
+  driftStage = 0;
+  driftStageMs = 0;
+  startDriftStage();
+}
+
+bool driftDone(uint32_t elapsedMs)
+{
+  if (elapsedMs < driftStageMs + 100 || !idleStatus())
+  {
+    return false;
+  }
+  if (driftStage == DRIFT_CROSSING_STAGE)
+  {
+    driftCrossingErrorDeg[0] = yawErrorDeg();
+    driftCrossingErrorDeg[1] = tiltErrorDeg();
+  }
+  if (++driftStage == DRIFT_STAGE_COUNT)
+  {
+    return true;
+  }
+  driftStageMs = elapsedMs;
+  startDriftStage();
+  return false;
+}
+
+void driftCheck(uint32_t elapsedMs)
+{
+  long yawLost = DRIFT_STAGES[0].yawSkip;
+  long tiltLost = DRIFT_STAGES[0].tiltSkip;
+  // Lost steps leave the counters behind the mechanism, so each reference is seen that many steps early
+  bool corrected = labs(yawDriftTotalSteps + yawLost) <= 1 && labs(tiltDriftTotalSteps + tiltLost) <= 1;
+  report("missed steps", corrected && fabsf(driftCrossingErrorDeg[0]) <= POSITION_TOLERANCE_DEG &&
+                             fabsf(driftCrossingErrorDeg[1]) <= POSITION_TOLERANCE_DEG &&
+                             fabsf(yawErrorDeg()) <= POSITION_TOLERANCE_DEG &&
+                             fabsf(tiltErrorDeg()) <= POSITION_TOLERANCE_DEG,
+         "%u ms, corrected yaw %ld/tilt %ld steps of %ld/%ld lost on the way, landing %.3f°/%.3f° off, then %.3f°/%.3f°",
+         elapsedMs, -yawDriftTotalSteps, -tiltDriftTotalSteps, yawLost, tiltLost, driftCrossingErrorDeg[0],
+         driftCrossingErrorDeg[1], yawErrorDeg(), tiltErrorDeg());
+}
+
+const ScenarioStep SCENARIO[] = {
+    {"connect", connectStart, connectDone, connectCheck, 2000},
+    {"clock sync", clockSyncStart, clockSyncDone, clockSyncCheck, 100},
+    {"moveTo right", moveRightStart, moveDone, moveCheck, 10000},
+    {"moveTo across 180", moveAcrossStart, moveAcrossDone, moveAcrossCheck, 10000},
+    {"intercept", interceptStartStep, interceptDone, interceptCheck, INTERCEPT_RUN_MS + 1000},
+    {"joystick", jogStart, jogDone, jogCheck, JOYSTICK_HOLD_MS + 1000},
+    {"release", nullptr, releaseDone, releaseCheck, SETTLE_TIMEOUT_MS},
+    {"fire", fireStart, fireDone, fireCheck, 3000},
+    {"fire pattern", firePatternStart, firePatternDone, firePatternCheck, 15000},
+    {"fire on arrival", fireOnArrivalStart, fireOnArrivalDone, fireOnArrivalCheck, 5000},
+    {"arrival disarm", fireDisarmStart, fireDisarmDone, fireDisarmCheck, 5000},
+    {"home", homeStart, homeDone, homeCheck, 40000},
+    {"home repeatability", homeRepeatStart, homeRepeatDone, homeRepeatCheck, 60000},
+    {"missed steps", driftStart, driftDone, driftCheck, 30000},
+};
+const size_t SCENARIO_STEPS = sizeof(SCENARIO) / sizeof(SCENARIO[0]);
+
+void finish()
+{
+  const VirtualTurretStats &stats = virtualTurret().stats();
+  printf("[%8.3fs] %u status frames, %u yaw / %u tilt steps, %u tilt steps lost at hard stops\n",
+         sim::nowUs() / 1e6, statusFrames, stats.yawSteps, stats.tiltSteps, stats.tiltStepsLost);
+  char metrics[METRICS_BUFFER_SIZE];
+  if (encodeMetricsJson(latencyMetrics, metrics, sizeof(metrics)) > 0)
+  {
+    printf("%s\n", metrics);
+  }
+  if (nvsPath && !sim::saveNvs(nvsPath))
+  {
+    report("nvs", false, "could not write %s", nvsPath);
+  }
+  printf("%s (%d failed)\n", failures ? "FAILED" : "PASSED", failures);
+  fflush(stdout);
+  exit(failures ? 1 : 0);
+}
+
+void scenarioTick(uint64_t nowUs)
+{
+  if (!sim::tasksRunning())
+  {
+    return;
+  }
+  // Arduino's loopTask, which writes finished calibrations to NVS
+  loop();
+  if (client)
+  {
+    readStatus();
+  }
+
+  const ScenarioStep &step = SCENARIO[stepIndex];
+  uint32_t nowMs = (uint32_t)(nowUs / 1000);
+  if (!stepStarted)
+  {
+    stepStarted = true;
+    stepStartMs = nowMs;
+    eventFlags = 0;
+    if (step.start)
+    {
+      step.start();
+    }
+    return;
+  }
+
+  uint32_t elapsedMs = nowMs - stepStartMs;
+  bool done = step.done(elapsedMs);
+  if (!done && elapsedMs < step.timeoutMs)
+  {
+    return;
+  }
+  if (done)
+  {
+    step.check(elapsedMs);
+  }
+  else
+  {
+    report(step.name, false, "timed out after %u ms", elapsedMs);
+  }
+
+  stepStarted = false;
+  if (++stepIndex == SCENARIO_STEPS)
+  {
+    finish();
+  }
+}
+}
+
+int main(int argc, char **argv)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0)
+    {
+      sim::setVerbose(true);
+    }
+    else if (strcmp(argv[i], "--nvs") == 0 && i + 1 < argc)
+    {
+      nvsPath = argv[++i];
+    }
+  }
+  if (getenv("SIM_VERBOSE"))
+  {
+    sim::setVerbose(true);
+  }
+
+  virtualTurret().reset(DEFAULT_VIRTUAL_TURRET);
+  sim::setIdleHook(scenarioTick);
+  Preferences prefs;
+  bool calibrationStored = nvsPath && sim::loadNvs(nvsPath) && prefs.begin("turret", true) &&
+                           prefs.isKey("calibration");
+
+  setup();
+  uint32_t bootMs = (uint32_t)(sim::nowUs() / 1000);
+  report("boot", !calibrationStored || bootMs <= VERIFIED_BOOT_MAX_MS,
+         "setup() returned after %u ms, %u yaw / %u tilt steps during %s startup calibration", bootMs,
+         virtualTurret().stats().yawSteps, virtualTurret().stats().tiltSteps,
+         calibrationStored ? "stored" : "full");
+  sim::runTasks();
+  return 2;
+}
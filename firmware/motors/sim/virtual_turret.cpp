@@ -0,0 +1,209 @@
+#include "virtual_turret.h"
+
+#include <Arduino.h>
+#include <math.h>
+
+VirtualTurret &virtualTurret()
+{
+  static VirtualTurret turret;
+  return turret;
+}
+
+void VirtualTurret::reset(const VirtualTurretConfig &config)
+{
+  cfg = config;
+  statsValue = {};
+  yawPosition = 0;
+  tiltPosition = 0;
+  servo = 0;
+  yawStepsToSkip = 0;
+  tiltStepsToSkip = 0;
+  for (uint8_t pin = 0; pin < SIM_PIN_COUNT; pin++)
+  {
+    levels[pin] = LOW;
+    isrs[pin] = nullptr;
+    isrModes[pin] = 0;
+  }
+  updateInputs();
+}
+
+float VirtualTurret::yawStepsPerDeg() const
+{
+  return cfg.stepsPerRevolution * cfg.microsteps * cfg.yawGearRatio / 360.0f;
+}
+
+float VirtualTurret::tiltStepsPerDeg() const
+{
+  return cfg.stepsPerRevolution * cfg.microsteps * cfg.tiltGearRatio / 360.0f;
+}
+
+float VirtualTurret::yawDeg() const
+{
+  return cfg.startYawDeg + yawPosition / yawStepsPerDeg();
+}
+
+float VirtualTurret::tiltDeg() const
+{
+  return cfg.startTiltDeg + tiltPosition / tiltStepsPerDeg();
+}
+
+bool VirtualTurret::homeActive() const
+{
+  float offset = fmodf(yawDeg() - cfg.homeMagnetDeg, 360.0f);
+  if (offset > 180.0f)
+  {
+    offset -= 360.0f;
+  }
+  else if (offset < -180.0f)
+  {
+    offset += 360.0f;
+  }
+  return fabsf(offset) <= cfg.homeWindowDeg * 0.5f;
+}
+
+bool VirtualTurret::upLimitActive() const
+{
+  return tiltDeg() >= cfg.tiltUpLimitDeg;
+}
+
+bool VirtualTurret::downLimitActive() const
+{
+  return tiltDeg() <= cfg.tiltDownLimitDeg;
+}
+
+void VirtualTurret::pinMode(uint8_t pin, uint8_t mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+void VirtualTurret::write(uint8_t pin, uint8_t level)
+{
+  if (pin >= SIM_PIN_COUNT)
+  {
+    return;
+  }
+  bool rising = levels[pin] == LOW && level == HIGH;
+  levels[pin] = level;
+  if (!rising)
+  {
+    return;
+  }
+  if (pin == SIM_H_STEP_PIN)
+  {
+    step(true);
+  }
+  else if (pin == SIM_V_STEP_PIN)
+  {
+    step(false);
+  }
+}
+
+int VirtualTurret::read(uint8_t pin) const
+{
+  return pin < SIM_PIN_COUNT ? levels[pin] : LOW;
+}
+
+void VirtualTurret::attachInterrupt(uint8_t pin, void (*isr)(), int mode)
+{
+  if (pin < SIM_PIN_COUNT)
+  {
+    isrs[pin] = isr;
+    isrModes[pin] = mode;
+  }
+}
+
+void VirtualTurret::detachInterrupt(uint8_t pin)
+{
+  if (pin < SIM_PIN_COUNT)
+  {
+    isrs[pin] = nullptr;
+  }
+}
+
+void VirtualTurret::servoWrite(int angle, uint32_t nowMs)
+{
+  // Anything past halfway counts as pulling the trigger
+  if (servo < 45 && angle >= 45)
+  {
+    statsValue.triggerPulls++;
+    statsValue.lastTriggerMs = nowMs;
+    statsValue.lastTriggerUs = micros();
+  }
+  servo = angle;
+}
+
+void VirtualTurret::skipSteps(bool yaw, uint32_t count)
+{
+  (yaw ? yawStepsToSkip : tiltStepsToSkip) += count;
+}
+
+void VirtualTurret::step(bool yaw)
+{
+  statsValue.lastStepUs = micros();
+  uint32_t &toSkip = yaw ? yawStepsToSkip : tiltStepsToSkip;
+  if (toSkip > 0)
+  {
+    toSkip--;
+    statsValue.stepsSkipped++;
+    (yaw ? statsValue.yawSteps : statsValue.tiltSteps)++;
+    return;
+  }
+  if (yaw)
+  {
+    yawPosition += levels[SIM_H_DIR_PIN] == HIGH ? 1 : -1;
+    statsValue.yawSteps++;
+  }
+  else
+  {
+    long next = tiltPosition + (levels[SIM_V_DIR_PIN] == HIGH ? 1 : -1);
+    float nextDeg = cfg.startTiltDeg + next / tiltStepsPerDeg();
+    if (nextDeg > cfg.tiltUpLimitDeg + cfg.tiltHardStopDeg ||
+        nextDeg < cfg.tiltDownLimitDeg - cfg.tiltHardStopDeg)
+    {
+      statsValue.tiltStepsLost++;
+    }
+    else
+    {
+      tiltPosition = next;
+    }
+    statsValue.tiltSteps++;
+  }
+  updateInputs();
+}
+
+int VirtualTurret::sensorLevel(uint8_t pin) const
+{
+  // Hall sensor and limit switches all pull LOW when active
+  switch (pin)
+  {
+  case SIM_H_HOME_PIN:
+    return homeActive() ? LOW : HIGH;
+  case SIM_UP_LIMIT_PIN:
+    return upLimitActive() ? LOW : HIGH;
+  case SIM_DOWN_LIMIT_PIN:
+    return downLimitActive() ? LOW : HIGH;
+  default:
+    return levels[pin];
+  }
+}
+
+void VirtualTurret::updateInputs()
+{
+  static const uint8_t inputs[] = {SIM_H_HOME_PIN, SIM_UP_LIMIT_PIN, SIM_DOWN_LIMIT_PIN};
+  for (uint8_t pin : inputs)
+  {
+    int level = sensorLevel(pin);
+    if (level == levels[pin])
+    {
+      continue;
+    }
+    levels[pin] = level;
+    void (*isr)() = isrs[pin];
+    int mode = isrModes[pin];
+    if (isr && (mode == CHANGE || (mode == FALLING && level == LOW) || (mode == RISING && level == HIGH)))
+    {
+      isr();
+    }
+  }
+}
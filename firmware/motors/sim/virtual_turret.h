@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdint.h>
+
+// Mechanical model of the turret seen through its GPIOs.
+// Step pulses move the output shafts through the gear ratios; the yaw hall
+// sensor and the two tilt limit switches are derived from the resulting
+// angles. Tilt past a limit switch runs into a hard stop and loses steps.
+
+// Must match the pin assignments in src/main.cpp
+const uint8_t SIM_H_STEP_PIN = 26;
+const uint8_t SIM_H_DIR_PIN = 25;
+const uint8_t SIM_H_HOME_PIN = 32;
+const uint8_t SIM_V_STEP_PIN = 14;
+const uint8_t SIM_V_DIR_PIN = 12;
+const uint8_t SIM_UP_LIMIT_PIN = 5;
+const uint8_t SIM_DOWN_LIMIT_PIN = 4;
+const uint8_t SIM_SERVO_PIN = 27;
+const uint8_t SIM_PIN_COUNT = 40;
+
+struct VirtualTurretConfig
+{
+  float stepsPerRevolution; // Motor full steps
+  float microsteps;
+  float yawGearRatio;
+  float tiltGearRatio;
+  float homeMagnetDeg;      // Center of the hall sensor's active window
+  float homeWindowDeg;      // Width of the active window
+  float tiltDownLimitDeg;   // Switch closes at or below this angle
+  float tiltUpLimitDeg;     // Switch closes at or above this angle
+  float tiltHardStopDeg;    // Travel past a switch before the hard stop
+  float startYawDeg;        // Power-on pose
+  float startTiltDeg;
+};
+
+const VirtualTurretConfig DEFAULT_VIRTUAL_TURRET = {
+    200.0f, 2.0f, 4.0f, 4.67f,
+    137.0f, 4.0f,
+    -32.0f, 38.0f, 3.0f,
+    0.0f, 6.0f};
+
+struct VirtualTurretStats
+{
+  uint32_t yawSteps;
+  uint32_t tiltSteps;
+  uint32_t tiltStepsLost;   // Pulses absorbed by a hard stop
+  uint32_t stepsSkipped;    // Pulses dropped by skipSteps()
+  uint32_t triggerPulls;    // Servo moves from rest to fire position
+  uint32_t lastTriggerMs;
+  uint32_t lastTriggerUs;   // The same pull, to compare with lastStepUs
+  uint32_t lastStepUs;      // Either axis
+};
+
+class VirtualTurret
+{
+public:
+  void reset(const VirtualTurretConfig &config);
+
+  // GPIO hooks
+  void pinMode(uint8_t pin, uint8_t mode);
+  void write(uint8_t pin, uint8_t level);
+  int read(uint8_t pin) const;
+  void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+  void detachInterrupt(uint8_t pin);
+  void servoWrite(int angle, uint32_t nowMs);
+
+  // The next count pulses on the axis do not move it, like a stalled motor
+  void skipSteps(bool yaw, uint32_t count);
+
+  // Physical output angles; yaw is unwrapped
+  float yawDeg() const;
+  float tiltDeg() const;
+  float yawStepsPerDeg() const;
+  float tiltStepsPerDeg() const;
+  int servoAngle() const { return servo; }
+  bool homeActive() const;
+  bool upLimitActive() const;
+  bool downLimitActive() const;
+  const VirtualTurretConfig &config() const { return cfg; }
+  const VirtualTurretStats &stats() const { return statsValue; }
+
+private:
+  void step(bool yaw);
+  int sensorLevel(uint8_t pin) const;
+  void updateInputs();
+
+  VirtualTurretConfig cfg = DEFAULT_VIRTUAL_TURRET;
+  VirtualTurretStats statsValue = {};
+  long yawPosition = 0; // Microsteps since power-on
+  long tiltPosition = 0;
+  int servo = 0;
+  uint32_t yawStepsToSkip = 0;
+  uint32_t tiltStepsToSkip = 0;
+  uint8_t levels[SIM_PIN_COUNT] = {};
+  void (*isrs[SIM_PIN_COUNT])() = {};
+  int isrModes[SIM_PIN_COUNT] = {};
+};
+
+VirtualTurret &virtualTurret();
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+
+// Compile-time axis mechanics. A config struct names the drive train, speed
+// limits and homing strategy as static constexpr members; Axis<Config> turns
+// them into the conversions main.cpp uses, so each axis gets its own constant
+// steps-per-degree instead of branching on which axis it is at run time.
+//
+//   struct ExampleAxisConfig
+//   {
+//     static constexpr float MOTOR_STEPS_PER_REV = 200.0f;
+//     static constexpr int MICROSTEPS = 2;
+//     static constexpr float GEAR_RATIO = 4.0f;            // Motor turns per output turn
+//     static constexpr int MAX_STEPS_PER_SEC = 1000;
+//     static constexpr float RUN_SPEED_FACTOR = 0.6f;      // Fraction of max for normal motion
+//     static constexpr float CALIBRATION_SPEED_FACTOR = 0.3f;
+//     static constexpr bool CONTINUOUS = true;             // Slip ring, angle wraps
+//     static constexpr HomingStrategy HOMING = HOMING_HALL_SENSOR;
+//   };
+
+enum HomingStrategy : uint8_t
+{
+  HOMING_HALL_SENSOR,   // One index sensor per turn
+  HOMING_LIMIT_SWITCHES // End stops at both ends of a limited range
+};
+
+template <typename Config>
+struct Axis
+{
+  static_assert(Config::MOTOR_STEPS_PER_REV > 0 && Config::MICROSTEPS > 0 && Config::GEAR_RATIO > 0,
+                "Axis drive train must be positive");
+  static_assert(Config::MAX_STEPS_PER_SEC > 0, "Axis needs a speed limit");
+  static_assert(!Config::CONTINUOUS || Config::HOMING == HOMING_HALL_SENSOR,
+                "A continuous axis has no end stops to home against");
+
+  static constexpr float stepsPerDegree()
+  {
+    return Config::MOTOR_STEPS_PER_REV * Config::MICROSTEPS * Config::GEAR_RATIO / 360.0f;
+  }
+  static constexpr float degreesPerStep()
+  {
+    return 360.0f / (Config::MOTOR_STEPS_PER_REV * Config::MICROSTEPS * Config::GEAR_RATIO);
+  }
+  static constexpr long fullRotationSteps() { return (long)(stepsPerDegree() * 360.0f); }
+  static constexpr bool continuous() { return Config::CONTINUOUS; }
+  static constexpr HomingStrategy homing() { return Config::HOMING; }
+
+  // Speeds in steps/s
+  static constexpr int maxStepsPerSec() { return Config::MAX_STEPS_PER_SEC; }
+  static constexpr float runStepsPerSec() { return Config::MAX_STEPS_PER_SEC * Config::RUN_SPEED_FACTOR; }
+  static constexpr float calibrationStepsPerSec()
+  {
+    return Config::MAX_STEPS_PER_SEC * Config::CALIBRATION_SPEED_FACTOR;
+  }
+
+  // Truncates toward zero, as the angular move commands always have
+  static long toSteps(float degrees) { return (long)(degrees * stepsPerDegree()); }
+  // Also converts steps/s and steps/s^2 to deg/s and deg/s^2
+  // Multiplies by the folded reciprocal; stepsPerDegree() is not a power of two,
+  // so dividing would cost a float divide every motor cycle
+  static float toDegrees(float steps) { return steps * degreesPerStep(); }
+  static float toStepsPerSec(float degreesPerSec) { return degreesPerSec * stepsPerDegree(); }
+};
@@ -0,0 +1,432 @@
+#include "calibration.h"
+
+#include <stdlib.h>
+
+namespace
+{
+  const uint8_t FULL_PHASE_COUNT = 8;   // Yaw backoff .. tilt center
+  const uint8_t QUICK_PHASE_COUNT = 4;  // Yaw backoff, search, center, tilt center
+  const uint8_t VERIFY_PHASE_COUNT = 6; // Yaw backoff, search, center, tilt clear down, find down, center
+
+  uint8_t phaseCount(CalibrationMode mode)
+  {
+    switch (mode)
+    {
+    case CALIBRATE_QUICK_HOME:
+      return QUICK_PHASE_COUNT;
+    case CALIBRATE_VERIFY:
+      return VERIFY_PHASE_COUNT;
+    default:
+      return FULL_PHASE_COUNT;
+    }
+  }
+}
+
+CalibrationSequencer::CalibrationSequencer(QueuedStepper &yawStepper, QueuedStepper &tiltStepper)
+    : yaw(yawStepper), tilt(tiltStepper)
+{
+}
+
+void CalibrationSequencer::configure(const CalibrationConfig &newConfig, const CalibrationInputs &newInputs)
+{
+  config = newConfig;
+  inputs = newInputs;
+}
+
+void CalibrationSequencer::start(CalibrationMode mode, uint32_t nowMs, long tiltCenter)
+{
+  resultValue = CalibrationResult();
+  resultValue.tiltCenter = tiltCenter;
+  modeValue = mode;
+  phaseValue = CAL_IDLE;
+  phasesDone = 0;
+  yawStartMs = nowMs;
+  tiltStartMs = nowMs;
+  inputs.resetHomeLatch();
+  enterPhase(CAL_YAW_BACKOFF, nowMs);
+}
+
+void CalibrationSequencer::startVerify(uint32_t nowMs, long downLimit, long upLimit, long tiltCenter)
+{
+  reference = CalibrationResult();
+  reference.downLimit = downLimit;
+  reference.upLimit = upLimit;
+  reference.tiltCenter = tiltCenter;
+  start(CALIBRATE_VERIFY, nowMs, tiltCenter);
+}
+
+void CalibrationSequencer::abort()
+{
+  if (!running())
+  {
+    return;
+  }
+  yaw.stop();
+  tilt.stop();
+  yaw.setMaxSpeed(config.yawRunSpeed);
+  tilt.setMaxSpeed(config.tiltRunSpeed);
+  phaseValue = CAL_ABORTED;
+}
+
+void CalibrationSequencer::enterPhase(CalibrationPhase next, uint32_t nowMs, uint32_t settleMs)
+{
+  if (phaseValue != CAL_IDLE)
+  {
+    phasesDone++;
+  }
+  phaseValue = next;
+  phaseStarted = false;
+  settleUntilMs = nowMs + settleMs;
+}
+
+bool CalibrationSequencer::timedOut(uint32_t startMs, uint32_t nowMs) const
+{
+  return nowMs - startMs > config.axisTimeoutMs;
+}
+
+long CalibrationSequencer::travelled(QueuedStepper &stepper) const
+{
+  return labs(stepper.currentPosition() - phaseStartPosition);
+}
+
+long CalibrationSequencer::tiltFindSteps() const
+{
+  // From anywhere inside the stored range the down limit is at most its width away
+  if (modeValue == CALIBRATE_VERIFY)
+  {
+    return labs(reference.upLimit - reference.downLimit) + config.tiltVerifyMarginSteps;
+  }
+  return config.tiltSearchSteps;
+}
+
+void CalibrationSequencer::finishYaw(bool found, uint32_t nowMs)
+{
+  yaw.stop();
+  yaw.setMaxSpeed(config.yawRunSpeed);
+  if (found)
+  {
+    // Zero at the magnet center
+    yaw.setCurrentPosition(0);
+    inputs.resetHomeLatch();
+  }
+  resultValue.yawHomed = found;
+  tiltStartMs = nowMs;
+  if (!found && modeValue == CALIBRATE_VERIFY)
+  {
+    finishTilt(); // Already failed; the full calibration that follows redoes tilt anyway
+    return;
+  }
+  enterPhase(modeValue == CALIBRATE_QUICK_HOME ? CAL_TILT_CENTER : CAL_TILT_CLEAR_DOWN, nowMs);
+}
+
+void CalibrationSequencer::finishTilt()
+{
+  tilt.setMaxSpeed(config.tiltRunSpeed);
+  phasesDone = phaseCount(modeValue);
+  phaseValue = CAL_DONE;
+}
+
+bool CalibrationSequencer::step(uint32_t nowMs)
+{
+  if (!running())
+  {
+    return false;
+  }
+  if ((int32_t)(nowMs - settleUntilMs) < 0)
+  {
+    return true; // Letting the axis settle after the previous phase
+  }
+
+  bool entering = !phaseStarted;
+  phaseStarted = true;
+
+  switch (phaseValue)
+  {
+  case CAL_YAW_BACKOFF:
+    if (entering)
+    {
+      if (!inputs.homeActive())
+      {
+        enterPhase(CAL_YAW_SEARCH, nowMs);
+        break;
+      }
+      // Sensor already active on start: back off slowly before sweeping
+      yaw.setMaxSpeed(config.yawBackoffSpeed);
+      phaseStartPosition = yaw.currentPosition();
+      phaseLength = config.yawBackoffSteps;
+      yaw.moveTo(phaseStartPosition - config.yawBackoffSteps);
+    }
+    if (!inputs.homeActive())
+    {
+      yaw.stop();
+      inputs.resetHomeLatch();
+      enterPhase(CAL_YAW_SEARCH, nowMs, config.yawBackoffSettleMs);
+      break;
+    }
+    yaw.run();
+    if (timedOut(yawStartMs, nowMs))
+    {
+      finishYaw(false, nowMs);
+    }
+    break;
+
+  case CAL_YAW_SEARCH:
+  {
+    if (entering)
+    {
+      yaw.setMaxSpeed(config.yawSearchSpeed);
+      phaseStartPosition = yaw.currentPosition();
+      phaseLength = config.yawSearchSteps;
+      yaw.moveTo(phaseStartPosition + config.yawSearchSteps);
+    }
+    if (travelled(yaw) >= config.yawSearchSteps)
+    {
+      finishYaw(false, nowMs);
+      break;
+    }
+    yaw.run();
+    long enterPosition = 0;
+    long exitPosition = 0;
+    if (inputs.homeEdges(enterPosition, exitPosition))
+    {
+      // Both edges were crossed the same way, so halfway is the magnet center
+      yawHomeCenter = enterPosition + (exitPosition - enterPosition) / 2;
+      resultValue.yawWindowSteps = labs(exitPosition - enterPosition);
+      enterPhase(CAL_YAW_CENTER, nowMs);
+    }
+    else if (timedOut(yawStartMs, nowMs))
+    {
+      finishYaw(false, nowMs);
+    }
+    break;
+  }
+
+  case CAL_YAW_CENTER:
+    if (entering)
+    {
+      // Brakes from the sweep and comes back, always arriving from the same side
+      phaseStartPosition = yaw.currentPosition();
+      phaseLength = labs(yawHomeCenter - phaseStartPosition);
+      yaw.moveTo(yawHomeCenter);
+    }
+    if (yaw.currentPosition() == yawHomeCenter && !yaw.isRunning())
+    {
+      finishYaw(true, nowMs);
+      break;
+    }
+    yaw.run();
+    if (timedOut(yawStartMs, nowMs))
+    {
+      finishYaw(false, nowMs);
+    }
+    break;
+
+  case CAL_TILT_CLEAR_DOWN:
+  case CAL_TILT_CLEAR_UP:
+  {
+    bool clearingDown = phaseValue == CAL_TILT_CLEAR_DOWN;
+    bool (*limitActive)() = clearingDown ? inputs.downLimitActive : inputs.upLimitActive;
+    CalibrationPhase next = clearingDown && modeValue != CALIBRATE_VERIFY ? CAL_TILT_CLEAR_UP : CAL_TILT_FIND_DOWN;
+    if (entering)
+    {
+      tilt.setMaxSpeed(config.tiltSearchSpeed);
+      if (!limitActive())
+      {
+        enterPhase(next, nowMs);
+        break;
+      }
+      phaseStartPosition = tilt.currentPosition();
+      phaseLength = config.tiltClearSteps;
+      tilt.moveTo(phaseStartPosition + (clearingDown ? config.tiltClearSteps : -config.tiltClearSteps));
+    }
+    if (!limitActive() || travelled(tilt) >= config.tiltSearchSteps)
+    {
+      tilt.stop();
+      enterPhase(next, nowMs, config.tiltSettleMs);
+      break;
+    }
+    tilt.run();
+    if (timedOut(tiltStartMs, nowMs))
+    {
+      tilt.stop();
+      finishTilt();
+    }
+    break;
+  }
+
+  case CAL_TILT_FIND_DOWN:
+  case CAL_TILT_FIND_UP:
+  {
+    bool findingDown = phaseValue == CAL_TILT_FIND_DOWN;
+    bool (*limitActive)() = findingDown ? inputs.downLimitActive : inputs.upLimitActive;
+    long searchSteps = tiltFindSteps();
+    if (entering)
+    {
+      phaseStartPosition = tilt.currentPosition();
+      phaseLength = searchSteps;
+      tilt.moveTo(phaseStartPosition + (findingDown ? -searchSteps : searchSteps));
+    }
+
+    bool found = limitActive();
+    bool ended = found || travelled(tilt) >= searchSteps;
+    if (!ended)
+    {
+      tilt.run();
+      ended = timedOut(tiltStartMs, nowMs);
+    }
+    if (!ended)
+    {
+      break;
+    }
+
+    tilt.stop();
+    if (modeValue == CALIBRATE_VERIFY)
+    {
+      if (!found)
+      {
+        finishTilt();
+        break;
+      }
+      // Re-base tilt on the switch; the stored limits and center are relative to it
+      tilt.setCurrentPosition(reference.downLimit);
+      resultValue.downFound = true;
+      resultValue.upFound = true;
+      resultValue.downLimit = reference.downLimit;
+      resultValue.upLimit = reference.upLimit;
+      resultValue.tiltCenter = reference.tiltCenter;
+      enterPhase(CAL_TILT_CENTER, nowMs, config.tiltSettleMs);
+    }
+    else if (findingDown)
+    {
+      resultValue.downFound = found;
+      resultValue.downLimit = tilt.currentPosition();
+      enterPhase(CAL_TILT_FIND_UP, nowMs, config.tiltSettleMs);
+    }
+    else
+    {
+      resultValue.upFound = found;
+      resultValue.upLimit = tilt.currentPosition();
+      if (resultValue.downFound && resultValue.upFound)
+      {
+        resultValue.tiltCenter = (resultValue.downLimit + resultValue.upLimit) / 2;
+        enterPhase(CAL_TILT_CENTER, nowMs, config.tiltSettleMs);
+      }
+      else
+      {
+        finishTilt();
+      }
+    }
+    break;
+  }
+
+  case CAL_TILT_CENTER:
+    if (entering)
+    {
+      if (modeValue == CALIBRATE_VERIFY)
+      {
+        tilt.setMaxSpeed(config.tiltRunSpeed); // The range is known; the up limit guards the move
+      }
+      phaseStartPosition = tilt.currentPosition();
+      phaseLength = labs(resultValue.tiltCenter - phaseStartPosition);
+      tilt.moveTo(resultValue.tiltCenter);
+    }
+    if (modeValue == CALIBRATE_VERIFY && inputs.upLimitActive())
+    {
+      // The range is shorter than stored: the mechanism or a switch has moved
+      tilt.stop();
+      resultValue.upFound = false;
+      finishTilt();
+      break;
+    }
+    if (tilt.distanceToGo() == 0)
+    {
+      resultValue.tiltCalibrated = true;
+      finishTilt();
+      break;
+    }
+    tilt.run();
+    if (timedOut(tiltStartMs, nowMs))
+    {
+      tilt.stop();
+      finishTilt();
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  return running();
+}
+
+float CalibrationSequencer::progress()
+{
+  uint8_t total = phaseCount(modeValue);
+  if (phaseValue == CAL_IDLE)
+  {
+    return 0.0f;
+  }
+  if (!running())
+  {
+    return (float)phasesDone / total;
+  }
+
+  float fraction = 0.0f;
+  if (phaseStarted && phaseLength > 0)
+  {
+    QueuedStepper &stepper =
+        (phaseValue == CAL_YAW_BACKOFF || phaseValue == CAL_YAW_SEARCH || phaseValue == CAL_YAW_CENTER) ? yaw : tilt;
+    fraction = (float)travelled(stepper) / phaseLength;
+    if (fraction > 1.0f)
+    {
+      fraction = 1.0f;
+    }
+  }
+  return (phasesDone + fraction) / total;
+}
+
+const char *calibrationModeName(CalibrationMode mode)
+{
+  switch (mode)
+  {
+  case CALIBRATE_FULL:
+    return "calibrate";
+  case CALIBRATE_QUICK_HOME:
+    return "home";
+  case CALIBRATE_VERIFY:
+    return "verify";
+  default:
+    return "unknown";
+  }
+}
+
+const char *calibrationPhaseName(CalibrationPhase phase)
+{
+  switch (phase)
+  {
+  case CAL_IDLE:
+    return "idle";
+  case CAL_YAW_BACKOFF:
+    return "yawBackoff";
+  case CAL_YAW_SEARCH:
+    return "yawSearch";
+  case CAL_YAW_CENTER:
+    return "yawCenter";
+  case CAL_TILT_CLEAR_DOWN:
+    return "tiltClearDown";
+  case CAL_TILT_CLEAR_UP:
+    return "tiltClearUp";
+  case CAL_TILT_FIND_DOWN:
+    return "tiltFindDown";
+  case CAL_TILT_FIND_UP:
+    return "tiltFindUp";
+  case CAL_TILT_CENTER:
+    return "tiltCenter";
+  case CAL_DONE:
+    return "done";
+  case CAL_ABORTED:
+    return "aborted";
+  default:
+    return "unknown";
+  }
+}
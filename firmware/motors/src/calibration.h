@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stdint.h>
+#include "step_engine.h"
+
+// Incremental yaw-home / tilt-limit calibration.
+// step() is called once per motor task cycle and never blocks; each call runs
+// the steppers a little, checks the sensors and advances between phases. A full
+// calibration sweeps tilt to both limit switches; a quick home only re-finds
+// the yaw hall sensor and recenters tilt inside the already known range. Yaw
+// homes on the magnet center: the sweep crosses the whole sensor window in
+// one direction, the sensor interrupt latches the step count at both edges,
+// and the axis returns to halfway between them, so the zero depends neither
+// on sweep speed nor on when the motor task gets to look. A
+// verify run checks a stored calibration after a power cycle: it re-finds the
+// hall sensor, touches only the down limit to re-base tilt on the stored
+// range, and fails if the up limit closes on the way to the stored center.
+
+enum CalibrationMode : uint8_t
+{
+  CALIBRATE_FULL,
+  CALIBRATE_QUICK_HOME,
+  CALIBRATE_VERIFY
+};
+
+enum CalibrationPhase : uint8_t
+{
+  CAL_IDLE,
+  CAL_YAW_BACKOFF,
+  CAL_YAW_SEARCH,
+  CAL_YAW_CENTER,
+  CAL_TILT_CLEAR_DOWN,
+  CAL_TILT_CLEAR_UP,
+  CAL_TILT_FIND_DOWN,
+  CAL_TILT_FIND_UP,
+  CAL_TILT_CENTER,
+  CAL_DONE,
+  CAL_ABORTED
+};
+
+struct CalibrationInputs
+{
+  bool (*homeActive)(); // Hall sensor level
+  // Yaw positions latched when the sensor turned on and then off again since
+  // resetHomeLatch(); false until both edges have been seen
+  bool (*homeEdges)(long &enterPosition, long &exitPosition);
+  void (*resetHomeLatch)();
+  bool (*upLimitActive)();
+  bool (*downLimitActive)();
+};
+
+struct CalibrationConfig
+{
+  long yawBackoffSteps;  // Move off an already active home sensor
+  long yawSearchSteps;   // Longest sweep looking for the home sensor
+  long tiltClearSteps;   // Move off an already active limit switch
+  long tiltSearchSteps;  // Longest sweep toward each limit
+  long tiltVerifyMarginSteps; // Verify: travel allowed past the stored range before the down limit counts as missing
+  float yawBackoffSpeed; // steps/s
+  float yawSearchSpeed;
+  float yawRunSpeed;     // Restored when yaw homing ends
+  float tiltSearchSpeed;
+  float tiltRunSpeed;    // Restored when the tilt phase ends
+  uint32_t yawBackoffSettleMs;
+  uint32_t tiltSettleMs;
+  uint32_t axisTimeoutMs; // Per axis
+};
+
+struct CalibrationResult
+{
+  bool yawHomed;
+  bool tiltCalibrated;
+  bool downFound;
+  bool upFound;
+  long downLimit;
+  long upLimit;
+  long tiltCenter;
+  long yawWindowSteps; // Width of the hall sensor's active window
+};
+
+class CalibrationSequencer
+{
+public:
+  CalibrationSequencer(QueuedStepper &yaw, QueuedStepper &tilt);
+
+  void configure(const CalibrationConfig &config, const CalibrationInputs &inputs);
+
+  // tiltCenter is only used by CALIBRATE_QUICK_HOME
+  void start(CalibrationMode mode, uint32_t nowMs, long tiltCenter = 0);
+  // CALIBRATE_VERIFY against limits from an earlier full calibration
+  void startVerify(uint32_t nowMs, long downLimit, long upLimit, long tiltCenter);
+
+  // Returns true while calibration is still running
+  bool step(uint32_t nowMs);
+  void abort();
+
+  bool running() const { return phaseValue != CAL_IDLE && phaseValue != CAL_DONE && phaseValue != CAL_ABORTED; }
+  CalibrationMode mode() const { return modeValue; }
+  CalibrationPhase phase() const { return phaseValue; }
+  float progress();
+  const CalibrationResult &result() const { return resultValue; }
+
+private:
+  void enterPhase(CalibrationPhase next, uint32_t nowMs, uint32_t settleMs = 0);
+  void finishYaw(bool found, uint32_t nowMs);
+  void finishTilt();
+  bool timedOut(uint32_t startMs, uint32_t nowMs) const;
+  long travelled(QueuedStepper &stepper) const;
+  long tiltFindSteps() const;
+
+  QueuedStepper &yaw;
+  QueuedStepper &tilt;
+  CalibrationConfig config = {};
+  CalibrationInputs inputs = {};
+  CalibrationResult resultValue = {};
+  CalibrationResult reference = {}; // Stored limits a verify run checks against
+  CalibrationMode modeValue = CALIBRATE_FULL;
+  CalibrationPhase phaseValue = CAL_IDLE;
+  bool phaseStarted = false;
+  uint32_t settleUntilMs = 0;
+  uint32_t yawStartMs = 0;
+  uint32_t tiltStartMs = 0;
+  long phaseStartPosition = 0;
+  long phaseLength = 1;
+  long yawHomeCenter = 0;
+  uint8_t phasesDone = 0;
+};
+
+const char *calibrationModeName(CalibrationMode mode);
+const char *calibrationPhaseName(CalibrationPhase phase);
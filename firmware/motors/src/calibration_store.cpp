@@ -0,0 +1,87 @@
+#include "calibration_store.h"
+
+#include <Preferences.h>
+#include <string.h>
+
+namespace
+{
+  const char *NVS_NAMESPACE = "turret";
+  const char *NVS_KEY = "calibration";
+
+  struct CalibrationRecord
+  {
+    uint8_t version;
+    uint8_t reserved[3];
+    uint32_t fingerprint;
+    StoredCalibration calibration;
+  };
+
+  bool readRecord(CalibrationRecord &record)
+  {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true))
+    {
+      return false;
+    }
+    bool ok = prefs.getBytesLength(NVS_KEY) == sizeof(record) &&
+              prefs.getBytes(NVS_KEY, &record, sizeof(record)) == sizeof(record);
+    prefs.end();
+    return ok;
+  }
+}
+
+uint32_t calibrationFingerprint(const float *constants, size_t count)
+{
+  uint32_t hash = 2166136261u;
+  const uint8_t *bytes = (const uint8_t *)constants;
+  for (size_t i = 0; i < count * sizeof(float); i++)
+  {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+bool loadStoredCalibration(uint32_t fingerprint, StoredCalibration &out)
+{
+  CalibrationRecord record;
+  if (!readRecord(record) || record.version != CALIBRATION_STORE_VERSION || record.fingerprint != fingerprint)
+  {
+    return false;
+  }
+  out = record.calibration;
+  return true;
+}
+
+bool saveStoredCalibration(uint32_t fingerprint, const StoredCalibration &calibration)
+{
+  CalibrationRecord record;
+  memset(&record, 0, sizeof(record));
+  record.version = CALIBRATION_STORE_VERSION;
+  record.fingerprint = fingerprint;
+  record.calibration = calibration;
+
+  CalibrationRecord existing;
+  if (readRecord(existing) && memcmp(&existing, &record, sizeof(record)) == 0)
+  {
+    return true;
+  }
+
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false))
+  {
+    return false;
+  }
+  bool ok = prefs.putBytes(NVS_KEY, &record, sizeof(record)) == sizeof(record);
+  prefs.end();
+  return ok;
+}
+
+void clearStoredCalibration()
+{
+  Preferences prefs;
+  if (prefs.begin(NVS_NAMESPACE, false))
+  {
+    prefs.remove(NVS_KEY);
+    prefs.end();
+  }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Full calibration results kept in NVS across power cycles, so boot can verify
+// them instead of sweeping both axes again. A record carries a fingerprint of
+// the drive train constants it was measured with; one taken with a different
+// gear ratio, microstep factor or direction setting reads as missing.
+
+const uint8_t CALIBRATION_STORE_VERSION = 1;
+
+struct StoredCalibration
+{
+  int32_t downLimit; // Tilt steps; only their spacing survives a power cycle
+  int32_t upLimit;
+  int32_t tiltCenter;
+};
+
+// FNV-1a over the raw bytes of the given constants
+uint32_t calibrationFingerprint(const float *constants, size_t count);
+
+bool loadStoredCalibration(uint32_t fingerprint, StoredCalibration &out);
+// Skips the flash write when the same record is already stored
+bool saveStoredCalibration(uint32_t fingerprint, const StoredCalibration &calibration);
+void clearStoredCalibration();
@@ -0,0 +1,30 @@
+#include "clock_sync.h"
+
+#include <string.h>
+
+namespace
+{
+  void putU64(uint8_t *p, uint64_t v)
+  {
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      p[i] = (uint8_t)(v >> (8 * i));
+    }
+  }
+}
+
+size_t answerClockSync(const uint8_t *request, size_t len, uint64_t receiveUs, uint64_t sendUs,
+                       uint8_t *out, size_t capacity)
+{
+  if (!request || len != CLOCK_SYNC_REQUEST_SIZE || capacity < CLOCK_SYNC_RESPONSE_SIZE ||
+      request[0] != CLOCK_SYNC_MAGIC || request[1] != CLOCK_SYNC_VERSION || request[2] != CLOCK_SYNC_REQUEST)
+  {
+    return 0;
+  }
+  // Sequence and t0 go back unchanged so the camera can match the reply
+  memcpy(out, request, CLOCK_SYNC_REQUEST_SIZE);
+  out[2] = CLOCK_SYNC_RESPONSE;
+  putU64(out + 16, receiveUs);
+  putU64(out + 24, sendUs);
+  return CLOCK_SYNC_RESPONSE_SIZE;
+}
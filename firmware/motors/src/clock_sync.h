@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// NTP-style clock sync between the camera and the motor controller, over UDP.
+// The motor controller is the reference clock; it only answers requests. The
+// camera sends its send time t0, the reply carries the motor controller's
+// receive time t1 and send time t2, and the camera notes its receive time t3.
+// All times are esp_timer microseconds since boot, little-endian.
+//
+//   REQUEST   magic, version, type, reserved, uint32 sequence, uint64 t0
+//   RESPONSE  the request's 16 bytes followed by uint64 t1, uint64 t2
+//
+// firmware/cam/src/clock_sync.h carries the same layout plus the offset filter.
+
+const uint16_t CLOCK_SYNC_PORT = 4211;
+const uint8_t CLOCK_SYNC_MAGIC = 0xC5;
+const uint8_t CLOCK_SYNC_VERSION = 1;
+const size_t CLOCK_SYNC_REQUEST_SIZE = 16;
+const size_t CLOCK_SYNC_RESPONSE_SIZE = 32;
+
+enum ClockSyncType : uint8_t
+{
+  CLOCK_SYNC_REQUEST = 0x01,
+  CLOCK_SYNC_RESPONSE = 0x02,
+};
+
+// Builds the response to a request received at receiveUs. Returns the length
+// written, or 0 when the request is malformed or capacity is too small.
+size_t answerClockSync(const uint8_t *request, size_t len, uint64_t receiveUs, uint64_t sendUs,
+                       uint8_t *out, size_t capacity);
@@ -0,0 +1,141 @@
+#include "fire_control.h"
+
+void FireSequencer::configure(uint32_t cycle, uint32_t onTargetTimeout)
+{
+  cycleMs = cycle;
+  onTargetTimeoutMs = onTargetTimeout;
+}
+
+uint16_t FireSequencer::enqueue(const FirePattern &pattern)
+{
+  if (pattern.shots == 0 || pattern.shots > FIRE_MAX_SHOTS || pattern.settleMs > FIRE_MAX_SETTLE_MS ||
+      count >= FIRE_QUEUE_DEPTH)
+  {
+    return 0;
+  }
+  uint8_t slot = (head + count) % FIRE_QUEUE_DEPTH;
+  queue[slot] = pattern;
+  ids[slot] = nextId;
+  count++;
+  if (++nextId == 0)
+  {
+    nextId = 1;
+  }
+  return ids[slot];
+}
+
+void FireSequencer::clear()
+{
+  count = 0;
+  fired = 0;
+  due = false;
+}
+
+bool FireSequencer::cancel(uint16_t id)
+{
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (ids[(head + i) % FIRE_QUEUE_DEPTH] != id)
+    {
+      continue;
+    }
+    if (i == 0)
+    {
+      pop();
+      return true;
+    }
+    for (uint8_t j = i; j + 1 < count; j++)
+    {
+      uint8_t slot = (head + j) % FIRE_QUEUE_DEPTH;
+      uint8_t next = (head + j + 1) % FIRE_QUEUE_DEPTH;
+      queue[slot] = queue[next];
+      ids[slot] = ids[next];
+    }
+    count--;
+    return true;
+  }
+  return false;
+}
+
+uint32_t FireSequencer::spacing(const FirePattern &pattern) const
+{
+  uint32_t ms = cycleMs;
+  if (pattern.intervalMs > ms)
+  {
+    ms = pattern.intervalMs;
+  }
+  if (pattern.maxRatePerMin > 0)
+  {
+    uint32_t rateMs = (60000UL + pattern.maxRatePerMin - 1) / pattern.maxRatePerMin;
+    if (rateMs > ms)
+    {
+      ms = rateMs;
+    }
+  }
+  return ms;
+}
+
+void FireSequencer::pop()
+{
+  head = (head + 1) % FIRE_QUEUE_DEPTH;
+  count--;
+  fired = 0;
+  due = false;
+}
+
+FireEvent FireSequencer::update(uint32_t nowMs, bool triggerReady, bool onTarget, FireShot &shot)
+{
+  if (!onTarget)
+  {
+    settled = false;
+  }
+  else if (!settled)
+  {
+    settled = true;
+    settledMs = nowMs;
+  }
+  if (count == 0)
+  {
+    return FIRE_NONE;
+  }
+  const FirePattern &pattern = queue[head];
+  // A pattern's first shot only has to clear the trigger cycle; its cadence starts there
+  uint32_t wait = fired == 0 ? cycleMs : spacing(pattern);
+  if (!due)
+  {
+    if (!triggerReady || (pulled && nowMs - lastPullMs < wait))
+    {
+      return FIRE_NONE;
+    }
+    due = true;
+    dueMs = nowMs;
+  }
+
+  shot.pattern = ids[head];
+  shot.shots = pattern.shots;
+  shot.waitedMs = nowMs - dueMs;
+  if (pattern.onTarget && !onTarget)
+  {
+    if (shot.waitedMs <= onTargetTimeoutMs)
+    {
+      return FIRE_NONE;
+    }
+    shot.shot = fired;
+    pop();
+    return FIRE_ABANDONED;
+  }
+  if (!triggerReady || (pattern.onTarget && nowMs - settledMs < pattern.settleMs))
+  {
+    return FIRE_NONE;
+  }
+
+  shot.shot = ++fired;
+  pulled = true;
+  lastPullMs = nowMs;
+  due = false;
+  if (fired >= pattern.shots)
+  {
+    pop();
+  }
+  return FIRE_PULL;
+}
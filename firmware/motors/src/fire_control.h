@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdint.h>
+
+// Fire-control sequencer. Fire requests are queued as patterns (shot count,
+// cadence, rate cap, on-target gate) and released one trigger pull at a time.
+// Pulls never come closer together than the servo's full pull-and-return
+// cycle, whatever a pattern asks for, so a request made while the trigger is
+// still moving waits its turn instead of being dropped. A gated shot holds
+// until the caller reports the axes on target and goes the moment they are,
+// rather than on a fixed timer; one that stays off target too long gives up
+// the rest of its pattern. A settle time makes a gated shot wait for the
+// axes to stay on target that long first, for mechanical ringing to die out.
+
+const uint8_t FIRE_QUEUE_DEPTH = 8;
+const uint8_t FIRE_MAX_SHOTS = 50;
+const uint16_t FIRE_MAX_SETTLE_MS = 1000;
+
+struct FirePattern
+{
+  uint8_t shots;          // 1..FIRE_MAX_SHOTS
+  uint16_t intervalMs;    // Cadence between pulls, 0 = as fast as the trigger cycles
+  uint16_t maxRatePerMin; // Rounds per minute cap, 0 = none beyond the trigger cycle
+  bool onTarget;          // Hold each shot until the axes are on target
+  uint16_t settleMs;      // ...and have stayed there this long
+};
+
+enum FireEvent : uint8_t
+{
+  FIRE_NONE,
+  FIRE_PULL,      // Pull the trigger now
+  FIRE_ABANDONED, // The pattern's remaining shots were dropped
+};
+
+struct FireShot
+{
+  uint16_t pattern;  // Id enqueue() gave the pattern
+  uint8_t shot;      // 1-based; for FIRE_ABANDONED, the shots fired
+  uint8_t shots;     // In the pattern
+  uint32_t waitedMs; // Held past its slot waiting to be on target
+};
+
+class FireSequencer
+{
+public:
+  // cycleMs: shortest time between pulls; onTargetTimeoutMs: longest a gated shot waits
+  void configure(uint32_t cycleMs, uint32_t onTargetTimeoutMs);
+  // Returns the pattern's id, or 0 if it is invalid or the queue is full
+  uint16_t enqueue(const FirePattern &pattern);
+  void clear();
+  // Drops one pattern, e.g. a shot armed for a move that was cancelled
+  bool cancel(uint16_t id);
+
+  bool busy() const { return count > 0; }
+  uint8_t queued() const { return count; }
+  uint32_t cycle() const { return cycleMs; }
+  // Time between pulls within the pattern
+  uint32_t spacing(const FirePattern &pattern) const;
+
+  // Call every control cycle; triggerReady is false while a pull is still returning
+  FireEvent update(uint32_t nowMs, bool triggerReady, bool onTarget, FireShot &shot);
+
+private:
+  void pop();
+
+  FirePattern queue[FIRE_QUEUE_DEPTH] = {};
+  uint16_t ids[FIRE_QUEUE_DEPTH] = {};
+  uint8_t head = 0;
+  uint8_t count = 0;
+  uint8_t fired = 0; // Shots of the head pattern already pulled
+  uint16_t nextId = 1;
+  uint32_t cycleMs = 0;
+  uint32_t onTargetTimeoutMs = 0;
+  bool pulled = false; // lastPullMs is valid
+  uint32_t lastPullMs = 0;
+  bool due = false; // The head shot's slot has come
+  uint32_t dueMs = 0;
+  bool settled = false; // On target since settledMs
+  uint32_t settledMs = 0;
+};
@@ -0,0 +1,145 @@
+#include "intercept_solver.h"
+
+#include <math.h>
+
+namespace
+{
+  float clampf(float v, float limit)
+  {
+    if (v > limit)
+    {
+      return limit;
+    }
+    if (v < -limit)
+    {
+      return -limit;
+    }
+    return v;
+  }
+
+  float wrapDegrees(float deg)
+  {
+    deg = fmodf(deg + 180.0f, 360.0f);
+    if (deg < 0.0f)
+    {
+      deg += 360.0f;
+    }
+    return deg - 180.0f;
+  }
+}
+
+float interceptAxisTime(float distance, float velocity, float minVelocity, float maxVelocity, float accel)
+{
+  if (accel <= 0.0f)
+  {
+    return INFINITY;
+  }
+  // Signed distance covered braking to a stop; what is left decides which way to go first
+  float remaining = distance - velocity * fabsf(velocity) / (2.0f * accel);
+  if (remaining < 0.0f)
+  {
+    float lower = minVelocity;
+    distance = -distance;
+    velocity = -velocity;
+    remaining = -remaining;
+    minVelocity = -maxVelocity;
+    maxVelocity = -lower;
+  }
+  if (remaining == 0.0f)
+  {
+    return fabsf(velocity) / accel;
+  }
+  if (maxVelocity <= 0.0f)
+  {
+    return INFINITY;
+  }
+
+  float peak = sqrtf((2.0f * accel * distance + velocity * velocity) / 2.0f);
+  if (peak <= maxVelocity)
+  {
+    return (peak - velocity) / accel + peak / accel;
+  }
+  // Signed: getting to the limit from the wrong way starts by going backward
+  float rampDistance = fabsf(maxVelocity - velocity) * (maxVelocity + velocity) / (2.0f * accel);
+  float stopDistance = maxVelocity * maxVelocity / (2.0f * accel);
+  return fabsf(maxVelocity - velocity) / accel + maxVelocity / accel +
+         (distance - rampDistance - stopDistance) / maxVelocity;
+}
+
+void InterceptSolver::configure(const InterceptConfig &newConfig)
+{
+  config = newConfig;
+}
+
+void InterceptSolver::setTarget(const float position[INTERCEPT_AXES], const float targetRate[INTERCEPT_AXES],
+                                uint32_t measuredAt, float lead)
+{
+  for (uint8_t i = 0; i < INTERCEPT_AXES; i++)
+  {
+    target[i] = position[i];
+    rate[i] = targetRate[i];
+  }
+  measuredAtMs = measuredAt;
+  leadS = lead;
+  hasTarget = true;
+}
+
+float InterceptSolver::aimAt(uint8_t axis, uint32_t nowMs) const
+{
+  float ageS = (int32_t)(nowMs - measuredAtMs) / 1000.0f;
+  if (ageS > config.maxExtrapolationS)
+  {
+    ageS = config.maxExtrapolationS;
+  }
+  return target[axis] + rate[axis] * (ageS + leadS);
+}
+
+float InterceptSolver::errorTo(uint8_t axis, float aim, float position) const
+{
+  float error = aim - position;
+  return config.axes[axis].wraps ? wrapDegrees(error) : error;
+}
+
+InterceptPlan InterceptSolver::plan(const float position[INTERCEPT_AXES], const float velocity[INTERCEPT_AXES],
+                                    uint32_t nowMs) const
+{
+  InterceptPlan out = {};
+  out.reachable = hasTarget;
+  for (uint8_t i = 0; i < INTERCEPT_AXES && hasTarget; i++)
+  {
+    const InterceptAxisLimits &limits = config.axes[i];
+    float aim = aimAt(i, nowMs);
+    out.aim[i] = aim;
+    out.lead[i] = rate[i] * leadS;
+    // Relative to the track, the axis may go as fast as its limit allows on top of the target's rate.
+    // Planned at the braking deceleration update() uses, so the estimate is not optimistic.
+    float time = interceptAxisTime(errorTo(i, aim, position[i]), velocity[i] - rate[i],
+                                   -limits.maxVelocity - rate[i], limits.maxVelocity - rate[i],
+                                   limits.maxAccel * config.brakingFraction);
+    out.reachable = out.reachable && fabsf(rate[i]) < limits.maxVelocity && isfinite(time);
+    if (time > out.timeToTrackS)
+    {
+      out.timeToTrackS = time;
+    }
+  }
+  return out;
+}
+
+void InterceptSolver::update(const float position[INTERCEPT_AXES], const float velocity[INTERCEPT_AXES],
+                             uint32_t nowMs, float dt, float out[INTERCEPT_AXES]) const
+{
+  for (uint8_t i = 0; i < INTERCEPT_AXES; i++)
+  {
+    if (!hasTarget || dt <= 0.0f)
+    {
+      out[i] = velocity[i];
+      continue;
+    }
+    const InterceptAxisLimits &limits = config.axes[i];
+    float error = errorTo(i, aimAt(i, nowMs), position[i]);
+    float braking = sqrtf(2.0f * limits.maxAccel * config.brakingFraction * fabsf(error));
+    float closing = fminf(braking, config.settleGain * fabsf(error));
+    float desired = clampf(rate[i] + (error < 0.0f ? -closing : closing), limits.maxVelocity);
+    out[i] = velocity[i] + clampf(desired - velocity[i], limits.maxAccel * dt);
+  }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+
+// Lead-angle intercept for a target moving at a constant angular rate.
+// A shot leaves one lead time after the trigger is commanded (servo travel
+// plus any flight time), so the aim point is where the target will be that
+// far ahead, and it moves at the target's rate. Seen from that moving point
+// each axis is a plain double integrator, so the quickest way onto the track
+// with the velocity matched is bang-bang with a coast at the speed limit,
+// which has a closed form. update() flies the same profile as a feedback
+// law: close on the track at up to the axis limits, brake along the
+// maximum-deceleration curve, then ride the track at the target's rate.
+
+const uint8_t INTERCEPT_AXES = 2;
+
+struct InterceptAxisLimits
+{
+  float maxVelocity; // deg/s
+  float maxAccel;    // deg/s^2
+  bool wraps;        // Angle wraps at +/-180, so errors take the short way round
+};
+
+struct InterceptConfig
+{
+  InterceptAxisLimits axes[INTERCEPT_AXES];
+  float brakingFraction;   // 0..1 of maxAccel planned for braking; the rest absorbs step timing
+  float settleGain;        // 1/s, caps the closing speed near the track where the braking curve is steep
+  float maxExtrapolationS; // Longest time a target state is carried forward
+};
+
+struct InterceptPlan
+{
+  bool reachable;             // Target rates are within the axis speed limits
+  float timeToTrackS;         // Until both axes are on the lead track with matched rate
+  float aim[INTERCEPT_AXES];  // deg, lead aim point now
+  float lead[INTERCEPT_AXES]; // deg, aim point minus target position now
+};
+
+// Shortest time to bring an axis distance deg short of a point it must stop
+// relative to, moving at velocity relative to it, with relative speed kept in
+// [minVelocity, maxVelocity]. Infinite when the bounds leave no way there.
+float interceptAxisTime(float distance, float velocity, float minVelocity, float maxVelocity, float accel);
+
+class InterceptSolver
+{
+public:
+  void configure(const InterceptConfig &config);
+  void reset() { hasTarget = false; }
+
+  // Target angles and rates, as measured at measuredAtMs; leadS is how far
+  // ahead of the target to aim
+  void setTarget(const float position[INTERCEPT_AXES], const float rate[INTERCEPT_AXES], uint32_t measuredAtMs,
+                 float leadS);
+  bool active() const { return hasTarget; }
+  uint32_t measuredAt() const { return measuredAtMs; }
+
+  // position and velocity are the axes' current state in deg and deg/s
+  InterceptPlan plan(const float position[INTERCEPT_AXES], const float velocity[INTERCEPT_AXES],
+                     uint32_t nowMs) const;
+  // Commanded axis velocities in deg/s for the next dt seconds
+  void update(const float position[INTERCEPT_AXES], const float velocity[INTERCEPT_AXES], uint32_t nowMs, float dt,
+              float out[INTERCEPT_AXES]) const;
+
+private:
+  float aimAt(uint8_t axis, uint32_t nowMs) const;
+  float errorTo(uint8_t axis, float aim, float position) const;
+
+  InterceptConfig config = {};
+  bool hasTarget = false;
+  float target[INTERCEPT_AXES] = {};
+  float rate[INTERCEPT_AXES] = {};
+  uint32_t measuredAtMs = 0;
+  float leadS = 0.0f;
+};
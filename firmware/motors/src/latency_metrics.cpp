@@ -0,0 +1,199 @@
+#include "latency_metrics.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+namespace
+{
+  // Appends to a fixed buffer; any overflow poisons the whole write
+  void appendf(char *out, size_t capacity, size_t &len, bool &overflow, const char *format, ...)
+  {
+    if (overflow)
+    {
+      return;
+    }
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(out + len, capacity - len, format, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= capacity - len)
+    {
+      overflow = true;
+      return;
+    }
+    len += (size_t)n;
+  }
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+  clear(0);
+}
+
+void LatencyHistogram::clear(uint32_t epoch)
+{
+  for (uint8_t i = 0; i < LATENCY_BUCKETS; i++)
+  {
+    buckets[i].store(0, std::memory_order_relaxed);
+  }
+  count.store(0, std::memory_order_relaxed);
+  maxUs.store(0, std::memory_order_relaxed);
+  epochValue.store(epoch, std::memory_order_release);
+}
+
+void LatencyHistogram::record(uint32_t us, uint32_t epoch)
+{
+  if (epochValue.load(std::memory_order_relaxed) != epoch)
+  {
+    clear(epoch);
+  }
+  // Single writer, so plain load/store instead of read-modify-write
+  std::atomic<uint32_t> &bucket = buckets[latencyBucket(us)];
+  bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  if (us > maxUs.load(std::memory_order_relaxed))
+  {
+    maxUs.store(us, std::memory_order_relaxed);
+  }
+}
+
+void LatencyHistogram::addTo(LatencySummary &summary, uint32_t epoch) const
+{
+  if (epochValue.load(std::memory_order_acquire) != epoch)
+  {
+    return;
+  }
+  // Counts may be a sample apart from the buckets; fine for a histogram
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < LATENCY_BUCKETS; i++)
+  {
+    uint32_t n = buckets[i].load(std::memory_order_relaxed);
+    summary.buckets[i] += n;
+    total += n;
+  }
+  summary.count += total;
+  uint32_t peak = maxUs.load(std::memory_order_relaxed);
+  if (peak > summary.maxUs)
+  {
+    summary.maxUs = peak;
+  }
+}
+
+void LatencyMetrics::record(MetricId metric, uint8_t core, uint32_t us)
+{
+  if (metric >= METRIC_COUNT)
+  {
+    return;
+  }
+  histograms[metric][core < METRICS_CORES ? core : 0].record(us, epoch.load(std::memory_order_relaxed));
+}
+
+void LatencyMetrics::reset()
+{
+  epoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+LatencySummary LatencyMetrics::summary(MetricId metric) const
+{
+  LatencySummary result = {};
+  if (metric >= METRIC_COUNT)
+  {
+    return result;
+  }
+  uint32_t current = epoch.load(std::memory_order_relaxed);
+  for (uint8_t core = 0; core < METRICS_CORES; core++)
+  {
+    histograms[metric][core].addTo(result, current);
+  }
+  return result;
+}
+
+uint8_t latencyBucket(uint32_t us)
+{
+  uint8_t bucket = 0;
+  while (us > 0 && bucket < LATENCY_BUCKETS - 1)
+  {
+    us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+uint32_t latencyPercentileUs(const LatencySummary &summary, float fraction)
+{
+  if (summary.count == 0)
+  {
+    return 0;
+  }
+  uint32_t target = (uint32_t)(fraction * summary.count);
+  if (target >= summary.count)
+  {
+    target = summary.count - 1;
+  }
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < LATENCY_BUCKETS; i++)
+  {
+    seen += summary.buckets[i];
+    if (seen > target)
+    {
+      if (i == LATENCY_BUCKETS - 1)
+      {
+        return summary.maxUs;
+      }
+      // Never report more than was actually seen
+      uint32_t upper = 1u << i;
+      return upper < summary.maxUs ? upper : summary.maxUs;
+    }
+  }
+  return summary.maxUs;
+}
+
+const char *metricName(MetricId metric)
+{
+  switch (metric)
+  {
+  case METRIC_LOOP_PERIOD:
+    return "loopPeriod";
+  case METRIC_LOOP_WORK:
+    return "loopWork";
+  case METRIC_COMMAND_TO_STEP:
+    return "commandToStep";
+  case METRIC_JSON_PARSE:
+    return "jsonParse";
+  case METRIC_STATUS_PUBLISH:
+    return "statusPublish";
+  default:
+    return "unknown";
+  }
+}
+
+size_t encodeMetricsJson(const LatencyMetrics &metrics, char *out, size_t capacity)
+{
+  size_t len = 0;
+  bool overflow = capacity == 0;
+  appendf(out, capacity, len, overflow, "{\"metrics\":{\"resets\":%lu", (unsigned long)metrics.resets());
+  for (uint8_t m = 0; m < METRIC_COUNT; m++)
+  {
+    MetricId metric = (MetricId)m;
+    LatencySummary summary = metrics.summary(metric);
+    appendf(out, capacity, len, overflow, ",\"%s\":{\"count\":%lu,\"p50Us\":%lu,\"p99Us\":%lu,\"maxUs\":%lu,\"buckets\":[",
+           metricName(metric), (unsigned long)summary.count,
+           (unsigned long)latencyPercentileUs(summary, 0.5f),
+           (unsigned long)latencyPercentileUs(summary, 0.99f),
+           (unsigned long)summary.maxUs);
+
+    // Trailing empty buckets are left off
+    uint8_t used = LATENCY_BUCKETS;
+    while (used > 0 && summary.buckets[used - 1] == 0)
+    {
+      used--;
+    }
+    for (uint8_t i = 0; i < used; i++)
+    {
+      appendf(out, capacity, len, overflow, i == 0 ? "%lu" : ",%lu", (unsigned long)summary.buckets[i]);
+    }
+    appendf(out, capacity, len, overflow, "]}");
+  }
+  appendf(out, capacity, len, overflow, "}}");
+  return overflow ? 0 : len;
+}
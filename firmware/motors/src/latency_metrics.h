@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// Latency histograms for the motion-control path.
+// Each metric keeps one histogram per core. A histogram has a single writer,
+// and recording is a few relaxed loads and stores with no locks, so it is
+// cheap enough for the motor loop. Readers on any task sum the per-core copies.
+// reset() only bumps an epoch; each writer clears its own buckets the next
+// time it records, and readers ignore histograms still on an older epoch.
+
+// Bucket 0 counts samples under 1 us; bucket n counts [2^(n-1), 2^n) us and
+// the last bucket is open ended (~1 s and up)
+const uint8_t LATENCY_BUCKETS = 22;
+const uint8_t METRICS_CORES = 2;
+const size_t METRICS_BUFFER_SIZE = 2048;
+
+enum MetricId : uint8_t
+{
+  METRIC_LOOP_PERIOD,     // motorTask iteration start to start
+  METRIC_LOOP_WORK,       // motorTask iteration, excluding its vTaskDelay
+  METRIC_COMMAND_TO_STEP, // WebSocket frame received to first step pulse, from rest
+  METRIC_JSON_PARSE,      // deserializeJson of one text frame
+  METRIC_STATUS_PUBLISH,  // One publishTelemetry() pass
+  METRIC_COUNT
+};
+
+struct LatencySummary
+{
+  uint32_t count;
+  uint32_t maxUs;
+  uint32_t buckets[LATENCY_BUCKETS];
+};
+
+class LatencyHistogram
+{
+public:
+  LatencyHistogram();
+
+  // Writer side; clears first when epoch moved on since the last record
+  void record(uint32_t us, uint32_t epoch);
+
+  // Any task; adds nothing unless the histogram is on epoch
+  void addTo(LatencySummary &summary, uint32_t epoch) const;
+
+private:
+  void clear(uint32_t epoch);
+
+  std::atomic<uint32_t> buckets[LATENCY_BUCKETS];
+  std::atomic<uint32_t> count;
+  std::atomic<uint32_t> maxUs;
+  std::atomic<uint32_t> epochValue;
+};
+
+class LatencyMetrics
+{
+public:
+  void record(MetricId metric, uint8_t core, uint32_t us);
+  void reset();
+  LatencySummary summary(MetricId metric) const;
+  uint32_t resets() const { return epoch.load(std::memory_order_relaxed); }
+
+private:
+  LatencyHistogram histograms[METRIC_COUNT][METRICS_CORES];
+  std::atomic<uint32_t> epoch{0};
+};
+
+uint8_t latencyBucket(uint32_t us);
+
+// Upper bound of the bucket holding the given fraction of samples (0..1)
+uint32_t latencyPercentileUs(const LatencySummary &summary, float fraction);
+
+const char *metricName(MetricId metric);
+
+// {"metrics": {"loopPeriod": {"count", "p50Us", "p99Us", "maxUs", "buckets": [...]}, ...}}
+// Returns the length written, or 0 if it did not fit.
+size_t encodeMetricsJson(const LatencyMetrics &metrics, char *out, size_t capacity);
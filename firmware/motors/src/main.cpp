@@ -2,9 +2,26 @@
 #include <AsyncTCP.h>
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
-#include <AccelStepper.h>
 #include <ESP32Servo.h>
+#include <AsyncUDP.h>
+#include <ESPmDNS.h>
+#include <esp_timer.h>
 #include <math.h>
+#include "axis.h"
+#include "step_engine.h"
+#include "turret_protocol.h"
+#include "motion_planner.h"
+#include "tracking_controller.h"
+#include "intercept_solver.h"
+#include "fire_control.h"
+#include "spsc_ring.h"
+#include "seqlock.h"
+#include "calibration.h"
+#include "calibration_store.h"
+#include "telemetry.h"
+#include "latency_metrics.h"
+#include "clock_sync.h"
+#include "pose_history.h"
 
 // Simple ring buffer for recent error messages sent to UI
 const size_t MAX_ERROR_LOG = 6;
@@ -18,6 +35,18 @@ const char *password = "mistycanoe3";
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
 
+// Connected clients; a client that sends binary frames also receives binary status
+const size_t MAX_WS_CLIENTS = 8;
+// Written by the AsyncTCP task, read by motorTask when broadcasting status
+struct WsClientSlot
+{
+  volatile uint32_t id;
+  volatile bool used;
+  volatile bool binaryStatus;
+  volatile bool needsKeyframe; // New client, or a frame was skipped because its queue was full
+};
+WsClientSlot wsClients[MAX_WS_CLIENTS];
+
 // Horizontal stepper motor settings (yaw)
 const int H_STEP_PIN = 26;
 const int H_DIR_PIN = 25;
@@ -33,35 +62,56 @@ const bool LIMIT_SWITCH_ACTIVE_LOW = true; // Set false if your limit switches a
 
 const int microstepFactor = 2;
 const int baseMaxStepsPerSec = 500;
-const float verticalSpeedScale = 0.5f; // Tilt moves at half the yaw speed
-const int horizontalMaxStepsPerSec = baseMaxStepsPerSec * microstepFactor;
-const int verticalMaxStepsPerSec = (int)(horizontalMaxStepsPerSec * verticalSpeedScale);
-const float joystickSpeedLimit = 0.6;               // Clamp joystick speed to 60% of max
-const float horizontalCalibrationSpeedFactor = 0.3; // Fraction of max speed during calibration (yaw)
-const float verticalCalibrationSpeedFactor = 0.28;  // Slower tilt calibration sweep
+constexpr float verticalSpeedScale = 0.5f;  // Tilt moves at half the yaw speed
+constexpr float joystickSpeedLimit = 0.6f;  // Clamp joystick speed to 60% of max
 const float verticalClearSpeedFactor = 0.10;        // Slowest tilt speed when clearing limits
-const float effectiveHorizontalMaxStepsPerSec = horizontalMaxStepsPerSec * joystickSpeedLimit;
-const float effectiveVerticalMaxStepsPerSec = verticalMaxStepsPerSec * joystickSpeedLimit;
+const float horizontalBackoffSpeedFactor = 0.15;    // Yaw speed when backing off an active home sensor
 const float joystickAccelStepsPerSec2 = 2500.0f;
 const float joystickFilterTimeConstantSec = 0.12f;
 const float jogReleaseTimeConstantSec = 0.06f; // Pull yaw target back quickly when stick is released
 const float deadzone = 0.1;
 const float speedExponent = 1.0; // Control speed curve: 1.0 = linear, 2.0 = exponential
-const unsigned long CALIBRATION_TIMEOUT_MS = 15000;
+const unsigned long CALIBRATION_TIMEOUT_MS = 15000; // Per axis
+const unsigned long YAW_BACKOFF_SETTLE_MS = 150;
+const unsigned long TILT_SETTLE_MS = 50;
+const unsigned long CALIBRATION_PROGRESS_INTERVAL_MS = 250;
+// Calibration runs on motorTask, so its printf logging and status JSON share this stack
+const uint32_t MOTOR_TASK_STACK_BYTES = 8192;
+TaskHandle_t motorTaskHandle = NULL;
 const unsigned long CONTROL_TIMEOUT_MS = 750;       // Soft timeout: no new joystick packets
 const unsigned long CONTROL_HARD_TIMEOUT_MS = 3000; // Hard timeout: stop even if WS stays connected
 
-// Angular motion settings
-const float HORIZONTAL_GEAR_RATIO = 4.0;  // 4:1 gear ratio for yaw
-const float VERTICAL_GEAR_RATIO = 4.67;   // 4.67:1 gear ratio for tilt (12-tooth motor gear, 56-tooth output gear)
-const float STEPS_PER_REVOLUTION = 200.0; // Standard stepper motor (1.8° per step)
-const float DEGREES_PER_REVOLUTION = 360.0;
-
-// Calculate steps per degree for each axis (accounting for microstepping and gear ratios)
-const float HORIZONTAL_STEPS_PER_DEGREE = (STEPS_PER_REVOLUTION * microstepFactor * HORIZONTAL_GEAR_RATIO) / DEGREES_PER_REVOLUTION;
-const float VERTICAL_STEPS_PER_DEGREE = (STEPS_PER_REVOLUTION * microstepFactor * VERTICAL_GEAR_RATIO) / DEGREES_PER_REVOLUTION;
-const long HORIZONTAL_FULL_ROTATION_STEPS = (long)(HORIZONTAL_STEPS_PER_DEGREE * DEGREES_PER_REVOLUTION);
-const long HORIZONTAL_HALF_RANGE_STEPS = HORIZONTAL_FULL_ROTATION_STEPS / 2;
+// Axis mechanics; steps per degree account for microstepping and gear ratios
+struct YawAxisConfig
+{
+  static constexpr float MOTOR_STEPS_PER_REV = 200.0f; // Standard stepper motor (1.8° per step)
+  static constexpr int MICROSTEPS = microstepFactor;
+  static constexpr float GEAR_RATIO = 4.0f; // 4:1 gear ratio for yaw
+  static constexpr int MAX_STEPS_PER_SEC = baseMaxStepsPerSec * microstepFactor;
+  static constexpr float RUN_SPEED_FACTOR = joystickSpeedLimit;
+  static constexpr float CALIBRATION_SPEED_FACTOR = 0.6f; // Home sweep; edge capture makes the zero speed-independent
+  static constexpr bool CONTINUOUS = true;                 // Slip ring
+  static constexpr HomingStrategy HOMING = HOMING_HALL_SENSOR;
+};
+
+struct TiltAxisConfig
+{
+  static constexpr float MOTOR_STEPS_PER_REV = 200.0f;
+  static constexpr int MICROSTEPS = microstepFactor;
+  static constexpr float GEAR_RATIO = 4.67f; // 12-tooth motor gear, 56-tooth output gear
+  static constexpr int MAX_STEPS_PER_SEC = (int)(YawAxisConfig::MAX_STEPS_PER_SEC * verticalSpeedScale);
+  static constexpr float RUN_SPEED_FACTOR = joystickSpeedLimit;
+  static constexpr float CALIBRATION_SPEED_FACTOR = 0.28f; // Slower tilt calibration sweep
+  static constexpr bool CONTINUOUS = false;
+  static constexpr HomingStrategy HOMING = HOMING_LIMIT_SWITCHES;
+};
+
+typedef Axis<YawAxisConfig> YawAxis;
+typedef Axis<TiltAxisConfig> TiltAxis;
+
+// CalibrationSequencer's phases are written for these strategies
+static_assert(YawAxis::homing() == HOMING_HALL_SENSOR, "Yaw calibration searches for the hall sensor");
+static_assert(TiltAxis::homing() == HOMING_LIMIT_SWITCHES, "Tilt calibration sweeps between limit switches");
 
 // Angular positioning variables
 long horizontalCenterPosition = 0;
@@ -76,18 +126,20 @@ const int TRIGGER_MIN_HOLD_MS = 300;      // Minimum time to hold trigger pulled
 const int TRIGGER_MIN_RETURN_MS = 200;    // Minimum time to allow return to rest
 const float TRIGGER_MS_PER_DEGREE = 4.5f; // Conservative timing for MG996R
 const int TRIGGER_MOVE_EXTRA_MS = 150;    // Extra margin for full travel
-const int BURST_SHOT_COUNT = 3;
-const unsigned long BURST_SHOT_INTERVAL_MS = 500;
-const unsigned long BURST_EXTRA_TIMEOUT_MS = 500;
+
+// Fire control: requests queue as patterns and are released by fireSequencer.
+// "single" and "burst" are the ungated patterns they always were.
+const uint8_t BURST_SHOT_COUNT = 3;
+const uint16_t BURST_SHOT_INTERVAL_MS = 500;
+const unsigned long FIRE_ON_TARGET_TIMEOUT_MS = 10000; // A gated shot gives up after this long off target
+const float FIRE_ON_TARGET_DEG = 0.5f;                 // Tracking error that counts as on target
+const uint16_t FIRE_ARRIVAL_SETTLE_MS = 20;            // Default hold at rest before a fireOnArrival shot
+FireSequencer fireSequencer;
+uint16_t arrivalShotPattern = 0; // Armed by moveToAngle's fireOnArrival, 0 = none
 
 // Servo and trigger control variables
 Servo triggerServo;
 volatile bool triggerActive = false; // Prevents overlapping trigger calls
-unsigned long burstStartTime = 0;
-int burstShotCount = 0;
-bool inBurstMode = false;
-unsigned long burstIntervalMs = BURST_SHOT_INTERVAL_MS;
-unsigned long burstTotalTimeoutMs = (BURST_SHOT_COUNT * BURST_SHOT_INTERVAL_MS) + BURST_EXTRA_TIMEOUT_MS;
 
 // Non-blocking trigger timing variables
 unsigned long triggerStartTime = 0;
@@ -96,9 +148,6 @@ bool triggerReturning = false;
 unsigned long triggerHoldTimeMs = 0;
 unsigned long triggerReturnTimeMs = 0;
 
-// Burst fire needs separate timing from individual trigger pulls
-unsigned long nextBurstShotTime = 0;
-
 // Limit switch variables
 volatile bool upLimitHit = false;
 volatile bool downLimitHit = false;
@@ -106,12 +155,33 @@ bool isHorizontalCalibrated = false;
 bool isVerticalCalibrated = false;
 long upLimitPosition = 0;
 long downLimitPosition = 0;
-volatile bool homeSensorTriggered = false;
-
-// Global joystick values (updated via WebSocket)
-volatile float joystickX = 0.0;
-volatile float joystickY = 0.0;
-volatile unsigned long lastControlMessageTime = 0;
+// Raw yaw step counts at the hall sensor's first on and following off edge since
+// clearHomeSensorLatch(), latched by homeSensorISR
+volatile int32_t homeEnterSteps = 0;
+volatile int32_t homeExitSteps = 0;
+volatile bool homeEntered = false;
+volatile bool homeExited = false;
+// Raw tilt step counts where a limit switch last closed, latched by its ISR
+volatile int32_t upLimitSteps = 0;
+volatile int32_t downLimitSteps = 0;
+volatile bool upLimitLatched = false;
+volatile bool downLimitLatched = false;
+
+// Missed-step checks: with no encoder, the yaw magnet (passed every turn) and
+// the tilt limit switches are the only absolute references. A crossing that
+// disagrees with the calibrated position moves the angle reference to match.
+const long YAW_DRIFT_TOLERANCE_STEPS = 2;  // Sensor/switch repeatability; smaller errors are left alone
+const long TILT_DRIFT_TOLERANCE_STEPS = 2;
+long yawHomeWindowSteps = 0; // Sensor window width measured when homing
+uint32_t yawDriftCorrections = 0;
+uint32_t tiltDriftCorrections = 0;
+long yawDriftTotalSteps = 0; // Sum of corrections since calibration
+long tiltDriftTotalSteps = 0;
+
+// Joystick values (set by CMD_JOYSTICK in motorTask)
+float joystickX = 0.0;
+float joystickY = 0.0;
+unsigned long lastControlMessageTime = 0;
 float filteredJoystickX = 0.0f;
 float filteredJoystickY = 0.0f;
 float verticalSmoothedSpeed = 0.0f;
@@ -121,18 +191,172 @@ float horizontalJogTarget = 0.0f;
 float verticalJogTarget = 0.0f;
 unsigned long lastJogUpdateTime = 0;
 
-// Calibration control flag
-volatile bool calibrationInProgress = false;
+// Calibration/homing runs as a state machine stepped from motorTask
+bool calibrationInProgress = false;
+CalibrationPhase lastReportedCalibrationPhase = CAL_IDLE;
+unsigned long lastCalibrationProgressMs = 0;
+// A finished calibration is written to NVS from loop(), off motorTask's stack.
+// A flash write also stalls the core it runs on for several milliseconds.
+StoredCalibration pendingCalibrationStore; // Written by motorTask before the flag is set
+std::atomic<bool> calibrationStorePending(false);
 
 // Movement mode control - prevents conflicts between joystick and angular positioning
-volatile bool angularMovementInProgress = false;
+bool angularMovementInProgress = false;
 unsigned long angularMovementStartTime = 0;
 const unsigned long ANGULAR_MOVEMENT_TIMEOUT = 10000; // 10 seconds max for angular moves
-unsigned long lastStatusSend = 0;
-const unsigned long STATUS_INTERVAL_MS = 1000;
+unsigned long angularMovementTimeoutMs = ANGULAR_MOVEMENT_TIMEOUT;
+
+// Visual-servo tracking (track command): pixel errors from the detector drive a velocity loop
+const float CAMERA_HFOV_DEG = 62.0f; // OV2640 horizontal field of view
+const float CAMERA_VFOV_DEG = 41.0f; // Vertical field of view at the 3:2 HVGA stream size
+const unsigned long TRACKING_TIMEOUT_MS = 500; // Stop if detections stop arriving
+const TrackingGains YAW_TRACKING_GAINS = {4.0f, 0.5f, 0.0f, 1.0f, 0.5f, 200.0f, 5.0f,
+                                          YawAxis::toDegrees(YawAxis::runStepsPerSec()),
+                                          YawAxis::toDegrees(joystickAccelStepsPerSec2)};
+const TrackingGains TILT_TRACKING_GAINS = {4.0f, 0.5f, 0.0f, 1.0f, 0.5f, 200.0f, 5.0f,
+                                           TiltAxis::toDegrees(TiltAxis::runStepsPerSec()),
+                                           TiltAxis::toDegrees(joystickAccelStepsPerSec2)};
+TrackingController trackingController;
+bool trackingActive = false;
+unsigned long lastTrackingUpdateUs = 0;
+
+// Intercept (intercept command): the target's angles and rates drive the same
+// velocity loop, aimed one trigger travel (plus flight time, if given) ahead so
+// the shot meets the target instead of landing behind it
+const unsigned long INTERCEPT_TIMEOUT_MS = 1000; // Stop if target updates stop arriving
+const unsigned long INTERCEPT_MAX_FLIGHT_MS = 2000;
+const InterceptConfig INTERCEPT_CONFIG = {
+    {{YawAxis::toDegrees(YawAxis::runStepsPerSec()),
+      YawAxis::toDegrees(joystickAccelStepsPerSec2), true},
+     {TiltAxis::toDegrees(TiltAxis::runStepsPerSec()),
+      TiltAxis::toDegrees(joystickAccelStepsPerSec2), false}},
+    0.8f,
+    15.0f,
+    INTERCEPT_TIMEOUT_MS / 1000.0f};
+InterceptSolver interceptSolver;
+bool interceptMode = false; // Set with trackingActive when the loop follows interceptSolver
+unsigned long lastInterceptUpdateMs = 0;
+
+// Coordinated moves: both axes share one speed profile so they start and stop together
+const unsigned long SYNC_MOVE_START_DELAY_US = 2000; // Lets both axes flush before the first step
+bool coordinatedMotionEnabled = true;
+SyncProfile angularSyncProfile;
+
+// Queued waypoint sequences (moveSequence command)
+const float SEQUENCE_JUNCTION_TIME_SEC = 0.05f; // Corner blending aggressiveness
+const float SEQUENCE_POSITION_GAIN = 20.0f;     // 1/s correction toward the planned position
+MotionPlanner motionPlanner;
+bool sequenceInProgress = false;
+unsigned long lastSequenceUpdateUs = 0;
+
+// Telemetry: changed fields are published at telemetryIntervalMs, full keyframes
+// go to new or lagging clients and to everyone every TELEMETRY_KEYFRAME_MS
+const uint32_t TELEMETRY_DEFAULT_RATE_HZ = 20;
+const unsigned long TELEMETRY_KEYFRAME_MS = 5000;
+const TelemetryEvents NO_TELEMETRY_EVENTS = {false, false, false, false};
+unsigned long telemetryIntervalMs = 1000 / TELEMETRY_DEFAULT_RATE_HZ;
+unsigned long lastTelemetryMs = 0;
+unsigned long lastKeyframeMs = 0;
+TelemetryState telemetryBaseline;
+bool telemetryBaselineValid = false;
+char telemetryDeltaBuffer[TELEMETRY_BUFFER_SIZE];
+char telemetryKeyframeBuffer[TELEMETRY_BUFFER_SIZE];
+char telemetryEventBuffer[TELEMETRY_EVENT_BUFFER_SIZE];
+uint32_t telemetryFramesSkipped = 0;
+
+// Latency histograms, read by {"getMetrics": true}. Each core has its own cycle
+// counter, so only intervals measured on the pinned motor task use cycles;
+// anything that crosses tasks or runs on the unpinned AsyncTCP task uses micros().
+const unsigned long STEP_LATENCY_TIMEOUT_MS = 500; // Command produced no steps
+LatencyMetrics latencyMetrics;
+uint32_t cpuCyclesPerUs = 240;
+char metricsBuffer[METRICS_BUFFER_SIZE]; // WebSocket handler only
+std::atomic<bool> stepLatencyArmed(false); // Set by motorTask, cleared by the step ISR
+std::atomic<uint32_t> firstStepUs(0);
+bool stepLatencyPending = false;
+uint32_t stepLatencyStartUs = 0;
+
+// Pose history for matching camera frames to where the turret pointed,
+// recorded every motor cycle. The camera syncs its clock to esp_timer here
+// over UDP, finding us by mDNS name, and asks {"getPoseAt": {"timeUs": t}}
+// for a frame's capture time. Binary clients can page through the whole
+// history with POSE_HISTORY_REQUEST frames.
+const char *MDNS_HOSTNAME = "turret-motors";
+const size_t POSE_EXPORT_MAX_SAMPLES = 256;
+PoseHistory poseHistory;
+PoseSample poseExportSamples[POSE_EXPORT_MAX_SAMPLES]; // WebSocket handler only
+uint8_t poseExportFrame[POSE_HISTORY_HEADER_SIZE + POSE_EXPORT_MAX_SAMPLES * POSE_HISTORY_SAMPLE_SIZE];
+AsyncUDP clockSyncUdp;
+std::atomic<uint32_t> clockSyncRequests(0);
+
+// Command mailbox: the WebSocket handler (AsyncTCP task) only parses and enqueues.
+// All stepper and motion state is owned by motorTask, which drains the ring each cycle.
+enum MotorCommandType : uint8_t
+{
+  CMD_CLIENT_CONNECTED,
+  CMD_CLIENT_DISCONNECTED,
+  CMD_JOYSTICK,
+  CMD_MOVE_TO_ANGLE,
+  CMD_MOVE_BY_ANGLE,
+  CMD_MOVE_TO_CENTER,
+  CMD_MOVE_SEQUENCE,
+  CMD_TRACK,
+  CMD_INTERCEPT,
+  CMD_STOP_TRACKING,
+  CMD_CANCEL_ANGULAR,
+  CMD_SET_COORDINATED,
+  CMD_FIRE,
+  CMD_CANCEL_FIRE,
+  CMD_HOME,
+  CMD_CALIBRATE,
+  CMD_ABORT_CALIBRATION,
+  CMD_SET_TELEMETRY_RATE,
+  CMD_REPORT_ERROR
+};
+
+const uint8_t JOYSTICK_HAS_X = 1 << 0;
+const uint8_t JOYSTICK_HAS_Y = 1 << 1;
+const size_t COMMAND_TEXT_LEN = 48;
+const size_t COMMAND_QUEUE_DEPTH = 16;
+
+struct MotorCommand
+{
+  MotorCommandType type;
+  uint8_t axes;      // CMD_JOYSTICK: JOYSTICK_HAS_X / JOYSTICK_HAS_Y
+  uint8_t count;     // CMD_MOVE_SEQUENCE: waypoints used
+  FirePattern firePattern; // CMD_FIRE, or CMD_MOVE_TO_ANGLE's arrival shot (shots = 0 for none)
+  bool enabled;      // CMD_SET_COORDINATED
+  uint16_t rateHz;   // CMD_SET_TELEMETRY_RATE
+  float horizontal;  // Joystick x, angle (deg) or yaw tracking error (deg)
+  float vertical;    // Joystick y, angle (deg) or tilt tracking error (deg)
+  float rates[PLANNER_AXES]; // CMD_INTERCEPT: target deg/s
+  uint64_t targetUs;         // CMD_INTERCEPT: esp_timer time the target was seen, 0 = now
+  uint16_t flightMs;         // CMD_INTERCEPT: projectile flight time added to the lead
+  float waypoints[PLANNER_MAX_SEGMENTS][PLANNER_AXES];
+  char text[COMMAND_TEXT_LEN]; // CMD_REPORT_ERROR
+  uint32_t receivedUs;         // micros() when the frame arrived
+};
+
+SpscRing<MotorCommand, COMMAND_QUEUE_DEPTH> commandMailbox;
+std::atomic<uint32_t> droppedCommandCount(0);
+uint32_t reportedDroppedCommands = 0;
+
+// State published by motorTask for readers on other tasks
+struct TurretSnapshot
+{
+  float horizontalAngle;
+  float verticalAngle;
+  int32_t horizontalPosition;
+  int32_t verticalPosition;
+  uint32_t flags; // STATUS_* bits
+  uint32_t updatedMs;
+};
+Seqlock<TurretSnapshot> turretSnapshot;
 
 // Forward declarations
 void cancelAngularMovement();
+void clearMoveSequence();
+void stopTracking();
 void homeTurret();
 void stopAllMotion();
 void syncJogTargetsToCurrent();
@@ -141,26 +365,116 @@ void sendStatus(bool movementComplete = false, bool calibrationCompleteFlag = fa
 void getCurrentAngles(float &horizontalAngle, float &verticalAngle);
 void recordError(const String &msg);
 void appendErrors(JsonArray &arr);
+void publishTelemetry(const TelemetryEvents &events);
+void publishTurretSnapshot();
+
+// Step engine: steps are planned ahead into per-axis queues and emitted by a hardware timer ISR
+const uint8_t HORIZONTAL_AXIS = 0;
+const uint8_t VERTICAL_AXIS = 1;
+const uint8_t STEP_TIMER_ID = 0;
+const uint16_t STEP_TIMER_DIVIDER = 80; // 80 MHz APB clock -> 1us timer ticks
+DRAM_ATTR const uint8_t STEP_PINS[STEP_ENGINE_MAX_AXES] = {H_STEP_PIN, V_STEP_PIN};
+DRAM_ATTR const uint8_t DIR_PINS[STEP_ENGINE_MAX_AXES] = {H_DIR_PIN, V_DIR_PIN};
+StepEngine stepEngine;
+hw_timer_t *stepTimer = NULL;
+
+QueuedStepper horizontalStepper(stepEngine, HORIZONTAL_AXIS);
+QueuedStepper verticalStepper(stepEngine, VERTICAL_AXIS);
+CalibrationSequencer calibrationSequencer(horizontalStepper, verticalStepper);
+
+void IRAM_ATTR setStepDirection(uint8_t axis, bool forward)
+{
+  digitalWrite(DIR_PINS[axis], forward ? HIGH : LOW);
+}
+
+void IRAM_ATTR stepPinHigh(uint8_t axis, uint32_t nowUs)
+{
+  digitalWrite(STEP_PINS[axis], HIGH);
+  if (stepLatencyArmed.load(std::memory_order_relaxed))
+  {
+    firstStepUs.store(nowUs, std::memory_order_relaxed);
+    stepLatencyArmed.store(false, std::memory_order_release);
+  }
+}
+
+void IRAM_ATTR stepPinLow(uint8_t axis)
+{
+  digitalWrite(STEP_PINS[axis], LOW);
+}
+
+void IRAM_ATTR stepPulseDelay()
+{
+  delayMicroseconds(2);
+}
+
+uint32_t IRAM_ATTR stepClockUs()
+{
+  return micros();
+}
+
+void IRAM_ATTR stepTimerISR()
+{
+  uint32_t nextUs = stepEngine.service(micros());
+  timerAlarmWrite(stepTimer, nextUs, true);
+}
+
+void startStepEngine()
+{
+  for (uint8_t axis = 0; axis < STEP_ENGINE_MAX_AXES; axis++)
+  {
+    pinMode(STEP_PINS[axis], OUTPUT);
+    pinMode(DIR_PINS[axis], OUTPUT);
+    digitalWrite(STEP_PINS[axis], LOW);
+  }
 
-// Create AccelStepper instances
-AccelStepper horizontalStepper(AccelStepper::DRIVER, H_STEP_PIN, H_DIR_PIN);
-AccelStepper verticalStepper(AccelStepper::DRIVER, V_STEP_PIN, V_DIR_PIN);
+  StepOutput output = {setStepDirection, stepPinHigh, stepPinLow, stepPulseDelay};
+  stepEngine.begin(output, stepClockUs);
+
+  stepTimer = timerBegin(STEP_TIMER_ID, STEP_TIMER_DIVIDER, true);
+  timerAttachInterrupt(stepTimer, &stepTimerISR, true);
+  timerAlarmWrite(stepTimer, STEP_IDLE_POLL_US, true);
+  timerAlarmEnable(stepTimer);
+}
 
 // Interrupt service routines for limit switches and sensors
 // These functions are called instantly when the inputs change state
 void IRAM_ATTR homeSensorISR()
 {
-  homeSensorTriggered = digitalRead(H_HOME_PIN) == LOW;
+  // The step ISR counts a step before raising its pulse, so this is the step that moved the edge
+  int32_t steps = stepEngine.channel(HORIZONTAL_AXIS).position.load(std::memory_order_relaxed);
+  if (digitalRead(H_HOME_PIN) == LOW)
+  {
+    if (!homeEntered)
+    {
+      homeEnterSteps = steps;
+      homeEntered = true;
+    }
+  }
+  else if (homeEntered && !homeExited)
+  {
+    homeExitSteps = steps;
+    homeExited = true;
+  }
 }
 
 void IRAM_ATTR upLimitISR()
 {
   upLimitHit = LIMIT_SWITCH_ACTIVE_LOW ? (digitalRead(UP_LIMIT_PIN) == LOW) : (digitalRead(UP_LIMIT_PIN) == HIGH);
+  if (upLimitHit && !upLimitLatched)
+  {
+    upLimitSteps = stepEngine.channel(VERTICAL_AXIS).position.load(std::memory_order_relaxed);
+    upLimitLatched = true;
+  }
 }
 
 void IRAM_ATTR downLimitISR()
 {
   downLimitHit = LIMIT_SWITCH_ACTIVE_LOW ? (digitalRead(DOWN_LIMIT_PIN) == LOW) : (digitalRead(DOWN_LIMIT_PIN) == HIGH);
+  if (downLimitHit && !downLimitLatched)
+  {
+    downLimitSteps = stepEngine.channel(VERTICAL_AXIS).position.load(std::memory_order_relaxed);
+    downLimitLatched = true;
+  }
 }
 
 bool canMoveUp()
@@ -226,6 +540,19 @@ float wrapTo180(float angle)
   return wrapped360;
 }
 
+// Stick deflection past the deadzone, shaped by speedExponent, as a signed axis speed in steps/s
+template <typename A>
+float joystickAxisSpeed(float input)
+{
+  if (fabs(input) <= deadzone)
+  {
+    return 0.0f;
+  }
+  float norm = (fabs(input) - deadzone) / (1.0 - deadzone);
+  float mappedSpeed = pow(norm, speedExponent) * A::runStepsPerSec();
+  return input > 0 ? mappedSpeed : -mappedSpeed;
+}
+
 float shortestDeltaDegrees(float currentDeg, float targetDeg)
 {
   float delta = targetDeg - currentDeg;
@@ -240,51 +567,234 @@ float shortestDeltaDegrees(float currentDeg, float targetDeg)
   return delta;
 }
 
-void sendStatus(bool movementComplete, bool calibrationCompleteFlag, bool yawHomed, bool tiltCalibrated)
+void recordMetric(MetricId metric, uint32_t us)
+{
+  latencyMetrics.record(metric, (uint8_t)xPortGetCoreID(), us);
+}
+
+uint32_t cyclesToUs(uint32_t cycles)
+{
+  return cycles / cpuCyclesPerUs;
+}
+
+bool isAxisMoving()
+{
+  return fabs(horizontalStepper.speed()) > 0.5f || fabs(verticalStepper.speed()) > 0.5f;
+}
+
+uint16_t statusFlags(bool isMoving, bool movementComplete, bool calibrationCompleteFlag, bool yawHomed, bool tiltCalibrated)
+{
+  return (angularPositioningEnabled ? STATUS_CALIBRATED : 0) |
+         (calibrationInProgress ? STATUS_CALIBRATING : 0) |
+         (angularMovementInProgress ? STATUS_ANGULAR_IN_PROGRESS : 0) |
+         (isMoving ? STATUS_IS_MOVING : 0) |
+         (isHomeSensorActive() ? STATUS_YAW_HOME : 0) |
+         (upLimitHit ? STATUS_TILT_UP : 0) |
+         (downLimitHit ? STATUS_TILT_DOWN : 0) |
+         (triggerActive ? STATUS_TRIGGER_ACTIVE : 0) |
+         (movementComplete ? STATUS_MOVEMENT_COMPLETE : 0) |
+         (calibrationCompleteFlag ? STATUS_CALIBRATION_COMPLETE : 0) |
+         (yawHomed ? STATUS_YAW_HOMED : 0) |
+         (tiltCalibrated ? STATUS_TILT_CALIBRATED : 0);
+}
+
+// Called from motorTask; WebSocket-side readers use turretSnapshot instead
+void publishTurretSnapshot()
 {
+  TurretSnapshot snap;
+  getCurrentAngles(snap.horizontalAngle, snap.verticalAngle);
+  snap.horizontalPosition = horizontalStepper.currentPosition();
+  snap.verticalPosition = verticalStepper.currentPosition();
+  snap.flags = statusFlags(isAxisMoving(), false, false, false, false);
+  snap.updatedMs = millis();
+  turretSnapshot.write(snap);
+}
+
+int16_t speedToPoseSample(float stepsPerSec)
+{
+  return (int16_t)constrain(lroundf(stepsPerSec), -32767L, 32767L);
+}
+
+// Motor task only. Positions are stored relative to the calibrated center so
+// a lookup reads the same way getCurrentAngles() does.
+void recordPose()
+{
+  PoseSample sample;
+  sample.timeUs = esp_timer_get_time();
+  sample.yawSteps = (int32_t)(horizontalStepper.currentPosition() - horizontalCenterPosition);
+  sample.tiltSteps = (int32_t)(verticalStepper.currentPosition() - verticalCenterPosition);
+  sample.yawStepsPerSec = speedToPoseSample(horizontalStepper.speed());
+  sample.tiltStepsPerSec = speedToPoseSample(verticalStepper.speed());
+  poseHistory.record(sample);
+}
+
+TelemetryState captureTelemetry()
+{
+  TelemetryState state;
+  getCurrentAngles(state.horizontalAngle, state.verticalAngle);
+  state.horizontalPosition = horizontalStepper.currentPosition();
+  state.verticalPosition = verticalStepper.currentPosition();
+  state.flags = statusFlags(isAxisMoving(), false, false, false, false);
+  state.coordinated = coordinatedMotionEnabled;
+  state.tracking = trackingActive;
+  return state;
+}
+
+// Falls back to a keyframe without the error list if the errors do not fit
+size_t encodeTelemetryKeyframe(const TelemetryState &current, const TelemetryEvents &events,
+                               const char *const *errors, size_t errorCount)
+{
+  size_t len = encodeTelemetryJson(current, nullptr, events, errors, errorCount,
+                                   telemetryKeyframeBuffer, sizeof(telemetryKeyframeBuffer));
+  if (len == 0)
+  {
+    len = encodeTelemetryJson(current, nullptr, events, nullptr, 0,
+                              telemetryKeyframeBuffer, sizeof(telemetryKeyframeBuffer));
+  }
+  return len;
+}
+
+// Sends each client what it is missing: binary clients get the fixed status frame
+// when anything changed, JSON clients a delta or (when resyncing) a keyframe.
+// Clients whose send queue is full are skipped and resynced with a keyframe later.
+void publishTelemetry(const TelemetryEvents &events)
+{
+  unsigned long now = millis();
+  lastTelemetryMs = now;
   if (ws.count() == 0)
   {
+    telemetryBaselineValid = false;
     return;
   }
+  uint32_t startCycles = ESP.getCycleCount();
+
+  TelemetryState current = captureTelemetry();
+  bool hasEvents = events.movementComplete || events.calibrationComplete;
+  bool keyframeDue = !telemetryBaselineValid || now - lastKeyframeMs >= TELEMETRY_KEYFRAME_MS;
+  bool changed = keyframeDue || telemetryChanged(current, telemetryBaseline);
 
-  StaticJsonDocument<768> doc;
-  JsonObject status = doc.createNestedObject("status");
-  status["calibrated"] = angularPositioningEnabled;
-  status["calibrating"] = calibrationInProgress;
-  float hAngle = 0.0f, vAngle = 0.0f;
-  getCurrentAngles(hAngle, vAngle);
-  JsonObject angles = status.createNestedObject("angles");
-  angles["horizontal"] = hAngle;
-  angles["vertical"] = vAngle;
-  JsonObject positions = status.createNestedObject("positions");
-  positions["horizontal"] = horizontalStepper.currentPosition();
-  positions["vertical"] = verticalStepper.currentPosition();
-  JsonObject movement = status.createNestedObject("movement");
-  movement["angularInProgress"] = angularMovementInProgress;
-  movement["isMoving"] = fabs(horizontalStepper.speed()) > 0.5f || fabs(verticalStepper.speed()) > 0.5f;
-  JsonObject sensors = status.createNestedObject("sensors");
-  sensors["yawHome"] = isHomeSensorActive();
-  sensors["tiltUp"] = upLimitHit;
-  sensors["tiltDown"] = downLimitHit;
-  status["triggerActive"] = triggerActive;
+  const char *errors[MAX_ERROR_LOG];
+  size_t errorCount = 0;
+  for (size_t i = 0; i < errorLogCount; i++)
+  {
+    errors[errorCount++] = errorLog[(errorLogHead + MAX_ERROR_LOG - errorLogCount + i) % MAX_ERROR_LOG].c_str();
+  }
 
-  if (movementComplete)
+  size_t keyframeLen = 0;
+  size_t deltaLen = 0;
+  if (keyframeDue)
+  {
+    keyframeLen = encodeTelemetryKeyframe(current, events, errors, errorCount);
+    telemetryBaseline = current;
+    telemetryBaselineValid = true;
+    lastKeyframeMs = now;
+  }
+  else
   {
-    doc["movementComplete"] = true;
+    deltaLen = encodeTelemetryJson(current, &telemetryBaseline, events, nullptr, 0,
+                                   telemetryDeltaBuffer, sizeof(telemetryDeltaBuffer));
   }
-  if (calibrationCompleteFlag)
+
+  uint8_t frame[PROTOCOL_MAX_FRAME_SIZE];
+  size_t frameLen = 0;
+  for (size_t i = 0; i < MAX_WS_CLIENTS; i++)
   {
-    doc["calibrationComplete"] = true;
-    doc["yawHomed"] = yawHomed;
-    doc["tiltCalibrated"] = tiltCalibrated;
+    WsClientSlot &slot = wsClients[i];
+    if (!slot.used)
+    {
+      continue;
+    }
+    bool resync = keyframeDue || slot.needsKeyframe;
+    if (!resync && !changed && !hasEvents)
+    {
+      continue;
+    }
+    AsyncWebSocketClient *c = ws.client(slot.id);
+    if (!c)
+    {
+      continue;
+    }
+    if (c->queueIsFull())
+    {
+      slot.needsKeyframe = true;
+      telemetryFramesSkipped++;
+      continue;
+    }
+
+    if (slot.binaryStatus)
+    {
+      if (frameLen == 0)
+      {
+        TurretStatus bin = {};
+        bin.flags = current.flags |
+                    (events.movementComplete ? STATUS_MOVEMENT_COMPLETE : 0) |
+                    (events.calibrationComplete ? STATUS_CALIBRATION_COMPLETE : 0) |
+                    (events.yawHomed ? STATUS_YAW_HOMED : 0) |
+                    (events.tiltCalibrated ? STATUS_TILT_CALIBRATED : 0);
+        bin.horizontalAngle = current.horizontalAngle;
+        bin.verticalAngle = current.verticalAngle;
+        bin.horizontalPosition = current.horizontalPosition;
+        bin.verticalPosition = current.verticalPosition;
+        bin.errorCount = (uint8_t)errorLogCount;
+        frameLen = encodeStatus(bin, frame, sizeof(frame));
+      }
+      c->binary(frame, frameLen);
+    }
+    else if (resync)
+    {
+      if (keyframeLen == 0)
+      {
+        keyframeLen = encodeTelemetryKeyframe(current, events, errors, errorCount);
+      }
+      if (keyframeLen > 0)
+      {
+        c->text(telemetryKeyframeBuffer, keyframeLen);
+      }
+    }
+    else if (deltaLen > 0)
+    {
+      c->text(telemetryDeltaBuffer, deltaLen);
+    }
+    slot.needsKeyframe = false;
   }
+  recordMetric(METRIC_STATUS_PUBLISH, cyclesToUs(ESP.getCycleCount() - startCycles));
+}
 
-  JsonArray errors = doc.createNestedArray("errors");
-  appendErrors(errors);
+// Sends a one-shot message from telemetryEventBuffer to every client. One whose
+// queue is full misses it and is resynced with a keyframe, as publishTelemetry() does.
+void publishEvent(size_t len)
+{
+  if (len == 0)
+  {
+    return;
+  }
+  for (size_t i = 0; i < MAX_WS_CLIENTS; i++)
+  {
+    WsClientSlot &slot = wsClients[i];
+    if (!slot.used)
+    {
+      continue;
+    }
+    AsyncWebSocketClient *c = ws.client(slot.id);
+    if (!c)
+    {
+      continue;
+    }
+    if (c->queueIsFull())
+    {
+      slot.needsKeyframe = true;
+      telemetryFramesSkipped++;
+      continue;
+    }
+    c->text(telemetryEventBuffer, len);
+  }
+}
 
-  String responseStr;
-  serializeJson(doc, responseStr);
-  ws.textAll(responseStr);
+// Publishes immediately; the flags are one-shot events carried with this update only
+void sendStatus(bool movementComplete, bool calibrationCompleteFlag, bool yawHomed, bool tiltCalibrated)
+{
+  TelemetryEvents events = {movementComplete, calibrationCompleteFlag, yawHomed, tiltCalibrated};
+  publishTelemetry(events);
 }
 
 void stopAllMotion()
@@ -368,395 +878,511 @@ void updateTrigger()
   }
 }
 
-void fireSingleShot()
+// Full pull-and-return time, the shortest spacing between shots
+unsigned long computeTriggerCycleMs()
 {
-  if (triggerActive)
+  unsigned long moveTimeMs = computeTriggerMoveTimeMs();
+  return moveTimeMs + max((unsigned long)TRIGGER_MIN_RETURN_MS, moveTimeMs);
+}
+
+// Angular moves are on target once every step is out and both axes are at
+// rest, sequences once they finish, tracking and intercept once the aim error
+// is small, anything else once both axes stop
+bool axesOnTarget()
+{
+  if (calibrationInProgress)
   {
-    Serial.println("Trigger already active - ignoring single shot command");
-    return;
+    return false;
   }
-
-  Serial.println("Firing single shot");
-  startTriggerPull();
+  if (trackingActive)
+  {
+    float yawDeg = YawAxis::toDegrees(horizontalStepper.currentPosition() - horizontalCenterPosition);
+    float tiltDeg = TiltAxis::toDegrees(verticalStepper.currentPosition() - verticalCenterPosition);
+    float yawError = trackingController.yawError();
+    float tiltError = trackingController.tiltError();
+    if (interceptMode)
+    {
+      float position[INTERCEPT_AXES] = {yawDeg, tiltDeg};
+      float velocity[INTERCEPT_AXES] = {YawAxis::toDegrees(horizontalStepper.speed()),
+                                        TiltAxis::toDegrees(verticalStepper.speed())};
+      InterceptPlan plan = interceptSolver.plan(position, velocity, millis());
+      yawError = wrapTo180(plan.aim[0] - yawDeg);
+      tiltError = plan.aim[1] - tiltDeg;
+    }
+    return fabs(yawError) <= FIRE_ON_TARGET_DEG && fabs(tiltError) <= FIRE_ON_TARGET_DEG;
+  }
+  if (angularMovementInProgress)
+  {
+    // Checked directly rather than waiting for motorTask to end the move a cycle later
+    return !sequenceInProgress && horizontalStepper.distanceToGo() == 0 && verticalStepper.distanceToGo() == 0 &&
+           !isAxisMoving();
+  }
+  return !isAxisMoving();
 }
 
-void startBurstFire()
+void reportShot(const FireShot &shot, uint64_t timeUs)
 {
-  if (triggerActive || inBurstMode)
+  Serial.printf("Shot %u/%u of pattern %u%s\n", shot.shot, shot.shots, shot.pattern,
+                shot.waitedMs > 0 ? " (held for target)" : "");
+  if (ws.count() == 0)
   {
-    Serial.println("Trigger or burst already active - ignoring burst fire command");
     return;
   }
+  publishEvent(encodeShotJson(shot.pattern, shot.shot, shot.shots, timeUs, shot.waitedMs,
+                              telemetryEventBuffer, sizeof(telemetryEventBuffer)));
+}
 
-  inBurstMode = true;
-  burstShotCount = 0;
-  burstStartTime = millis();
-  unsigned long moveTimeMs = computeTriggerMoveTimeMs();
-  unsigned long triggerCycleMs = moveTimeMs + max((unsigned long)TRIGGER_MIN_RETURN_MS, moveTimeMs);
-  burstIntervalMs = max(BURST_SHOT_INTERVAL_MS, triggerCycleMs);
-  burstTotalTimeoutMs = (burstIntervalMs * BURST_SHOT_COUNT) + BURST_EXTRA_TIMEOUT_MS;
-  nextBurstShotTime = burstStartTime; // First shot fires immediately
-  Serial.printf("Starting burst fire mode (%d shots, %lums interval)\n",
-                BURST_SHOT_COUNT, burstIntervalMs);
+// Returns the pattern's id, or 0 if it was rejected
+uint16_t queueFirePattern(const FirePattern &pattern)
+{
+  uint16_t id = fireSequencer.enqueue(pattern);
+  if (id == 0)
+  {
+    recordError("Fire rejected: queue full");
+    return 0;
+  }
+  Serial.printf("Fire pattern %u queued: %u shot(s), %lu ms apart%s\n", id, pattern.shots,
+                (unsigned long)fireSequencer.spacing(pattern), pattern.onTarget ? ", on target" : "");
+  return id;
 }
 
-void updateBurstFire()
+// A fireOnArrival shot belongs to its move; anything that ends or replaces the move drops it
+void disarmArrivalShot()
 {
-  if (!inBurstMode)
-    return;
+  if (arrivalShotPattern != 0 && fireSequencer.cancel(arrivalShotPattern))
+  {
+    Serial.println("Arrival shot disarmed");
+  }
+  arrivalShotPattern = 0;
+}
 
-  unsigned long currentTime = millis();
+void cancelFire()
+{
+  if (fireSequencer.busy())
+  {
+    Serial.printf("Fire queue cleared (%u pattern(s))\n", fireSequencer.queued());
+  }
+  fireSequencer.clear();
+}
 
-  // Check if we can fire the next shot (trigger must be ready)
-  if (burstShotCount < BURST_SHOT_COUNT && !triggerActive && currentTime >= nextBurstShotTime)
+// Releases queued shots; the trigger itself is run by updateTrigger()
+void updateFireControl()
+{
+  FireShot shot = {};
+  FireEvent event = fireSequencer.update(millis(), !triggerActive, axesOnTarget(), shot);
+  if (event != FIRE_NONE && shot.pattern == arrivalShotPattern)
+  {
+    arrivalShotPattern = 0;
+  }
+  if (event == FIRE_PULL)
   {
-    Serial.printf("Firing burst shot %d/%d\n", burstShotCount + 1, BURST_SHOT_COUNT);
     startTriggerPull();
-    burstShotCount++;
-
-    // Schedule next shot based on configured interval
-    nextBurstShotTime = currentTime + burstIntervalMs;
+    reportShot(shot, esp_timer_get_time());
   }
-
-  // End burst mode after timeout or all shots fired
-  unsigned long elapsedTime = currentTime - burstStartTime;
-  if (elapsedTime >= burstTotalTimeoutMs || burstShotCount >= BURST_SHOT_COUNT)
+  else if (event == FIRE_ABANDONED)
   {
-    inBurstMode = false;
-    Serial.println("Burst fire complete");
+    recordError("Fire pattern " + String(shot.pattern) + " abandoned after " + String(shot.shot) + "/" +
+                String(shot.shots) + " shots: not on target");
   }
 }
 
-// Calibration function - moves to both limits to establish working range
-bool calibrateHorizontalMotor()
+bool homeSensorEdges(long &enterPosition, long &exitPosition)
 {
-  Serial.println("Starting horizontal motor calibration using hall-effect home sensor...");
-  isHorizontalCalibrated = false;
-  homeSensorTriggered = isHomeSensorActive();
-  unsigned long startTime = millis();
-
-  // If sensor is already triggered, gently move off it first
-  if (homeSensorTriggered)
+  if (!homeExited)
   {
-    Serial.println("Home sensor active on start - backing off slowly");
-    horizontalStepper.setMaxSpeed(horizontalMaxStepsPerSec * 0.15);
-    long backoffStart = horizontalStepper.currentPosition();
-    horizontalStepper.moveTo(backoffStart - (long)(HORIZONTAL_STEPS_PER_DEGREE * 10));
-    while (isHomeSensorActive())
-    {
-      horizontalStepper.run();
-      if (millis() - startTime > CALIBRATION_TIMEOUT_MS)
-      {
-        Serial.println("Timeout while backing off home sensor");
-        horizontalStepper.stop();
-        return false;
-      }
-      delay(1);
-    }
-    horizontalStepper.stop();
-    homeSensorTriggered = false;
-    delay(150);
+    return false;
   }
+  enterPosition = horizontalStepper.positionFromEmitted(homeEnterSteps);
+  exitPosition = horizontalStepper.positionFromEmitted(homeExitSteps);
+  return true;
+}
 
-  const long searchStartPosition = horizontalStepper.currentPosition();
-  const long maxSearchSteps = (long)(HORIZONTAL_FULL_ROTATION_STEPS * 1.5); // Up to 1.5 revolutions
-  bool homeFound = false;
+void clearHomeSensorLatch()
+{
+  homeExited = false;
+  homeEntered = false;
+}
 
-  Serial.println("Sweeping yaw to find home sensor...");
-  horizontalStepper.setMaxSpeed(horizontalMaxStepsPerSec * horizontalCalibrationSpeedFactor);
-  horizontalStepper.moveTo(searchStartPosition + maxSearchSteps);
-  while (labs(horizontalStepper.currentPosition() - searchStartPosition) < maxSearchSteps)
-  {
-    horizontalStepper.run();
-    if (homeSensorTriggered || isHomeSensorActive())
-    {
-      homeFound = true;
-      break;
-    }
-    if (millis() - startTime > CALIBRATION_TIMEOUT_MS)
-    {
-      Serial.println("Timeout while searching for yaw home sensor");
-      break;
-    }
-    delay(1);
-  }
-  horizontalStepper.stop();
-  horizontalStepper.setMaxSpeed(effectiveHorizontalMaxStepsPerSec);
+void configureCalibration()
+{
+  CalibrationConfig config = {
+      (long)(YawAxis::stepsPerDegree() * 10),
+      (long)(YawAxis::fullRotationSteps() * 1.5), // Up to 1.5 revolutions
+      (long)(TiltAxis::stepsPerDegree() * 10),
+      (long)(TiltAxis::stepsPerDegree() * 200), // ~200° equivalent travel
+      (long)(TiltAxis::stepsPerDegree() * 10),
+      YawAxis::maxStepsPerSec() * horizontalBackoffSpeedFactor,
+      YawAxis::calibrationStepsPerSec(),
+      YawAxis::runStepsPerSec(),
+      TiltAxis::calibrationStepsPerSec(),
+      TiltAxis::runStepsPerSec(),
+      YAW_BACKOFF_SETTLE_MS,
+      TILT_SETTLE_MS,
+      CALIBRATION_TIMEOUT_MS};
+  CalibrationInputs inputs = {isHomeSensorActive, homeSensorEdges, clearHomeSensorLatch,
+                              isUpLimitActive, isDownLimitActive};
+  calibrationSequencer.configure(config, inputs);
+}
+
+// Constants a stored calibration depends on; changing any of them invalidates it
+uint32_t currentCalibrationFingerprint()
+{
+  const float constants[] = {YawAxis::stepsPerDegree(),
+                             TiltAxis::stepsPerDegree(),
+                             (float)microstepFactor,
+                             YawAxisConfig::GEAR_RATIO,
+                             TiltAxisConfig::GEAR_RATIO,
+                             VERTICAL_DIR_INVERT ? 1.0f : 0.0f,
+                             LIMIT_SWITCH_ACTIVE_LOW ? 1.0f : 0.0f};
+  return calibrationFingerprint(constants, sizeof(constants) / sizeof(constants[0]));
+}
 
-  if (!homeFound)
+// Starts calibration, a quick re-home or a check of a stored calibration;
+// runCalibrationStep() advances it from motorTask
+bool startCalibration(CalibrationMode mode, const StoredCalibration *stored = nullptr)
+{
+  if (calibrationInProgress)
   {
-    Serial.println("ERROR: Home sensor not detected during yaw calibration");
+    Serial.println("Calibration already running - ignoring request");
     return false;
   }
 
-  // Zero position at the sensor
-  horizontalStepper.setCurrentPosition(0);
-  horizontalCenterPosition = 0;
-  isHorizontalCalibrated = true;
-  homeSensorTriggered = false;
-
-  Serial.println("Horizontal calibration complete!");
-  Serial.println("Yaw home set at 0° with continuous rotation enabled (slip ring)");
+  if (mode == CALIBRATE_FULL)
+  {
+    Serial.println("Starting motor calibration (yaw hall sensor + tilt limits)...");
+  }
+  else if (mode == CALIBRATE_VERIFY)
+  {
+    Serial.println("Verifying stored calibration (yaw hall sensor + tilt down limit)...");
+  }
+  else
+  {
+    Serial.println("Starting homing sequence (yaw hall sensor + tilt center)...");
+  }
+  cancelAngularMovement();
+  calibrationInProgress = true;
+  horizontalStepper.setSpeed(0);
+  verticalStepper.setSpeed(0);
+  if (mode == CALIBRATE_VERIFY && stored)
+  {
+    calibrationSequencer.startVerify(millis(), stored->downLimit, stored->upLimit, stored->tiltCenter);
+  }
+  else
+  {
+    calibrationSequencer.start(mode, millis(), verticalCenterPosition);
+  }
+  lastReportedCalibrationPhase = CAL_IDLE;
+  lastCalibrationProgressMs = 0;
+  publishTurretSnapshot();
   return true;
 }
 
-bool calibrateVerticalMotor()
+void calibrateMotors()
 {
-  Serial.println("Starting vertical motor calibration...");
-  isVerticalCalibrated = false;
-  Serial.printf("Initial limit states - Up: %s, Down: %s\n",
-                upLimitHit ? "HIT" : "OK", downLimitHit ? "HIT" : "OK");
-  const long maxVerticalSearchSteps = (long)(VERTICAL_STEPS_PER_DEGREE * 200); // ~200° equivalent travel
-  bool downFound = false;
-  bool upFound = false;
-  unsigned long startTime = millis();
+  startCalibration(CALIBRATE_FULL);
+}
 
-  // Set calibration speed - moderate pace, not too slow
-  verticalStepper.setMaxSpeed(verticalMaxStepsPerSec * verticalCalibrationSpeedFactor);
+// Power-on: a few seconds to verify a stored calibration instead of the full
+// sweep; finishCalibration() falls back to the sweep if it does not verify
+void startupCalibration()
+{
+  StoredCalibration stored;
+  if (!loadStoredCalibration(currentCalibrationFingerprint(), stored))
+  {
+    Serial.println("No stored calibration for this configuration");
+    calibrateMotors();
+    return;
+  }
+  startCalibration(CALIBRATE_VERIFY, &stored);
+}
 
-  // If already at down limit, gently move up to clear it
-  if (isDownLimitActive())
+void homeTurret()
+{
+  if (!angularPositioningEnabled)
   {
-    Serial.println("Down limit active at start, clearing...");
-    long clearStart = verticalStepper.currentPosition();
-    verticalStepper.moveTo(clearStart + (long)(VERTICAL_STEPS_PER_DEGREE * 10));
-    while (isDownLimitActive() && labs(verticalStepper.currentPosition() - clearStart) < maxVerticalSearchSteps)
-    {
-      verticalStepper.run();
-      if (millis() - startTime > CALIBRATION_TIMEOUT_MS)
-      {
-        Serial.println("Timeout while clearing down limit");
-        verticalStepper.stop();
-        return false;
-      }
-      delay(1);
-    }
-    verticalStepper.stop();
-    delay(50);
+    Serial.println("System not calibrated - running full calibration before homing");
+    startCalibration(CALIBRATE_FULL);
+    return;
   }
+  startCalibration(CALIBRATE_QUICK_HOME);
+}
 
-  // If already at up limit, gently move down to clear it
-  if (isUpLimitActive())
+void sendCalibrationProgress()
+{
+  if (ws.count() == 0)
   {
-    Serial.println("Up limit active at start, clearing...");
-    long clearStart = verticalStepper.currentPosition();
-    verticalStepper.moveTo(clearStart - (long)(VERTICAL_STEPS_PER_DEGREE * 10));
-    while (isUpLimitActive() && labs(verticalStepper.currentPosition() - clearStart) < maxVerticalSearchSteps)
-    {
-      verticalStepper.run();
-      if (millis() - startTime > CALIBRATION_TIMEOUT_MS)
-      {
-        Serial.println("Timeout while clearing up limit");
-        verticalStepper.stop();
-        return false;
-      }
-      delay(1);
-    }
-    verticalStepper.stop();
-    delay(50);
+    return;
   }
+  StaticJsonDocument<160> doc;
+  JsonObject progress = doc.createNestedObject("calibrationProgress");
+  progress["mode"] = calibrationModeName(calibrationSequencer.mode());
+  progress["phase"] = calibrationPhaseName(calibrationSequencer.phase());
+  progress["progress"] = calibrationSequencer.progress();
+  String payload;
+  serializeJson(doc, payload);
+  ws.textAll(payload);
+}
+
+// Applies the sequencer result. An aborted run keeps whatever was calibrated
+// before, except a yaw zero that was already re-found.
+void finishCalibration()
+{
+  const CalibrationResult &result = calibrationSequencer.result();
+  bool aborted = calibrationSequencer.phase() == CAL_ABORTED;
+  bool fullCalibration = calibrationSequencer.mode() == CALIBRATE_FULL;
+  bool verifying = calibrationSequencer.mode() == CALIBRATE_VERIFY;
 
-  // Move down to find the down limit - stop when switch activates
-  Serial.println("Finding down limit...");
-  long downSearchStart = verticalStepper.currentPosition();
-  verticalStepper.moveTo(downSearchStart - maxVerticalSearchSteps);
-  while (labs(verticalStepper.currentPosition() - downSearchStart) < maxVerticalSearchSteps)
+  if (result.yawHomed || !aborted)
   {
-    if (isDownLimitActive())
+    isHorizontalCalibrated = result.yawHomed;
+    if (result.yawHomed)
     {
-      downFound = true;
-      verticalStepper.stop();
-      downLimitPosition = verticalStepper.currentPosition();
-      Serial.printf("Down limit found at position: %ld\n", downLimitPosition);
-      break;
+      horizontalCenterPosition = 0;
+      yawHomeWindowSteps = result.yawWindowSteps;
+      yawDriftCorrections = 0;
+      yawDriftTotalSteps = 0;
+      Serial.println("Yaw home set at 0° with continuous rotation enabled (slip ring)");
     }
-    verticalStepper.run();
-    if (millis() - startTime > CALIBRATION_TIMEOUT_MS)
+    else
     {
-      Serial.println("Timeout searching for down limit");
-      verticalStepper.stop();
-      break;
+      Serial.println("ERROR: Home sensor not detected during yaw calibration");
     }
-    delay(1);
   }
-  verticalStepper.stop();
-  delay(50);
 
-  if (!downFound)
+  if (verifying && !aborted && !(result.yawHomed && result.tiltCalibrated))
   {
-    downLimitPosition = verticalStepper.currentPosition();
-    Serial.printf("Down limit not found (last position: %ld)\n", downLimitPosition);
+    Serial.printf("Stored calibration did not verify (yaw %s, tilt %s) - running full calibration\n",
+                  result.yawHomed ? "ok" : "no home", result.tiltCalibrated ? "ok" : "range mismatch");
+    calibrationInProgress = false;
+    startCalibration(CALIBRATE_FULL);
+    return;
   }
 
-  // Move up to find the up limit - stop when switch activates
-  Serial.println("Finding up limit...");
-  long upSearchStart = verticalStepper.currentPosition();
-  verticalStepper.moveTo(upSearchStart + maxVerticalSearchSteps);
-  while (labs(verticalStepper.currentPosition() - upSearchStart) < maxVerticalSearchSteps)
+  if ((fullCalibration || verifying) && !aborted)
   {
-    if (isUpLimitActive())
+    downLimitPosition = result.downLimit;
+    upLimitPosition = result.upLimit;
+    isVerticalCalibrated = result.tiltCalibrated;
+    if (result.tiltCalibrated)
     {
-      upFound = true;
-      verticalStepper.stop();
-      upLimitPosition = verticalStepper.currentPosition();
-      Serial.printf("Up limit found at position: %ld\n", upLimitPosition);
-      break;
+      verticalCenterPosition = result.tiltCenter;
+      tiltDriftCorrections = 0;
+      tiltDriftTotalSteps = 0;
+      long vMin = 0;
+      long vMax = 0;
+      getVerticalBounds(vMin, vMax);
+      Serial.printf("Vertical working range: %ld to %ld steps (%ld total)\n", vMin, vMax, vMax - vMin);
     }
-    verticalStepper.run();
-    if (millis() - startTime > CALIBRATION_TIMEOUT_MS)
+    else
     {
-      Serial.println("Timeout searching for up limit");
-      verticalStepper.stop();
-      break;
+      Serial.printf("WARNING: Vertical calibration incomplete - limits found: down=%s up=%s\n",
+                    result.downFound ? "yes" : "no", result.upFound ? "yes" : "no");
     }
-    delay(1);
   }
-  verticalStepper.stop();
-  delay(50);
 
-  if (!upFound)
+  angularPositioningEnabled = isHorizontalCalibrated && isVerticalCalibrated;
+  calibrationInProgress = false;
+  upLimitLatched = false; // Switch hits during calibration are not drift
+  downLimitLatched = false;
+  syncJogTargetsToCurrent();
+
+  if (aborted)
   {
-    upLimitPosition = verticalStepper.currentPosition();
-    Serial.printf("Up limit not found (last position: %ld)\n", upLimitPosition);
+    Serial.println("Calibration aborted");
+    if (ws.count() > 0)
+    {
+      ws.textAll("{\"calibrationAborted\":true}");
+    }
+    sendStatus(false, false, isHorizontalCalibrated, isVerticalCalibrated);
+    return;
   }
 
-  if (downFound && upFound)
+  if (!fullCalibration && !verifying)
   {
-    // Move to center
-    long centerPosition = (downLimitPosition + upLimitPosition) / 2;
-    verticalCenterPosition = centerPosition;
-    verticalStepper.moveTo(centerPosition);
-    while (verticalStepper.distanceToGo() != 0)
+    StaticJsonDocument<96> response;
+    response["homeComplete"] = true;
+    response["yawHomed"] = result.yawHomed;
+    response["tiltCentered"] = result.tiltCalibrated;
+    String responseStr;
+    serializeJson(response, responseStr);
+    if (ws.count() > 0)
     {
-      verticalStepper.run();
+      ws.textAll(responseStr);
     }
+    Serial.println("Homing sequence complete");
+    sendStatus(false, false, result.yawHomed, isVerticalCalibrated);
+    return;
+  }
 
-    isVerticalCalibrated = true;
-    verticalStepper.setMaxSpeed(effectiveVerticalMaxStepsPerSec);
-    Serial.println("Vertical calibration complete!");
-    long vMin = 0;
-    long vMax = 0;
-    getVerticalBounds(vMin, vMax);
-    Serial.printf("Vertical working range: %ld to %ld steps (%ld total)\n",
-                  vMin, vMax,
-                  vMax - vMin);
-    return true;
-  }
-
-  isVerticalCalibrated = false;
-  Serial.println("WARNING: Vertical calibration incomplete - limit switches not detected as expected");
-  verticalStepper.setMaxSpeed(effectiveVerticalMaxStepsPerSec);
-  return false;
-}
-
-void calibrateMotors()
-{
-  Serial.println("Starting motor calibration - pausing motor task...");
-  calibrationInProgress = true;
-  cancelAngularMovement();
-  delay(100); // Give motor task time to pause
-
-  unsigned long calibrationStart = millis();
-  bool horizontalOk = calibrateHorizontalMotor();
-  if (millis() - calibrationStart > CALIBRATION_TIMEOUT_MS)
+  if (angularPositioningEnabled && verifying)
   {
-    Serial.println("Calibration timeout reached during yaw homing");
-    stopAllMotion();
-  }
-
-  bool verticalOk = calibrateVerticalMotor();
-  if (millis() - calibrationStart > (CALIBRATION_TIMEOUT_MS * 2))
-  {
-    Serial.println("Calibration timeout reached during tilt sweep");
-    stopAllMotion();
+    Serial.println("Stored calibration verified");
   }
-
-  angularPositioningEnabled = horizontalOk && verticalOk;
-
-  calibrationInProgress = false; // Resume motor task
-  syncJogTargetsToCurrent();
-  if (angularPositioningEnabled)
+  else if (angularPositioningEnabled)
   {
-    Serial.println("All motors calibrated! Motor task resumed.");
+    pendingCalibrationStore = {(int32_t)downLimitPosition, (int32_t)upLimitPosition, (int32_t)verticalCenterPosition};
+    calibrationStorePending.store(true, std::memory_order_release);
+    Serial.println("All motors calibrated!");
     Serial.printf("Angular positioning enabled - Center positions: H=%ld, V=%ld\n",
                   horizontalCenterPosition, verticalCenterPosition);
     Serial.printf("Steps per degree - Horizontal: %.2f, Vertical: %.2f\n",
-                  HORIZONTAL_STEPS_PER_DEGREE, VERTICAL_STEPS_PER_DEGREE);
+                  YawAxis::stepsPerDegree(), TiltAxis::stepsPerDegree());
   }
   else
   {
     Serial.println("Calibration incomplete - check sensors/limit switches");
   }
-  sendStatus(false, true, horizontalOk, verticalOk);
+  sendStatus(false, true, result.yawHomed, result.tiltCalibrated);
+  // Calibration's logging and status JSON are the deepest calls motorTask makes.
+  // The startup calibration runs in setup(), before the task exists.
+  if (motorTaskHandle)
+  {
+    Serial.printf("Motor task stack headroom: %u bytes\n", (unsigned)uxTaskGetStackHighWaterMark(motorTaskHandle));
+  }
 }
 
-void homeTurret()
+void abortCalibration()
 {
-  if (!angularPositioningEnabled)
+  if (!calibrationInProgress)
   {
-    Serial.println("System not calibrated - running full calibration before homing");
-    calibrateMotors();
     return;
   }
+  calibrationSequencer.abort();
+  finishCalibration();
+}
 
-  Serial.println("Starting homing sequence (yaw hall sensor + tilt center)...");
-  calibrationInProgress = true;
-  cancelAngularMovement();
-  horizontalStepper.setSpeed(0);
-  verticalStepper.setSpeed(0);
-  delay(50);
-
-  bool yawOk = calibrateHorizontalMotor();
+void runCalibrationStep()
+{
+  unsigned long now = millis();
+  bool stillRunning = calibrationSequencer.step(now);
 
-  // Move tilt back to center using known range
-  verticalStepper.moveTo(verticalCenterPosition);
-  while (verticalStepper.distanceToGo() != 0)
+  CalibrationPhase phase = calibrationSequencer.phase();
+  if (phase != lastReportedCalibrationPhase || now - lastCalibrationProgressMs >= CALIBRATION_PROGRESS_INTERVAL_MS)
   {
-    verticalStepper.run();
+    if (phase != lastReportedCalibrationPhase)
+    {
+      Serial.printf("Calibration phase: %s\n", calibrationPhaseName(phase));
+    }
+    lastReportedCalibrationPhase = phase;
+    lastCalibrationProgressMs = now;
+    sendCalibrationProgress();
   }
 
-  angularPositioningEnabled = yawOk && isVerticalCalibrated;
-  calibrationInProgress = false;
-  syncJogTargetsToCurrent();
+  if (!stillRunning)
+  {
+    finishCalibration();
+  }
+}
 
-  StaticJsonDocument<96> response;
-  response["homeComplete"] = true;
-  response["yawHomed"] = yawOk;
-  response["tiltCentered"] = true;
-  String responseStr;
-  serializeJson(response, responseStr);
-  if (ws.count() > 0)
+void reportDrift(const char *axis, long steps, uint32_t corrections, long totalSteps)
+{
+  Serial.printf("Missed steps: %s off by %ld steps at its reference, corrected (%lu corrections, %ld steps total)\n",
+                axis, steps, (unsigned long)corrections, totalSteps);
+  if (ws.count() == 0)
   {
-    ws.textAll(responseStr);
+    return;
   }
+  publishEvent(encodeDriftJson(axis, (int32_t)steps, corrections, (int32_t)totalSteps,
+                               telemetryEventBuffer, sizeof(telemetryEventBuffer)));
+}
 
-  Serial.println("Homing sequence complete");
-  sendStatus(false, false, yawOk, isVerticalCalibrated);
+// The angular move in flight was planned against the old reference, so its
+// target moves with it. A sequence needs nothing: runSequenceStep() works from
+// the center positions every cycle.
+void shiftMoveInFlight(QueuedStepper &stepper, long drift)
+{
+  if (angularMovementInProgress && !sequenceInProgress)
+  {
+    stepper.shiftTarget(drift);
+  }
 }
 
-// Angular motion functions
-long degreesToSteps(float degrees, bool isHorizontal)
+// A full pass through the yaw sensor window, in either direction, puts the
+// magnet center halfway between its edges; that must be a whole number of
+// turns from the yaw zero
+void checkYawReference()
 {
-  if (isHorizontal)
+  long enterPosition = 0;
+  long exitPosition = 0;
+  if (!homeSensorEdges(enterPosition, exitPosition))
   {
-    return (long)(degrees * HORIZONTAL_STEPS_PER_DEGREE);
+    return;
   }
-  else
+  clearHomeSensorLatch();
+  // Turning back inside the window leaves both edges on the same side
+  if (!isHorizontalCalibrated || labs(exitPosition - enterPosition) * 2 < yawHomeWindowSteps)
+  {
+    return;
+  }
+
+  float stepsPerTurn = YawAxis::stepsPerDegree() * 360.0f;
+  long center = enterPosition + (exitPosition - enterPosition) / 2 - horizontalCenterPosition;
+  long drift = center - lroundf(roundf(center / stepsPerTurn) * stepsPerTurn);
+  if (labs(drift) <= YAW_DRIFT_TOLERANCE_STEPS)
   {
-    return (long)(degrees * VERTICAL_STEPS_PER_DEGREE);
+    return;
   }
+  horizontalCenterPosition += drift;
+  shiftMoveInFlight(horizontalStepper, drift);
+  yawDriftCorrections++;
+  yawDriftTotalSteps += drift;
+  reportDrift("yaw", drift, yawDriftCorrections, yawDriftTotalSteps);
 }
 
-float stepsToDegrees(long steps, bool isHorizontal)
+// A limit switch closes at the position calibration found for it
+void checkTiltReference()
 {
-  if (isHorizontal)
+  if (!upLimitLatched && !downLimitLatched)
+  {
+    return;
+  }
+  bool up = upLimitLatched;
+  long hit = verticalStepper.positionFromEmitted(up ? upLimitSteps : downLimitSteps);
+  if (up)
   {
-    return (float)steps / HORIZONTAL_STEPS_PER_DEGREE;
+    upLimitLatched = false;
   }
   else
   {
-    return (float)steps / VERTICAL_STEPS_PER_DEGREE;
+    downLimitLatched = false;
+  }
+  if (!isVerticalCalibrated)
+  {
+    return;
   }
+
+  long drift = hit - (up ? upLimitPosition : downLimitPosition);
+  if (labs(drift) <= TILT_DRIFT_TOLERANCE_STEPS)
+  {
+    return;
+  }
+  upLimitPosition += drift;
+  downLimitPosition += drift;
+  verticalCenterPosition += drift;
+  shiftMoveInFlight(verticalStepper, drift);
+  tiltDriftCorrections++;
+  tiltDriftTotalSteps += drift;
+  reportDrift("tilt", drift, tiltDriftCorrections, tiltDriftTotalSteps);
+}
+
+// Starts an angular move to absolute step targets, coordinated when enabled
+void startAxisMoves(long targetHorizontalPosition, long targetVerticalPosition)
+{
+  if (!coordinatedMotionEnabled)
+  {
+    horizontalStepper.moveTo(targetHorizontalPosition);
+    verticalStepper.moveTo(targetVerticalPosition);
+    return;
+  }
+
+  long distances[STEP_ENGINE_MAX_AXES] = {
+      targetHorizontalPosition - horizontalStepper.currentPosition(),
+      targetVerticalPosition - verticalStepper.currentPosition()};
+  float maxSpeeds[STEP_ENGINE_MAX_AXES] = {horizontalStepper.maxSpeed(), verticalStepper.maxSpeed()};
+  float accels[STEP_ENGINE_MAX_AXES] = {horizontalStepper.acceleration(), verticalStepper.acceleration()};
+  angularSyncProfile.plan(distances, maxSpeeds, accels, STEP_ENGINE_MAX_AXES, micros() + SYNC_MOVE_START_DELAY_US);
+  horizontalStepper.moveToSynchronized(targetHorizontalPosition, angularSyncProfile);
+  verticalStepper.moveToSynchronized(targetVerticalPosition, angularSyncProfile);
 }
 
 bool moveToAbsoluteAngle(float horizontalDegrees, float verticalDegrees)
@@ -776,12 +1402,12 @@ bool moveToAbsoluteAngle(float horizontalDegrees, float verticalDegrees)
   }
 
   // Horizontal (yaw) with slip ring: wrap target to 0-360 and take shortest path
-  float currentHorizontalAngle = wrapTo360(stepsToDegrees(horizontalStepper.currentPosition() - horizontalCenterPosition, true));
+  float currentHorizontalAngle = wrapTo360(YawAxis::toDegrees(horizontalStepper.currentPosition() - horizontalCenterPosition));
   float targetHorizontalAngle = wrapTo360(horizontalDegrees);
   float horizontalDelta = shortestDeltaDegrees(currentHorizontalAngle, targetHorizontalAngle);
-  long targetHorizontalPosition = horizontalStepper.currentPosition() + degreesToSteps(horizontalDelta, true);
+  long targetHorizontalPosition = horizontalStepper.currentPosition() + YawAxis::toSteps(horizontalDelta);
 
-  long targetVerticalPosition = verticalCenterPosition + degreesToSteps(verticalDegrees, false);
+  long targetVerticalPosition = verticalCenterPosition + TiltAxis::toSteps(verticalDegrees);
 
   // Check if targets are within limits (tilt only)
   long vMin = 0;
@@ -799,15 +1425,26 @@ bool moveToAbsoluteAngle(float horizontalDegrees, float verticalDegrees)
                 targetHorizontalAngle, horizontalDelta, verticalDegrees, targetHorizontalPosition, targetVerticalPosition);
 
   // Set angular movement mode to prevent joystick interference
+  clearMoveSequence();
+  stopTracking();
   angularMovementInProgress = true;
   angularMovementStartTime = millis();
+  angularMovementTimeoutMs = ANGULAR_MOVEMENT_TIMEOUT;
 
-  horizontalStepper.moveTo(targetHorizontalPosition);
-  verticalStepper.moveTo(targetVerticalPosition);
+  startAxisMoves(targetHorizontalPosition, targetVerticalPosition);
 
   return true;
 }
 
+// The arrival shot is queued only if the move starts
+void moveToAngleAndFire(float horizontal, float vertical, const FirePattern &arrivalShot)
+{
+  if (moveToAbsoluteAngle(horizontal, vertical) && arrivalShot.shots > 0)
+  {
+    arrivalShotPattern = queueFirePattern(arrivalShot);
+  }
+}
+
 bool moveByRelativeAngle(float horizontalDegrees, float verticalDegrees)
 {
   if (calibrationInProgress)
@@ -825,8 +1462,8 @@ bool moveByRelativeAngle(float horizontalDegrees, float verticalDegrees)
   }
 
   // Calculate relative movement in steps
-  long horizontalSteps = degreesToSteps(horizontalDegrees, true);
-  long verticalSteps = degreesToSteps(verticalDegrees, false);
+  long horizontalSteps = YawAxis::toSteps(horizontalDegrees);
+  long verticalSteps = TiltAxis::toSteps(verticalDegrees);
 
   // Calculate target positions
   long targetHorizontalPosition = horizontalStepper.currentPosition() + horizontalSteps;
@@ -847,15 +1484,283 @@ bool moveByRelativeAngle(float horizontalDegrees, float verticalDegrees)
                 horizontalDegrees, verticalDegrees, horizontalSteps, verticalSteps);
 
   // Set angular movement mode to prevent joystick interference
+  clearMoveSequence();
+  stopTracking();
   angularMovementInProgress = true;
   angularMovementStartTime = millis();
+  angularMovementTimeoutMs = ANGULAR_MOVEMENT_TIMEOUT;
+
+  startAxisMoves(targetHorizontalPosition, targetVerticalPosition);
+
+  return true;
+}
+
+void clearMoveSequence()
+{
+  sequenceInProgress = false;
+  float here[PLANNER_AXES] = {0.0f, 0.0f};
+  motionPlanner.reset(here);
+}
+
+// Accepts a list of {horizontal, vertical} waypoints. A new sequence starts from
+// the current pose; while one is running, waypoints are appended and re-planned.
+bool startMoveSequence(const float waypoints[][PLANNER_AXES], size_t waypointCount)
+{
+  if (calibrationInProgress)
+  {
+    recordError("Sequence rejected: calibration in progress");
+    return false;
+  }
+  if (!angularPositioningEnabled)
+  {
+    recordError("Sequence rejected: turret not calibrated");
+    return false;
+  }
 
-  horizontalStepper.move(horizontalSteps);
-  verticalStepper.move(verticalSteps);
+  bool appending = sequenceInProgress && angularMovementInProgress;
+  if (waypointCount == 0 || waypointCount > (appending ? motionPlanner.freeSlots() : PLANNER_MAX_SEGMENTS))
+  {
+    Serial.printf("Sequence rejected: %u waypoints (max %u)\n", (unsigned)waypointCount,
+                  (unsigned)(appending ? motionPlanner.freeSlots() : PLANNER_MAX_SEGMENTS));
+    recordError("Sequence rejected: bad waypoint count");
+    return false;
+  }
 
+  // Validate the whole sequence before queuing any of it
+  long vMin = 0;
+  long vMax = 0;
+  getVerticalBounds(vMin, vMax);
+  for (size_t i = 0; i < waypointCount; i++)
+  {
+    long targetVerticalPosition = verticalCenterPosition + TiltAxis::toSteps(waypoints[i][1]);
+    if (targetVerticalPosition < vMin || targetVerticalPosition > vMax)
+    {
+      recordError("Sequence rejected: vertical waypoint out of limits");
+      return false;
+    }
+  }
+
+  if (!appending)
+  {
+    // Plan in unwrapped yaw degrees so the sequence can cross 0/360 freely
+    float start[PLANNER_AXES] = {
+        YawAxis::toDegrees(horizontalStepper.currentPosition() - horizontalCenterPosition),
+        TiltAxis::toDegrees(verticalStepper.currentPosition() - verticalCenterPosition)};
+    PlannerLimits limits = {
+        {YawAxis::toDegrees(YawAxis::runStepsPerSec()), TiltAxis::toDegrees(TiltAxis::runStepsPerSec())},
+        {YawAxis::toDegrees(joystickAccelStepsPerSec2), TiltAxis::toDegrees(joystickAccelStepsPerSec2)},
+        SEQUENCE_JUNCTION_TIME_SEC};
+    motionPlanner.setLimits(limits);
+    motionPlanner.reset(start);
+  }
+
+  for (size_t i = 0; i < waypointCount; i++)
+  {
+    float last[PLANNER_AXES];
+    motionPlanner.lastWaypoint(last);
+    float yawDelta = shortestDeltaDegrees(wrapTo360(last[0]), wrapTo360(waypoints[i][0]));
+    float target[PLANNER_AXES] = {last[0] + yawDelta, waypoints[i][1]};
+    motionPlanner.addWaypoint(target);
+  }
+
+  Serial.printf("%s %u waypoints (planned time %.2fs)\n", appending ? "Appended" : "Starting sequence with",
+                (unsigned)waypointCount, motionPlanner.remainingTime());
+
+  if (!appending)
+  {
+    stopTracking();
+    angularMovementInProgress = true;
+    angularMovementStartTime = millis();
+    sequenceInProgress = true;
+    lastSequenceUpdateUs = micros();
+  }
+  angularMovementTimeoutMs = (millis() - angularMovementStartTime) +
+                             (unsigned long)(motionPlanner.remainingTime() * 1000.0f) + ANGULAR_MOVEMENT_TIMEOUT;
   return true;
 }
 
+// Tracks the planner setpoint with feed-forward velocity plus position correction.
+// When the last segment finishes, hands the final target to run() to land exactly.
+void runSequenceStep()
+{
+  unsigned long nowUs = micros();
+  float dt = (nowUs - lastSequenceUpdateUs) / 1000000.0f;
+  lastSequenceUpdateUs = nowUs;
+
+  PlannerSample sample = motionPlanner.advance(dt);
+  long hTarget = horizontalCenterPosition + lroundf(sample.position[0] * YawAxis::stepsPerDegree());
+  long vTarget = verticalCenterPosition + lroundf(sample.position[1] * TiltAxis::stepsPerDegree());
+
+  if (sample.done)
+  {
+    sequenceInProgress = false;
+    horizontalStepper.moveTo(hTarget);
+    verticalStepper.moveTo(vTarget);
+    return;
+  }
+
+  float hSpeed = YawAxis::toStepsPerSec(sample.velocity[0]) +
+                 SEQUENCE_POSITION_GAIN * (hTarget - horizontalStepper.currentPosition());
+  float vSpeed = TiltAxis::toStepsPerSec(sample.velocity[1]) +
+                 SEQUENCE_POSITION_GAIN * (vTarget - verticalStepper.currentPosition());
+  horizontalStepper.setSpeed(hSpeed);
+  verticalStepper.setSpeed(vSpeed);
+  horizontalStepper.runSpeed();
+  verticalStepper.runSpeed();
+}
+
+// Angular errors are target minus aim point, already converted from pixels
+void applyTrackMeasurement(float yawErrorDeg, float tiltErrorDeg)
+{
+  if (calibrationInProgress)
+  {
+    recordError("Track rejected: calibration in progress");
+    return;
+  }
+
+  if (angularMovementInProgress)
+  {
+    cancelAngularMovement();
+  }
+
+  lastControlMessageTime = millis();
+  if (interceptMode)
+  {
+    interceptMode = false;
+    interceptSolver.reset();
+  }
+  if (!trackingActive)
+  {
+    Serial.println("Tracking started");
+    lastTrackingUpdateUs = micros();
+    trackingActive = true;
+  }
+  float yawDeg = YawAxis::toDegrees(horizontalStepper.currentPosition() - horizontalCenterPosition);
+  float tiltDeg = TiltAxis::toDegrees(verticalStepper.currentPosition() - verticalCenterPosition);
+  trackingController.measure(yawErrorDeg, tiltErrorDeg, yawDeg, tiltDeg, millis());
+}
+
+// Target angles are turret angles as moveToAngle takes them, rates in deg/s
+void applyInterceptTarget(const MotorCommand &cmd)
+{
+  if (calibrationInProgress)
+  {
+    recordError("Intercept rejected: calibration in progress");
+    return;
+  }
+  if (!angularPositioningEnabled)
+  {
+    recordError("Intercept rejected: turret not calibrated");
+    return;
+  }
+
+  if (angularMovementInProgress)
+  {
+    cancelAngularMovement();
+  }
+
+  // A target stamped in our clock (e.g. a synced camera frame) is carried forward by its age
+  unsigned long nowMs = millis();
+  uint64_t nowUs = esp_timer_get_time();
+  unsigned long ageMs = cmd.targetUs != 0 && cmd.targetUs < nowUs ? (unsigned long)((nowUs - cmd.targetUs) / 1000) : 0;
+  float target[INTERCEPT_AXES] = {cmd.horizontal, cmd.vertical};
+  float leadS = (computeTriggerMoveTimeMs() + cmd.flightMs) / 1000.0f;
+  interceptSolver.setTarget(target, cmd.rates, nowMs - ageMs, leadS);
+  lastControlMessageTime = nowMs;
+  lastInterceptUpdateMs = nowMs;
+  if (trackingActive && interceptMode)
+  {
+    return;
+  }
+
+  trackingController.stop();
+  interceptMode = true;
+  trackingActive = true;
+  lastTrackingUpdateUs = micros();
+  float position[INTERCEPT_AXES] = {
+      YawAxis::toDegrees(horizontalStepper.currentPosition() - horizontalCenterPosition),
+      TiltAxis::toDegrees(verticalStepper.currentPosition() - verticalCenterPosition)};
+  float velocity[INTERCEPT_AXES] = {YawAxis::toDegrees(horizontalStepper.speed()),
+                                    TiltAxis::toDegrees(verticalStepper.speed())};
+  InterceptPlan plan = interceptSolver.plan(position, velocity, nowMs);
+  Serial.printf("Intercept started: lead %.2f°/%.2f° (%lu ms), on track in %.0f ms\n", plan.lead[0], plan.lead[1],
+                (unsigned long)(leadS * 1000.0f), plan.timeToTrackS * 1000.0f);
+  if (!plan.reachable)
+  {
+    recordError("Intercept: target moves faster than the turret");
+  }
+}
+
+void stopTracking()
+{
+  if (!trackingActive)
+  {
+    return;
+  }
+  trackingActive = false;
+  interceptMode = false;
+  interceptSolver.reset();
+  trackingController.stop();
+  stopAllMotion();
+  syncJogTargetsToCurrent();
+  Serial.println("Tracking stopped");
+}
+
+void runTrackingStep()
+{
+  unsigned long nowMs = millis();
+  unsigned long nowUs = micros();
+  float dt = (nowUs - lastTrackingUpdateUs) / 1000000.0f;
+  lastTrackingUpdateUs = nowUs;
+
+  float yawDeg = YawAxis::toDegrees(horizontalStepper.currentPosition() - horizontalCenterPosition);
+  float tiltDeg = TiltAxis::toDegrees(verticalStepper.currentPosition() - verticalCenterPosition);
+  bool timedOut = interceptMode ? nowMs - lastInterceptUpdateMs > INTERCEPT_TIMEOUT_MS
+                                : trackingController.timedOut(nowMs);
+  if (timedOut)
+  {
+    Serial.println(interceptMode ? "Intercept timeout - no target updates" : "Tracking timeout - no detections");
+    stopTracking();
+    sendStatus(false, false, false, false);
+    return;
+  }
+
+  float hSpeed = 0.0f;
+  float vSpeed = 0.0f;
+  if (interceptMode)
+  {
+    float position[INTERCEPT_AXES] = {yawDeg, tiltDeg};
+    float velocity[INTERCEPT_AXES] = {YawAxis::toDegrees(horizontalStepper.speed()),
+                                      TiltAxis::toDegrees(verticalStepper.speed())};
+    float command[INTERCEPT_AXES];
+    interceptSolver.update(position, velocity, nowMs, dt, command);
+    hSpeed = YawAxis::toStepsPerSec(command[0]);
+    vSpeed = TiltAxis::toStepsPerSec(command[1]);
+  }
+  else
+  {
+    TrackingOutput out = trackingController.update(yawDeg, tiltDeg, nowMs, dt);
+    hSpeed = YawAxis::toStepsPerSec(out.yawVelocity);
+    vSpeed = TiltAxis::toStepsPerSec(out.tiltVelocity);
+  }
+
+  // Never drive tilt into a limit switch or past the calibrated range
+  long vPos = verticalStepper.currentPosition();
+  long vMin = 0;
+  long vMax = 0;
+  getVerticalBounds(vMin, vMax);
+  if ((vSpeed > 0.0f && (!canMoveUp() || (isVerticalCalibrated && vPos >= vMax))) ||
+      (vSpeed < 0.0f && (!canMoveDown() || (isVerticalCalibrated && vPos <= vMin))))
+  {
+    vSpeed = 0.0f;
+  }
+
+  horizontalStepper.setSpeed(hSpeed);
+  verticalStepper.setSpeed(vSpeed);
+  horizontalStepper.runSpeed();
+  verticalStepper.runSpeed();
+}
+
 void getCurrentAngles(float &horizontalAngle, float &verticalAngle)
 {
   if (!angularPositioningEnabled)
@@ -868,9 +1773,9 @@ void getCurrentAngles(float &horizontalAngle, float &verticalAngle)
   long horizontalOffset = horizontalStepper.currentPosition() - horizontalCenterPosition;
   long verticalOffset = verticalStepper.currentPosition() - verticalCenterPosition;
 
-  float absoluteYaw = wrapTo360(stepsToDegrees(horizontalOffset, true));
+  float absoluteYaw = wrapTo360(YawAxis::toDegrees(horizontalOffset));
   horizontalAngle = wrapTo180(absoluteYaw); // Report in -180..180 for easier readability
-  verticalAngle = stepsToDegrees(verticalOffset, false);
+  verticalAngle = TiltAxis::toDegrees(verticalOffset);
 }
 
 void appendErrors(JsonArray &arr)
@@ -916,27 +1821,248 @@ bool moveToCenter()
   return moveToAbsoluteAngle(0.0, 0.0);
 }
 
-void motorTask(void *parameter)
+void applyJoystickAxis(float &axis, float value)
+{
+  axis = value;
+  lastControlMessageTime = millis();
+
+  // Manual input always overrides tracking and angular moves
+  if (trackingActive && fabs(value) > deadzone)
+  {
+    Serial.println("Joystick input detected - stopping tracking");
+    stopTracking();
+  }
+
+  // Cancel angular movement if significant joystick input is detected
+  if (angularMovementInProgress && fabs(value) > deadzone)
+  {
+    Serial.println("Joystick input detected - cancelling angular movement");
+    cancelAngularMovement();
+  }
+}
+
+// True for commands that are expected to set the turret moving
+bool commandStartsMotion(const MotorCommand &cmd)
+{
+  switch (cmd.type)
+  {
+  case CMD_JOYSTICK:
+    return ((cmd.axes & JOYSTICK_HAS_X) && fabs(cmd.horizontal) > deadzone) ||
+           ((cmd.axes & JOYSTICK_HAS_Y) && fabs(cmd.vertical) > deadzone);
+  case CMD_MOVE_TO_ANGLE:
+  case CMD_MOVE_BY_ANGLE:
+  case CMD_MOVE_TO_CENTER:
+  case CMD_MOVE_SEQUENCE:
+  case CMD_TRACK:
+  case CMD_INTERCEPT:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Times command-to-first-step only from rest; while the turret is already
+// moving the next step says nothing about how fast the command took effect
+void armStepLatency(const MotorCommand &cmd)
+{
+  if (stepLatencyPending || isAxisMoving() || !commandStartsMotion(cmd))
+  {
+    return;
+  }
+  stepLatencyStartUs = cmd.receivedUs;
+  stepLatencyPending = true;
+  stepLatencyArmed.store(true, std::memory_order_release);
+}
+
+void updateStepLatency()
+{
+  if (!stepLatencyPending)
+  {
+    return;
+  }
+  if (!stepLatencyArmed.load(std::memory_order_acquire))
+  {
+    recordMetric(METRIC_COMMAND_TO_STEP, firstStepUs.load(std::memory_order_relaxed) - stepLatencyStartUs);
+    stepLatencyPending = false;
+  }
+  else if (micros() - stepLatencyStartUs > STEP_LATENCY_TIMEOUT_MS * 1000UL)
+  {
+    stepLatencyArmed.store(false, std::memory_order_relaxed);
+    stepLatencyPending = false;
+  }
+}
+
+void executeMotorCommand(const MotorCommand &cmd)
+{
+  armStepLatency(cmd);
+  if (commandStartsMotion(cmd))
+  {
+    disarmArrivalShot();
+  }
+  switch (cmd.type)
+  {
+  case CMD_CLIENT_CONNECTED:
+    lastControlMessageTime = millis();
+    joystickX = 0.0f;
+    joystickY = 0.0f;
+    resetJoystickFilter();
+    syncJogTargetsToCurrent();
+    stopAllMotion();
+    break;
+  case CMD_CLIENT_DISCONNECTED:
+    stopTracking();
+    cancelFire();
+    joystickX = 0.0f;
+    joystickY = 0.0f;
+    resetJoystickFilter();
+    angularMovementInProgress = false;
+    clearMoveSequence();
+    syncJogTargetsToCurrent();
+    stopAllMotion();
+    lastControlMessageTime = millis();
+    Serial.println("Motion halted due to WebSocket disconnect");
+    sendStatus(false, false, false, false);
+    break;
+  case CMD_JOYSTICK:
+    if (cmd.axes & JOYSTICK_HAS_X)
+    {
+      applyJoystickAxis(joystickX, cmd.horizontal);
+    }
+    if (cmd.axes & JOYSTICK_HAS_Y)
+    {
+      applyJoystickAxis(joystickY, cmd.vertical);
+    }
+    break;
+  case CMD_MOVE_TO_ANGLE:
+    moveToAngleAndFire(cmd.horizontal, cmd.vertical, cmd.firePattern);
+    break;
+  case CMD_MOVE_BY_ANGLE:
+    moveByRelativeAngle(cmd.horizontal, cmd.vertical);
+    break;
+  case CMD_MOVE_TO_CENTER:
+    moveToCenter();
+    break;
+  case CMD_MOVE_SEQUENCE:
+    startMoveSequence(cmd.waypoints, cmd.count);
+    break;
+  case CMD_TRACK:
+    applyTrackMeasurement(cmd.horizontal, cmd.vertical);
+    break;
+  case CMD_INTERCEPT:
+    applyInterceptTarget(cmd);
+    break;
+  case CMD_STOP_TRACKING:
+    stopTracking();
+    break;
+  case CMD_CANCEL_ANGULAR:
+    cancelAngularMovement();
+    break;
+  case CMD_SET_COORDINATED:
+    coordinatedMotionEnabled = cmd.enabled;
+    Serial.printf("Coordinated motion %s\n", coordinatedMotionEnabled ? "enabled" : "disabled");
+    break;
+  case CMD_FIRE:
+    queueFirePattern(cmd.firePattern);
+    break;
+  case CMD_CANCEL_FIRE:
+    cancelFire();
+    break;
+  case CMD_HOME:
+    Serial.println("Home requested via WebSocket");
+    homeTurret();
+    break;
+  case CMD_CALIBRATE:
+    Serial.println("Calibration requested via WebSocket");
+    calibrateMotors();
+    break;
+  case CMD_ABORT_CALIBRATION:
+    Serial.println("Calibration abort requested via WebSocket");
+    abortCalibration();
+    break;
+  case CMD_SET_TELEMETRY_RATE:
+  {
+    uint32_t rateHz = constrain((uint32_t)cmd.rateHz, TELEMETRY_MIN_RATE_HZ, TELEMETRY_MAX_RATE_HZ);
+    telemetryIntervalMs = 1000 / rateHz;
+    Serial.printf("Telemetry rate set to %lu Hz\n", (unsigned long)rateHz);
+    break;
+  }
+  case CMD_REPORT_ERROR:
+    recordError(cmd.text);
+    break;
+  default:
+    break;
+  }
+}
+
+void drainMotorCommands()
+{
+  MotorCommand cmd;
+  while (commandMailbox.pop(cmd))
+  {
+    executeMotorCommand(cmd);
+  }
+
+  uint32_t dropped = droppedCommandCount.load(std::memory_order_relaxed);
+  if (dropped != reportedDroppedCommands)
+  {
+    Serial.printf("Command queue overflow - %lu commands dropped\n", (unsigned long)(dropped - reportedDroppedCommands));
+    reportedDroppedCommands = dropped;
+    recordError("Command queue full - commands dropped");
+  }
+}
+
+// Records how long this motorTask pass ran, then sleeps until the next tick
+void endMotorCycle(uint32_t cycleStart)
+{
+  recordMetric(METRIC_LOOP_WORK, cyclesToUs(ESP.getCycleCount() - cycleStart));
+  vTaskDelay(1 / portTICK_PERIOD_MS);
+}
+
+void motorTask(void *)
 {
   // Used to throttle logging frequency
   unsigned long lastLogTime = 0;
+  uint32_t lastCycleStart = 0;
+  bool firstCycle = true;
 
   for (;;)
   {
+    uint32_t cycleStart = ESP.getCycleCount();
+    if (!firstCycle)
+    {
+      recordMetric(METRIC_LOOP_PERIOD, cyclesToUs(cycleStart - lastCycleStart));
+    }
+    lastCycleStart = cycleStart;
+    firstCycle = false;
+
     if (lastJogUpdateTime == 0)
     {
       syncJogTargetsToCurrent();
     }
 
-    // Pause motor task during calibration
+    // Apply commands queued by the WebSocket handler, then publish state for it
+    drainMotorCommands();
+    updateStepLatency();
+    publishTurretSnapshot();
+    recordPose();
+    if (millis() - lastTelemetryMs >= telemetryIntervalMs)
+    {
+      publishTelemetry(NO_TELEMETRY_EVENTS);
+    }
+
+    // Calibration/homing owns both axes until it finishes or is aborted
     if (calibrationInProgress)
     {
-      vTaskDelay(50 / portTICK_PERIOD_MS); // Wait 50ms and check again
+      runCalibrationStep();
+      endMotorCycle(cycleStart);
       continue;
     }
 
-    // Handle burst fire timing
-    updateBurstFire();
+    checkYawReference();
+    checkTiltReference();
+
+    // Release queued shots as their slots come and the axes settle
+    updateFireControl();
 
     // Handle non-blocking trigger control
     updateTrigger();
@@ -968,18 +2094,33 @@ void motorTask(void *parameter)
       controlTimeoutActive = false;
     }
 
+    if (trackingActive)
+    {
+      runTrackingStep();
+      endMotorCycle(cycleStart);
+      continue;
+    }
+
     // Check if angular movement is in progress
     if (angularMovementInProgress)
     {
       // Check for timeout to prevent getting stuck
       unsigned long currentTime = millis();
-      if (currentTime - angularMovementStartTime > ANGULAR_MOVEMENT_TIMEOUT)
+      if (currentTime - angularMovementStartTime > angularMovementTimeoutMs)
       {
         Serial.println("Angular movement timeout - resuming joystick control");
         angularMovementInProgress = false;
+        disarmArrivalShot();
+        clearMoveSequence();
         syncJogTargetsToCurrent();
         sendStatus(true, false, false, false);
       }
+      else if (sequenceInProgress)
+      {
+        runSequenceStep();
+        endMotorCycle(cycleStart);
+        continue;
+      }
       else
       {
         // Check if both motors have reached their targets
@@ -1009,7 +2150,7 @@ void motorTask(void *parameter)
           }
 
           // Skip joystick processing while angular movement is active
-          vTaskDelay(1 / portTICK_PERIOD_MS);
+          endMotorCycle(cycleStart);
           continue;
         }
       }
@@ -1036,53 +2177,25 @@ void motorTask(void *parameter)
     else
     {
       filteredJoystickX = currentX;
-      filteredJoystickY = currentY;
-    }
-
-    currentX = filteredJoystickX;
-    currentY = filteredJoystickY;
-    float currentHorizontalSpeed = 0.0f;
-    float currentVerticalSpeed = 0.0f;
-    bool verticalBlocked = false;
-
-    // Handle horizontal movement (X-axis)
-    if (fabs(currentX) > deadzone)
-    {
-      float normX = (fabs(currentX) - deadzone) / (1.0 - deadzone);
-      float mappedSpeed = pow(normX, speedExponent) * effectiveHorizontalMaxStepsPerSec;
-
-      currentHorizontalSpeed = (currentX > 0) ? mappedSpeed : -mappedSpeed;
-    }
-    else
-    {
-      currentHorizontalSpeed = 0;
+      filteredJoystickY = currentY;
     }
 
-    // Handle vertical movement (Y-axis)
-    if (fabs(currentY) > deadzone)
-    {
-      float normY = (fabs(currentY) - deadzone) / (1.0 - deadzone);
-      float mappedSpeed = pow(normY, speedExponent) * effectiveVerticalMaxStepsPerSec;
+    currentX = filteredJoystickX;
+    currentY = filteredJoystickY;
+    float currentHorizontalSpeed = 0.0f;
+    float currentVerticalSpeed = 0.0f;
+    bool verticalBlocked = false;
 
-      // Check limit switches before setting speed
-      if (currentY > 0 && canMoveUp())
-      { // Moving up
-        currentVerticalSpeed = mappedSpeed;
-      }
-      else if (currentY < 0 && canMoveDown())
-      { // Moving down
-        currentVerticalSpeed = -mappedSpeed;
-      }
-      else
-      {
-        // Hit a limit switch or trying to move into a limit
-        currentVerticalSpeed = 0;
-        verticalBlocked = true;
-      }
-    }
-    else
+    // Horizontal movement (X-axis)
+    currentHorizontalSpeed = joystickAxisSpeed<YawAxis>(currentX);
+
+    // Vertical movement (Y-axis), checking limit switches before setting speed
+    currentVerticalSpeed = joystickAxisSpeed<TiltAxis>(currentY);
+    if ((currentVerticalSpeed > 0 && !canMoveUp()) || (currentVerticalSpeed < 0 && !canMoveDown()))
     {
+      // Hit a limit switch or trying to move into a limit
       currentVerticalSpeed = 0;
+      verticalBlocked = true;
     }
 
     // Integrate joystick velocity into moving target position (yaw only)
@@ -1129,8 +2242,8 @@ void motorTask(void *parameter)
     if (currentMillis - lastLogTime >= 500)
     {
       lastLogTime = currentMillis;
-      float horizontalPercentSpeed = (fabs(currentHorizontalSpeed) / effectiveHorizontalMaxStepsPerSec) * 100.0;
-      float verticalPercentSpeed = (fabs(currentVerticalSpeed) / effectiveVerticalMaxStepsPerSec) * 100.0;
+      float horizontalPercentSpeed = (fabs(currentHorizontalSpeed) / YawAxis::runStepsPerSec()) * 100.0;
+      float verticalPercentSpeed = (fabs(currentVerticalSpeed) / TiltAxis::runStepsPerSec()) * 100.0;
       Serial.printf("Joy: X=%.3f Y=%.3f | H: %.1f%% V: %.1f%% | Home:%s | TiltLimits: U=%s D=%s | H_Pos: %ld V_Pos: %ld | Trigger: %s | Cal: H=%s V=%s | Mode: %s\n",
                     currentX, currentY,
                     horizontalPercentSpeed, verticalPercentSpeed,
@@ -1145,15 +2258,339 @@ void motorTask(void *parameter)
                     angularMovementInProgress ? "ANGULAR" : "JOYSTICK");
     }
 
-    // Periodic status broadcast to UI
-    if (currentMillis - lastStatusSend >= STATUS_INTERVAL_MS)
+    // Minimal delay to yield to other tasks
+    endMotorCycle(cycleStart);
+  }
+}
+
+void registerWsClient(uint32_t id)
+{
+  for (size_t i = 0; i < MAX_WS_CLIENTS; i++)
+  {
+    if (!wsClients[i].used)
+    {
+      wsClients[i].id = id;
+      wsClients[i].binaryStatus = false;
+      wsClients[i].needsKeyframe = true;
+      wsClients[i].used = true;
+      return;
+    }
+  }
+}
+
+void unregisterWsClient(uint32_t id)
+{
+  for (size_t i = 0; i < MAX_WS_CLIENTS; i++)
+  {
+    if (wsClients[i].used && wsClients[i].id == id)
     {
-      lastStatusSend = currentMillis;
-      sendStatus(false, false, false, false);
+      wsClients[i].used = false;
     }
+  }
+}
 
-    // Minimal delay to yield to other tasks
-    vTaskDelay(1 / portTICK_PERIOD_MS);
+// Runs on the AsyncUDP task; answers straight away so the reply times are tight
+void onClockSyncPacket(AsyncUDPPacket &packet)
+{
+  uint64_t receiveUs = esp_timer_get_time();
+  uint8_t reply[CLOCK_SYNC_RESPONSE_SIZE];
+  size_t len = answerClockSync(packet.data(), packet.length(), receiveUs, esp_timer_get_time(), reply, sizeof(reply));
+  if (len > 0)
+  {
+    packet.write(reply, len);
+    clockSyncRequests.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void setWsClientBinary(uint32_t id)
+{
+  for (size_t i = 0; i < MAX_WS_CLIENTS; i++)
+  {
+    if (wsClients[i].used && wsClients[i].id == id && !wsClients[i].binaryStatus)
+    {
+      wsClients[i].binaryStatus = true;
+      wsClients[i].needsKeyframe = true;
+    }
+  }
+}
+
+// Producer side of the command mailbox; only called from the AsyncTCP task
+bool postCommand(const MotorCommand &cmd)
+{
+  if (!commandMailbox.push(cmd))
+  {
+    droppedCommandCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+MotorCommand makeCommand(MotorCommandType type)
+{
+  MotorCommand cmd;
+  memset(&cmd, 0, sizeof(cmd));
+  cmd.type = type;
+  cmd.receivedUs = micros();
+  return cmd;
+}
+
+void postAngleCommand(MotorCommandType type, float horizontal, float vertical)
+{
+  MotorCommand cmd = makeCommand(type);
+  cmd.horizontal = horizontal;
+  cmd.vertical = vertical;
+  postCommand(cmd);
+}
+
+// Errors are logged by motorTask so the error ring has a single writer
+void postError(const String &msg)
+{
+  MotorCommand cmd = makeCommand(CMD_REPORT_ERROR);
+  strlcpy(cmd.text, msg.c_str(), sizeof(cmd.text));
+  postCommand(cmd);
+}
+
+// Pixel error is target minus frame center; +x is right, +y is down in the image
+void postTrackCommand(JsonVariant track)
+{
+  if (track.is<bool>())
+  {
+    if (!track.as<bool>())
+    {
+      postCommand(makeCommand(CMD_STOP_TRACKING));
+    }
+    return;
+  }
+
+  float width = track["width"] | 480.0f;
+  float height = track["height"] | 320.0f;
+  if (width <= 0.0f || height <= 0.0f)
+  {
+    postError("Track rejected: bad frame size");
+    return;
+  }
+
+  postAngleCommand(CMD_TRACK,
+                   (track["errorX"].as<float>() / width) * CAMERA_HFOV_DEG,
+                   -(track["errorY"].as<float>() / height) * CAMERA_VFOV_DEG);
+}
+
+void postIntercept(float horizontal, float vertical, float horizontalRate, float verticalRate, uint64_t targetUs,
+                   long flightMs)
+{
+  if (!isfinite(horizontal) || !isfinite(vertical) || !isfinite(horizontalRate) || !isfinite(verticalRate) ||
+      flightMs < 0 || flightMs > (long)INTERCEPT_MAX_FLIGHT_MS)
+  {
+    postError("Intercept rejected: bad target");
+    return;
+  }
+  MotorCommand cmd = makeCommand(CMD_INTERCEPT);
+  cmd.horizontal = horizontal;
+  cmd.vertical = vertical;
+  cmd.rates[0] = horizontalRate;
+  cmd.rates[1] = verticalRate;
+  cmd.targetUs = targetUs;
+  cmd.flightMs = (uint16_t)flightMs;
+  postCommand(cmd);
+}
+
+// {"intercept": {"horizontal", "vertical", "horizontalRate", "verticalRate"}} with
+// optional "timeUs" (esp_timer time the target was seen) and "flightMs"
+void postInterceptCommand(JsonVariant intercept)
+{
+  if (intercept.is<bool>())
+  {
+    if (!intercept.as<bool>())
+    {
+      postCommand(makeCommand(CMD_STOP_TRACKING));
+    }
+    return;
+  }
+
+  postIntercept(intercept["horizontal"].as<float>(), intercept["vertical"].as<float>(),
+                intercept["horizontalRate"] | 0.0f, intercept["verticalRate"] | 0.0f,
+                intercept["timeUs"] | (uint64_t)0, intercept["flightMs"] | 0L);
+}
+
+void postFirePattern(const FirePattern &pattern)
+{
+  MotorCommand cmd = makeCommand(CMD_FIRE);
+  cmd.firePattern = pattern;
+  postCommand(cmd);
+}
+
+void postFireMode(FireMode mode)
+{
+  if (mode == FIRE_CANCEL)
+  {
+    postCommand(makeCommand(CMD_CANCEL_FIRE));
+    return;
+  }
+  FirePattern pattern = {1, 0, 0, false, 0};
+  if (mode == FIRE_BURST)
+  {
+    pattern.shots = BURST_SHOT_COUNT;
+    pattern.intervalMs = BURST_SHOT_INTERVAL_MS;
+  }
+  postFirePattern(pattern);
+}
+
+// {"fire": "single" | "burst" | "cancel"}, or a pattern
+// {"fire": {"shots", "intervalMs", "maxRate", "onTarget", "settleMs"}} (rounds/min, on target by default)
+void postFireCommand(JsonVariant fire)
+{
+  if (fire.is<JsonObject>())
+  {
+    long shots = fire["shots"] | 1L;
+    long intervalMs = fire["intervalMs"] | 0L;
+    long maxRate = fire["maxRate"] | 0L;
+    long settleMs = fire["settleMs"] | 0L;
+    if (shots < 1 || shots > FIRE_MAX_SHOTS || intervalMs < 0 || intervalMs > 0xFFFF || maxRate < 0 ||
+        maxRate > 0xFFFF || settleMs < 0 || settleMs > FIRE_MAX_SETTLE_MS)
+    {
+      postError("Fire rejected: bad pattern");
+      return;
+    }
+    FirePattern pattern = {(uint8_t)shots, (uint16_t)intervalMs, (uint16_t)maxRate, fire["onTarget"] | true,
+                           (uint16_t)settleMs};
+    postFirePattern(pattern);
+    return;
+  }
+
+  String fireMode = fire.as<String>();
+  if (fireMode == "single" || fireMode == "burst" || fireMode == "cancel")
+  {
+    postFireMode(fireMode == "burst" ? FIRE_BURST : fireMode == "cancel" ? FIRE_CANCEL : FIRE_SINGLE);
+  }
+  else
+  {
+    Serial.println("Unknown fire mode: " + fireMode);
+    postError("Unknown fire mode: " + fireMode);
+  }
+}
+
+// {"moveToAngle": {"horizontal", "vertical"}}, optionally with "fireOnArrival": true
+// and "settleMs" (how long the axes must rest on target before the shot)
+void postMoveToAngleCommand(JsonVariant move)
+{
+  MotorCommand cmd = makeCommand(CMD_MOVE_TO_ANGLE);
+  cmd.horizontal = move["horizontal"].as<float>();
+  cmd.vertical = move["vertical"].as<float>();
+  if (move["fireOnArrival"] | false)
+  {
+    long settleMs = move["settleMs"] | (long)FIRE_ARRIVAL_SETTLE_MS;
+    if (settleMs < 0 || settleMs > FIRE_MAX_SETTLE_MS)
+    {
+      postError("Move rejected: bad settleMs");
+      return;
+    }
+    FirePattern arrivalShot = {1, 0, 0, true, (uint16_t)settleMs};
+    cmd.firePattern = arrivalShot;
+  }
+  postCommand(cmd);
+}
+
+void postSequenceCommand(JsonArray waypoints)
+{
+  size_t count = waypoints.size();
+  if (count == 0 || count > PLANNER_MAX_SEGMENTS)
+  {
+    Serial.printf("Sequence rejected: %u waypoints (max %u)\n", (unsigned)count, (unsigned)PLANNER_MAX_SEGMENTS);
+    postError("Sequence rejected: bad waypoint count");
+    return;
+  }
+
+  MotorCommand cmd = makeCommand(CMD_MOVE_SEQUENCE);
+  cmd.count = (uint8_t)count;
+  size_t i = 0;
+  for (JsonObject wp : waypoints)
+  {
+    cmd.waypoints[i][0] = wp["horizontal"].as<float>();
+    cmd.waypoints[i][1] = wp["vertical"].as<float>();
+    i++;
+  }
+  postCommand(cmd);
+}
+
+void handleBinaryCommand(AsyncWebSocketClient *client, const uint8_t *data, size_t len)
+{
+  TurretCommand cmd;
+  DecodeResult result = decodeCommand(data, len, cmd);
+  if (result != DECODE_OK)
+  {
+    Serial.printf("Binary frame rejected: %s\n", decodeResultName(result));
+    postError(String("Bad binary frame: ") + decodeResultName(result));
+    return;
+  }
+
+  // Answered here from the lock-free history; asking for it does not switch
+  // the client to binary status
+  if (cmd.type == FRAME_POSE_HISTORY_REQUEST)
+  {
+    size_t maxSamples = cmd.maxSamples > 0 && cmd.maxSamples < POSE_EXPORT_MAX_SAMPLES ? cmd.maxSamples : POSE_EXPORT_MAX_SAMPLES;
+    bool more = false;
+    size_t count = poseHistory.copySince(cmd.afterUs, poseExportSamples, maxSamples, more);
+    size_t frameLen = encodePoseHistory(poseExportSamples, count, more ? POSE_HISTORY_MORE : 0,
+                                        poseExportFrame, sizeof(poseExportFrame));
+    if (client && frameLen > 0)
+    {
+      client->binary(poseExportFrame, frameLen);
+    }
+    return;
+  }
+
+  if (client)
+  {
+    setWsClientBinary(client->id());
+  }
+
+  switch (cmd.type)
+  {
+  case FRAME_JOYSTICK:
+  {
+    MotorCommand joy = makeCommand(CMD_JOYSTICK);
+    joy.axes = JOYSTICK_HAS_X | JOYSTICK_HAS_Y;
+    joy.horizontal = cmd.x;
+    joy.vertical = cmd.y;
+    postCommand(joy);
+    break;
+  }
+  case FRAME_MOVE_TO_ANGLE:
+    postAngleCommand(CMD_MOVE_TO_ANGLE, cmd.horizontal, cmd.vertical);
+    break;
+  case FRAME_MOVE_BY_ANGLE:
+    postAngleCommand(CMD_MOVE_BY_ANGLE, cmd.horizontal, cmd.vertical);
+    break;
+  case FRAME_FIRE:
+    postFireMode(cmd.fireMode);
+    break;
+  case FRAME_MOVE_TO_ANGLE_AND_FIRE:
+  {
+    MotorCommand move = makeCommand(CMD_MOVE_TO_ANGLE);
+    move.horizontal = cmd.horizontal;
+    move.vertical = cmd.vertical;
+    move.firePattern = cmd.firePattern;
+    postCommand(move);
+    break;
+  }
+  case FRAME_FIRE_PATTERN:
+  {
+    MotorCommand fire = makeCommand(CMD_FIRE);
+    fire.firePattern = cmd.firePattern;
+    postCommand(fire);
+    break;
+  }
+  case FRAME_HOME:
+    postCommand(makeCommand(CMD_HOME));
+    break;
+  case FRAME_CALIBRATE:
+    postCommand(makeCommand(CMD_CALIBRATE));
+    break;
+  case FRAME_INTERCEPT:
+    postIntercept(cmd.horizontal, cmd.vertical, cmd.horizontalRate, cmd.verticalRate, cmd.targetUs, cmd.flightMs);
+    break;
+  default:
+    break;
   }
 }
 
@@ -1164,139 +2601,189 @@ void onWebSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
   {
   case WS_EVT_CONNECT:
     Serial.printf("WebSocket client connected: %u\n", client->id());
-    lastControlMessageTime = millis();
-    joystickX = 0.0f;
-    joystickY = 0.0f;
-    resetJoystickFilter();
-    syncJogTargetsToCurrent();
-    stopAllMotion();
+    registerWsClient(client->id());
+    postCommand(makeCommand(CMD_CLIENT_CONNECTED));
     break;
   case WS_EVT_DISCONNECT:
     Serial.printf("WebSocket client disconnected: %u\n", client->id());
-    joystickX = 0.0f;
-    joystickY = 0.0f;
-    resetJoystickFilter();
-    angularMovementInProgress = false;
-    syncJogTargetsToCurrent();
-    stopAllMotion();
-    horizontalStepper.stop();
-    verticalStepper.stop();
-    lastControlMessageTime = millis();
-    Serial.println("Motion halted due to WebSocket disconnect");
-    sendStatus(false, false, false, false);
+    unregisterWsClient(client->id());
+    postCommand(makeCommand(CMD_CLIENT_DISCONNECTED));
     break;
   case WS_EVT_DATA:
   {
-    StaticJsonDocument<200> doc;
+    AwsFrameInfo *info = (AwsFrameInfo *)arg;
+    if (info && info->opcode == WS_BINARY)
+    {
+      if (info->final && info->index == 0 && info->len == len)
+      {
+        handleBinaryCommand(client, data, len);
+      }
+      else
+      {
+        postError("Fragmented binary frame ignored");
+      }
+      return;
+    }
+
+    StaticJsonDocument<1024> doc;
+    uint32_t parseStartUs = micros();
     DeserializationError error = deserializeJson(doc, data, len);
+    recordMetric(METRIC_JSON_PARSE, micros() - parseStartUs);
     if (error)
     {
       Serial.print("deserializeJson() failed: ");
       Serial.println(error.c_str());
-      recordError("Bad JSON from client");
+      postError("Bad JSON from client");
       return;
     }
-    if (doc.containsKey("x"))
-    {
-      joystickX = doc["x"].as<float>();
-      lastControlMessageTime = millis();
-
-      // Cancel angular movement if significant joystick input is detected
-      if (angularMovementInProgress && fabs(joystickX) > deadzone)
-      {
-        Serial.println("Joystick input detected - cancelling angular movement");
-        cancelAngularMovement();
-      }
-    }
-    if (doc.containsKey("y"))
+    if (doc.containsKey("x") || doc.containsKey("y"))
     {
-      joystickY = doc["y"].as<float>();
-      lastControlMessageTime = millis();
-
-      // Cancel angular movement if significant joystick input is detected
-      if (angularMovementInProgress && fabs(joystickY) > deadzone)
-      {
-        Serial.println("Joystick input detected - cancelling angular movement");
-        cancelAngularMovement();
-      }
+      MotorCommand joy = makeCommand(CMD_JOYSTICK);
+      joy.axes = (doc.containsKey("x") ? JOYSTICK_HAS_X : 0) | (doc.containsKey("y") ? JOYSTICK_HAS_Y : 0);
+      joy.horizontal = doc["x"].as<float>();
+      joy.vertical = doc["y"].as<float>();
+      postCommand(joy);
     }
 
     // Check for calibration command
     if (doc.containsKey("calibrate") && doc["calibrate"].as<bool>())
     {
-      Serial.println("Calibration requested via WebSocket");
-      calibrateMotors();
+      postCommand(makeCommand(CMD_CALIBRATE));
     }
 
     if (doc.containsKey("home") && doc["home"].as<bool>())
     {
-      Serial.println("Home requested via WebSocket");
-      homeTurret();
+      postCommand(makeCommand(CMD_HOME));
+    }
+
+    if (doc.containsKey("abortCalibration") && doc["abortCalibration"].as<bool>())
+    {
+      postCommand(makeCommand(CMD_ABORT_CALIBRATION));
     }
 
     // Check for trigger commands
     if (doc.containsKey("fire"))
     {
-      String fireMode = doc["fire"].as<String>();
-      if (fireMode == "single")
-      {
-        fireSingleShot();
-      }
-      else if (fireMode == "burst")
-      {
-        startBurstFire();
-      }
-      else
-      {
-        Serial.println("Unknown fire mode: " + fireMode);
-        recordError("Unknown fire mode: " + fireMode);
-      }
+      postFireCommand(doc["fire"]);
     }
 
     // Check for angular movement commands
     if (doc.containsKey("moveToAngle"))
     {
-      float horizontalAngle = doc["moveToAngle"]["horizontal"].as<float>();
-      float verticalAngle = doc["moveToAngle"]["vertical"].as<float>();
-      moveToAbsoluteAngle(horizontalAngle, verticalAngle);
+      postMoveToAngleCommand(doc["moveToAngle"]);
     }
 
     if (doc.containsKey("moveByAngle"))
     {
-      float horizontalAngle = doc["moveByAngle"]["horizontal"].as<float>();
-      float verticalAngle = doc["moveByAngle"]["vertical"].as<float>();
-      moveByRelativeAngle(horizontalAngle, verticalAngle);
+      postAngleCommand(CMD_MOVE_BY_ANGLE, doc["moveByAngle"]["horizontal"].as<float>(), doc["moveByAngle"]["vertical"].as<float>());
+    }
+
+    if (doc.containsKey("track"))
+    {
+      postTrackCommand(doc["track"]);
+    }
+
+    if (doc.containsKey("intercept"))
+    {
+      postInterceptCommand(doc["intercept"]);
+    }
+
+    if (doc.containsKey("moveSequence"))
+    {
+      postSequenceCommand(doc["moveSequence"].as<JsonArray>());
     }
 
     if (doc.containsKey("moveToCenter") && doc["moveToCenter"].as<bool>())
     {
-      moveToCenter();
+      postCommand(makeCommand(CMD_MOVE_TO_CENTER));
+    }
+
+    if (doc.containsKey("telemetryRate"))
+    {
+      MotorCommand rate = makeCommand(CMD_SET_TELEMETRY_RATE);
+      rate.rateHz = (uint16_t)constrain(doc["telemetryRate"].as<int>(), 0, 1000);
+      postCommand(rate);
+    }
+
+    if (doc.containsKey("coordinatedMotion"))
+    {
+      MotorCommand coordinated = makeCommand(CMD_SET_COORDINATED);
+      coordinated.enabled = doc["coordinatedMotion"].as<bool>();
+      postCommand(coordinated);
     }
 
     // Check for cancel angular movement command
     if (doc.containsKey("cancelAngularMovement") && doc["cancelAngularMovement"].as<bool>())
     {
-      cancelAngularMovement();
+      postCommand(makeCommand(CMD_CANCEL_ANGULAR));
     }
 
+    // Answered here from the published snapshot; never touches the steppers
     if (doc.containsKey("getCurrentAngles") && doc["getCurrentAngles"].as<bool>())
     {
-      float horizontalAngle, verticalAngle;
-      getCurrentAngles(horizontalAngle, verticalAngle);
+      TurretSnapshot snap = turretSnapshot.read();
 
       // Send back current angles via WebSocket
       StaticJsonDocument<200> response;
-      response["currentAngles"]["horizontal"] = horizontalAngle;
-      response["currentAngles"]["vertical"] = verticalAngle;
-      response["positions"]["horizontal"] = horizontalStepper.currentPosition();
-      response["positions"]["vertical"] = verticalStepper.currentPosition();
-      response["calibrated"] = angularPositioningEnabled;
+      response["currentAngles"]["horizontal"] = snap.horizontalAngle;
+      response["currentAngles"]["vertical"] = snap.verticalAngle;
+      response["positions"]["horizontal"] = snap.horizontalPosition;
+      response["positions"]["vertical"] = snap.verticalPosition;
+      response["calibrated"] = (snap.flags & STATUS_CALIBRATED) != 0;
 
       String responseStr;
       serializeJson(response, responseStr);
       server->textAll(responseStr);
 
-      Serial.printf("Current angles - H: %.2f°, V: %.2f°\n", horizontalAngle, verticalAngle);
+      Serial.printf("Current angles - H: %.2f°, V: %.2f°\n", snap.horizontalAngle, snap.verticalAngle);
+    }
+
+    // Answered from the pose history; the time is in this controller's
+    // esp_timer microseconds, as the camera stamps its frames after clock sync
+    if (doc.containsKey("getPoseAt"))
+    {
+      uint64_t timeUs = doc["getPoseAt"]["timeUs"].as<uint64_t>();
+      PoseEstimate pose;
+      PoseLookup lookup = poseHistory.poseAt(timeUs, pose);
+
+      StaticJsonDocument<256> response;
+      response["poseAt"]["timeUs"] = timeUs;
+      response["poseAt"]["result"] = poseLookupName(lookup);
+      if (lookup == POSE_INTERPOLATED || lookup == POSE_LATEST)
+      {
+        response["poseAt"]["sampleTimeUs"] = pose.timeUs;
+        response["poseAt"]["horizontal"] = wrapTo180(wrapTo360(YawAxis::toDegrees(pose.yawSteps)));
+        response["poseAt"]["vertical"] = TiltAxis::toDegrees(pose.tiltSteps);
+        response["poseAt"]["horizontalSpeed"] = YawAxis::toDegrees(pose.yawStepsPerSec);
+        response["poseAt"]["verticalSpeed"] = TiltAxis::toDegrees(pose.tiltStepsPerSec);
+      }
+      response["poseAt"]["calibrated"] = (turretSnapshot.read().flags & STATUS_CALIBRATED) != 0;
+      response["poseAt"]["nowUs"] = (uint64_t)esp_timer_get_time();
+
+      String responseStr;
+      serializeJson(response, responseStr);
+      client->text(responseStr);
+    }
+
+    // Histograms are safe to read from any task; reset after reading so both
+    // can be combined into one request
+    if (doc.containsKey("getMetrics") && doc["getMetrics"].as<bool>())
+    {
+      size_t metricsLen = encodeMetricsJson(latencyMetrics, metricsBuffer, sizeof(metricsBuffer));
+      if (metricsLen > 0)
+      {
+        client->text(metricsBuffer, metricsLen);
+      }
+      else
+      {
+        postError("Metrics response did not fit");
+      }
+    }
+
+    if (doc.containsKey("resetMetrics") && doc["resetMetrics"].as<bool>())
+    {
+      latencyMetrics.reset();
+      Serial.println("Latency metrics reset");
     }
     break;
   }
@@ -1309,6 +2796,7 @@ void setup()
 {
   Serial.begin(115200);
   delay(1000);
+  cpuCyclesPerUs = ESP.getCpuFreqMHz();
   Serial.println("Starting ESP32 WebSocket and Stepper Motor Control");
   lastControlMessageTime = millis();
 
@@ -1318,17 +2806,16 @@ void setup()
   pinMode(DOWN_LIMIT_PIN, INPUT_PULLUP);
 
   // Attach interrupts for sensors
-  attachInterrupt(digitalPinToInterrupt(H_HOME_PIN), homeSensorISR, FALLING);
+  attachInterrupt(digitalPinToInterrupt(H_HOME_PIN), homeSensorISR, CHANGE);
   attachInterrupt(digitalPinToInterrupt(UP_LIMIT_PIN), upLimitISR, CHANGE);
   attachInterrupt(digitalPinToInterrupt(DOWN_LIMIT_PIN), downLimitISR, CHANGE);
 
   // Initialize sensor states
-  homeSensorTriggered = digitalRead(H_HOME_PIN) == LOW;
   upLimitHit = LIMIT_SWITCH_ACTIVE_LOW ? (digitalRead(UP_LIMIT_PIN) == LOW) : (digitalRead(UP_LIMIT_PIN) == HIGH);
   downLimitHit = LIMIT_SWITCH_ACTIVE_LOW ? (digitalRead(DOWN_LIMIT_PIN) == LOW) : (digitalRead(DOWN_LIMIT_PIN) == HIGH);
 
   Serial.printf("Initial sensor states - Yaw home: %s, Up: %s, Down: %s\n",
-                homeSensorTriggered ? "ACTIVE" : "CLEAR",
+                isHomeSensorActive() ? "ACTIVE" : "CLEAR",
                 upLimitHit ? "HIT" : "OK", downLimitHit ? "HIT" : "OK");
 
   // Check for problematic vertical limit switch configuration
@@ -1340,12 +2827,17 @@ void setup()
   }
 
   // Initialize stepper settings
-  horizontalStepper.setMaxSpeed(effectiveHorizontalMaxStepsPerSec);
-  verticalStepper.setMaxSpeed(effectiveVerticalMaxStepsPerSec);
+  startStepEngine();
+  horizontalStepper.setMaxSpeed(YawAxis::runStepsPerSec());
+  verticalStepper.setMaxSpeed(TiltAxis::runStepsPerSec());
   horizontalStepper.setAcceleration(joystickAccelStepsPerSec2);
   verticalStepper.setAcceleration(joystickAccelStepsPerSec2);
   verticalStepper.setPinsInverted(VERTICAL_DIR_INVERT, false, false); // Tilt direction configuration
 
+  trackingController.configure(YAW_TRACKING_GAINS, TILT_TRACKING_GAINS, TRACKING_TIMEOUT_MS);
+  interceptSolver.configure(INTERCEPT_CONFIG);
+  fireSequencer.configure(computeTriggerCycleMs(), FIRE_ON_TARGET_TIMEOUT_MS);
+
   // Initialize servo motor for trigger
   triggerServo.setPeriodHertz(50);           // Standard 50Hz servo
   triggerServo.attach(SERVO_PIN, 500, 2500); // Min/Max pulse width in microseconds
@@ -1356,9 +2848,15 @@ void setup()
   Serial.println("Waiting 1 second before motion...");
   delay(1000); // Safety delay after power-on
 
+  // Nothing else is running yet, so step the startup calibration to completion here
   Serial.println("Running startup calibration...");
-  calibrateMotors();
-  syncJogTargetsToCurrent();
+  configureCalibration();
+  startupCalibration();
+  while (calibrationInProgress)
+  {
+    runCalibrationStep();
+    delay(1);
+  }
 
   // Connect to WiFi
   WiFi.begin(ssid, password);
@@ -1372,6 +2870,21 @@ void setup()
   Serial.print("Connected, IP address: ");
   Serial.println(WiFi.localIP());
 
+  // The camera finds us by name and syncs its frame timestamps to our clock
+  if (!MDNS.begin(MDNS_HOSTNAME))
+  {
+    Serial.println("mDNS responder failed to start");
+  }
+  if (clockSyncUdp.listen(CLOCK_SYNC_PORT))
+  {
+    clockSyncUdp.onPacket(onClockSyncPacket);
+    Serial.printf("Clock sync on %s.local UDP port %u\n", MDNS_HOSTNAME, CLOCK_SYNC_PORT);
+  }
+  else
+  {
+    Serial.println("Clock sync UDP listen failed");
+  }
+
   // Setup WebSocket
   ws.onEvent(onWebSocketEvent);
   server.addHandler(&ws);
@@ -1381,10 +2894,10 @@ void setup()
   xTaskCreatePinnedToCore(
       motorTask,   // Task function
       "MotorTask", // Name of task
-      2048,        // Stack size in words
+      MOTOR_TASK_STACK_BYTES, // Stack size in bytes on ESP-IDF
       NULL,        // Task input parameter
       1,           // Priority of the task
-      NULL,        // Task handle
+      &motorTaskHandle, // Task handle
       1            // Core where the task should run (0 or 1)
   );
 
@@ -1392,28 +2905,60 @@ void setup()
   Serial.println("Available WebSocket commands:");
   Serial.println("  - {\"calibrate\": true} - Calibrate yaw home + tilt limits");
   Serial.println("  - {\"home\": true} - Re-home yaw (hall) and recenter tilt");
+  Serial.println("  - {\"abortCalibration\": true} - Stop a running calibration/home");
   Serial.println("  - {\"fire\": \"single\"} - Fire single shot");
   Serial.printf("  - {\"fire\": \"burst\"} - Fire %d-shot burst\n", BURST_SHOT_COUNT);
+  Serial.println("  - {\"fire\": {\"shots\": 5, \"intervalMs\": 0, \"maxRate\": 60, \"onTarget\": true}} - Queue a pattern");
+  Serial.println("  - {\"fire\": \"cancel\"} - Drop queued shots");
+  Serial.printf("  - {\"moveToAngle\": {..., \"fireOnArrival\": true, \"settleMs\": %u}} - Fire once the move settles\n",
+                FIRE_ARRIVAL_SETTLE_MS);
   Serial.println("  - {\"x\": 0.5, \"y\": 0.0} - Control turret movement (joystick mode)");
   Serial.println("  - {\"moveToAngle\": {\"horizontal\": 45.0, \"vertical\": -10.0}} - Move to absolute angles");
   Serial.println("  - {\"moveByAngle\": {\"horizontal\": 5.0, \"vertical\": 2.0}} - Move by relative angles");
+  Serial.println("  - {\"moveSequence\": [{\"horizontal\": 30, \"vertical\": 5}, ...]} - Blend through up to 16 waypoints");
   Serial.println("  - {\"moveToCenter\": true} - Move to center position (0°, 0°)");
+  Serial.println("  - {\"coordinatedMotion\": false} - Let yaw/tilt finish angular moves independently");
+  Serial.printf("  - {\"telemetryRate\": 20} - Status update rate in Hz (%lu-%lu, changed fields only)\n",
+                (unsigned long)TELEMETRY_MIN_RATE_HZ, (unsigned long)TELEMETRY_MAX_RATE_HZ);
+  Serial.println("  - {\"track\": {\"errorX\": 40, \"errorY\": -12, \"width\": 480, \"height\": 320}} - Visual-servo toward a detection");
+  Serial.println("  - {\"track\": false} - Stop tracking");
+  Serial.println("  - {\"intercept\": {\"horizontal\": 30, \"vertical\": 5, \"horizontalRate\": 20, \"verticalRate\": 0}} - Lead a moving target");
+  Serial.println("  - {\"intercept\": false} - Stop intercept");
   Serial.println("  - {\"cancelAngularMovement\": true} - Cancel ongoing angular movement");
   Serial.println("  - {\"getCurrentAngles\": true} - Get current turret angles");
+  Serial.println("  - {\"getPoseAt\": {\"timeUs\": 123456789}} - Turret angles at a synced camera capture time");
+  Serial.println("  - {\"getMetrics\": true} - Latency histograms (loop, command-to-step, parse, status)");
+  Serial.println("  - {\"resetMetrics\": true} - Clear the latency histograms");
+  Serial.printf("Binary frames (magic 0x%02X, v%u) are accepted for joystick/move/fire/home/calibrate;\n",
+                PROTOCOL_MAGIC, PROTOCOL_VERSION);
+  Serial.println("  clients that send them receive binary status frames instead of JSON");
   Serial.println("Note: Joystick input automatically cancels angular movement for safety");
 }
 
 void loop()
 {
+  // Calibrations are seconds apart, so the record cannot change while it is copied
+  if (calibrationStorePending.load(std::memory_order_acquire))
+  {
+    StoredCalibration stored = pendingCalibrationStore;
+    calibrationStorePending.store(false, std::memory_order_relaxed);
+    if (!saveStoredCalibration(currentCalibrationFingerprint(), stored))
+    {
+      Serial.println("WARNING: Could not store calibration - next boot runs a full calibration");
+    }
+  }
   yield();
 }
 
 void cancelAngularMovement()
 {
+  stopTracking();
+  disarmArrivalShot();
   if (angularMovementInProgress)
   {
     Serial.println("Cancelling angular movement - resuming joystick control");
     angularMovementInProgress = false;
+    clearMoveSequence();
 
     // Stop both motors
     stopAllMotion();
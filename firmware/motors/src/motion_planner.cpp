@@ -0,0 +1,254 @@
+#include "motion_planner.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+  const float MIN_SEGMENT_LENGTH = 0.001f; // deg
+  const float AXIS_EPSILON = 1e-6f;
+}
+
+void MotionPlanner::setLimits(const PlannerLimits &newLimits)
+{
+  limits = newLimits;
+}
+
+void MotionPlanner::reset(const float position[PLANNER_AXES])
+{
+  count = 0;
+  elapsed = 0.0f;
+  for (size_t a = 0; a < PLANNER_AXES; a++)
+  {
+    end[a] = position[a];
+  }
+}
+
+void MotionPlanner::lastWaypoint(float out[PLANNER_AXES]) const
+{
+  for (size_t a = 0; a < PLANNER_AXES; a++)
+  {
+    out[a] = end[a];
+  }
+}
+
+bool MotionPlanner::addWaypoint(const float target[PLANNER_AXES])
+{
+  if (count >= PLANNER_MAX_SEGMENTS)
+  {
+    return false;
+  }
+
+  PlannerSegment seg;
+  memset(&seg, 0, sizeof(seg));
+  float lengthSq = 0.0f;
+  for (size_t a = 0; a < PLANNER_AXES; a++)
+  {
+    seg.start[a] = end[a];
+    seg.unit[a] = target[a] - end[a];
+    lengthSq += seg.unit[a] * seg.unit[a];
+  }
+  seg.length = sqrtf(lengthSq);
+  if (seg.length < MIN_SEGMENT_LENGTH)
+  {
+    return true; // Already there
+  }
+
+  // Path speed/accel limited by whichever axis saturates first
+  seg.maxVelocity = INFINITY;
+  seg.accel = INFINITY;
+  for (size_t a = 0; a < PLANNER_AXES; a++)
+  {
+    seg.unit[a] /= seg.length;
+    float component = fabsf(seg.unit[a]);
+    if (component > AXIS_EPSILON)
+    {
+      seg.maxVelocity = fminf(seg.maxVelocity, limits.maxVelocity[a] / component);
+      seg.accel = fminf(seg.accel, limits.maxAccel[a] / component);
+    }
+  }
+
+  // Corner speed: per-axis velocity jump must fit in maxAccel * junctionTime
+  seg.maxJunctionVelocity = 0.0f;
+  if (count > 0)
+  {
+    const PlannerSegment &prev = segments[count - 1];
+    float junction = fminf(seg.maxVelocity, prev.maxVelocity);
+    for (size_t a = 0; a < PLANNER_AXES; a++)
+    {
+      float change = fabsf(seg.unit[a] - prev.unit[a]);
+      if (change > AXIS_EPSILON)
+      {
+        junction = fminf(junction, limits.maxAccel[a] * limits.junctionTime / change);
+      }
+    }
+    seg.maxJunctionVelocity = junction;
+  }
+
+  segments[count++] = seg;
+  for (size_t a = 0; a < PLANNER_AXES; a++)
+  {
+    end[a] = target[a];
+  }
+  replan();
+  return true;
+}
+
+// Backward pass from a full stop at the last waypoint, then a forward pass
+// from the segment being executed. Segment 0's profile is frozen once it has
+// started, so only its successors are re-profiled.
+void MotionPlanner::replan()
+{
+  size_t first = (elapsed > 0.0f) ? 1 : 0;
+  if (first >= count)
+  {
+    if (count > 0 && first == 0)
+    {
+      profileSegment(segments[0]);
+    }
+    return;
+  }
+
+  segments[count - 1].exitVelocity = 0.0f;
+  for (size_t i = count - 1; i > first; i--)
+  {
+    PlannerSegment &seg = segments[i];
+    float reachable = sqrtf(seg.exitVelocity * seg.exitVelocity + 2.0f * seg.accel * seg.length);
+    seg.entryVelocity = fminf(seg.maxJunctionVelocity, reachable);
+    segments[i - 1].exitVelocity = seg.entryVelocity;
+  }
+
+  if (first == 0)
+  {
+    segments[0].entryVelocity = 0.0f;
+  }
+  else
+  {
+    segments[first].entryVelocity = segments[0].exitVelocity;
+  }
+
+  for (size_t i = first; i < count; i++)
+  {
+    PlannerSegment &seg = segments[i];
+    if (i > first)
+    {
+      seg.entryVelocity = segments[i - 1].exitVelocity;
+    }
+    float reachable = sqrtf(seg.entryVelocity * seg.entryVelocity + 2.0f * seg.accel * seg.length);
+    seg.exitVelocity = fminf(seg.exitVelocity, reachable);
+    profileSegment(seg);
+  }
+}
+
+void MotionPlanner::profileSegment(PlannerSegment &seg)
+{
+  float ve = seg.entryVelocity;
+  float vx = seg.exitVelocity;
+  float a = seg.accel;
+  float peak = sqrtf((2.0f * a * seg.length + ve * ve + vx * vx) / 2.0f);
+  float vc = fminf(seg.maxVelocity, peak);
+  vc = fmaxf(vc, fmaxf(ve, vx));
+
+  float accelDist = (vc * vc - ve * ve) / (2.0f * a);
+  float decelDist = (vc * vc - vx * vx) / (2.0f * a);
+  float cruiseDist = seg.length - accelDist - decelDist;
+  if (cruiseDist < 0.0f)
+  {
+    cruiseDist = 0.0f;
+  }
+
+  seg.cruiseVelocity = vc;
+  seg.accelTime = (vc - ve) / a;
+  seg.decelTime = (vc - vx) / a;
+  seg.cruiseTime = vc > 0.0f ? cruiseDist / vc : 0.0f;
+}
+
+float MotionPlanner::segmentDuration(const PlannerSegment &seg) const
+{
+  return seg.accelTime + seg.cruiseTime + seg.decelTime;
+}
+
+float MotionPlanner::distanceAt(const PlannerSegment &seg, float t, float &speed) const
+{
+  float a = seg.accel;
+  if (t <= seg.accelTime)
+  {
+    speed = seg.entryVelocity + a * t;
+    return seg.entryVelocity * t + 0.5f * a * t * t;
+  }
+  float dist = seg.entryVelocity * seg.accelTime + 0.5f * a * seg.accelTime * seg.accelTime;
+  t -= seg.accelTime;
+  if (t <= seg.cruiseTime)
+  {
+    speed = seg.cruiseVelocity;
+    return dist + seg.cruiseVelocity * t;
+  }
+  dist += seg.cruiseVelocity * seg.cruiseTime;
+  t -= seg.cruiseTime;
+  if (t > seg.decelTime)
+  {
+    t = seg.decelTime;
+  }
+  speed = seg.cruiseVelocity - a * t;
+  dist += seg.cruiseVelocity * t - 0.5f * a * t * t;
+  return fminf(dist, seg.length);
+}
+
+PlannerSample MotionPlanner::advance(float dt)
+{
+  PlannerSample sample;
+  memset(&sample, 0, sizeof(sample));
+
+  if (count == 0)
+  {
+    for (size_t a = 0; a < PLANNER_AXES; a++)
+    {
+      sample.position[a] = end[a];
+    }
+    sample.done = true;
+    return sample;
+  }
+
+  elapsed += dt;
+  while (count > 0 && elapsed >= segmentDuration(segments[0]))
+  {
+    elapsed -= segmentDuration(segments[0]);
+    for (size_t i = 1; i < count; i++)
+    {
+      segments[i - 1] = segments[i];
+    }
+    count--;
+  }
+
+  if (count == 0)
+  {
+    elapsed = 0.0f;
+    for (size_t a = 0; a < PLANNER_AXES; a++)
+    {
+      sample.position[a] = end[a];
+    }
+    sample.done = true;
+    return sample;
+  }
+
+  const PlannerSegment &seg = segments[0];
+  float speed = 0.0f;
+  float dist = distanceAt(seg, elapsed, speed);
+  for (size_t a = 0; a < PLANNER_AXES; a++)
+  {
+    sample.position[a] = seg.start[a] + seg.unit[a] * dist;
+    sample.velocity[a] = seg.unit[a] * speed;
+  }
+  sample.done = false;
+  return sample;
+}
+
+float MotionPlanner::remainingTime() const
+{
+  float total = -elapsed;
+  for (size_t i = 0; i < count; i++)
+  {
+    total += segmentDuration(segments[i]);
+  }
+  return total > 0.0f ? total : 0.0f;
+}
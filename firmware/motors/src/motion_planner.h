@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stddef.h>
+
+// Look-ahead trajectory planner for queued two-axis waypoints.
+// Waypoints are joined by straight segments in (yaw, tilt) degree space. Each
+// segment gets a trapezoidal speed profile, and a backward/forward pass over the
+// whole queue picks junction speeds so the turret blends through waypoints
+// instead of stopping at each one. Yaw is unwrapped: callers resolve wrap-around
+// before adding a waypoint.
+
+const size_t PLANNER_AXES = 2;
+const size_t PLANNER_MAX_SEGMENTS = 16;
+
+struct PlannerLimits
+{
+  float maxVelocity[PLANNER_AXES]; // deg/s per axis
+  float maxAccel[PLANNER_AXES];    // deg/s^2 per axis
+  float junctionTime;              // Time allowed to absorb the per-axis velocity change at a corner (s)
+};
+
+struct PlannerSample
+{
+  float position[PLANNER_AXES];
+  float velocity[PLANNER_AXES];
+  bool done;
+};
+
+struct PlannerSegment
+{
+  float start[PLANNER_AXES];
+  float unit[PLANNER_AXES];
+  float length;
+  float maxVelocity;
+  float accel;
+  float maxJunctionVelocity;
+  float entryVelocity;
+  float exitVelocity;
+  float cruiseVelocity;
+  float accelTime;
+  float cruiseTime;
+  float decelTime;
+};
+
+class MotionPlanner
+{
+public:
+  void setLimits(const PlannerLimits &limits);
+
+  // Clears the queue and sets the position the next waypoint starts from
+  void reset(const float position[PLANNER_AXES]);
+  bool addWaypoint(const float target[PLANNER_AXES]);
+
+  // Moves the trajectory forward by dt seconds and returns the new setpoint
+  PlannerSample advance(float dt);
+
+  bool active() const { return count > 0; }
+  size_t pending() const { return count; }
+  size_t freeSlots() const { return PLANNER_MAX_SEGMENTS - count; }
+  void lastWaypoint(float out[PLANNER_AXES]) const;
+  float remainingTime() const;
+
+private:
+  void replan();
+  void profileSegment(PlannerSegment &seg);
+  float segmentDuration(const PlannerSegment &seg) const;
+  float distanceAt(const PlannerSegment &seg, float t, float &speed) const;
+
+  PlannerLimits limits = {};
+  PlannerSegment segments[PLANNER_MAX_SEGMENTS];
+  size_t count = 0;
+  float elapsed = 0.0f; // Time spent in segments[0]
+  float end[PLANNER_AXES] = {};
+};
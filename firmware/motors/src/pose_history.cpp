@@ -0,0 +1,168 @@
+#include "pose_history.h"
+
+namespace
+{
+  // Slots written after the reader looked at head may already be overwritten;
+  // keep this many of the oldest out of the search
+  const uint32_t POSE_READ_MARGIN = 8;
+  const uint8_t POSE_READ_ATTEMPTS = 4;
+}
+
+PoseHistory::PoseHistory() : head(0)
+{
+  for (size_t i = 0; i < POSE_HISTORY_SIZE; i++)
+  {
+    for (size_t w = 0; w < WORDS; w++)
+    {
+      slots[i][w].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+void PoseHistory::record(const PoseSample &sample)
+{
+  uint32_t index = head.load(std::memory_order_relaxed);
+  std::atomic<uint32_t> *slot = slots[index & (POSE_HISTORY_SIZE - 1)];
+  slot[0].store((uint32_t)sample.timeUs, std::memory_order_relaxed);
+  slot[1].store((uint32_t)(sample.timeUs >> 32), std::memory_order_relaxed);
+  slot[2].store((uint32_t)sample.yawSteps, std::memory_order_relaxed);
+  slot[3].store((uint32_t)sample.tiltSteps, std::memory_order_relaxed);
+  slot[4].store((uint32_t)(uint16_t)sample.yawStepsPerSec | ((uint32_t)(uint16_t)sample.tiltStepsPerSec << 16),
+                std::memory_order_relaxed);
+  head.store(index + 1, std::memory_order_release);
+}
+
+uint64_t PoseHistory::readTime(uint32_t index) const
+{
+  const std::atomic<uint32_t> *slot = slots[index & (POSE_HISTORY_SIZE - 1)];
+  return slot[0].load(std::memory_order_relaxed) | ((uint64_t)slot[1].load(std::memory_order_relaxed) << 32);
+}
+
+void PoseHistory::readSlot(uint32_t index, PoseSample &out) const
+{
+  const std::atomic<uint32_t> *slot = slots[index & (POSE_HISTORY_SIZE - 1)];
+  out.timeUs = readTime(index);
+  out.yawSteps = (int32_t)slot[2].load(std::memory_order_relaxed);
+  out.tiltSteps = (int32_t)slot[3].load(std::memory_order_relaxed);
+  uint32_t speeds = slot[4].load(std::memory_order_relaxed);
+  out.yawStepsPerSec = (int16_t)(speeds & 0xFFFF);
+  out.tiltStepsPerSec = (int16_t)(speeds >> 16);
+}
+
+// First index in [oldest, end) recorded after timeUs, or end
+uint32_t PoseHistory::firstAfter(uint32_t oldest, uint32_t end, uint64_t timeUs) const
+{
+  uint32_t low = oldest;
+  uint32_t high = end;
+  while (low < high)
+  {
+    uint32_t mid = low + (high - low) / 2;
+    if (readTime(mid) <= timeUs)
+    {
+      low = mid + 1;
+    }
+    else
+    {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+PoseLookup PoseHistory::poseAt(uint64_t timeUs, PoseEstimate &out) const
+{
+  for (uint8_t attempt = 0; attempt < POSE_READ_ATTEMPTS; attempt++)
+  {
+    uint32_t end = head.load(std::memory_order_acquire);
+    if (end == 0)
+    {
+      return POSE_EMPTY;
+    }
+    uint32_t held = end < POSE_HISTORY_SIZE - POSE_READ_MARGIN ? end : POSE_HISTORY_SIZE - POSE_READ_MARGIN;
+    uint32_t oldest = end - held;
+
+    PoseSample newest;
+    readSlot(end - 1, newest);
+    if (timeUs >= newest.timeUs)
+    {
+      out.timeUs = newest.timeUs;
+      out.yawSteps = newest.yawSteps;
+      out.tiltSteps = newest.tiltSteps;
+      out.yawStepsPerSec = newest.yawStepsPerSec;
+      out.tiltStepsPerSec = newest.tiltStepsPerSec;
+      return POSE_LATEST;
+    }
+    if (timeUs < readTime(oldest))
+    {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (head.load(std::memory_order_relaxed) - oldest < POSE_HISTORY_SIZE)
+      {
+        return POSE_TOO_OLD;
+      }
+      continue;
+    }
+
+    // Last sample at or before timeUs
+    uint32_t low = firstAfter(oldest, end - 1, timeUs) - 1;
+
+    PoseSample before;
+    PoseSample after;
+    readSlot(low, before);
+    readSlot(low + 1, after);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    bool overwritten = head.load(std::memory_order_relaxed) - low >= POSE_HISTORY_SIZE;
+    if (overwritten || before.timeUs > timeUs || after.timeUs <= timeUs)
+    {
+      continue;
+    }
+
+    float t = (float)(timeUs - before.timeUs) / (float)(after.timeUs - before.timeUs);
+    out.timeUs = timeUs;
+    out.yawSteps = before.yawSteps + t * (after.yawSteps - before.yawSteps);
+    out.tiltSteps = before.tiltSteps + t * (after.tiltSteps - before.tiltSteps);
+    out.yawStepsPerSec = before.yawStepsPerSec + t * (after.yawStepsPerSec - before.yawStepsPerSec);
+    out.tiltStepsPerSec = before.tiltStepsPerSec + t * (after.tiltStepsPerSec - before.tiltStepsPerSec);
+    return POSE_INTERPOLATED;
+  }
+  return POSE_TOO_OLD; // Writer kept lapping us; whatever was asked for is gone
+}
+
+size_t PoseHistory::copySince(uint64_t afterUs, PoseSample *out, size_t capacity, bool &more) const
+{
+  more = false;
+  for (uint8_t attempt = 0; attempt < POSE_READ_ATTEMPTS; attempt++)
+  {
+    uint32_t end = head.load(std::memory_order_acquire);
+    uint32_t held = end < POSE_HISTORY_SIZE - POSE_READ_MARGIN ? end : POSE_HISTORY_SIZE - POSE_READ_MARGIN;
+    uint32_t first = firstAfter(end - held, end, afterUs);
+    size_t count = end - first < capacity ? end - first : capacity;
+    for (size_t i = 0; i < count; i++)
+    {
+      readSlot(first + i, out[i]);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (head.load(std::memory_order_relaxed) - first >= POSE_HISTORY_SIZE)
+    {
+      continue;
+    }
+    more = first + count < end;
+    return count;
+  }
+  return 0;
+}
+
+const char *poseLookupName(PoseLookup lookup)
+{
+  switch (lookup)
+  {
+  case POSE_INTERPOLATED:
+    return "interpolated";
+  case POSE_LATEST:
+    return "latest";
+  case POSE_TOO_OLD:
+    return "tooOld";
+  case POSE_EMPTY:
+    return "empty";
+  }
+  return "unknown";
+}
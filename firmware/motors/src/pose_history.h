@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// Recent turret poses indexed by time, for matching camera frames (stamped in
+// this controller's clock via clock_sync.h) to where the turret was pointing.
+// The motor task appends; any task may look up a time without locking. A
+// reader that races the writer into the slot it is reading retries, the same
+// way a Seqlock reader does.
+
+const size_t POSE_HISTORY_SIZE = 2048; // Power of two; about 2 s at the control rate
+
+struct PoseSample
+{
+  uint64_t timeUs; // esp_timer microseconds
+  int32_t yawSteps;
+  int32_t tiltSteps;
+  int16_t yawStepsPerSec; // Commanded speed, clamped to int16
+  int16_t tiltStepsPerSec;
+};
+
+enum PoseLookup : uint8_t
+{
+  POSE_INTERPOLATED, // Between two recorded samples
+  POSE_LATEST,       // At or after the newest sample; that sample is returned
+  POSE_TOO_OLD,      // Before the oldest sample still held
+  POSE_EMPTY
+};
+
+struct PoseEstimate
+{
+  uint64_t timeUs;
+  float yawSteps;
+  float tiltSteps;
+  float yawStepsPerSec;
+  float tiltStepsPerSec;
+};
+
+class PoseHistory
+{
+  static_assert((POSE_HISTORY_SIZE & (POSE_HISTORY_SIZE - 1)) == 0, "Pose history size must be a power of two");
+
+public:
+  PoseHistory();
+
+  // Writer side (motor task only); times must not go backwards
+  void record(const PoseSample &sample);
+
+  // Any task
+  PoseLookup poseAt(uint64_t timeUs, PoseEstimate &out) const;
+  // Samples recorded after afterUs, oldest first, up to capacity. Starts at
+  // the oldest sample held when afterUs is older than that. more is set when
+  // newer samples did not fit.
+  size_t copySince(uint64_t afterUs, PoseSample *out, size_t capacity, bool &more) const;
+  uint32_t recorded() const { return head.load(std::memory_order_acquire); }
+
+private:
+  static const size_t WORDS = 5;
+
+  void readSlot(uint32_t index, PoseSample &out) const;
+  uint64_t readTime(uint32_t index) const;
+  uint32_t firstAfter(uint32_t oldest, uint32_t end, uint64_t timeUs) const;
+
+  std::atomic<uint32_t> slots[POSE_HISTORY_SIZE][WORDS];
+  std::atomic<uint32_t> head; // Samples ever recorded
+};
+
+const char *poseLookupName(PoseLookup lookup);
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+// Single-writer sequence lock for publishing a small POD snapshot.
+// The writer never blocks; readers retry while a write is in progress, so a
+// reader always sees a consistent copy without taking a mutex.
+template <typename T>
+class Seqlock
+{
+  static_assert(sizeof(T) % sizeof(uint32_t) == 0, "Seqlock payload must be a multiple of 4 bytes");
+
+public:
+  Seqlock() : sequence(0)
+  {
+    for (size_t i = 0; i < WORDS; i++)
+    {
+      words[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // Writer side (one task only)
+  void write(const T &next)
+  {
+    uint32_t buffer[WORDS];
+    memcpy(buffer, &next, sizeof(T));
+
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; i++)
+    {
+      words[i].store(buffer[i], std::memory_order_relaxed);
+    }
+    sequence.store(seq + 2, std::memory_order_release);
+  }
+
+  // Any task; spins only while a write is in flight
+  T read() const
+  {
+    uint32_t buffer[WORDS];
+    uint32_t before;
+    uint32_t after;
+    do
+    {
+      before = sequence.load(std::memory_order_acquire);
+      for (size_t i = 0; i < WORDS; i++)
+      {
+        buffer[i] = words[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    T copy;
+    memcpy(&copy, buffer, sizeof(T));
+    return copy;
+  }
+
+  // Number of completed writes
+  uint32_t version() const
+  {
+    return sequence.load(std::memory_order_acquire) >> 1;
+  }
+
+private:
+  static const size_t WORDS = sizeof(T) / sizeof(uint32_t);
+
+  std::atomic<uint32_t> words[WORDS];
+  std::atomic<uint32_t> sequence;
+};
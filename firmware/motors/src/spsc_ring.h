@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// Fixed-size single-producer/single-consumer ring buffer.
+// The producer only writes head and the consumer only writes tail, so push/pop
+// never block and are safe between a task and an ISR or between two cores.
+template <typename T, size_t CAPACITY>
+class SpscRing
+{
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+  SpscRing() : head(0), tail(0) {}
+
+  // Producer side
+  bool push(const T &item)
+  {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= CAPACITY)
+    {
+      return false;
+    }
+    slots[h & (CAPACITY - 1)] = item;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool full() const
+  {
+    return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire) >= CAPACITY;
+  }
+
+  // Consumer side
+  bool pop(T &item)
+  {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+    item = slots[t & (CAPACITY - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Returns the oldest item without removing it, or nullptr when empty
+  const T *peek() const
+  {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+    {
+      return nullptr;
+    }
+    return &slots[t & (CAPACITY - 1)];
+  }
+
+  // Removes the item returned by peek()
+  void drop()
+  {
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  // Discards everything currently queued (consumer side only)
+  void clear()
+  {
+    tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+  }
+
+  // Either side
+  size_t size() const
+  {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+
+  bool empty() const
+  {
+    return size() == 0;
+  }
+
+  static constexpr size_t capacity()
+  {
+    return CAPACITY;
+  }
+
+private:
+  T slots[CAPACITY];
+  std::atomic<uint32_t> head;
+  std::atomic<uint32_t> tail;
+};
@@ -0,0 +1,454 @@
+#include "step_engine.h"
+
+#include <math.h>
+
+void StepEngine::begin(const StepOutput &output, uint32_t (*clockUs)())
+{
+  out = output;
+  clock = clockUs;
+}
+
+uint32_t STEP_ENGINE_ISR_ATTR StepEngine::service(uint32_t nowUs)
+{
+  uint32_t nextDelay = STEP_IDLE_POLL_US;
+  bool pulsed[STEP_ENGINE_MAX_AXES] = {};
+  bool anyPulse = false;
+  bool directionChanged = false;
+
+  for (uint8_t axis = 0; axis < STEP_ENGINE_MAX_AXES; axis++)
+  {
+    StepChannel &ch = channels[axis];
+    uint32_t request = ch.flushRequest.load(std::memory_order_acquire);
+    if (request != ch.flushAck.load(std::memory_order_relaxed))
+    {
+      ch.queue.clear();
+      ch.flushAck.store(request, std::memory_order_release);
+    }
+
+    const StepEvent *ev = ch.queue.peek();
+    if (!ev)
+    {
+      continue;
+    }
+
+    int32_t early = (int32_t)(ev->dueUs - nowUs);
+    if (early <= (int32_t)STEP_DUE_SLACK_US)
+    {
+      if (ev->direction != ch.lastDirection)
+      {
+        ch.lastDirection = ev->direction;
+        out.setDirection(axis, (ev->direction > 0) != ch.directionInverted);
+        directionChanged = true;
+      }
+      ch.position.fetch_add(ev->direction, std::memory_order_relaxed);
+      ch.queue.drop();
+      pulsed[axis] = true;
+      anyPulse = true;
+
+      ev = ch.queue.peek();
+      if (!ev)
+      {
+        continue;
+      }
+      early = (int32_t)(ev->dueUs - nowUs);
+    }
+
+    uint32_t wait = early > (int32_t)STEP_MIN_SERVICE_US ? (uint32_t)early : STEP_MIN_SERVICE_US;
+    if (wait < nextDelay)
+    {
+      nextDelay = wait;
+    }
+  }
+
+  if (!anyPulse)
+  {
+    return nextDelay;
+  }
+
+  // DRV8825 needs DIR stable before the STEP edge and STEP high for ~2us
+  if (directionChanged)
+  {
+    out.pulseDelay();
+  }
+  for (uint8_t axis = 0; axis < STEP_ENGINE_MAX_AXES; axis++)
+  {
+    if (pulsed[axis])
+    {
+      out.stepHigh(axis, nowUs);
+    }
+  }
+  out.pulseDelay();
+  for (uint8_t axis = 0; axis < STEP_ENGINE_MAX_AXES; axis++)
+  {
+    if (pulsed[axis])
+    {
+      out.stepLow(axis);
+    }
+  }
+  return nextDelay;
+}
+
+QueuedStepper::QueuedStepper(StepEngine &engine, uint8_t axis)
+    : engine(engine), channel(engine.channel(axis))
+{
+}
+
+void QueuedStepper::setMaxSpeed(float stepsPerSec)
+{
+  maxSpeedValue = fabsf(stepsPerSec);
+}
+
+void QueuedStepper::setAcceleration(float stepsPerSec2)
+{
+  if (stepsPerSec2 > 0.0f)
+  {
+    accelValue = stepsPerSec2;
+  }
+}
+
+void QueuedStepper::setSpeed(float stepsPerSec)
+{
+  syncProfile = nullptr;
+  if (stepsPerSec > maxSpeedValue)
+  {
+    stepsPerSec = maxSpeedValue;
+  }
+  else if (stepsPerSec < -maxSpeedValue)
+  {
+    stepsPerSec = -maxSpeedValue;
+  }
+  speedValue = stepsPerSec;
+}
+
+void QueuedStepper::setPinsInverted(bool directionInvert, bool stepInvert, bool enableInvert)
+{
+  (void)stepInvert;
+  (void)enableInvert;
+  channel.directionInverted = directionInvert;
+}
+
+void QueuedStepper::moveTo(long absolute)
+{
+  target = absolute;
+  syncProfile = nullptr;
+}
+
+// Moves to absolute with step timing taken from a profile shared with other
+// axes. Steps still queued from earlier motion are dropped so the profile
+// starts from a known position.
+void QueuedStepper::moveToSynchronized(long absolute, const SyncProfile &profile)
+{
+  requestFlush();
+  target = absolute;
+  syncProfile = &profile;
+  syncStarted = false;
+}
+
+void QueuedStepper::move(long relative)
+{
+  moveTo(currentPosition() + relative);
+}
+
+long QueuedStepper::currentPosition()
+{
+  syncFlush();
+  if (hasPendingPosition)
+  {
+    return pendingPosition;
+  }
+  return channel.position.load(std::memory_order_relaxed) + positionOffset;
+}
+
+long QueuedStepper::distanceToGo()
+{
+  return target - currentPosition();
+}
+
+void QueuedStepper::setCurrentPosition(long position)
+{
+  requestFlush();
+  pendingPosition = position;
+  hasPendingPosition = true;
+  syncProfile = nullptr;
+  target = position;
+  speedValue = 0.0f;
+}
+
+// Drops queued-but-unemitted steps so the axis halts within one step, then
+// decelerates toward a stopping point if the caller keeps calling run().
+void QueuedStepper::stop()
+{
+  requestFlush();
+  syncProfile = nullptr;
+  if (speedValue != 0.0f)
+  {
+    long stepsToStop = (long)((speedValue * speedValue) / (2.0f * accelValue)) + 1;
+    target = currentPosition() + (speedValue > 0.0f ? stepsToStop : -stepsToStop);
+  }
+}
+
+bool QueuedStepper::isRunning()
+{
+  return speedValue != 0.0f || distanceToGo() != 0 || !channel.queue.empty();
+}
+
+void QueuedStepper::requestFlush()
+{
+  channel.flushRequest.fetch_add(1, std::memory_order_release);
+  flushPending = true;
+}
+
+// Returns true once the ISR has acknowledged any pending flush
+bool QueuedStepper::syncFlush()
+{
+  if (!flushPending)
+  {
+    return true;
+  }
+  if (channel.flushAck.load(std::memory_order_acquire) != channel.flushRequest.load(std::memory_order_relaxed))
+  {
+    return false;
+  }
+  flushPending = false;
+  long emitted = channel.position.load(std::memory_order_relaxed);
+  if (hasPendingPosition)
+  {
+    positionOffset = pendingPosition - emitted;
+    hasPendingPosition = false;
+  }
+  plannedPosition = emitted + positionOffset;
+  lastDueUs = engine.now();
+  return true;
+}
+
+// Keeps lastDueUs within wrap-safe range after the axis has been idle
+void QueuedStepper::anchorTimeline(uint32_t nowUs)
+{
+  if (channel.queue.empty() && nowUs - lastDueUs > 1000000UL)
+  {
+    lastDueUs = nowUs - 1000000UL;
+  }
+}
+
+bool QueuedStepper::queueStep(int8_t direction, float stepSpeed, uint32_t nowUs)
+{
+  uint32_t interval = (uint32_t)(1000000.0f / fabsf(stepSpeed));
+  uint32_t due = lastDueUs + interval;
+  if ((int32_t)(due - nowUs) < 0)
+  {
+    due = nowUs;
+  }
+  if ((int32_t)(due - nowUs) > (int32_t)STEP_LOOKAHEAD_US)
+  {
+    return false;
+  }
+  StepEvent ev = {due, direction};
+  if (!channel.queue.push(ev))
+  {
+    return false;
+  }
+  plannedPosition += direction;
+  lastDueUs = due;
+  return true;
+}
+
+// Plans accelerated steps toward target. Speed is updated per step using
+// v^2 = v0^2 +/- 2a, which gives the same trapezoid AccelStepper produces.
+bool QueuedStepper::run()
+{
+  if (!syncFlush())
+  {
+    return true;
+  }
+
+  uint32_t nowUs = engine.now();
+  if (syncProfile)
+  {
+    return runSynchronized(nowUs);
+  }
+  anchorTimeline(nowUs);
+  float startSpeed = sqrtf(2.0f * accelValue);
+  while (!channel.queue.full() && maxSpeedValue > 0.0f)
+  {
+    long dist = target - plannedPosition;
+    if (dist == 0)
+    {
+      speedValue = 0.0f;
+      break;
+    }
+
+    int8_t dir = dist > 0 ? 1 : -1;
+    float v = speedValue;
+    float vSquared = v * v;
+    bool sameDirection = (v > 0.0f && dir > 0) || (v < 0.0f && dir < 0);
+    float nextSpeed;
+    if (v == 0.0f)
+    {
+      nextSpeed = dir * startSpeed;
+    }
+    else if (!sameDirection)
+    {
+      // Moving away from target: brake, then reverse from rest
+      float slower = vSquared - 2.0f * accelValue;
+      if (slower > startSpeed * startSpeed)
+      {
+        nextSpeed = v > 0.0f ? sqrtf(slower) : -sqrtf(slower);
+      }
+      else
+      {
+        nextSpeed = dir * startSpeed;
+      }
+    }
+    else if (vSquared / (2.0f * accelValue) >= (float)labs(dist))
+    {
+      float slower = vSquared - 2.0f * accelValue;
+      nextSpeed = dir * (slower > startSpeed * startSpeed ? sqrtf(slower) : startSpeed);
+    }
+    else
+    {
+      nextSpeed = dir * sqrtf(vSquared + 2.0f * accelValue);
+    }
+
+    if (nextSpeed > maxSpeedValue)
+    {
+      nextSpeed = maxSpeedValue;
+    }
+    else if (nextSpeed < -maxSpeedValue)
+    {
+      nextSpeed = -maxSpeedValue;
+    }
+
+    int8_t stepDir = nextSpeed > 0.0f ? 1 : -1;
+    if (!queueStep(stepDir, nextSpeed, nowUs))
+    {
+      break;
+    }
+    speedValue = nextSpeed;
+  }
+
+  return speedValue != 0.0f || distanceToGo() != 0;
+}
+
+// Plans steps at the constant speed set by setSpeed()
+bool QueuedStepper::runSpeed()
+{
+  if (!syncFlush())
+  {
+    return true;
+  }
+  if (fabsf(speedValue) < 0.01f)
+  {
+    return false;
+  }
+
+  uint32_t nowUs = engine.now();
+  anchorTimeline(nowUs);
+  int8_t dir = speedValue > 0.0f ? 1 : -1;
+  bool queued = false;
+  while (!channel.queue.full() && queueStep(dir, speedValue, nowUs))
+  {
+    queued = true;
+  }
+  return queued;
+}
+
+bool QueuedStepper::runSynchronized(uint32_t nowUs)
+{
+  if (!syncStarted)
+  {
+    syncStart = plannedPosition;
+    syncSteps = target - plannedPosition;
+    syncStarted = true;
+  }
+
+  long total = labs(syncSteps);
+  int8_t dir = syncSteps > 0 ? 1 : -1;
+  while (!channel.queue.full())
+  {
+    long done = labs(plannedPosition - syncStart);
+    if (done >= total)
+    {
+      syncProfile = nullptr;
+      speedValue = 0.0f;
+      break;
+    }
+
+    float t = syncProfile->timeAt((float)(done + 1) / (float)total);
+    uint32_t due = syncProfile->startUs + (uint32_t)(t * 1000000.0f);
+    if ((int32_t)(due - nowUs) > (int32_t)STEP_LOOKAHEAD_US)
+    {
+      break;
+    }
+    StepEvent ev = {due, dir};
+    if (!channel.queue.push(ev))
+    {
+      break;
+    }
+    plannedPosition += dir;
+    lastDueUs = due;
+    speedValue = dir * syncProfile->rateAt(t) * total;
+  }
+  return distanceToGo() != 0;
+}
+
+void SyncProfile::plan(const long *distances, const float *maxSpeeds, const float *accels, uint8_t axes, uint32_t nowUs)
+{
+  startUs = nowUs;
+  peakRate = INFINITY;
+  accelRate = INFINITY;
+  for (uint8_t a = 0; a < axes; a++)
+  {
+    float d = (float)labs(distances[a]);
+    if (d > 0.0f)
+    {
+      peakRate = fminf(peakRate, maxSpeeds[a] / d);
+      accelRate = fminf(accelRate, accels[a] / d);
+    }
+  }
+  if (isinf(peakRate) || isinf(accelRate))
+  {
+    peakRate = 1.0f;
+    accelRate = 1.0f;
+    accelTime = 0.0f;
+    duration = 0.0f;
+    return;
+  }
+
+  // Triangle profile when there is no room to reach peak rate
+  if (peakRate * peakRate / accelRate > 1.0f)
+  {
+    peakRate = sqrtf(accelRate);
+  }
+  accelTime = peakRate / accelRate;
+  float accelProgress = 0.5f * accelRate * accelTime * accelTime;
+  duration = 2.0f * accelTime + (1.0f - 2.0f * accelProgress) / peakRate;
+}
+
+float SyncProfile::timeAt(float progress) const
+{
+  float accelProgress = 0.5f * accelRate * accelTime * accelTime;
+  if (progress <= accelProgress)
+  {
+    return sqrtf(2.0f * progress / accelRate);
+  }
+  if (progress < 1.0f - accelProgress)
+  {
+    return accelTime + (progress - accelProgress) / peakRate;
+  }
+  float remaining = 1.0f - progress;
+  return duration - sqrtf(2.0f * (remaining > 0.0f ? remaining : 0.0f) / accelRate);
+}
+
+float SyncProfile::rateAt(float t) const
+{
+  if (t < accelTime)
+  {
+    return accelRate * t;
+  }
+  if (t < duration - accelTime)
+  {
+    return peakRate;
+  }
+  float remaining = duration - t;
+  return remaining > 0.0f ? accelRate * remaining : 0.0f;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include "spsc_ring.h"
+
+#ifdef ESP32
+#include <esp_attr.h>
+#define STEP_ENGINE_ISR_ATTR IRAM_ATTR
+#else
+#define STEP_ENGINE_ISR_ATTR
+#endif
+
+// Timer-driven step pulse engine.
+// Motion code plans individual steps a few milliseconds ahead into a per-axis
+// queue; a hardware timer ISR (or the host simulation loop) calls service() and
+// emits each pulse at its due time, independent of motorTask scheduling.
+
+const uint8_t STEP_ENGINE_MAX_AXES = 2;
+const size_t STEP_QUEUE_DEPTH = 32;            // Per-axis queued steps (power of two)
+const uint32_t STEP_LOOKAHEAD_US = 10000;      // How far ahead of real time steps are planned
+const uint32_t STEP_IDLE_POLL_US = 100;        // Timer period while no steps are queued
+const uint32_t STEP_MIN_SERVICE_US = 5;        // Shortest timer re-arm interval
+const uint32_t STEP_DUE_SLACK_US = 2;          // Emit steps due within this window now
+
+// Output hooks used by service(). The ESP32 build toggles GPIOs, the host
+// simulation records a pulse trace.
+struct StepOutput
+{
+  void (*setDirection)(uint8_t axis, bool forward);
+  void (*stepHigh)(uint8_t axis, uint32_t nowUs);
+  void (*stepLow)(uint8_t axis);
+  void (*pulseDelay)(); // Holds STEP high / DIR setup long enough for the driver
+};
+
+struct StepEvent
+{
+  uint32_t dueUs;
+  int8_t direction; // +1 or -1
+};
+
+struct StepChannel
+{
+  SpscRing<StepEvent, STEP_QUEUE_DEPTH> queue;
+  std::atomic<int32_t> position{0}; // Steps actually emitted
+  std::atomic<uint32_t> flushRequest{0};
+  std::atomic<uint32_t> flushAck{0};
+  int8_t lastDirection = 0;
+  bool directionInverted = false;
+};
+
+class StepEngine
+{
+public:
+  void begin(const StepOutput &output, uint32_t (*clockUs)());
+
+  // Emits every step that is due and returns microseconds until the next one.
+  // Runs in the timer ISR on hardware.
+  uint32_t service(uint32_t nowUs);
+
+  StepChannel &channel(uint8_t axis) { return channels[axis]; }
+  uint32_t now() const { return clock(); }
+
+private:
+  StepChannel channels[STEP_ENGINE_MAX_AXES];
+  StepOutput out = {};
+  uint32_t (*clock)() = nullptr;
+};
+
+// Shared trapezoidal profile over normalized progress (0..1) for coordinated
+// multi-axis moves. Each axis places its k-th of N steps at timeAt(k/N), so all
+// axes start together and emit their final step at the same instant.
+struct SyncProfile
+{
+  uint32_t startUs;
+  float peakRate;   // progress/s
+  float accelRate;  // progress/s^2
+  float accelTime;  // s
+  float duration;   // s
+
+  // Picks the fastest profile that keeps every axis within its own limits
+  void plan(const long *distances, const float *maxSpeeds, const float *accels, uint8_t axes, uint32_t nowUs);
+  float timeAt(float progress) const;
+  float rateAt(float t) const;
+};
+
+// AccelStepper-compatible front end for one axis of the step engine.
+// run()/runSpeed() no longer toggle pins themselves; they plan steps up to
+// STEP_LOOKAHEAD_US ahead so pulse timing no longer depends on how often the
+// caller gets scheduled. currentPosition() reports steps actually emitted.
+class QueuedStepper
+{
+public:
+  QueuedStepper(StepEngine &engine, uint8_t axis);
+
+  void setMaxSpeed(float stepsPerSec);
+  float maxSpeed() const { return maxSpeedValue; }
+  void setAcceleration(float stepsPerSec2);
+  void setSpeed(float stepsPerSec);
+  float speed() const { return speedValue; }
+  void setPinsInverted(bool directionInvert, bool stepInvert, bool enableInvert);
+
+  float acceleration() const { return accelValue; }
+
+  void moveTo(long absolute);
+  void moveToSynchronized(long absolute, const SyncProfile &profile);
+  void move(long relative);
+  // Moves the target of the motion in progress without restarting it; a
+  // synchronized move plays out its profile and then covers the difference
+  // the way run() does
+  void shiftTarget(long steps) { target += steps; }
+  long targetPosition() const { return target; }
+  long currentPosition();
+  // currentPosition() units for a StepChannel::position sample, e.g. one an
+  // input ISR latched; not valid across a pending setCurrentPosition()
+  long positionFromEmitted(int32_t emitted) const { return emitted + positionOffset; }
+  long distanceToGo();
+  void setCurrentPosition(long position);
+
+  bool run();
+  bool runSpeed();
+  void stop();
+  bool isRunning();
+
+private:
+  void requestFlush();
+  bool syncFlush();
+  void anchorTimeline(uint32_t nowUs);
+  bool queueStep(int8_t direction, float stepSpeed, uint32_t nowUs);
+  bool runSynchronized(uint32_t nowUs);
+
+  StepEngine &engine;
+  StepChannel &channel;
+  float maxSpeedValue = 1.0f;
+  float accelValue = 1.0f;
+  float speedValue = 0.0f; // Signed speed of the last planned step
+  long target = 0;
+  long plannedPosition = 0; // Position once every queued step is emitted
+  long positionOffset = 0;
+  long pendingPosition = 0;
+  bool hasPendingPosition = false;
+  bool flushPending = false;
+  uint32_t lastDueUs = 0;
+  const SyncProfile *syncProfile = nullptr;
+  long syncStart = 0;
+  long syncSteps = 0;
+  bool syncStarted = false;
+};
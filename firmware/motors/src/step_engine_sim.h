@@ -0,0 +1,94 @@
+#pragma once
+
+#include "step_engine.h"
+
+// Host-side simulation backend for the step engine.
+// Replaces the hardware timer with a virtual clock and records every pulse so
+// step timing can be checked off-target.
+
+struct StepPulse
+{
+  uint8_t axis;
+  bool forward;
+  uint32_t timeUs;
+};
+
+const size_t STEP_SIM_TRACE_CAPACITY = 8192;
+
+struct StepSimState
+{
+  uint32_t clockUs = 0;
+  bool forward[STEP_ENGINE_MAX_AXES] = {};
+  StepPulse trace[STEP_SIM_TRACE_CAPACITY];
+  size_t traceCount = 0;
+};
+
+inline StepSimState &stepSim()
+{
+  static StepSimState state;
+  return state;
+}
+
+inline uint32_t stepSimClock()
+{
+  return stepSim().clockUs;
+}
+
+inline void stepSimSetDirection(uint8_t axis, bool forward)
+{
+  stepSim().forward[axis] = forward;
+}
+
+inline void stepSimStepHigh(uint8_t axis, uint32_t nowUs)
+{
+  StepSimState &sim = stepSim();
+  if (sim.traceCount < STEP_SIM_TRACE_CAPACITY)
+  {
+    sim.trace[sim.traceCount++] = {axis, sim.forward[axis], nowUs};
+  }
+}
+
+inline void stepSimStepLow(uint8_t axis)
+{
+  (void)axis;
+}
+
+inline void stepSimPulseDelay()
+{
+}
+
+inline void beginStepSim(StepEngine &engine)
+{
+  stepSim() = StepSimState();
+  StepOutput output = {stepSimSetDirection, stepSimStepHigh, stepSimStepLow, stepSimPulseDelay};
+  engine.begin(output, stepSimClock);
+}
+
+// Advances virtual time to untilUs, servicing the engine exactly when the
+// hardware timer would fire. onTick runs every tickUs of simulated time and
+// stands in for motorTask.
+template <typename TickFn>
+void runStepSim(StepEngine &engine, uint32_t untilUs, uint32_t tickUs, TickFn onTick)
+{
+  StepSimState &sim = stepSim();
+  uint32_t nextService = sim.clockUs;
+  uint32_t nextTick = sim.clockUs;
+  while ((int32_t)(untilUs - sim.clockUs) > 0)
+  {
+    if ((int32_t)(nextTick - nextService) <= 0)
+    {
+      sim.clockUs = nextTick;
+      onTick();
+      nextTick += tickUs;
+      if ((int32_t)(nextService - sim.clockUs) < 0)
+      {
+        nextService = sim.clockUs;
+      }
+    }
+    else
+    {
+      sim.clockUs = nextService;
+      nextService = sim.clockUs + engine.service(sim.clockUs);
+    }
+  }
+}
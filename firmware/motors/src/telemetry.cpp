@@ -0,0 +1,341 @@
+#include "telemetry.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include "turret_protocol.h"
+
+namespace
+{
+  const int MAX_DEPTH = 4;
+
+  // Appends JSON into a fixed buffer; any overflow poisons the whole write
+  class JsonWriter
+  {
+  public:
+    JsonWriter(char *buffer, size_t capacity) : out(buffer), cap(capacity) {}
+
+    void openRoot()
+    {
+      append("{");
+      first[0] = true;
+    }
+
+    void open(const char *name)
+    {
+      key(name);
+      append("{");
+      if (depth + 1 < MAX_DEPTH)
+      {
+        first[++depth] = true;
+      }
+    }
+
+    void close()
+    {
+      append("}");
+      if (depth > 0)
+      {
+        depth--;
+      }
+    }
+
+    void boolean(const char *name, bool value)
+    {
+      key(name);
+      append(value ? "true" : "false");
+    }
+
+    void number(const char *name, float value)
+    {
+      key(name);
+      append("%.2f", value);
+    }
+
+    void integer(const char *name, int32_t value)
+    {
+      key(name);
+      append("%ld", (long)value);
+    }
+
+    void unsignedInteger(const char *name, uint64_t value)
+    {
+      key(name);
+      append("%llu", (unsigned long long)value);
+    }
+
+    void string(const char *name, const char *value)
+    {
+      key(name);
+      append("\"");
+      escaped(value);
+      append("\"");
+    }
+
+    void stringArray(const char *name, const char *const *values, size_t count)
+    {
+      key(name);
+      append("[");
+      for (size_t i = 0; i < count; i++)
+      {
+        append(i == 0 ? "\"" : ",\"");
+        escaped(values[i]);
+        append("\"");
+      }
+      append("]");
+    }
+
+    size_t finish()
+    {
+      return overflow ? 0 : len;
+    }
+
+  private:
+    void key(const char *name)
+    {
+      if (!first[depth])
+      {
+        append(",");
+      }
+      first[depth] = false;
+      append("\"%s\":", name);
+    }
+
+    void escaped(const char *text)
+    {
+      for (const char *c = text ? text : ""; *c; c++)
+      {
+        if (*c == '"' || *c == '\\')
+        {
+          append("\\%c", *c);
+        }
+        else if ((unsigned char)*c < 0x20)
+        {
+          append("\\u%04x", (unsigned)(unsigned char)*c);
+        }
+        else
+        {
+          append("%c", *c);
+        }
+      }
+    }
+
+    void append(const char *fmt, ...)
+    {
+      if (overflow)
+      {
+        return;
+      }
+      va_list args;
+      va_start(args, fmt);
+      int written = vsnprintf(out + len, cap - len, fmt, args);
+      va_end(args);
+      if (written < 0 || (size_t)written >= cap - len)
+      {
+        overflow = true;
+        return;
+      }
+      len += written;
+    }
+
+    char *out;
+    size_t cap;
+    size_t len = 0;
+    bool overflow = false;
+    bool first[MAX_DEPTH] = {true, true, true, true};
+    int depth = 0;
+  };
+
+  bool angleChanged(float current, float baseline)
+  {
+    return fabsf(current - baseline) >= TELEMETRY_ANGLE_EPSILON;
+  }
+
+  bool flagsChanged(uint16_t current, uint16_t baseline, uint16_t mask)
+  {
+    return ((current ^ baseline) & mask) != 0;
+  }
+}
+
+bool telemetryChanged(const TelemetryState &current, const TelemetryState &baseline)
+{
+  return angleChanged(current.horizontalAngle, baseline.horizontalAngle) ||
+         angleChanged(current.verticalAngle, baseline.verticalAngle) ||
+         current.horizontalPosition != baseline.horizontalPosition ||
+         current.verticalPosition != baseline.verticalPosition ||
+         current.flags != baseline.flags ||
+         current.coordinated != baseline.coordinated ||
+         current.tracking != baseline.tracking;
+}
+
+size_t encodeTelemetryJson(const TelemetryState &current, TelemetryState *baseline,
+                           const TelemetryEvents &events, const char *const *errors, size_t errorCount,
+                           char *out, size_t capacity)
+{
+  bool full = baseline == nullptr;
+  bool hasEvents = events.movementComplete || events.calibrationComplete;
+  bool changed = full || telemetryChanged(current, *baseline);
+  if (!changed && !hasEvents && !errors)
+  {
+    return 0;
+  }
+
+  TelemetryState prev = full ? current : *baseline;
+  JsonWriter w(out, capacity);
+  w.openRoot();
+
+  if (changed)
+  {
+    w.open(full ? "status" : "statusDelta");
+    if (full || flagsChanged(current.flags, prev.flags, STATUS_CALIBRATED))
+    {
+      w.boolean("calibrated", current.flags & STATUS_CALIBRATED);
+    }
+    if (full || flagsChanged(current.flags, prev.flags, STATUS_CALIBRATING))
+    {
+      w.boolean("calibrating", current.flags & STATUS_CALIBRATING);
+    }
+
+    bool hAngle = full || angleChanged(current.horizontalAngle, prev.horizontalAngle);
+    bool vAngle = full || angleChanged(current.verticalAngle, prev.verticalAngle);
+    if (hAngle || vAngle)
+    {
+      w.open("angles");
+      if (hAngle)
+      {
+        w.number("horizontal", current.horizontalAngle);
+        prev.horizontalAngle = current.horizontalAngle;
+      }
+      if (vAngle)
+      {
+        w.number("vertical", current.verticalAngle);
+        prev.verticalAngle = current.verticalAngle;
+      }
+      w.close();
+    }
+
+    bool hPos = full || current.horizontalPosition != prev.horizontalPosition;
+    bool vPos = full || current.verticalPosition != prev.verticalPosition;
+    if (hPos || vPos)
+    {
+      w.open("positions");
+      if (hPos)
+      {
+        w.integer("horizontal", current.horizontalPosition);
+      }
+      if (vPos)
+      {
+        w.integer("vertical", current.verticalPosition);
+      }
+      w.close();
+    }
+
+    const uint16_t movementMask = STATUS_ANGULAR_IN_PROGRESS | STATUS_IS_MOVING;
+    if (full || flagsChanged(current.flags, prev.flags, movementMask) || current.coordinated != prev.coordinated)
+    {
+      w.open("movement");
+      if (full || flagsChanged(current.flags, prev.flags, STATUS_ANGULAR_IN_PROGRESS))
+      {
+        w.boolean("angularInProgress", current.flags & STATUS_ANGULAR_IN_PROGRESS);
+      }
+      if (full || flagsChanged(current.flags, prev.flags, STATUS_IS_MOVING))
+      {
+        w.boolean("isMoving", current.flags & STATUS_IS_MOVING);
+      }
+      if (full || current.coordinated != prev.coordinated)
+      {
+        w.boolean("coordinated", current.coordinated);
+      }
+      w.close();
+    }
+
+    const uint16_t sensorMask = STATUS_YAW_HOME | STATUS_TILT_UP | STATUS_TILT_DOWN;
+    if (full || flagsChanged(current.flags, prev.flags, sensorMask))
+    {
+      w.open("sensors");
+      if (full || flagsChanged(current.flags, prev.flags, STATUS_YAW_HOME))
+      {
+        w.boolean("yawHome", current.flags & STATUS_YAW_HOME);
+      }
+      if (full || flagsChanged(current.flags, prev.flags, STATUS_TILT_UP))
+      {
+        w.boolean("tiltUp", current.flags & STATUS_TILT_UP);
+      }
+      if (full || flagsChanged(current.flags, prev.flags, STATUS_TILT_DOWN))
+      {
+        w.boolean("tiltDown", current.flags & STATUS_TILT_DOWN);
+      }
+      w.close();
+    }
+
+    if (full || flagsChanged(current.flags, prev.flags, STATUS_TRIGGER_ACTIVE))
+    {
+      w.boolean("triggerActive", current.flags & STATUS_TRIGGER_ACTIVE);
+    }
+    if (full || current.tracking != prev.tracking)
+    {
+      w.boolean("tracking", current.tracking);
+    }
+    w.close();
+  }
+
+  if (events.movementComplete)
+  {
+    w.boolean("movementComplete", true);
+  }
+  if (events.calibrationComplete)
+  {
+    w.boolean("calibrationComplete", true);
+    w.boolean("yawHomed", events.yawHomed);
+    w.boolean("tiltCalibrated", events.tiltCalibrated);
+  }
+  if (errors)
+  {
+    w.stringArray("errors", errors, errorCount);
+  }
+  w.close();
+
+  size_t len = w.finish();
+  if (len > 0 && baseline)
+  {
+    // Angles keep their old baseline unless written; everything else is exact
+    prev.horizontalPosition = current.horizontalPosition;
+    prev.verticalPosition = current.verticalPosition;
+    prev.flags = current.flags;
+    prev.coordinated = current.coordinated;
+    prev.tracking = current.tracking;
+    *baseline = prev;
+  }
+  return len;
+}
+
+size_t encodeShotJson(uint16_t pattern, uint8_t shot, uint8_t shots, uint64_t timeUs, uint32_t waitedMs,
+                      char *out, size_t capacity)
+{
+  JsonWriter w(out, capacity);
+  w.openRoot();
+  w.open("shot");
+  w.unsignedInteger("pattern", pattern);
+  w.unsignedInteger("shot", shot);
+  w.unsignedInteger("of", shots);
+  w.unsignedInteger("timeUs", timeUs);
+  w.unsignedInteger("waitedMs", waitedMs);
+  w.close();
+  w.close();
+  return w.finish();
+}
+
+size_t encodeDriftJson(const char *axis, int32_t steps, uint32_t corrections, int32_t totalSteps,
+                       char *out, size_t capacity)
+{
+  JsonWriter w(out, capacity);
+  w.openRoot();
+  w.open("driftCorrected");
+  w.string("axis", axis);
+  w.integer("steps", steps);
+  w.unsignedInteger("corrections", corrections);
+  w.integer("totalSteps", totalSteps);
+  w.close();
+  w.close();
+  return w.finish();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// JSON status encoding for the telemetry publisher.
+// A keyframe carries the full {"status": {...}} object the UI has always
+// received. A delta carries {"statusDelta": {...}} with the same nesting but
+// only the fields that changed since the previous publish. Everything is
+// written with snprintf into a caller-owned buffer, so publishing does not
+// touch the heap.
+
+const uint32_t TELEMETRY_MIN_RATE_HZ = 1;
+const uint32_t TELEMETRY_MAX_RATE_HZ = 50;
+const float TELEMETRY_ANGLE_EPSILON = 0.01f; // deg, matches the 2-decimal encoding
+const size_t TELEMETRY_BUFFER_SIZE = 768;
+
+struct TelemetryState
+{
+  float horizontalAngle;
+  float verticalAngle;
+  int32_t horizontalPosition;
+  int32_t verticalPosition;
+  uint16_t flags; // STATUS_* bits, event bits excluded
+  bool coordinated;
+  bool tracking;
+};
+
+// One-shot fields appended at the top level, as sendStatus() always has
+struct TelemetryEvents
+{
+  bool movementComplete;
+  bool calibrationComplete;
+  bool yawHomed;
+  bool tiltCalibrated;
+};
+
+// Event messages sent alongside the status stream from motorTask, written the
+// same way: {"shot": {...}} for each trigger pull and {"driftCorrected": {...}}
+// when missed steps are corrected at a reference.
+const size_t TELEMETRY_EVENT_BUFFER_SIZE = 160;
+
+bool telemetryChanged(const TelemetryState &current, const TelemetryState &baseline);
+
+// baseline == nullptr encodes a keyframe. Otherwise encodes a delta against
+// *baseline and updates it to what the receiver holds afterwards; angles that
+// moved less than TELEMETRY_ANGLE_EPSILON stay at their old baseline value so
+// small drifts still add up to a send. errors may be null.
+// Returns the length written, or 0 when there was nothing to send or it did not fit.
+size_t encodeTelemetryJson(const TelemetryState &current, TelemetryState *baseline,
+                           const TelemetryEvents &events, const char *const *errors, size_t errorCount,
+                           char *out, size_t capacity);
+
+// Return the length written, or 0 when it did not fit
+size_t encodeShotJson(uint16_t pattern, uint8_t shot, uint8_t shots, uint64_t timeUs, uint32_t waitedMs,
+                      char *out, size_t capacity);
+size_t encodeDriftJson(const char *axis, int32_t steps, uint32_t corrections, int32_t totalSteps,
+                       char *out, size_t capacity);
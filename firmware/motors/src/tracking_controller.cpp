@@ -0,0 +1,125 @@
+#include "tracking_controller.h"
+
+#include <math.h>
+
+namespace
+{
+  float clampf(float v, float limit)
+  {
+    if (v > limit)
+    {
+      return limit;
+    }
+    if (v < -limit)
+    {
+      return -limit;
+    }
+    return v;
+  }
+}
+
+void AxisTracker::setGains(const TrackingGains &newGains)
+{
+  gains = newGains;
+}
+
+void AxisTracker::reset()
+{
+  hasTarget = false;
+  hasRate = false;
+  target = 0.0f;
+  rate = 0.0f;
+  integral = 0.0f;
+  previousError = 0.0f;
+  output = 0.0f;
+}
+
+void AxisTracker::measure(float errorDeg, float aimDeg, uint32_t nowMs)
+{
+  float newTarget = aimDeg + errorDeg;
+  if (hasTarget && nowMs != measuredAtMs)
+  {
+    float dtSec = (nowMs - measuredAtMs) / 1000.0f;
+    float rawRate = (newTarget - target) / dtSec;
+    rate = hasRate ? rate + gains.rateFilter * (rawRate - rate) : rawRate;
+    hasRate = true;
+  }
+  target = newTarget;
+  measuredAtMs = nowMs;
+  hasTarget = true;
+}
+
+float AxisTracker::update(float aimDeg, uint32_t nowMs, float dt)
+{
+  if (!hasTarget || dt <= 0.0f)
+  {
+    return output;
+  }
+
+  float leadMs = (float)(nowMs - measuredAtMs);
+  if (leadMs > gains.maxLeadMs)
+  {
+    leadMs = gains.maxLeadMs;
+  }
+  float predicted = target + rate * (leadMs / 1000.0f);
+  float error = predicted - aimDeg;
+
+  integral = clampf(integral + error * dt, gains.integralLimit);
+  float derivative = (error - previousError) / dt;
+  previousError = error;
+
+  float desired = gains.kff * rate + gains.kp * error + gains.ki * integral + gains.kd * derivative;
+  desired = clampf(desired, gains.maxVelocity);
+
+  float maxStep = gains.maxAccel * dt;
+  output += clampf(desired - output, maxStep);
+  return output;
+}
+
+void TrackingController::configure(const TrackingGains &yawGains, const TrackingGains &tiltGains, uint32_t timeout)
+{
+  yaw.setGains(yawGains);
+  tilt.setGains(tiltGains);
+  timeoutMs = timeout;
+}
+
+void TrackingController::start(uint32_t nowMs)
+{
+  if (!running)
+  {
+    yaw.reset();
+    tilt.reset();
+  }
+  running = true;
+  lastMeasurementMs = nowMs;
+}
+
+void TrackingController::stop()
+{
+  running = false;
+  yaw.reset();
+  tilt.reset();
+}
+
+void TrackingController::measure(float yawErrorDeg, float tiltErrorDeg, float yawDeg, float tiltDeg, uint32_t nowMs)
+{
+  if (!running)
+  {
+    start(nowMs);
+  }
+  yaw.measure(yawErrorDeg, yawDeg, nowMs);
+  tilt.measure(tiltErrorDeg, tiltDeg, nowMs);
+  lastMeasurementMs = nowMs;
+}
+
+TrackingOutput TrackingController::update(float yawDeg, float tiltDeg, uint32_t nowMs, float dt)
+{
+  TrackingOutput out = {0.0f, 0.0f, running};
+  if (!running)
+  {
+    return out;
+  }
+  out.yawVelocity = yaw.update(yawDeg, nowMs, dt);
+  out.tiltVelocity = tilt.update(tiltDeg, nowMs, dt);
+  return out;
+}
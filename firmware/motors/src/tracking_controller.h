@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+
+// Visual-servo velocity controller for one axis.
+// Camera measurements arrive at frame rate (a few Hz to ~20 Hz) while update()
+// runs at the motor control rate. Between frames the target position is
+// predicted from its estimated angular rate, so the loop keeps closing on the
+// target instead of holding a stale error. Output is an axis velocity (deg/s)
+// made of rate feed-forward plus PID on the predicted error.
+
+struct TrackingGains
+{
+  float kp;              // 1/s
+  float ki;              // 1/s^2
+  float kd;              // unitless
+  float kff;             // Fraction of estimated target rate fed forward
+  float rateFilter;      // 0..1 smoothing of the target-rate estimate per frame
+  float maxLeadMs;       // Longest time the target is extrapolated past a frame
+  float integralLimit;   // deg*s
+  float maxVelocity;     // deg/s
+  float maxAccel;        // deg/s^2
+};
+
+class AxisTracker
+{
+public:
+  void setGains(const TrackingGains &gains);
+  void reset();
+
+  // errorDeg: target minus aim point at capture time; aimDeg: axis position then
+  void measure(float errorDeg, float aimDeg, uint32_t nowMs);
+
+  // Returns the commanded axis velocity in deg/s
+  float update(float aimDeg, uint32_t nowMs, float dt);
+
+  float targetRate() const { return rate; }
+  float lastError() const { return previousError; }
+
+private:
+  TrackingGains gains = {};
+  bool hasTarget = false;
+  bool hasRate = false;
+  float target = 0.0f;   // deg, axis frame
+  float rate = 0.0f;     // deg/s
+  uint32_t measuredAtMs = 0;
+  float integral = 0.0f;
+  float previousError = 0.0f;
+  float output = 0.0f;
+};
+
+struct TrackingOutput
+{
+  float yawVelocity;  // deg/s
+  float tiltVelocity; // deg/s
+  bool active;
+};
+
+class TrackingController
+{
+public:
+  void configure(const TrackingGains &yawGains, const TrackingGains &tiltGains, uint32_t timeoutMs);
+  void start(uint32_t nowMs);
+  void stop();
+
+  // Angular errors are target minus aim point at the time the frame was taken
+  void measure(float yawErrorDeg, float tiltErrorDeg, float yawDeg, float tiltDeg, uint32_t nowMs);
+  TrackingOutput update(float yawDeg, float tiltDeg, uint32_t nowMs, float dt);
+
+  bool active() const { return running; }
+  bool timedOut(uint32_t nowMs) const { return running && nowMs - lastMeasurementMs > timeoutMs; }
+  uint32_t lastMeasurement() const { return lastMeasurementMs; }
+  // Predicted aim errors at the last update(), deg
+  float yawError() const { return yaw.lastError(); }
+  float tiltError() const { return tilt.lastError(); }
+
+private:
+  AxisTracker yaw;
+  AxisTracker tilt;
+  uint32_t timeoutMs = 0;
+  uint32_t lastMeasurementMs = 0;
+  bool running = false;
+};
@@ -0,0 +1,415 @@
+#include "turret_protocol.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+  const size_t JOYSTICK_PAYLOAD = 4;
+  const size_t ANGLE_PAYLOAD = 8;
+  const size_t FIRE_PAYLOAD = 1;
+  const size_t STATUS_PAYLOAD = 19;
+  const size_t POSE_HISTORY_REQUEST_PAYLOAD = 10;
+  const size_t INTERCEPT_PAYLOAD = 26;
+  const size_t FIRE_PATTERN_PAYLOAD = 8;
+  const size_t MOVE_AND_FIRE_PAYLOAD = 10;
+  const uint8_t FIRE_PATTERN_ON_TARGET = 1 << 0;
+  const float JOYSTICK_SCALE = 32767.0f;
+
+  void putU16(uint8_t *p, uint16_t v)
+  {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+  }
+
+  void putU32(uint8_t *p, uint32_t v)
+  {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+    p[2] = (uint8_t)((v >> 16) & 0xFF);
+    p[3] = (uint8_t)(v >> 24);
+  }
+
+  void putU64(uint8_t *p, uint64_t v)
+  {
+    putU32(p, (uint32_t)v);
+    putU32(p + 4, (uint32_t)(v >> 32));
+  }
+
+  void putF32(uint8_t *p, float v)
+  {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    putU32(p, bits);
+  }
+
+  uint16_t getU16(const uint8_t *p)
+  {
+    return (uint16_t)(p[0] | (p[1] << 8));
+  }
+
+  uint32_t getU32(const uint8_t *p)
+  {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  }
+
+  uint64_t getU64(const uint8_t *p)
+  {
+    return (uint64_t)getU32(p) | ((uint64_t)getU32(p + 4) << 32);
+  }
+
+  float getF32(const uint8_t *p)
+  {
+    uint32_t bits = getU32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+  }
+
+  int16_t joystickToWire(float v)
+  {
+    if (!(v == v))
+    {
+      return 0;
+    }
+    if (v > 1.0f)
+    {
+      v = 1.0f;
+    }
+    else if (v < -1.0f)
+    {
+      v = -1.0f;
+    }
+    return (int16_t)lroundf(v * JOYSTICK_SCALE);
+  }
+
+  float joystickFromWire(int16_t v)
+  {
+    float f = v / JOYSTICK_SCALE;
+    return f < -1.0f ? -1.0f : f;
+  }
+
+  size_t payloadSize(uint8_t type)
+  {
+    switch (type)
+    {
+    case FRAME_JOYSTICK:
+      return JOYSTICK_PAYLOAD;
+    case FRAME_MOVE_TO_ANGLE:
+    case FRAME_MOVE_BY_ANGLE:
+      return ANGLE_PAYLOAD;
+    case FRAME_FIRE:
+      return FIRE_PAYLOAD;
+    case FRAME_HOME:
+    case FRAME_CALIBRATE:
+      return 0;
+    case FRAME_POSE_HISTORY_REQUEST:
+      return POSE_HISTORY_REQUEST_PAYLOAD;
+    case FRAME_INTERCEPT:
+      return INTERCEPT_PAYLOAD;
+    case FRAME_FIRE_PATTERN:
+      return FIRE_PATTERN_PAYLOAD;
+    case FRAME_MOVE_TO_ANGLE_AND_FIRE:
+      return MOVE_AND_FIRE_PAYLOAD;
+    case FRAME_STATUS:
+      return STATUS_PAYLOAD;
+    default:
+      return (size_t)-1;
+    }
+  }
+
+  DecodeResult checkHeader(const uint8_t *data, size_t len)
+  {
+    if (!data || len < PROTOCOL_HEADER_SIZE)
+    {
+      return DECODE_TOO_SHORT;
+    }
+    if (data[0] != PROTOCOL_MAGIC)
+    {
+      return DECODE_BAD_MAGIC;
+    }
+    if (data[1] != PROTOCOL_VERSION)
+    {
+      return DECODE_BAD_VERSION;
+    }
+    size_t expected = payloadSize(data[2]);
+    if (expected == (size_t)-1)
+    {
+      return DECODE_UNKNOWN_TYPE;
+    }
+    if (len != PROTOCOL_HEADER_SIZE + expected)
+    {
+      return DECODE_BAD_LENGTH;
+    }
+    return DECODE_OK;
+  }
+
+  void putHeader(uint8_t *out, FrameType type)
+  {
+    out[0] = PROTOCOL_MAGIC;
+    out[1] = PROTOCOL_VERSION;
+    out[2] = type;
+  }
+}
+
+size_t encodeCommand(const TurretCommand &cmd, uint8_t *out, size_t outSize)
+{
+  size_t payload = payloadSize(cmd.type);
+  if (payload == (size_t)-1 || cmd.type == FRAME_STATUS || !out || outSize < PROTOCOL_HEADER_SIZE + payload)
+  {
+    return 0;
+  }
+
+  putHeader(out, cmd.type);
+  uint8_t *p = out + PROTOCOL_HEADER_SIZE;
+  switch (cmd.type)
+  {
+  case FRAME_JOYSTICK:
+    putU16(p, (uint16_t)joystickToWire(cmd.x));
+    putU16(p + 2, (uint16_t)joystickToWire(cmd.y));
+    break;
+  case FRAME_MOVE_TO_ANGLE:
+  case FRAME_MOVE_BY_ANGLE:
+    putF32(p, cmd.horizontal);
+    putF32(p + 4, cmd.vertical);
+    break;
+  case FRAME_FIRE:
+    p[0] = cmd.fireMode;
+    break;
+  case FRAME_POSE_HISTORY_REQUEST:
+    putU64(p, cmd.afterUs);
+    putU16(p + 8, cmd.maxSamples);
+    break;
+  case FRAME_INTERCEPT:
+    putF32(p, cmd.horizontal);
+    putF32(p + 4, cmd.vertical);
+    putF32(p + 8, cmd.horizontalRate);
+    putF32(p + 12, cmd.verticalRate);
+    putU64(p + 16, cmd.targetUs);
+    putU16(p + 24, cmd.flightMs);
+    break;
+  case FRAME_FIRE_PATTERN:
+    p[0] = cmd.firePattern.shots;
+    putU16(p + 1, cmd.firePattern.intervalMs);
+    putU16(p + 3, cmd.firePattern.maxRatePerMin);
+    p[5] = cmd.firePattern.onTarget ? FIRE_PATTERN_ON_TARGET : 0;
+    putU16(p + 6, cmd.firePattern.settleMs);
+    break;
+  case FRAME_MOVE_TO_ANGLE_AND_FIRE:
+    putF32(p, cmd.horizontal);
+    putF32(p + 4, cmd.vertical);
+    putU16(p + 8, cmd.firePattern.settleMs);
+    break;
+  default:
+    break;
+  }
+  return PROTOCOL_HEADER_SIZE + payload;
+}
+
+DecodeResult decodeCommand(const uint8_t *data, size_t len, TurretCommand &cmd)
+{
+  DecodeResult result = checkHeader(data, len);
+  if (result != DECODE_OK)
+  {
+    return result;
+  }
+  if (data[2] == FRAME_STATUS)
+  {
+    return DECODE_UNKNOWN_TYPE;
+  }
+
+  memset(&cmd, 0, sizeof(cmd));
+  cmd.type = (FrameType)data[2];
+  const uint8_t *p = data + PROTOCOL_HEADER_SIZE;
+  switch (cmd.type)
+  {
+  case FRAME_JOYSTICK:
+    cmd.x = joystickFromWire((int16_t)getU16(p));
+    cmd.y = joystickFromWire((int16_t)getU16(p + 2));
+    break;
+  case FRAME_MOVE_TO_ANGLE:
+  case FRAME_MOVE_BY_ANGLE:
+    cmd.horizontal = getF32(p);
+    cmd.vertical = getF32(p + 4);
+    if (!isfinite(cmd.horizontal) || !isfinite(cmd.vertical))
+    {
+      return DECODE_BAD_VALUE;
+    }
+    break;
+  case FRAME_FIRE:
+    if (p[0] != FIRE_SINGLE && p[0] != FIRE_BURST && p[0] != FIRE_CANCEL)
+    {
+      return DECODE_BAD_VALUE;
+    }
+    cmd.fireMode = (FireMode)p[0];
+    break;
+  case FRAME_POSE_HISTORY_REQUEST:
+    cmd.afterUs = getU64(p);
+    cmd.maxSamples = getU16(p + 8);
+    break;
+  case FRAME_INTERCEPT:
+    cmd.horizontal = getF32(p);
+    cmd.vertical = getF32(p + 4);
+    cmd.horizontalRate = getF32(p + 8);
+    cmd.verticalRate = getF32(p + 12);
+    cmd.targetUs = getU64(p + 16);
+    cmd.flightMs = getU16(p + 24);
+    if (!isfinite(cmd.horizontal) || !isfinite(cmd.vertical) || !isfinite(cmd.horizontalRate) ||
+        !isfinite(cmd.verticalRate))
+    {
+      return DECODE_BAD_VALUE;
+    }
+    break;
+  case FRAME_FIRE_PATTERN:
+    cmd.firePattern.shots = p[0];
+    cmd.firePattern.intervalMs = getU16(p + 1);
+    cmd.firePattern.maxRatePerMin = getU16(p + 3);
+    cmd.firePattern.onTarget = (p[5] & FIRE_PATTERN_ON_TARGET) != 0;
+    cmd.firePattern.settleMs = getU16(p + 6);
+    if (cmd.firePattern.shots == 0 || cmd.firePattern.shots > FIRE_MAX_SHOTS ||
+        cmd.firePattern.settleMs > FIRE_MAX_SETTLE_MS)
+    {
+      return DECODE_BAD_VALUE;
+    }
+    break;
+  case FRAME_MOVE_TO_ANGLE_AND_FIRE:
+    cmd.horizontal = getF32(p);
+    cmd.vertical = getF32(p + 4);
+    cmd.firePattern.shots = 1;
+    cmd.firePattern.onTarget = true;
+    cmd.firePattern.settleMs = getU16(p + 8);
+    if (!isfinite(cmd.horizontal) || !isfinite(cmd.vertical) || cmd.firePattern.settleMs > FIRE_MAX_SETTLE_MS)
+    {
+      return DECODE_BAD_VALUE;
+    }
+    break;
+  default:
+    break;
+  }
+  return DECODE_OK;
+}
+
+size_t encodeStatus(const TurretStatus &status, uint8_t *out, size_t outSize)
+{
+  if (!out || outSize < PROTOCOL_HEADER_SIZE + STATUS_PAYLOAD)
+  {
+    return 0;
+  }
+  putHeader(out, FRAME_STATUS);
+  uint8_t *p = out + PROTOCOL_HEADER_SIZE;
+  putU16(p, status.flags);
+  putF32(p + 2, status.horizontalAngle);
+  putF32(p + 6, status.verticalAngle);
+  putU32(p + 10, (uint32_t)status.horizontalPosition);
+  putU32(p + 14, (uint32_t)status.verticalPosition);
+  p[18] = status.errorCount;
+  return PROTOCOL_HEADER_SIZE + STATUS_PAYLOAD;
+}
+
+DecodeResult decodeStatus(const uint8_t *data, size_t len, TurretStatus &status)
+{
+  DecodeResult result = checkHeader(data, len);
+  if (result != DECODE_OK)
+  {
+    return result;
+  }
+  if (data[2] != FRAME_STATUS)
+  {
+    return DECODE_UNKNOWN_TYPE;
+  }
+  const uint8_t *p = data + PROTOCOL_HEADER_SIZE;
+  status.flags = getU16(p);
+  status.horizontalAngle = getF32(p + 2);
+  status.verticalAngle = getF32(p + 6);
+  status.horizontalPosition = (int32_t)getU32(p + 10);
+  status.verticalPosition = (int32_t)getU32(p + 14);
+  status.errorCount = p[18];
+  return DECODE_OK;
+}
+
+size_t encodePoseHistory(const PoseSample *samples, size_t count, uint8_t flags, uint8_t *out, size_t outSize)
+{
+  if (!out || count > 0xFFFF || (count > 0 && !samples) ||
+      outSize < POSE_HISTORY_HEADER_SIZE + count * POSE_HISTORY_SAMPLE_SIZE)
+  {
+    return 0;
+  }
+  putHeader(out, FRAME_POSE_HISTORY);
+  uint8_t *p = out + PROTOCOL_HEADER_SIZE;
+  uint64_t baseUs = count > 0 ? samples[0].timeUs : 0;
+  p[0] = flags;
+  putU16(p + 1, (uint16_t)count);
+  putU64(p + 3, baseUs);
+  p = out + POSE_HISTORY_HEADER_SIZE;
+  for (size_t i = 0; i < count; i++, p += POSE_HISTORY_SAMPLE_SIZE)
+  {
+    putU32(p, (uint32_t)(samples[i].timeUs - baseUs));
+    putU32(p + 4, (uint32_t)samples[i].yawSteps);
+    putU32(p + 8, (uint32_t)samples[i].tiltSteps);
+    putU16(p + 12, (uint16_t)samples[i].yawStepsPerSec);
+    putU16(p + 14, (uint16_t)samples[i].tiltStepsPerSec);
+  }
+  return POSE_HISTORY_HEADER_SIZE + count * POSE_HISTORY_SAMPLE_SIZE;
+}
+
+// Variable length, so checked here rather than by checkHeader()
+DecodeResult decodePoseHistory(const uint8_t *data, size_t len, uint8_t &flags, size_t &count,
+                               PoseSample *samples, size_t capacity)
+{
+  if (!data || len < POSE_HISTORY_HEADER_SIZE)
+  {
+    return DECODE_TOO_SHORT;
+  }
+  if (data[0] != PROTOCOL_MAGIC)
+  {
+    return DECODE_BAD_MAGIC;
+  }
+  if (data[1] != PROTOCOL_VERSION)
+  {
+    return DECODE_BAD_VERSION;
+  }
+  if (data[2] != FRAME_POSE_HISTORY)
+  {
+    return DECODE_UNKNOWN_TYPE;
+  }
+  const uint8_t *p = data + PROTOCOL_HEADER_SIZE;
+  flags = p[0];
+  count = getU16(p + 1);
+  uint64_t baseUs = getU64(p + 3);
+  if (len != POSE_HISTORY_HEADER_SIZE + count * POSE_HISTORY_SAMPLE_SIZE)
+  {
+    return DECODE_BAD_LENGTH;
+  }
+  p = data + POSE_HISTORY_HEADER_SIZE;
+  for (size_t i = 0; i < count && i < capacity; i++, p += POSE_HISTORY_SAMPLE_SIZE)
+  {
+    samples[i].timeUs = baseUs + getU32(p);
+    samples[i].yawSteps = (int32_t)getU32(p + 4);
+    samples[i].tiltSteps = (int32_t)getU32(p + 8);
+    samples[i].yawStepsPerSec = (int16_t)getU16(p + 12);
+    samples[i].tiltStepsPerSec = (int16_t)getU16(p + 14);
+  }
+  return DECODE_OK;
+}
+
+const char *decodeResultName(DecodeResult result)
+{
+  switch (result)
+  {
+  case DECODE_OK:
+    return "ok";
+  case DECODE_TOO_SHORT:
+    return "frame too short";
+  case DECODE_BAD_MAGIC:
+    return "bad magic";
+  case DECODE_BAD_VERSION:
+    return "unsupported protocol version";
+  case DECODE_UNKNOWN_TYPE:
+    return "unknown frame type";
+  case DECODE_BAD_LENGTH:
+    return "bad frame length";
+  case DECODE_BAD_VALUE:
+    return "bad field value";
+  }
+  return "unknown";
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fire_control.h"
+#include "pose_history.h"
+
+// Compact binary WebSocket protocol, carried alongside the JSON commands.
+// Every frame starts with a 3-byte header: magic, protocol version, frame type.
+// Multi-byte fields are little-endian; angles are IEEE-754 float32.
+//
+//   JOYSTICK      int16 x, int16 y (full scale = +/-1.0)
+//   MOVE_TO_ANGLE float32 horizontal, float32 vertical
+//   MOVE_BY_ANGLE float32 horizontal, float32 vertical
+//   FIRE          uint8 mode (0 = single, 1 = burst, 2 = cancel queued shots)
+//   HOME          (no payload)
+//   CALIBRATE     (no payload)
+//   POSE_HISTORY_REQUEST
+//                 uint64 afterUs, uint16 maxSamples (0 = as many as fit)
+//   INTERCEPT     float32 horizontal, float32 vertical, float32 hRate,
+//                 float32 vRate, uint64 timeUs (0 = now), uint16 flightMs
+//   FIRE_PATTERN  uint8 shots, uint16 intervalMs, uint16 maxRatePerMin
+//                 (0 = trigger cycle only), uint8 flags (bit 0 = on target),
+//                 uint16 settleMs
+//   MOVE_TO_ANGLE_AND_FIRE
+//                 float32 horizontal, float32 vertical, uint16 settleMs
+//   STATUS        uint16 flags, float32 hAngle, float32 vAngle,
+//                 int32 hPos, int32 vPos, uint8 errorCount
+//   POSE_HISTORY  uint8 flags, uint16 count, uint64 baseUs, then count x
+//                 {uint32 timeUs - baseUs, int32 yawSteps, int32 tiltSteps,
+//                  int16 yawStepsPerSec, int16 tiltStepsPerSec}
+//
+// POSE_HISTORY answers a request with the recorded poses after afterUs,
+// oldest first; a client pages through the history by asking again from the
+// last time it got while POSE_HISTORY_MORE is set.
+
+const uint8_t PROTOCOL_MAGIC = 0xA5;
+const uint8_t PROTOCOL_VERSION = 1;
+const size_t PROTOCOL_HEADER_SIZE = 3;
+const size_t PROTOCOL_MAX_FRAME_SIZE = 32;
+
+enum FrameType : uint8_t
+{
+  FRAME_JOYSTICK = 0x01,
+  FRAME_MOVE_TO_ANGLE = 0x02,
+  FRAME_MOVE_BY_ANGLE = 0x03,
+  FRAME_FIRE = 0x04,
+  FRAME_HOME = 0x05,
+  FRAME_CALIBRATE = 0x06,
+  FRAME_POSE_HISTORY_REQUEST = 0x07,
+  FRAME_INTERCEPT = 0x08,
+  FRAME_FIRE_PATTERN = 0x09,
+  FRAME_MOVE_TO_ANGLE_AND_FIRE = 0x0A,
+  FRAME_STATUS = 0x80,
+  FRAME_POSE_HISTORY = 0x81,
+};
+
+enum FireMode : uint8_t
+{
+  FIRE_SINGLE = 0,
+  FIRE_BURST = 1,
+  FIRE_CANCEL = 2,
+};
+
+enum DecodeResult
+{
+  DECODE_OK = 0,
+  DECODE_TOO_SHORT,
+  DECODE_BAD_MAGIC,
+  DECODE_BAD_VERSION,
+  DECODE_UNKNOWN_TYPE,
+  DECODE_BAD_LENGTH,
+  DECODE_BAD_VALUE,
+};
+
+struct TurretCommand
+{
+  FrameType type;
+  float x;          // JOYSTICK
+  float y;          // JOYSTICK
+  float horizontal; // MOVE_TO_ANGLE(_AND_FIRE) / MOVE_BY_ANGLE / INTERCEPT
+  float vertical;   // MOVE_TO_ANGLE(_AND_FIRE) / MOVE_BY_ANGLE / INTERCEPT
+  float horizontalRate; // INTERCEPT, deg/s
+  float verticalRate;   // INTERCEPT, deg/s
+  uint64_t targetUs;    // INTERCEPT
+  uint16_t flightMs;    // INTERCEPT
+  FireMode fireMode;
+  FirePattern firePattern; // FIRE_PATTERN; the arrival shot for MOVE_TO_ANGLE_AND_FIRE
+  uint64_t afterUs;     // POSE_HISTORY_REQUEST
+  uint16_t maxSamples;  // POSE_HISTORY_REQUEST
+};
+
+// Status flag bits
+const uint16_t STATUS_CALIBRATED = 1 << 0;
+const uint16_t STATUS_CALIBRATING = 1 << 1;
+const uint16_t STATUS_ANGULAR_IN_PROGRESS = 1 << 2;
+const uint16_t STATUS_IS_MOVING = 1 << 3;
+const uint16_t STATUS_YAW_HOME = 1 << 4;
+const uint16_t STATUS_TILT_UP = 1 << 5;
+const uint16_t STATUS_TILT_DOWN = 1 << 6;
+const uint16_t STATUS_TRIGGER_ACTIVE = 1 << 7;
+const uint16_t STATUS_MOVEMENT_COMPLETE = 1 << 8;
+const uint16_t STATUS_CALIBRATION_COMPLETE = 1 << 9;
+const uint16_t STATUS_YAW_HOMED = 1 << 10;
+const uint16_t STATUS_TILT_CALIBRATED = 1 << 11;
+
+struct TurretStatus
+{
+  uint16_t flags;
+  float horizontalAngle;
+  float verticalAngle;
+  int32_t horizontalPosition;
+  int32_t verticalPosition;
+  uint8_t errorCount;
+};
+
+// Pose history frame flag bits
+const uint8_t POSE_HISTORY_MORE = 1 << 0; // Newer samples did not fit
+const size_t POSE_HISTORY_HEADER_SIZE = PROTOCOL_HEADER_SIZE + 11;
+const size_t POSE_HISTORY_SAMPLE_SIZE = 16;
+
+// Encoders return the number of bytes written, or 0 if out is too small.
+size_t encodeCommand(const TurretCommand &cmd, uint8_t *out, size_t outSize);
+size_t encodeStatus(const TurretStatus &status, uint8_t *out, size_t outSize);
+// Sample times must lie within 2^32 us of the first one
+size_t encodePoseHistory(const PoseSample *samples, size_t count, uint8_t flags, uint8_t *out, size_t outSize);
+
+DecodeResult decodeCommand(const uint8_t *data, size_t len, TurretCommand &cmd);
+DecodeResult decodeStatus(const uint8_t *data, size_t len, TurretStatus &status);
+// count is the number of samples in the frame; at most capacity are decoded
+DecodeResult decodePoseHistory(const uint8_t *data, size_t len, uint8_t &flags, size_t &count,
+                               PoseSample *samples, size_t capacity);
+
+const char *decodeResultName(DecodeResult result);
@@ -0,0 +1,358 @@
+#include <unity.h>
+
+#include "calibration.h"
+#include "step_engine.h"
+#include "step_engine_sim.h"
+
+// Drives CalibrationSequencer against simulated hall sensor and limit switch
+// inputs. The world is in emitted-step coordinates, which setCurrentPosition()
+// never moves, so a re-zeroed axis can be checked against where its sensors
+// physically are. The hall sensor edges are latched from the step output
+// hook, the way the firmware's sensor interrupt latches them.
+
+const uint32_t MOTOR_TASK_PERIOD_US = 1000;
+
+// Settings main.cpp derives from its axis configs
+const CalibrationConfig CONFIG = {44, 2400, 51, 1037, 51, 150.0f, 600.0f, 600.0f, 140.0f, 300.0f, 150, 50, 15000};
+
+struct World
+{
+  long magnetLow;  // Hall sensor active for emitted yaw steps in [magnetLow, magnetHigh]
+  long magnetHigh;
+  long downLimit;  // Down switch closed at or below this emitted tilt step
+  long upLimit;    // Up switch closed at or above this one
+};
+
+static StepEngine *engine;
+static QueuedStepper *yaw;
+static QueuedStepper *tilt;
+static World world;
+static bool homeWasActive;
+static bool homeEntered;
+static bool homeExited;
+static int32_t homeEnterSteps;
+static int32_t homeExitSteps;
+
+static int32_t emitted(uint8_t axis)
+{
+  return engine->channel(axis).position.load();
+}
+
+static bool homeActive()
+{
+  return emitted(0) >= world.magnetLow && emitted(0) <= world.magnetHigh;
+}
+
+static bool homeEdges(long &enterPosition, long &exitPosition)
+{
+  if (!homeExited)
+  {
+    return false;
+  }
+  enterPosition = yaw->positionFromEmitted(homeEnterSteps);
+  exitPosition = yaw->positionFromEmitted(homeExitSteps);
+  return true;
+}
+
+static void resetHomeLatch()
+{
+  homeEntered = false;
+  homeExited = false;
+}
+
+static bool upLimitActive()
+{
+  return emitted(1) >= world.upLimit;
+}
+
+static bool downLimitActive()
+{
+  return emitted(1) <= world.downLimit;
+}
+
+// Step output hook: the engine counts a step before raising its pulse, so the
+// sensor level here is the one that step produced
+static void stepHigh(uint8_t axis, uint32_t nowUs)
+{
+  stepSimStepHigh(axis, nowUs);
+  if (axis != 0)
+  {
+    return;
+  }
+  bool active = homeActive();
+  if (active && !homeWasActive && !homeEntered)
+  {
+    homeEnterSteps = emitted(0);
+    homeEntered = true;
+  }
+  else if (!active && homeWasActive && homeEntered && !homeExited)
+  {
+    homeExitSteps = emitted(0);
+    homeExited = true;
+  }
+  homeWasActive = active;
+}
+
+void setUp(void)
+{
+  engine = new StepEngine();
+  beginStepSim(*engine);
+  StepOutput output = {stepSimSetDirection, stepHigh, stepSimStepLow, stepSimPulseDelay};
+  engine->begin(output, stepSimClock);
+  yaw = new QueuedStepper(*engine, 0);
+  tilt = new QueuedStepper(*engine, 1);
+  yaw->setMaxSpeed(CONFIG.yawRunSpeed);
+  tilt->setMaxSpeed(CONFIG.tiltRunSpeed);
+  yaw->setAcceleration(2500.0f);
+  tilt->setAcceleration(2500.0f);
+  world = {1180, 1220, -400, 500};
+  homeWasActive = false;
+  resetHomeLatch();
+}
+
+void tearDown(void)
+{
+  delete yaw;
+  delete tilt;
+  delete engine;
+}
+
+static uint32_t nowMs()
+{
+  return stepSim().clockUs / 1000;
+}
+
+// Steps the sequencer every motor task cycle until it finishes, then lets the
+// engine drain; abortAfterMs aborts it that long after the start
+static uint32_t runCalibration(CalibrationSequencer &cal, uint32_t abortAfterMs = 0)
+{
+  uint32_t startMs = nowMs();
+  bool running = true;
+  while (running && nowMs() - startMs < 60000)
+  {
+    runStepSim(*engine, stepSim().clockUs + 100000u, MOTOR_TASK_PERIOD_US, [&]()
+               {
+                 if (!running)
+                 {
+                   return;
+                 }
+                 if (abortAfterMs && nowMs() - startMs >= abortAfterMs)
+                 {
+                   cal.abort();
+                 }
+                 running = cal.step(nowMs());
+               });
+  }
+  return nowMs() - startMs;
+}
+
+static CalibrationSequencer makeSequencer()
+{
+  CalibrationSequencer cal(*yaw, *tilt);
+  CalibrationInputs inputs = {homeActive, homeEdges, resetHomeLatch, upLimitActive, downLimitActive};
+  cal.configure(CONFIG, inputs);
+  return cal;
+}
+
+// Moves an axis to an absolute position outside calibration
+static void moveTo(QueuedStepper &stepper, long position)
+{
+  stepper.moveTo(position);
+  runStepSim(*engine, stepSim().clockUs + 10000000u, MOTOR_TASK_PERIOD_US, [&]()
+             { stepper.run(); });
+  TEST_ASSERT_EQUAL(position, stepper.currentPosition());
+}
+
+static long magnetCenter()
+{
+  return world.magnetLow + (world.magnetHigh + 1 - world.magnetLow) / 2;
+}
+
+// Where the stepper puts an emitted step count, once a pending re-zero has
+// taken effect
+static long positionAt(QueuedStepper &stepper, long emittedSteps)
+{
+  stepper.currentPosition();
+  return stepper.positionFromEmitted(emittedSteps);
+}
+
+static void checkFullResult(CalibrationSequencer &cal)
+{
+  const CalibrationResult &r = cal.result();
+  TEST_ASSERT_EQUAL(CAL_DONE, cal.phase());
+  TEST_ASSERT_TRUE(r.yawHomed);
+  TEST_ASSERT_TRUE(r.tiltCalibrated);
+  TEST_ASSERT_TRUE(r.downFound && r.upFound);
+  // Yaw zero sits on the magnet center, and the axis is parked there
+  TEST_ASSERT_EQUAL(0, positionAt(*yaw, magnetCenter()));
+  TEST_ASSERT_EQUAL(0, yaw->currentPosition());
+  TEST_ASSERT_EQUAL(world.magnetHigh + 1 - world.magnetLow, r.yawWindowSteps);
+  // Tilt is not re-zeroed by a full calibration: limits are where the switches close
+  TEST_ASSERT_EQUAL(positionAt(*tilt, world.downLimit), r.downLimit);
+  TEST_ASSERT_EQUAL(positionAt(*tilt, world.upLimit), r.upLimit);
+  TEST_ASSERT_EQUAL((r.downLimit + r.upLimit) / 2, r.tiltCenter);
+  TEST_ASSERT_EQUAL(r.tiltCenter, tilt->currentPosition());
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, cal.progress());
+  // Run speeds are restored
+  TEST_ASSERT_EQUAL_FLOAT(CONFIG.yawRunSpeed, yaw->maxSpeed());
+  TEST_ASSERT_EQUAL_FLOAT(CONFIG.tiltRunSpeed, tilt->maxSpeed());
+}
+
+static void test_full_calibration(void)
+{
+  CalibrationSequencer cal = makeSequencer();
+  cal.start(CALIBRATE_FULL, nowMs());
+  TEST_ASSERT_TRUE(cal.running());
+  runCalibration(cal);
+  checkFullResult(cal);
+}
+
+// The zero lands on the same microstep whatever the sweep speed or where yaw
+// starts, including inside the sensor window
+static void test_yaw_zero_is_repeatable(void)
+{
+  const float speeds[] = {200.0f, 600.0f, 1000.0f};
+  for (float speed : speeds)
+  {
+    CalibrationConfig config = CONFIG;
+    config.yawSearchSpeed = speed;
+    CalibrationSequencer cal(*yaw, *tilt);
+    CalibrationInputs inputs = {homeActive, homeEdges, resetHomeLatch, upLimitActive, downLimitActive};
+    cal.configure(config, inputs);
+    cal.start(CALIBRATE_FULL, nowMs());
+    runCalibration(cal);
+    TEST_ASSERT_TRUE(cal.result().yawHomed);
+    TEST_ASSERT_EQUAL(0, positionAt(*yaw, magnetCenter()));
+    moveTo(*yaw, -300);
+  }
+
+  CalibrationSequencer cal = makeSequencer();
+  moveTo(*yaw, 10); // Inside the window: backs off first
+  TEST_ASSERT_TRUE(homeActive());
+  cal.start(CALIBRATE_FULL, nowMs());
+  runCalibration(cal);
+  checkFullResult(cal);
+}
+
+static void test_starts_on_limit_switch(void)
+{
+  world.downLimit = 0; // Tilt powered up resting on the down switch
+  world.upLimit = 900;
+  CalibrationSequencer cal = makeSequencer();
+  cal.start(CALIBRATE_FULL, nowMs());
+  runCalibration(cal);
+  checkFullResult(cal);
+}
+
+static void test_quick_home_refinds_yaw_only(void)
+{
+  CalibrationSequencer cal = makeSequencer();
+  cal.start(CALIBRATE_FULL, nowMs());
+  runCalibration(cal);
+  long center = cal.result().tiltCenter;
+  moveTo(*yaw, -700); // The world has no wraparound, so stay short of the magnet
+  moveTo(*tilt, center + 200);
+
+  cal.start(CALIBRATE_QUICK_HOME, nowMs(), center);
+  runCalibration(cal);
+  TEST_ASSERT_EQUAL(CAL_DONE, cal.phase());
+  TEST_ASSERT_TRUE(cal.result().yawHomed);
+  TEST_ASSERT_TRUE(cal.result().tiltCalibrated);
+  TEST_ASSERT_FALSE(cal.result().downFound); // No tilt sweep
+  TEST_ASSERT_EQUAL(0, positionAt(*yaw, magnetCenter()));
+  TEST_ASSERT_EQUAL(center, tilt->currentPosition());
+}
+
+// A power cycle loses both positions; verify re-finds yaw and re-bases tilt
+// on the down switch using the stored range
+static void test_verify_rebases_stored_calibration(void)
+{
+  CalibrationSequencer cal = makeSequencer();
+  cal.start(CALIBRATE_FULL, nowMs());
+  runCalibration(cal);
+  CalibrationResult stored = cal.result();
+
+  moveTo(*yaw, -500);
+  moveTo(*tilt, stored.tiltCenter - 150);
+  yaw->setCurrentPosition(0);
+  tilt->setCurrentPosition(0);
+
+  cal.startVerify(nowMs(), stored.downLimit, stored.upLimit, stored.tiltCenter);
+  uint32_t verifyMs = runCalibration(cal);
+  TEST_ASSERT_EQUAL(CAL_DONE, cal.phase());
+  TEST_ASSERT_TRUE(cal.result().yawHomed);
+  TEST_ASSERT_TRUE(cal.result().tiltCalibrated);
+  TEST_ASSERT_EQUAL(0, positionAt(*yaw, magnetCenter()));
+  TEST_ASSERT_EQUAL(stored.downLimit, positionAt(*tilt, world.downLimit));
+  TEST_ASSERT_EQUAL(stored.tiltCenter, tilt->currentPosition());
+  TEST_ASSERT_EQUAL(stored.upLimit, cal.result().upLimit);
+
+  // Much quicker than a full sweep
+  moveTo(*yaw, -500);
+  cal.start(CALIBRATE_FULL, nowMs());
+  uint32_t fullMs = runCalibration(cal);
+  TEST_ASSERT_LESS_THAN(fullMs, verifyMs);
+}
+
+static void test_verify_fails_when_range_shrank(void)
+{
+  CalibrationSequencer cal = makeSequencer();
+  cal.start(CALIBRATE_FULL, nowMs());
+  runCalibration(cal);
+  CalibrationResult stored = cal.result();
+
+  world.upLimit = world.downLimit + (stored.upLimit - stored.downLimit) / 3; // A switch moved
+  moveTo(*tilt, positionAt(*tilt, world.downLimit) + 50);
+  cal.startVerify(nowMs(), stored.downLimit, stored.upLimit, stored.tiltCenter);
+  runCalibration(cal);
+  TEST_ASSERT_EQUAL(CAL_DONE, cal.phase());
+  TEST_ASSERT_TRUE(cal.result().yawHomed);
+  TEST_ASSERT_FALSE(cal.result().tiltCalibrated);
+  TEST_ASSERT_FALSE(cal.result().upFound);
+}
+
+static void test_missing_sensors_time_out(void)
+{
+  world = {100000, 100010, -100000, 100000};
+  CalibrationSequencer cal = makeSequencer();
+  cal.start(CALIBRATE_FULL, nowMs());
+  uint32_t elapsed = runCalibration(cal);
+  TEST_ASSERT_EQUAL(CAL_DONE, cal.phase());
+  TEST_ASSERT_FALSE(cal.result().yawHomed);
+  TEST_ASSERT_FALSE(cal.result().tiltCalibrated);
+  TEST_ASSERT_FALSE(cal.result().downFound);
+  TEST_ASSERT_LESS_OR_EQUAL(2 * CONFIG.axisTimeoutMs + 100, elapsed);
+}
+
+static void test_abort_stops_promptly(void)
+{
+  CalibrationSequencer cal = makeSequencer();
+  cal.start(CALIBRATE_FULL, nowMs());
+  runCalibration(cal, 300);
+  TEST_ASSERT_EQUAL(CAL_ABORTED, cal.phase());
+  TEST_ASSERT_FALSE(cal.running());
+  TEST_ASSERT_FALSE(cal.step(nowMs()));
+
+  // Yaw brakes from the sweep instead of finishing it
+  long stoppedAt = emitted(0);
+  runStepSim(*engine, stepSim().clockUs + 1000000u, MOTOR_TASK_PERIOD_US, [&]()
+             { yaw->run(); });
+  TEST_ASSERT_LESS_THAN(200, labs(emitted(0) - stoppedAt));
+  TEST_ASSERT_EQUAL_FLOAT(CONFIG.yawRunSpeed, yaw->maxSpeed());
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_full_calibration);
+  RUN_TEST(test_yaw_zero_is_repeatable);
+  RUN_TEST(test_starts_on_limit_switch);
+  RUN_TEST(test_quick_home_refinds_yaw_only);
+  RUN_TEST(test_verify_rebases_stored_calibration);
+  RUN_TEST(test_verify_fails_when_range_shrank);
+  RUN_TEST(test_missing_sensors_time_out);
+  RUN_TEST(test_abort_stops_promptly);
+  return UNITY_END();
+}
@@ -0,0 +1,230 @@
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+
+#include "seqlock.h"
+#include "spsc_ring.h"
+
+// Two-thread stress tests for the WebSocket-to-motorTask mailbox and the
+// status snapshot. Each side runs on its own host thread, as the AsyncTCP task
+// and motorTask do on the two ESP32 cores. Build with -fsanitize=thread to
+// also check the memory ordering.
+
+const uint32_t ITEMS = 300000;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Large enough that a torn copy of a slot would show
+struct Record
+{
+  uint32_t sequence;
+  float payload[15];
+  uint32_t check;
+};
+
+static Record makeRecord(uint32_t i)
+{
+  Record r;
+  r.sequence = i;
+  for (int k = 0; k < 15; k++)
+  {
+    r.payload[k] = (float)(i + k);
+  }
+  r.check = ~i;
+  return r;
+}
+
+static bool intact(const Record &r)
+{
+  return r.check == ~r.sequence && r.payload[0] == (float)r.sequence && r.payload[14] == (float)(r.sequence + 14);
+}
+
+static void produce(SpscRing<Record, 16> &ring)
+{
+  for (uint32_t i = 0; i < ITEMS;)
+  {
+    if (ring.push(makeRecord(i)))
+    {
+      i++;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+static void test_ring_delivers_every_item_in_order(void)
+{
+  SpscRing<Record, 16> ring;
+  uint32_t received = 0;
+  uint32_t bad = 0;
+  std::thread producer(produce, std::ref(ring));
+  std::thread consumer([&]()
+                       {
+                         Record r;
+                         while (received < ITEMS)
+                         {
+                           if (!ring.pop(r))
+                           {
+                             std::this_thread::yield();
+                             continue;
+                           }
+                           if (r.sequence != received || !intact(r))
+                           {
+                             bad++;
+                           }
+                           received++;
+                         }
+                       });
+  producer.join();
+  consumer.join();
+  TEST_ASSERT_EQUAL(ITEMS, received);
+  TEST_ASSERT_EQUAL(0, bad);
+  TEST_ASSERT_TRUE(ring.empty());
+}
+
+// The step engine consumes with peek()/drop() and flushes with clear()
+static void test_ring_peek_drop_and_clear(void)
+{
+  SpscRing<Record, 16> ring;
+  uint32_t seen = 0;
+  uint32_t bad = 0;
+  bool first = true;
+  uint32_t last = 0;
+  std::thread producer(produce, std::ref(ring));
+  std::thread consumer([&]()
+                       {
+                         while (first || last + 1 < ITEMS)
+                         {
+                           const Record *r = ring.peek();
+                           if (!r)
+                           {
+                             std::this_thread::yield();
+                             continue;
+                           }
+                           // Items after a clear() are newer, never repeated or torn
+                           if (!intact(*r) || (!first && r->sequence <= last))
+                           {
+                             bad++;
+                           }
+                           first = false;
+                           last = r->sequence;
+                           seen++;
+                           // A clear can't reach the last item while the ring holds fewer than 32
+                           if (seen % 1000 == 0 && r->sequence + 32 < ITEMS)
+                           {
+                             ring.clear();
+                           }
+                           else
+                           {
+                             ring.drop();
+                           }
+                         }
+                       });
+  producer.join();
+  consumer.join();
+  TEST_ASSERT_EQUAL(0, bad);
+  TEST_ASSERT_EQUAL(ITEMS - 1, last);
+  TEST_ASSERT_LESS_OR_EQUAL(ITEMS, seen);
+}
+
+static void test_ring_capacity(void)
+{
+  SpscRing<uint32_t, 4> ring;
+  for (uint32_t i = 0; i < 4; i++)
+  {
+    TEST_ASSERT_TRUE(ring.push(i));
+  }
+  TEST_ASSERT_TRUE(ring.full());
+  TEST_ASSERT_FALSE(ring.push(99));
+  uint32_t v = 0;
+  TEST_ASSERT_TRUE(ring.pop(v));
+  TEST_ASSERT_EQUAL(0, v);
+  TEST_ASSERT_TRUE(ring.push(4));
+  TEST_ASSERT_EQUAL(4, ring.size());
+  ring.clear();
+  TEST_ASSERT_TRUE(ring.empty());
+  TEST_ASSERT_NULL(ring.peek());
+}
+
+struct Snapshot
+{
+  uint32_t version;
+  float horizontalAngle;
+  float verticalAngle;
+  int32_t horizontalPosition;
+  int32_t verticalPosition;
+  uint32_t flags;
+};
+
+static void test_seqlock_reads_are_never_torn(void)
+{
+  Seqlock<Snapshot> lock;
+  std::atomic<bool> reading(false);
+  std::atomic<bool> done(false);
+  uint32_t torn = 0;
+  uint32_t backwards = 0;
+  uint32_t reads = 0;
+  std::thread writer([&]()
+                     {
+                       while (!reading)
+                       {
+                         std::this_thread::yield();
+                       }
+                       for (uint32_t i = 1; i <= ITEMS; i++)
+                       {
+                         Snapshot s = {i, (float)i, -(float)i, (int32_t)i, -(int32_t)i, ~i};
+                         lock.write(s);
+                       }
+                       done = true;
+                     });
+  std::thread reader([&]()
+                     {
+                       uint32_t last = 0;
+                       reading = true;
+                       while (!done)
+                       {
+                         Snapshot s = lock.read();
+                         uint32_t i = s.version;
+                         if (i != 0 && (s.horizontalAngle != (float)i || s.verticalAngle != -(float)i ||
+                                        s.horizontalPosition != (int32_t)i || s.verticalPosition != -(int32_t)i ||
+                                        s.flags != ~i))
+                         {
+                           torn++;
+                         }
+                         if (i < last)
+                         {
+                           backwards++;
+                         }
+                         last = i;
+                         reads++;
+                       }
+                     });
+  writer.join();
+  reader.join();
+  TEST_ASSERT_EQUAL(0, torn);
+  TEST_ASSERT_EQUAL(0, backwards);
+  TEST_ASSERT_GREATER_THAN(0, reads);
+  TEST_ASSERT_EQUAL(ITEMS, lock.version());
+  TEST_ASSERT_EQUAL(ITEMS, lock.read().version);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_ring_delivers_every_item_in_order);
+  RUN_TEST(test_ring_peek_drop_and_clear);
+  RUN_TEST(test_ring_capacity);
+  RUN_TEST(test_seqlock_reads_are_never_torn);
+  return UNITY_END();
+}
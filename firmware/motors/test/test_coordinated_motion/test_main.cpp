@@ -0,0 +1,180 @@
+#include <unity.h>
+
+#include <stdlib.h>
+
+#include "axis.h"
+#include "step_engine.h"
+#include "step_engine_sim.h"
+
+// Coordinated angular moves on the step engine's simulation backend: both
+// axes must emit their last step within 1 ms of each other.
+
+// Drive trains and limits as configured in main.cpp
+struct YawTestConfig
+{
+  static constexpr float MOTOR_STEPS_PER_REV = 200.0f;
+  static constexpr int MICROSTEPS = 2;
+  static constexpr float GEAR_RATIO = 4.0f;
+  static constexpr int MAX_STEPS_PER_SEC = 1000;
+  static constexpr float RUN_SPEED_FACTOR = 0.6f;
+  static constexpr float CALIBRATION_SPEED_FACTOR = 0.6f;
+  static constexpr bool CONTINUOUS = true;
+  static constexpr HomingStrategy HOMING = HOMING_HALL_SENSOR;
+};
+
+struct TiltTestConfig
+{
+  static constexpr float MOTOR_STEPS_PER_REV = 200.0f;
+  static constexpr int MICROSTEPS = 2;
+  static constexpr float GEAR_RATIO = 4.67f;
+  static constexpr int MAX_STEPS_PER_SEC = 500;
+  static constexpr float RUN_SPEED_FACTOR = 0.6f;
+  static constexpr float CALIBRATION_SPEED_FACTOR = 0.28f;
+  static constexpr bool CONTINUOUS = false;
+  static constexpr HomingStrategy HOMING = HOMING_LIMIT_SWITCHES;
+};
+
+typedef Axis<YawTestConfig> YawAxis;
+typedef Axis<TiltTestConfig> TiltAxis;
+
+const float ACCEL_STEPS_PER_SEC2 = 2500.0f;
+const uint32_t SYNC_MOVE_START_DELAY_US = 2000;
+const uint32_t MOTOR_TASK_PERIOD_US = 1000;
+const uint32_t MAX_ARRIVAL_SKEW_US = 1000;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+struct MoveResult
+{
+  bool moved[STEP_ENGINE_MAX_AXES];
+  uint32_t firstUs[STEP_ENGINE_MAX_AXES];
+  uint32_t lastUs[STEP_ENGINE_MAX_AXES];
+  long position[STEP_ENGINE_MAX_AXES];
+  float worstProgressGap; // Largest difference in fraction of the move done
+};
+
+// Moves both axes from zero by the given angles, coordinated or with each
+// axis's own profile, and reads the pulse trace back
+static MoveResult runMove(float yawDegrees, float tiltDegrees, bool coordinated)
+{
+  StepEngine engine;
+  beginStepSim(engine);
+  QueuedStepper yaw(engine, 0);
+  QueuedStepper tilt(engine, 1);
+  yaw.setMaxSpeed(YawAxis::runStepsPerSec());
+  tilt.setMaxSpeed(TiltAxis::runStepsPerSec());
+  yaw.setAcceleration(ACCEL_STEPS_PER_SEC2);
+  tilt.setAcceleration(ACCEL_STEPS_PER_SEC2);
+
+  long targets[STEP_ENGINE_MAX_AXES] = {YawAxis::toSteps(yawDegrees), TiltAxis::toSteps(tiltDegrees)};
+  SyncProfile profile;
+  if (coordinated)
+  {
+    float maxSpeeds[STEP_ENGINE_MAX_AXES] = {yaw.maxSpeed(), tilt.maxSpeed()};
+    float accels[STEP_ENGINE_MAX_AXES] = {yaw.acceleration(), tilt.acceleration()};
+    profile.plan(targets, maxSpeeds, accels, STEP_ENGINE_MAX_AXES, engine.now() + SYNC_MOVE_START_DELAY_US);
+    yaw.moveToSynchronized(targets[0], profile);
+    tilt.moveToSynchronized(targets[1], profile);
+  }
+  else
+  {
+    yaw.moveTo(targets[0]);
+    tilt.moveTo(targets[1]);
+  }
+
+  runStepSim(engine, 20000000, MOTOR_TASK_PERIOD_US, [&]()
+             {
+               yaw.run();
+               tilt.run();
+             });
+
+  MoveResult result = {};
+  const StepSimState &sim = stepSim();
+  long done[STEP_ENGINE_MAX_AXES] = {};
+  for (size_t i = 0; i < sim.traceCount; i++)
+  {
+    const StepPulse &pulse = sim.trace[i];
+    if (!result.moved[pulse.axis])
+    {
+      result.moved[pulse.axis] = true;
+      result.firstUs[pulse.axis] = pulse.timeUs;
+    }
+    result.lastUs[pulse.axis] = pulse.timeUs;
+    done[pulse.axis]++;
+    if (targets[0] != 0 && targets[1] != 0)
+    {
+      float gap = (float)done[0] / labs(targets[0]) - (float)done[1] / labs(targets[1]);
+      gap = gap < 0.0f ? -gap : gap;
+      result.worstProgressGap = gap > result.worstProgressGap ? gap : result.worstProgressGap;
+    }
+  }
+  result.position[0] = yaw.currentPosition();
+  result.position[1] = tilt.currentPosition();
+  TEST_ASSERT_EQUAL(targets[0], result.position[0]);
+  TEST_ASSERT_EQUAL(targets[1], result.position[1]);
+  TEST_ASSERT_LESS_THAN(STEP_SIM_TRACE_CAPACITY, sim.traceCount);
+  return result;
+}
+
+static uint32_t skew(uint32_t a, uint32_t b)
+{
+  return a > b ? a - b : b - a;
+}
+
+static void test_arrival_skew_under_1ms(void)
+{
+  // Long and short, yaw- and tilt-dominated, reversed, and triangle profiles
+  const float moves[][2] = {{90.0f, 20.0f}, {10.0f, -45.0f}, {-170.0f, 60.0f}, {-3.0f, -2.0f},
+                            {45.0f, 44.0f}, {0.5f, 30.0f}, {120.0f, -1.0f}};
+  for (const float *move : moves)
+  {
+    MoveResult r = runMove(move[0], move[1], true);
+    TEST_ASSERT_TRUE(r.moved[0] && r.moved[1]);
+    TEST_ASSERT_LESS_OR_EQUAL(MAX_ARRIVAL_SKEW_US, skew(r.lastUs[0], r.lastUs[1]));
+    // Nothing moves before the profile's start
+    TEST_ASSERT_GREATER_OR_EQUAL(SYNC_MOVE_START_DELAY_US, r.firstUs[0]);
+    TEST_ASSERT_GREATER_OR_EQUAL(SYNC_MOVE_START_DELAY_US, r.firstUs[1]);
+  }
+}
+
+// Both axes cover the same fraction of their travel at every instant, so the
+// aim point moves in a straight line
+static void test_path_is_straight(void)
+{
+  MoveResult r = runMove(90.0f, 20.0f, true);
+  TEST_ASSERT_TRUE(r.worstProgressGap < 0.02f);
+}
+
+// The same move without coordination: the shorter axis arrives well early,
+// which is the dog-leg coordination removes
+static void test_independent_moves_skew(void)
+{
+  MoveResult r = runMove(90.0f, 20.0f, false);
+  TEST_ASSERT_GREATER_THAN(100000, skew(r.lastUs[0], r.lastUs[1]));
+  TEST_ASSERT_TRUE(r.worstProgressGap > 0.2f);
+}
+
+static void test_single_axis_move(void)
+{
+  MoveResult r = runMove(0.0f, 25.0f, true);
+  TEST_ASSERT_FALSE(r.moved[0]);
+  TEST_ASSERT_TRUE(r.moved[1]);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_arrival_skew_under_1ms);
+  RUN_TEST(test_path_is_straight);
+  RUN_TEST(test_independent_moves_skew);
+  RUN_TEST(test_single_axis_move);
+  return UNITY_END();
+}
@@ -0,0 +1,290 @@
+#include <unity.h>
+
+#include "fire_control.h"
+
+// Runs FireSequencer at the 1 ms control rate against a stand-in trigger that
+// is back at rest TRIGGER_BUSY_MS after each pull, quicker than the cycle the
+// sequencer is configured with, so the cycle limit is the sequencer's own.
+
+const uint32_t CYCLE_MS = 1110;              // computeTriggerCycleMs() for a 555 ms travel
+const uint32_t ON_TARGET_TIMEOUT_MS = 10000; // Mirrors FIRE_ON_TARGET_TIMEOUT_MS in main.cpp
+const uint32_t TRIGGER_BUSY_MS = 400;
+const size_t MAX_PULLS = 64;
+
+struct Pull
+{
+  uint32_t ms;
+  uint16_t pattern;
+  uint8_t shot;
+};
+
+class Range
+{
+public:
+  Range() { fire.configure(CYCLE_MS, ON_TARGET_TIMEOUT_MS); }
+
+  FireEvent step(bool onTarget)
+  {
+    FireShot shot = {};
+    FireEvent event = fire.update(nowMs, !pulledOnce || nowMs - lastPullMs >= TRIGGER_BUSY_MS, onTarget, shot);
+    if (event == FIRE_PULL)
+    {
+      TEST_ASSERT_TRUE(pullCount < MAX_PULLS);
+      pulls[pullCount++] = {nowMs, shot.pattern, shot.shot};
+      pulledOnce = true;
+      lastPullMs = nowMs;
+      lastShot = shot;
+    }
+    else if (event == FIRE_ABANDONED)
+    {
+      abandoned = shot;
+      abandonedMs = nowMs;
+    }
+    nowMs++;
+    return event;
+  }
+
+  void runFor(uint32_t ms, bool onTarget)
+  {
+    for (uint32_t end = nowMs + ms; nowMs < end;)
+    {
+      step(onTarget);
+    }
+  }
+
+  FireSequencer fire;
+  uint32_t nowMs = 5000;
+  Pull pulls[MAX_PULLS] = {};
+  size_t pullCount = 0;
+  FireShot lastShot = {};
+  FireShot abandoned = {};
+  uint32_t abandonedMs = 0;
+
+private:
+  bool pulledOnce = false;
+  uint32_t lastPullMs = 0;
+};
+
+static FirePattern pattern(uint8_t shots, uint16_t intervalMs = 0, uint16_t maxRatePerMin = 0,
+                           bool onTarget = false, uint16_t settleMs = 0)
+{
+  FirePattern p = {shots, intervalMs, maxRatePerMin, onTarget, settleMs};
+  return p;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// The gap between pulls is the largest of the trigger cycle, the interval and
+// the rate cap (rounded up, so the cap is never exceeded)
+static void test_spacing_takes_the_slowest_limit(void)
+{
+  Range range;
+  TEST_ASSERT_EQUAL_UINT32(CYCLE_MS, range.fire.spacing(pattern(3)));
+  TEST_ASSERT_EQUAL_UINT32(CYCLE_MS, range.fire.spacing(pattern(3, 500)));
+  TEST_ASSERT_EQUAL_UINT32(1500, range.fire.spacing(pattern(3, 1500)));
+  TEST_ASSERT_EQUAL_UINT32(CYCLE_MS, range.fire.spacing(pattern(3, 0, 120)));
+  TEST_ASSERT_EQUAL_UINT32(2000, range.fire.spacing(pattern(3, 1500, 30)));
+  TEST_ASSERT_EQUAL_UINT32(8572, range.fire.spacing(pattern(3, 0, 7)));
+  TEST_ASSERT_EQUAL_UINT32(3000, range.fire.spacing(pattern(3, 3000, 30)));
+}
+
+static void test_pulls_keep_the_pattern_cadence(void)
+{
+  Range range;
+  uint16_t interval = range.fire.enqueue(pattern(3, 1500));
+  uint16_t capped = range.fire.enqueue(pattern(2, 0, 40));
+  range.runFor(10000, false);
+
+  TEST_ASSERT_EQUAL(5, range.pullCount);
+  const uint32_t start = 5000;
+  const Pull expected[] = {
+      {start, interval, 1},
+      {start + 1500, interval, 2},
+      {start + 3000, interval, 3},
+      // The next pattern's first shot only waits out the trigger cycle
+      {start + 3000 + CYCLE_MS, capped, 1},
+      {start + 3000 + CYCLE_MS + 1500, capped, 2},
+  };
+  for (size_t i = 0; i < range.pullCount; i++)
+  {
+    TEST_ASSERT_EQUAL_UINT32(expected[i].ms, range.pulls[i].ms);
+    TEST_ASSERT_EQUAL_UINT16(expected[i].pattern, range.pulls[i].pattern);
+    TEST_ASSERT_EQUAL_UINT8(expected[i].shot, range.pulls[i].shot);
+  }
+  TEST_ASSERT_EQUAL_UINT8(2, range.lastShot.shots);
+  TEST_ASSERT_FALSE(range.fire.busy());
+}
+
+// However requests arrive, and however soon the trigger is back, two pulls are
+// never closer than one trigger cycle
+static void test_never_closer_than_cycle(void)
+{
+  Range range;
+  range.fire.enqueue(pattern(4));
+  range.runFor(700, false);
+  // Queued while the first pattern is mid-burst, then again just after a pull
+  range.fire.enqueue(pattern(1, 100));
+  range.runFor(3 * CYCLE_MS - 700 + 1, false);
+  range.fire.enqueue(pattern(2, 0, 600));
+  range.runFor(8000, false);
+
+  TEST_ASSERT_EQUAL(7, range.pullCount);
+  for (size_t i = 1; i < range.pullCount; i++)
+  {
+    TEST_ASSERT_EQUAL_UINT32(CYCLE_MS, range.pulls[i].ms - range.pulls[i - 1].ms);
+  }
+}
+
+// A gated shot goes the moment the axes are on target, reporting how long it
+// waited past its slot; one that waits longer than the timeout drops the rest
+// of its pattern and the next pattern carries on
+static void test_on_target_timeout_abandons_pattern(void)
+{
+  Range range;
+  uint16_t gated = range.fire.enqueue(pattern(3, 0, 0, true));
+  uint16_t next = range.fire.enqueue(pattern(1));
+  range.runFor(250, false);
+  TEST_ASSERT_EQUAL(0, range.pullCount);
+  range.runFor(10, true);
+  TEST_ASSERT_EQUAL(1, range.pullCount);
+  TEST_ASSERT_EQUAL_UINT32(250, range.lastShot.waitedMs);
+
+  uint32_t dueMs = range.pulls[0].ms + CYCLE_MS;
+  range.runFor(CYCLE_MS + ON_TARGET_TIMEOUT_MS, false);
+  TEST_ASSERT_EQUAL_UINT32(dueMs + ON_TARGET_TIMEOUT_MS + 1, range.abandonedMs);
+  TEST_ASSERT_EQUAL_UINT16(gated, range.abandoned.pattern);
+  TEST_ASSERT_EQUAL_UINT8(1, range.abandoned.shot);
+  TEST_ASSERT_EQUAL_UINT8(3, range.abandoned.shots);
+  TEST_ASSERT_EQUAL_UINT32(ON_TARGET_TIMEOUT_MS + 1, range.abandoned.waitedMs);
+
+  // The ungated pattern behind it does not care where the axes point, and its
+  // cycle ran out long ago
+  TEST_ASSERT_EQUAL(2, range.pullCount);
+  TEST_ASSERT_EQUAL_UINT16(next, range.pulls[1].pattern);
+  TEST_ASSERT_EQUAL_UINT32(range.abandonedMs + 1, range.pulls[1].ms);
+  TEST_ASSERT_FALSE(range.fire.busy());
+}
+
+// A settle time restarts whenever the axes leave the target
+static void test_settle_gates_on_target_shots(void)
+{
+  Range range;
+  range.fire.enqueue(pattern(2, 0, 0, true, 200));
+  range.runFor(150, true);
+  range.runFor(1, false);
+  range.runFor(200, true);
+  TEST_ASSERT_EQUAL(0, range.pullCount);
+  range.runFor(1, true);
+  TEST_ASSERT_EQUAL(1, range.pullCount);
+  TEST_ASSERT_EQUAL_UINT32(5000 + 351, range.pulls[0].ms);
+
+  // Settled long before the next slot, so it goes on the cycle exactly
+  range.runFor(CYCLE_MS, true);
+  TEST_ASSERT_EQUAL(2, range.pullCount);
+  TEST_ASSERT_EQUAL_UINT32(CYCLE_MS, range.pulls[1].ms - range.pulls[0].ms);
+  TEST_ASSERT_EQUAL_UINT32(0, range.lastShot.waitedMs);
+}
+
+// Cancelling from the middle of the ring closes the gap in order, including
+// across the wrap at the end of the array
+static void test_cancel_compacts_the_queue(void)
+{
+  Range range;
+  // Move the head near the end of the ring first
+  for (uint8_t i = 0; i < FIRE_QUEUE_DEPTH - 2; i++)
+  {
+    range.fire.enqueue(pattern(1));
+    range.runFor(CYCLE_MS, false);
+  }
+  TEST_ASSERT_FALSE(range.fire.busy());
+  range.pullCount = 0;
+
+  uint16_t ids[FIRE_QUEUE_DEPTH];
+  for (uint8_t i = 0; i < FIRE_QUEUE_DEPTH; i++)
+  {
+    ids[i] = range.fire.enqueue(pattern(1));
+    TEST_ASSERT_NOT_EQUAL(0, ids[i]);
+  }
+  TEST_ASSERT_EQUAL(0, range.fire.enqueue(pattern(1)));
+
+  TEST_ASSERT_TRUE(range.fire.cancel(ids[1]));
+  TEST_ASSERT_TRUE(range.fire.cancel(ids[5]));
+  TEST_ASSERT_FALSE(range.fire.cancel(ids[5]));
+  TEST_ASSERT_FALSE(range.fire.cancel(0));
+  TEST_ASSERT_EQUAL_UINT8(FIRE_QUEUE_DEPTH - 2, range.fire.queued());
+  uint16_t last = range.fire.enqueue(pattern(1));
+  TEST_ASSERT_NOT_EQUAL(0, last);
+
+  range.runFor(FIRE_QUEUE_DEPTH * CYCLE_MS, false);
+  const uint16_t expected[] = {ids[0], ids[2], ids[3], ids[4], ids[6], ids[7], last};
+  TEST_ASSERT_EQUAL(sizeof(expected) / sizeof(expected[0]), range.pullCount);
+  for (size_t i = 0; i < range.pullCount; i++)
+  {
+    TEST_ASSERT_EQUAL_UINT16(expected[i], range.pulls[i].pattern);
+  }
+}
+
+// Cancelling the pattern being fired drops its remaining shots, and the next
+// pattern starts from its first shot
+static void test_cancel_head_mid_pattern(void)
+{
+  Range range;
+  uint16_t burst = range.fire.enqueue(pattern(5));
+  uint16_t single = range.fire.enqueue(pattern(1));
+  range.runFor(CYCLE_MS + 1, false);
+  TEST_ASSERT_EQUAL(2, range.pullCount);
+  TEST_ASSERT_TRUE(range.fire.cancel(burst));
+  range.runFor(2 * CYCLE_MS, false);
+  TEST_ASSERT_EQUAL(3, range.pullCount);
+  TEST_ASSERT_EQUAL_UINT16(single, range.pulls[2].pattern);
+  TEST_ASSERT_EQUAL_UINT8(1, range.pulls[2].shot);
+  TEST_ASSERT_EQUAL_UINT32(CYCLE_MS, range.pulls[2].ms - range.pulls[1].ms);
+}
+
+// Ids run 1..65535 and skip 0, which means rejected
+static void test_ids_wrap_past_zero(void)
+{
+  FireSequencer fire;
+  fire.configure(CYCLE_MS, ON_TARGET_TIMEOUT_MS);
+  for (uint32_t expected = 1; expected <= UINT16_MAX; expected++)
+  {
+    TEST_ASSERT_EQUAL_UINT16(expected, fire.enqueue(pattern(1)));
+    fire.clear();
+  }
+  TEST_ASSERT_EQUAL_UINT16(1, fire.enqueue(pattern(1)));
+  TEST_ASSERT_EQUAL_UINT16(2, fire.enqueue(pattern(1)));
+}
+
+static void test_rejects_invalid_patterns(void)
+{
+  FireSequencer fire;
+  fire.configure(CYCLE_MS, ON_TARGET_TIMEOUT_MS);
+  TEST_ASSERT_EQUAL(0, fire.enqueue(pattern(0)));
+  TEST_ASSERT_EQUAL(0, fire.enqueue(pattern(FIRE_MAX_SHOTS + 1)));
+  TEST_ASSERT_EQUAL(0, fire.enqueue(pattern(1, 0, 0, true, FIRE_MAX_SETTLE_MS + 1)));
+  TEST_ASSERT_NOT_EQUAL(0, fire.enqueue(pattern(FIRE_MAX_SHOTS, 0, 0, true, FIRE_MAX_SETTLE_MS)));
+  TEST_ASSERT_EQUAL_UINT8(1, fire.queued());
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_spacing_takes_the_slowest_limit);
+  RUN_TEST(test_pulls_keep_the_pattern_cadence);
+  RUN_TEST(test_never_closer_than_cycle);
+  RUN_TEST(test_on_target_timeout_abandons_pattern);
+  RUN_TEST(test_settle_gates_on_target_shots);
+  RUN_TEST(test_cancel_compacts_the_queue);
+  RUN_TEST(test_cancel_head_mid_pattern);
+  RUN_TEST(test_ids_wrap_past_zero);
+  RUN_TEST(test_rejects_invalid_patterns);
+  return UNITY_END();
+}
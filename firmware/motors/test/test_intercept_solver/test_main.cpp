@@ -0,0 +1,302 @@
+#include <unity.h>
+
+#include <math.h>
+#include <stdio.h>
+
+#include "intercept_solver.h"
+
+// Runs the intercept solver at the 1 kHz motor rate against synthetic target
+// tracks. The axes follow the commanded velocity exactly, so what is checked
+// is the solver's own profile: where it aims, how fast it gets onto the lead
+// track and whether it then rides it at the target's rate.
+
+// Limits as configured in main.cpp (run speed, jog acceleration) and its
+// trigger travel: computeTriggerMoveTimeMs() for the default servo timing
+const InterceptConfig CONFIG = {{{135.0f, 562.5f, true}, {57.8f, 481.8f, false}}, 0.8f, 15.0f, 1.0f};
+const float TRIGGER_TRAVEL_S = 0.555f;
+const float DT = 0.001f;
+const float ON_TRACK_DEG = 0.05f;
+const float ON_TRACK_DPS = 0.5f;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static float wrapDegrees(float deg)
+{
+  deg = fmodf(deg + 180.0f, 360.0f);
+  if (deg < 0.0f)
+  {
+    deg += 360.0f;
+  }
+  return deg - 180.0f;
+}
+
+struct Track
+{
+  float start[INTERCEPT_AXES];
+  float rate[INTERCEPT_AXES];
+
+  float at(uint8_t axis, uint32_t ms) const
+  {
+    float deg = start[axis] + rate[axis] * ms / 1000.0f;
+    return CONFIG.axes[axis].wraps ? wrapDegrees(deg) : deg;
+  }
+};
+
+struct Run
+{
+  InterceptSolver solver;
+  float position[INTERCEPT_AXES] = {};
+  float velocity[INTERCEPT_AXES] = {};
+  float travelled[INTERCEPT_AXES] = {}; // Total distance moved, either way
+  uint32_t nowMs = 0;
+  float leadS = TRIGGER_TRAVEL_S;
+
+  Run() { solver.configure(CONFIG); }
+
+  // Measures the track every updateMs, as fresh detections would
+  void fly(const Track &track, uint32_t untilMs, uint32_t updateMs = 66)
+  {
+    for (; nowMs < untilMs; nowMs++)
+    {
+      if (!solver.active() || nowMs - solver.measuredAt() >= updateMs)
+      {
+        float seen[INTERCEPT_AXES] = {track.at(0, nowMs), track.at(1, nowMs)};
+        solver.setTarget(seen, track.rate, nowMs, leadS);
+      }
+      float command[INTERCEPT_AXES];
+      solver.update(position, velocity, nowMs, DT, command);
+      for (uint8_t i = 0; i < INTERCEPT_AXES; i++)
+      {
+        velocity[i] = command[i];
+        position[i] += velocity[i] * DT;
+        travelled[i] += fabsf(velocity[i] * DT);
+        if (CONFIG.axes[i].wraps)
+        {
+          position[i] = wrapDegrees(position[i]);
+        }
+      }
+    }
+  }
+
+  // Signed distance ahead of the target, minus the lead it should be at
+  float leadError(const Track &track, uint8_t axis) const
+  {
+    float ahead = position[axis] - track.at(axis, nowMs);
+    if (CONFIG.axes[axis].wraps)
+    {
+      ahead = wrapDegrees(ahead);
+    }
+    return ahead - track.rate[axis] * leadS;
+  }
+
+  bool onTrack(const Track &track) const
+  {
+    for (uint8_t i = 0; i < INTERCEPT_AXES; i++)
+    {
+      if (fabsf(leadError(track, i)) > ON_TRACK_DEG || fabsf(velocity[i] - track.rate[i]) > ON_TRACK_DPS)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Flies until both axes are on the track; returns the time taken in seconds
+  float timeToTrack(const Track &track, uint32_t limitMs)
+  {
+    uint32_t startMs = nowMs;
+    while (nowMs - startMs < limitMs && !onTrack(track))
+    {
+      fly(track, nowMs + 1);
+    }
+    return (nowMs - startMs) / 1000.0f;
+  }
+};
+
+// The closed form, branch by branch, against hand-worked profiles
+static void test_axis_time_closed_form(void)
+{
+  // On the track and at rest relative to it
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, interceptAxisTime(0.0f, 0.0f, -10.0f, 10.0f, 10.0f));
+  // Exactly the braking distance away: brake and arrive
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, interceptAxisTime(5.0f, 10.0f, -20.0f, 20.0f, 10.0f));
+  // Peak-limited triangle: 10 deg at 10 deg/s^2 peaks at 10 deg/s
+  TEST_ASSERT_EQUAL_FLOAT(2.0f, interceptAxisTime(10.0f, 0.0f, -100.0f, 100.0f, 10.0f));
+  TEST_ASSERT_EQUAL_FLOAT(2.0f, interceptAxisTime(-10.0f, 0.0f, -100.0f, 100.0f, 10.0f));
+  // Coast at the limit: 1 s up, 9 s at 10 deg/s, 1 s down
+  TEST_ASSERT_EQUAL_FLOAT(11.0f, interceptAxisTime(100.0f, 0.0f, -10.0f, 10.0f, 10.0f));
+  // Already past the limit relative to the track: slow to it, coast, stop
+  TEST_ASSERT_EQUAL_FLOAT(1.0f + 1.0f + (100.0f - 15.0f - 5.0f) / 10.0f,
+                          interceptAxisTime(100.0f, 20.0f, -10.0f, 10.0f, 10.0f));
+  // Braking overshoot: 10 deg/s toward a point 1 deg away stops 4 deg past it,
+  // then comes back 4 deg in a triangle
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f + 2.0f * sqrtf(0.4f), interceptAxisTime(1.0f, 10.0f, -20.0f, 20.0f, 10.0f));
+  // The same overshoot with the way back capped at 1 deg/s: stop 4 deg past,
+  // 0.1 s up to the cap, coast the 3.9 deg left, 0.1 s down
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f + 0.1f + 3.9f + 0.1f, interceptAxisTime(1.0f, 10.0f, -1.0f, 20.0f, 10.0f));
+  // No way there: the axis cannot move toward the point, or cannot accelerate
+  TEST_ASSERT_TRUE(isinf(interceptAxisTime(10.0f, 0.0f, -10.0f, 0.0f, 10.0f)));
+  TEST_ASSERT_TRUE(isinf(interceptAxisTime(10.0f, 0.0f, -10.0f, 10.0f, 0.0f)));
+}
+
+// The plan is the slower axis's closed form, at the braking deceleration
+static void test_plan_matches_closed_form(void)
+{
+  InterceptSolver solver;
+  solver.configure(CONFIG);
+  const float target[INTERCEPT_AXES] = {40.0f, 5.0f};
+  const float rate[INTERCEPT_AXES] = {15.0f, 2.0f};
+  const float position[INTERCEPT_AXES] = {0.0f, 0.0f};
+  const float velocity[INTERCEPT_AXES] = {0.0f, 0.0f};
+  solver.setTarget(target, rate, 1000, TRIGGER_TRAVEL_S);
+  InterceptPlan plan = solver.plan(position, velocity, 1200);
+
+  TEST_ASSERT_TRUE(plan.reachable);
+  float expected = 0.0f;
+  for (uint8_t i = 0; i < INTERCEPT_AXES; i++)
+  {
+    float aim = target[i] + rate[i] * (0.2f + TRIGGER_TRAVEL_S);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, aim, plan.aim[i]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, rate[i] * TRIGGER_TRAVEL_S, plan.lead[i]);
+    const InterceptAxisLimits &limits = CONFIG.axes[i];
+    expected = fmaxf(expected, interceptAxisTime(aim, -rate[i], -limits.maxVelocity - rate[i],
+                                                 limits.maxVelocity - rate[i],
+                                                 limits.maxAccel * CONFIG.brakingFraction));
+  }
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, expected, plan.timeToTrackS);
+}
+
+// Closes on a constant-rate target from rest, then rides the lead track
+static void test_constant_rate_track(void)
+{
+  const Track track = {{40.0f, 5.0f}, {15.0f, 2.0f}};
+  Run run;
+  run.leadS = TRIGGER_TRAVEL_S + 0.1f; // 100 ms flight time
+  run.fly(track, 1);
+  InterceptPlan plan = run.solver.plan(run.position, run.velocity, run.nowMs);
+  TEST_ASSERT_TRUE(plan.reachable);
+
+  float actual = run.timeToTrack(track, 5000);
+  char line[120];
+  snprintf(line, sizeof(line), "on track after %.3f s, closed form %.3f s", actual, plan.timeToTrackS);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_TRUE(run.onTrack(track));
+  // update() accelerates at the full limit but brakes at brakingFraction and
+  // settles exponentially, so it lands near the closed form, not on it
+  TEST_ASSERT_FLOAT_WITHIN(0.25f, plan.timeToTrackS, actual);
+
+  // Then stays on it at the target's rate, lead unchanged
+  run.fly(track, run.nowMs + 3000);
+  for (uint8_t i = 0; i < INTERCEPT_AXES; i++)
+  {
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, run.leadError(track, i));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, track.rate[i], run.velocity[i]);
+  }
+  plan = run.solver.plan(run.position, run.velocity, run.nowMs);
+  TEST_ASSERT_TRUE(plan.timeToTrackS < 0.05f);
+}
+
+// Yaw takes the short way across +/-180 to a target there, and follows a
+// moving one through the wrap
+static void test_wrapping_track(void)
+{
+  const Track still = {{165.0f, 0.0f}, {0.0f, 0.0f}};
+  Run run;
+  run.position[0] = -170.0f;
+  float actual = run.timeToTrack(still, 3000);
+  TEST_ASSERT_TRUE(run.onTrack(still));
+  // 25 deg the short way round, not 335 deg the long way
+  TEST_ASSERT_TRUE(run.travelled[0] < 30.0f);
+  TEST_ASSERT_TRUE(actual < 1.0f);
+
+  const Track crossing = {{150.0f, 0.0f}, {40.0f, 0.0f}};
+  Run across;
+  across.position[0] = 170.0f;
+  across.timeToTrack(crossing, 3000);
+  TEST_ASSERT_TRUE(across.onTrack(crossing));
+  across.fly(crossing, across.nowMs + 2000);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, across.leadError(crossing, 0));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 40.0f, across.velocity[0]);
+  // Through +180 to the negative side, never a turn the other way
+  TEST_ASSERT_TRUE(across.position[0] < 0.0f);
+  TEST_ASSERT_TRUE(across.travelled[0] < 40.0f * across.nowMs / 1000.0f + 10.0f);
+}
+
+// Faster than an axis can turn: unreachable, and the axis runs at its limit
+static void test_unreachable_target(void)
+{
+  const Track track = {{0.0f, 0.0f}, {150.0f, 0.0f}};
+  Run run;
+  run.fly(track, 1);
+  TEST_ASSERT_FALSE(run.solver.plan(run.position, run.velocity, run.nowMs).reachable);
+  run.fly(track, 2000);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, CONFIG.axes[0].maxVelocity, run.velocity[0]);
+
+  // Tilt has its own, lower limit
+  const Track steep = {{0.0f, 0.0f}, {0.0f, -60.0f}};
+  Run tilt;
+  tilt.fly(steep, 1);
+  TEST_ASSERT_FALSE(tilt.solver.plan(tilt.position, tilt.velocity, tilt.nowMs).reachable);
+}
+
+// A measurement is carried forward at most maxExtrapolationS
+static void test_extrapolation_is_clamped(void)
+{
+  InterceptSolver solver;
+  solver.configure(CONFIG);
+  const float target[INTERCEPT_AXES] = {10.0f, 0.0f};
+  const float rate[INTERCEPT_AXES] = {20.0f, -5.0f};
+  const float zero[INTERCEPT_AXES] = {0.0f, 0.0f};
+  solver.setTarget(target, rate, 1000, TRIGGER_TRAVEL_S);
+
+  InterceptPlan fresh = solver.plan(zero, zero, 1500);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 10.0f + 20.0f * (0.5f + TRIGGER_TRAVEL_S), fresh.aim[0]);
+  const uint32_t late[] = {2000, 5000, 60000};
+  for (uint32_t nowMs : late)
+  {
+    InterceptPlan old = solver.plan(zero, zero, nowMs);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 10.0f + 20.0f * (CONFIG.maxExtrapolationS + TRIGGER_TRAVEL_S), old.aim[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -5.0f * (CONFIG.maxExtrapolationS + TRIGGER_TRAVEL_S), old.aim[1]);
+  }
+}
+
+static void test_inactive_solver_holds_velocity(void)
+{
+  InterceptSolver solver;
+  solver.configure(CONFIG);
+  const float position[INTERCEPT_AXES] = {10.0f, 5.0f};
+  const float velocity[INTERCEPT_AXES] = {3.0f, -2.0f};
+  float out[INTERCEPT_AXES];
+  solver.update(position, velocity, 0, DT, out);
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, out[0]);
+  TEST_ASSERT_EQUAL_FLOAT(-2.0f, out[1]);
+  TEST_ASSERT_FALSE(solver.plan(position, velocity, 0).reachable);
+
+  const float rate[INTERCEPT_AXES] = {1.0f, 1.0f};
+  solver.setTarget(position, rate, 0, 0.0f);
+  solver.reset();
+  TEST_ASSERT_FALSE(solver.active());
+  solver.update(position, velocity, 0, DT, out);
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, out[0]);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_axis_time_closed_form);
+  RUN_TEST(test_plan_matches_closed_form);
+  RUN_TEST(test_constant_rate_track);
+  RUN_TEST(test_wrapping_track);
+  RUN_TEST(test_unreachable_target);
+  RUN_TEST(test_extrapolation_is_clamped);
+  RUN_TEST(test_inactive_solver_holds_velocity);
+  return UNITY_END();
+}
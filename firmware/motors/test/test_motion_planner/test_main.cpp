@@ -0,0 +1,247 @@
+#include <unity.h>
+
+#include <math.h>
+
+#include "motion_planner.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+const float DT = 0.001f;
+const PlannerLimits LIMITS = {{150.0f, 60.0f}, {500.0f, 250.0f}, 0.05f};
+
+struct RunStats
+{
+  float time;
+  float finalPosition[PLANNER_AXES];
+  float peakVelocity[PLANNER_AXES];
+  float largestVelocityStep[PLANNER_AXES]; // deg/s between samples
+  int corners; // Samples whose velocity change needs more than the axis's accel
+  float largestStep; // Biggest setpoint jump between samples, deg
+  bool done;
+};
+
+// Steps the planner until it reports done and records what the axes saw
+static RunStats run(MotionPlanner &planner, float maxTime = 30.0f)
+{
+  RunStats stats = {};
+  float lastVelocity[PLANNER_AXES] = {};
+  float lastPosition[PLANNER_AXES] = {};
+  bool first = true;
+  PlannerSample sample = {};
+  while (stats.time < maxTime)
+  {
+    sample = planner.advance(DT);
+    stats.time += DT;
+    for (size_t a = 0; a < PLANNER_AXES; a++)
+    {
+      stats.peakVelocity[a] = fmaxf(stats.peakVelocity[a], fabsf(sample.velocity[a]));
+      if (!first)
+      {
+        float velocityStep = fabsf(sample.velocity[a] - lastVelocity[a]);
+        stats.largestVelocityStep[a] = fmaxf(stats.largestVelocityStep[a], velocityStep);
+        if (velocityStep > LIMITS.maxAccel[a] * DT * 1.05f)
+        {
+          stats.corners++;
+        }
+        stats.largestStep = fmaxf(stats.largestStep, fabsf(sample.position[a] - lastPosition[a]));
+      }
+      lastVelocity[a] = sample.velocity[a];
+      lastPosition[a] = sample.position[a];
+    }
+    first = false;
+    if (sample.done)
+    {
+      break;
+    }
+  }
+  stats.done = sample.done;
+  stats.finalPosition[0] = sample.position[0];
+  stats.finalPosition[1] = sample.position[1];
+  return stats;
+}
+
+static void start(MotionPlanner &planner, float yaw, float tilt)
+{
+  planner.setLimits(LIMITS);
+  const float position[PLANNER_AXES] = {yaw, tilt};
+  planner.reset(position);
+}
+
+static void add(MotionPlanner &planner, float yaw, float tilt)
+{
+  const float target[PLANNER_AXES] = {yaw, tilt};
+  TEST_ASSERT_TRUE(planner.addWaypoint(target));
+}
+
+// Speeds stay within each axis's limit, and velocity changes faster than the
+// axis's acceleration only at the junctions, by at most the junction allowance
+static void checkWithinLimits(const RunStats &stats, int junctions)
+{
+  TEST_ASSERT_TRUE(stats.corners <= junctions * (int)PLANNER_AXES);
+  for (size_t a = 0; a < PLANNER_AXES; a++)
+  {
+    TEST_ASSERT_TRUE(stats.peakVelocity[a] <= LIMITS.maxVelocity[a] * 1.01f);
+    TEST_ASSERT_TRUE(stats.largestVelocityStep[a] <= LIMITS.maxAccel[a] * (LIMITS.junctionTime + DT) * 1.05f);
+  }
+  TEST_ASSERT_TRUE(stats.largestStep <= LIMITS.maxVelocity[0] * DT * 1.01f);
+}
+
+static void test_single_move_lands_on_target(void)
+{
+  MotionPlanner planner;
+  start(planner, 0.0f, 0.0f);
+  add(planner, 90.0f, -20.0f);
+  float predicted = planner.remainingTime();
+
+  RunStats stats = run(planner);
+  TEST_ASSERT_TRUE(stats.done);
+  TEST_ASSERT_FALSE(planner.active());
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 90.0f, stats.finalPosition[0]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, -20.0f, stats.finalPosition[1]);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, predicted, stats.time);
+  checkWithinLimits(stats, 0);
+  // Long enough to cruise, so yaw reaches its speed limit
+  TEST_ASSERT_FLOAT_WITHIN(1.5f, 150.0f, stats.peakVelocity[0]);
+}
+
+static void test_blends_through_waypoints(void)
+{
+  const float path[][PLANNER_AXES] = {{30.0f, 0.0f}, {60.0f, 10.0f}, {90.0f, 0.0f}, {120.0f, 10.0f}};
+
+  // The same path as separate stop-and-go moves
+  float stopAndGo = 0.0f;
+  float from[PLANNER_AXES] = {0.0f, 0.0f};
+  for (const float *waypoint : path)
+  {
+    MotionPlanner single;
+    start(single, from[0], from[1]);
+    add(single, waypoint[0], waypoint[1]);
+    stopAndGo += single.remainingTime();
+    from[0] = waypoint[0];
+    from[1] = waypoint[1];
+  }
+
+  MotionPlanner planner;
+  start(planner, 0.0f, 0.0f);
+  for (const float *waypoint : path)
+  {
+    add(planner, waypoint[0], waypoint[1]);
+  }
+  TEST_ASSERT_EQUAL(4, planner.pending());
+  TEST_ASSERT_TRUE(planner.remainingTime() < stopAndGo * 0.9f);
+
+  // Yaw keeps moving through every intermediate waypoint; tilt reverses at
+  // each one, so its junction allowance sets the corner speed (~18 deg/s)
+  float slowestYaw = INFINITY;
+  float elapsed = 0.0f;
+  PlannerSample sample;
+  do
+  {
+    sample = planner.advance(DT);
+    elapsed += DT;
+    if (sample.position[0] > 10.0f && sample.position[0] < 110.0f)
+    {
+      slowestYaw = fminf(slowestYaw, sample.velocity[0]);
+    }
+  } while (!sample.done && elapsed < 30.0f);
+  TEST_ASSERT_TRUE(sample.done);
+  TEST_ASSERT_TRUE(slowestYaw > 10.0f);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 120.0f, sample.position[0]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 10.0f, sample.position[1]);
+}
+
+static void test_corners_respect_axis_limits(void)
+{
+  MotionPlanner planner;
+  start(planner, 0.0f, 0.0f);
+  add(planner, 40.0f, 0.0f);
+  add(planner, 40.0f, 30.0f); // Right angle: yaw stops, tilt starts
+  add(planner, -40.0f, 30.0f);
+  add(planner, -40.0f, -30.0f);
+  RunStats stats = run(planner);
+  TEST_ASSERT_TRUE(stats.done);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, -40.0f, stats.finalPosition[0]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, -30.0f, stats.finalPosition[1]);
+  checkWithinLimits(stats, 3);
+}
+
+static void test_reversal_stops_at_waypoint(void)
+{
+  MotionPlanner planner;
+  start(planner, 0.0f, 0.0f);
+  add(planner, 50.0f, 0.0f);
+  add(planner, 0.0f, 0.0f);
+
+  // Yaw may only reverse after reaching the first waypoint
+  float furthest = 0.0f;
+  float elapsed = 0.0f;
+  PlannerSample sample;
+  do
+  {
+    sample = planner.advance(DT);
+    elapsed += DT;
+    furthest = fmaxf(furthest, sample.position[0]);
+  } while (!sample.done && elapsed < 30.0f);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, furthest);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, sample.position[0]);
+}
+
+static void test_queue_limits(void)
+{
+  MotionPlanner planner;
+  start(planner, 0.0f, 0.0f);
+  for (size_t i = 0; i < PLANNER_MAX_SEGMENTS; i++)
+  {
+    add(planner, (float)(i + 1) * 5.0f, (float)(i % 2));
+  }
+  TEST_ASSERT_EQUAL(0, planner.freeSlots());
+  const float extra[PLANNER_AXES] = {200.0f, 0.0f};
+  TEST_ASSERT_FALSE(planner.addWaypoint(extra));
+
+  float last[PLANNER_AXES];
+  planner.lastWaypoint(last);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 80.0f, last[0]);
+
+  // Segments free up as they complete, and appending mid-run keeps the setpoint continuous
+  RunStats partial = run(planner, 0.3f);
+  TEST_ASSERT_FALSE(partial.done);
+  TEST_ASSERT_GREATER_THAN(0, planner.freeSlots());
+  TEST_ASSERT_TRUE(planner.addWaypoint(extra));
+  RunStats rest = run(planner);
+  TEST_ASSERT_TRUE(rest.done);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 200.0f, rest.finalPosition[0]);
+  checkWithinLimits(rest, (int)PLANNER_MAX_SEGMENTS);
+}
+
+static void test_duplicate_waypoint_is_harmless(void)
+{
+  MotionPlanner planner;
+  start(planner, 10.0f, 5.0f);
+  const float same[PLANNER_AXES] = {10.0f, 5.0f};
+  planner.addWaypoint(same);
+  add(planner, 20.0f, 5.0f);
+  RunStats stats = run(planner);
+  TEST_ASSERT_TRUE(stats.done);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 20.0f, stats.finalPosition[0]);
+  TEST_ASSERT_FALSE(isnan(stats.finalPosition[1]));
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_single_move_lands_on_target);
+  RUN_TEST(test_blends_through_waypoints);
+  RUN_TEST(test_corners_respect_axis_limits);
+  RUN_TEST(test_reversal_stops_at_waypoint);
+  RUN_TEST(test_queue_limits);
+  RUN_TEST(test_duplicate_waypoint_is_harmless);
+  return UNITY_END();
+}
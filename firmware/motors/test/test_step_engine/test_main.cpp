@@ -0,0 +1,236 @@
+#include <unity.h>
+
+#include "step_engine.h"
+#include "step_engine_sim.h"
+
+// Checks step timing against the pulse trace recorded by the simulation backend
+
+const float YAW_STEPS_PER_SEC = 1000.0f; // Rated speeds from main.cpp
+const float TILT_STEPS_PER_SEC = 500.0f;
+const uint32_t MOTOR_TASK_PERIOD_US = 1000;
+const uint32_t MAX_JITTER_US = 10;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static size_t countPulses(uint8_t axis)
+{
+  size_t n = 0;
+  for (size_t i = 0; i < stepSim().traceCount; i++)
+  {
+    if (stepSim().trace[i].axis == axis)
+    {
+      n++;
+    }
+  }
+  return n;
+}
+
+// Largest deviation of the axis's pulse spacing from periodUs
+static uint32_t maxJitterUs(uint8_t axis, uint32_t periodUs)
+{
+  const StepSimState &sim = stepSim();
+  bool havePrevious = false;
+  uint32_t previous = 0;
+  uint32_t worst = 0;
+  for (size_t i = 0; i < sim.traceCount; i++)
+  {
+    if (sim.trace[i].axis != axis)
+    {
+      continue;
+    }
+    if (havePrevious)
+    {
+      uint32_t interval = sim.trace[i].timeUs - previous;
+      uint32_t error = interval > periodUs ? interval - periodUs : periodUs - interval;
+      if (error > worst)
+      {
+        worst = error;
+      }
+    }
+    previous = sim.trace[i].timeUs;
+    havePrevious = true;
+  }
+  return worst;
+}
+
+static void test_both_axes_reach_rated_speed(void)
+{
+  StepEngine engine;
+  beginStepSim(engine);
+  QueuedStepper yaw(engine, 0);
+  QueuedStepper tilt(engine, 1);
+  yaw.setMaxSpeed(YAW_STEPS_PER_SEC);
+  tilt.setMaxSpeed(TILT_STEPS_PER_SEC);
+  yaw.setSpeed(YAW_STEPS_PER_SEC);
+  tilt.setSpeed(-TILT_STEPS_PER_SEC);
+
+  runStepSim(engine, 1000000, MOTOR_TASK_PERIOD_US, [&]()
+             {
+               yaw.runSpeed();
+               tilt.runSpeed();
+             });
+
+  TEST_ASSERT_INT_WITHIN(1, 1000, countPulses(0));
+  TEST_ASSERT_INT_WITHIN(1, 500, countPulses(1));
+  TEST_ASSERT_LESS_OR_EQUAL(MAX_JITTER_US, maxJitterUs(0, 1000));
+  TEST_ASSERT_LESS_OR_EQUAL(MAX_JITTER_US, maxJitterUs(1, 2000));
+  TEST_ASSERT_INT_WITHIN(1, 1000, yaw.currentPosition());
+  TEST_ASSERT_INT_WITHIN(1, -500, tilt.currentPosition());
+}
+
+// A motorTask that stalls (JSON, logging) for less than the lookahead must not
+// disturb pulse timing
+static void test_stalled_caller_keeps_timing(void)
+{
+  StepEngine engine;
+  beginStepSim(engine);
+  QueuedStepper yaw(engine, 0);
+  yaw.setMaxSpeed(YAW_STEPS_PER_SEC);
+  yaw.setSpeed(YAW_STEPS_PER_SEC);
+
+  uint32_t tick = 0;
+  runStepSim(engine, 500000, MOTOR_TASK_PERIOD_US, [&]()
+             {
+               // Runs one tick in eight, i.e. every 8 ms
+               if (tick++ % 8 == 0)
+               {
+                 yaw.runSpeed();
+               }
+             });
+
+  TEST_ASSERT_INT_WITHIN(1, 500, countPulses(0));
+  TEST_ASSERT_LESS_OR_EQUAL(MAX_JITTER_US, maxJitterUs(0, 1000));
+}
+
+static void test_direction_follows_sign_and_inversion(void)
+{
+  StepEngine engine;
+  beginStepSim(engine);
+  QueuedStepper yaw(engine, 0);
+  QueuedStepper tilt(engine, 1);
+  yaw.setMaxSpeed(YAW_STEPS_PER_SEC);
+  tilt.setMaxSpeed(TILT_STEPS_PER_SEC);
+  tilt.setPinsInverted(true, false, false);
+  yaw.setSpeed(-YAW_STEPS_PER_SEC);
+  tilt.setSpeed(TILT_STEPS_PER_SEC);
+
+  runStepSim(engine, 20000, MOTOR_TASK_PERIOD_US, [&]()
+             {
+               yaw.runSpeed();
+               tilt.runSpeed();
+             });
+
+  const StepSimState &sim = stepSim();
+  TEST_ASSERT_GREATER_THAN(0, sim.traceCount);
+  for (size_t i = 0; i < sim.traceCount; i++)
+  {
+    TEST_ASSERT_FALSE(sim.trace[i].forward);
+  }
+}
+
+static void test_accelerated_move_lands_on_target(void)
+{
+  StepEngine engine;
+  beginStepSim(engine);
+  QueuedStepper yaw(engine, 0);
+  yaw.setMaxSpeed(YAW_STEPS_PER_SEC);
+  yaw.setAcceleration(2500.0f);
+  yaw.moveTo(1200);
+
+  runStepSim(engine, 2000000, MOTOR_TASK_PERIOD_US, [&]()
+             { yaw.run(); });
+
+  const StepSimState &sim = stepSim();
+  TEST_ASSERT_EQUAL(1200, countPulses(0));
+  TEST_ASSERT_EQUAL(1200, yaw.currentPosition());
+  TEST_ASSERT_EQUAL(0, yaw.distanceToGo());
+  TEST_ASSERT_FALSE(yaw.isRunning());
+
+  // Cruises at the rated speed between the ramps
+  uint32_t shortest = UINT32_MAX;
+  for (size_t i = 1; i < sim.traceCount; i++)
+  {
+    uint32_t interval = sim.trace[i].timeUs - sim.trace[i - 1].timeUs;
+    if (interval < shortest)
+    {
+      shortest = interval;
+    }
+  }
+  TEST_ASSERT_INT_WITHIN(MAX_JITTER_US, 1000, shortest);
+}
+
+// A target shifted mid-move (a drift correction) is reached without a restart:
+// the synchronized profile finishes its span and run() covers the rest
+static void test_shifted_target_lands_without_restart(void)
+{
+  StepEngine engine;
+  beginStepSim(engine);
+  QueuedStepper yaw(engine, 0);
+  yaw.setMaxSpeed(YAW_STEPS_PER_SEC);
+  yaw.setAcceleration(2500.0f);
+  long distances[STEP_ENGINE_MAX_AXES] = {1200, 0};
+  float maxSpeeds[STEP_ENGINE_MAX_AXES] = {YAW_STEPS_PER_SEC, TILT_STEPS_PER_SEC};
+  float accels[STEP_ENGINE_MAX_AXES] = {2500.0f, 2500.0f};
+  SyncProfile profile;
+  profile.plan(distances, maxSpeeds, accels, STEP_ENGINE_MAX_AXES, engine.now() + 2000);
+  yaw.moveToSynchronized(1200, profile);
+
+  runStepSim(engine, 600000, MOTOR_TASK_PERIOD_US, [&]()
+             { yaw.run(); });
+  size_t before = countPulses(0);
+  TEST_ASSERT_TRUE(before > 100 && before < 1200);
+  yaw.shiftTarget(-12);
+  runStepSim(engine, 3000000, MOTOR_TASK_PERIOD_US, [&]()
+             { yaw.run(); });
+
+  TEST_ASSERT_EQUAL(1188, yaw.currentPosition());
+  TEST_ASSERT_EQUAL(0, yaw.distanceToGo());
+  TEST_ASSERT_FALSE(yaw.isRunning());
+  // The profile ran its full span, then came back the 12 steps from rest
+  TEST_ASSERT_EQUAL(1200 + 12, countPulses(0));
+
+  yaw.shiftTarget(20);
+  runStepSim(engine, 4000000, MOTOR_TASK_PERIOD_US, [&]()
+             { yaw.run(); });
+  TEST_ASSERT_EQUAL(1208, yaw.currentPosition());
+}
+
+static void test_position_reset_flushes_queue(void)
+{
+  StepEngine engine;
+  beginStepSim(engine);
+  QueuedStepper yaw(engine, 0);
+  yaw.setMaxSpeed(YAW_STEPS_PER_SEC);
+  yaw.setSpeed(YAW_STEPS_PER_SEC);
+
+  runStepSim(engine, 100000, MOTOR_TASK_PERIOD_US, [&]()
+             { yaw.runSpeed(); });
+  size_t before = countPulses(0);
+  yaw.setCurrentPosition(0);
+  runStepSim(engine, 200000, MOTOR_TASK_PERIOD_US, [&]()
+             { yaw.currentPosition(); });
+
+  // Queued steps are flushed on the next service() rather than played out
+  TEST_ASSERT_LESS_OR_EQUAL(1, countPulses(0) - before);
+  TEST_ASSERT_EQUAL(0, yaw.currentPosition());
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_both_axes_reach_rated_speed);
+  RUN_TEST(test_stalled_caller_keeps_timing);
+  RUN_TEST(test_direction_follows_sign_and_inversion);
+  RUN_TEST(test_accelerated_move_lands_on_target);
+  RUN_TEST(test_shifted_target_lands_without_restart);
+  RUN_TEST(test_position_reset_flushes_queue);
+  return UNITY_END();
+}
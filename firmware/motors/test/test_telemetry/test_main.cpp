@@ -0,0 +1,247 @@
+#include <unity.h>
+
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "telemetry.h"
+#include "turret_protocol.h"
+
+// Telemetry encoding and a bandwidth benchmark of the publisher's schedule:
+// deltas at the default 20 Hz with a keyframe every 5 s, against the full
+// snapshot the firmware used to send at the same rate. Heap allocations are
+// counted by replacing the global operator new.
+
+const uint32_t RATE_HZ = 20;
+const uint32_t KEYFRAME_MS = 5000;
+const uint32_t BENCH_MS = 60000;
+const float YAW_STEPS_PER_DEGREE = 4.444f;
+const float TILT_STEPS_PER_DEGREE = 5.189f;
+const TelemetryEvents NO_EVENTS = {false, false, false, false};
+
+static size_t allocations = 0;
+
+void *operator new(size_t size)
+{
+  allocations++;
+  void *p = malloc(size ? size : 1);
+  if (!p)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  free(p);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static TelemetryState idleState()
+{
+  TelemetryState s = {};
+  s.horizontalAngle = 12.5f;
+  s.verticalAngle = -3.25f;
+  s.horizontalPosition = 56;
+  s.verticalPosition = -17;
+  s.flags = STATUS_CALIBRATED;
+  s.coordinated = true;
+  return s;
+}
+
+// Moves 4 s out of every 10, yaw at 30 deg/s and tilt at 10 deg/s
+static TelemetryState benchState(uint32_t ms)
+{
+  TelemetryState s = idleState();
+  uint32_t cycle = ms / 10000;
+  uint32_t phaseMs = ms % 10000;
+  float movingMs = (float)(cycle * 4000 + (phaseMs < 4000 ? phaseMs : 4000));
+  float direction = cycle % 2 ? -1.0f : 1.0f;
+  s.horizontalAngle += direction * 30.0f * movingMs / 1000.0f;
+  s.verticalAngle += direction * 10.0f * movingMs / 1000.0f;
+  s.horizontalPosition = (int32_t)(s.horizontalAngle * YAW_STEPS_PER_DEGREE);
+  s.verticalPosition = (int32_t)(s.verticalAngle * TILT_STEPS_PER_DEGREE);
+  if (phaseMs < 4000)
+  {
+    s.flags |= STATUS_IS_MOVING;
+  }
+  return s;
+}
+
+struct BenchResult
+{
+  size_t bytes;
+  size_t messages;
+  size_t allocations;
+};
+
+// Runs publishTelemetry()'s schedule for one client that is never backed up
+static BenchResult runBench(bool deltas)
+{
+  static char buffer[TELEMETRY_BUFFER_SIZE];
+  TelemetryState baseline = {};
+  bool baselineValid = false;
+  uint32_t lastKeyframeMs = 0;
+  BenchResult result = {};
+  size_t allocationsBefore = allocations;
+  for (uint32_t ms = 0; ms < BENCH_MS; ms += 1000 / RATE_HZ)
+  {
+    TelemetryState current = benchState(ms);
+    size_t len;
+    if (!deltas || !baselineValid || ms - lastKeyframeMs >= KEYFRAME_MS)
+    {
+      len = encodeTelemetryJson(current, nullptr, NO_EVENTS, nullptr, 0, buffer, sizeof(buffer));
+      baseline = current;
+      baselineValid = true;
+      lastKeyframeMs = ms;
+    }
+    else
+    {
+      len = encodeTelemetryJson(current, &baseline, NO_EVENTS, nullptr, 0, buffer, sizeof(buffer));
+    }
+    if (len > 0)
+    {
+      result.bytes += len;
+      result.messages++;
+    }
+  }
+  result.allocations = allocations - allocationsBefore;
+  return result;
+}
+
+static void test_bandwidth_and_allocations(void)
+{
+  BenchResult full = runBench(false);
+  BenchResult delta = runBench(true);
+  float seconds = BENCH_MS / 1000.0f;
+  char line[160];
+  snprintf(line, sizeof(line), "full snapshots %.0f B/s, deltas %.0f B/s (%.0f msg/s), %.2f allocs/s",
+           full.bytes / seconds, delta.bytes / seconds, delta.messages / seconds, delta.allocations / seconds);
+  TEST_MESSAGE(line);
+
+  TEST_ASSERT_EQUAL(0, full.allocations);
+  TEST_ASSERT_EQUAL(0, delta.allocations);
+  TEST_ASSERT_TRUE(delta.bytes / seconds < 1200.0f);
+  TEST_ASSERT_TRUE(delta.bytes * 4 < full.bytes);
+  // Idle periods send nothing between keyframes
+  TEST_ASSERT_TRUE(delta.messages < full.messages * 6 / 10);
+}
+
+static void test_keyframe_has_every_field(void)
+{
+  char out[TELEMETRY_BUFFER_SIZE];
+  const char *errors[] = {"Limit switch stuck", "Quote \" and \\ escaped"};
+  size_t len = encodeTelemetryJson(idleState(), nullptr, NO_EVENTS, errors, 2, out, sizeof(out));
+  TEST_ASSERT_EQUAL(strlen(out), len);
+  TEST_ASSERT_EQUAL_STRING("{\"status\":{\"calibrated\":true,\"calibrating\":false,"
+                           "\"angles\":{\"horizontal\":12.50,\"vertical\":-3.25},"
+                           "\"positions\":{\"horizontal\":56,\"vertical\":-17},"
+                           "\"movement\":{\"angularInProgress\":false,\"isMoving\":false,\"coordinated\":true},"
+                           "\"sensors\":{\"yawHome\":false,\"tiltUp\":false,\"tiltDown\":false},"
+                           "\"triggerActive\":false,\"tracking\":false},"
+                           "\"errors\":[\"Limit switch stuck\",\"Quote \\\" and \\\\ escaped\"]}",
+                           out);
+}
+
+static void test_delta_carries_only_changes(void)
+{
+  char out[TELEMETRY_BUFFER_SIZE];
+  TelemetryState baseline = idleState();
+  TelemetryState current = baseline;
+  TEST_ASSERT_EQUAL(0, encodeTelemetryJson(current, &baseline, NO_EVENTS, nullptr, 0, out, sizeof(out)));
+
+  current.horizontalPosition = 60;
+  current.flags |= STATUS_IS_MOVING;
+  size_t len = encodeTelemetryJson(current, &baseline, NO_EVENTS, nullptr, 0, out, sizeof(out));
+  TEST_ASSERT_GREATER_THAN(0, len);
+  TEST_ASSERT_EQUAL_STRING("{\"statusDelta\":{\"positions\":{\"horizontal\":60},\"movement\":{\"isMoving\":true}}}", out);
+  TEST_ASSERT_EQUAL(60, baseline.horizontalPosition);
+  TEST_ASSERT_FALSE(telemetryChanged(current, baseline));
+
+  // One-shot events go out even when nothing else changed
+  TelemetryEvents done = {true, false, false, false};
+  encodeTelemetryJson(current, &baseline, done, nullptr, 0, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("{\"movementComplete\":true}", out);
+}
+
+// Drift below the deadband is not sent, but it adds up against the old baseline
+static void test_angle_drift_accumulates(void)
+{
+  char out[TELEMETRY_BUFFER_SIZE];
+  TelemetryState baseline = idleState();
+  TelemetryState current = baseline;
+  size_t sends = 0;
+  for (int i = 1; i <= 10; i++)
+  {
+    current.horizontalAngle = 12.5f + i * 0.004f;
+    if (encodeTelemetryJson(current, &baseline, NO_EVENTS, nullptr, 0, out, sizeof(out)) > 0)
+    {
+      sends++;
+      TEST_ASSERT_NOT_NULL(strstr(out, "\"angles\":{\"horizontal\":"));
+    }
+    TEST_ASSERT_TRUE(current.horizontalAngle - baseline.horizontalAngle < TELEMETRY_ANGLE_EPSILON);
+  }
+  TEST_ASSERT_EQUAL(3, sends);
+}
+
+static void test_overflow_returns_zero(void)
+{
+  char out[64];
+  TelemetryState baseline = idleState();
+  TelemetryState current = baseline;
+  current.horizontalPosition = 1;
+  TEST_ASSERT_EQUAL(0, encodeTelemetryJson(current, nullptr, NO_EVENTS, nullptr, 0, out, sizeof(out)));
+  // A delta that did not fit leaves the baseline alone so it is sent again
+  char tiny[8];
+  TEST_ASSERT_EQUAL(0, encodeTelemetryJson(current, &baseline, NO_EVENTS, nullptr, 0, tiny, sizeof(tiny)));
+  TEST_ASSERT_EQUAL(56, baseline.horizontalPosition);
+}
+
+// The largest values each field can take must still fit the event buffer
+static void test_event_messages(void)
+{
+  char out[TELEMETRY_EVENT_BUFFER_SIZE];
+  size_t before = allocations;
+  size_t len = encodeShotJson(3, 2, 5, 1234567890123ULL, 40, out, sizeof(out));
+  TEST_ASSERT_EQUAL(strlen(out), len);
+  TEST_ASSERT_EQUAL_STRING("{\"shot\":{\"pattern\":3,\"shot\":2,\"of\":5,\"timeUs\":1234567890123,\"waitedMs\":40}}", out);
+  TEST_ASSERT_GREATER_THAN(0, encodeShotJson(UINT16_MAX, UINT8_MAX, UINT8_MAX, UINT64_MAX, UINT32_MAX, out, sizeof(out)));
+
+  len = encodeDriftJson("tilt", -7, 2, -11, out, sizeof(out));
+  TEST_ASSERT_EQUAL(strlen(out), len);
+  TEST_ASSERT_EQUAL_STRING("{\"driftCorrected\":{\"axis\":\"tilt\",\"steps\":-7,\"corrections\":2,\"totalSteps\":-11}}", out);
+  TEST_ASSERT_GREATER_THAN(0, encodeDriftJson("yaw", INT32_MIN, UINT32_MAX, INT32_MIN, out, sizeof(out)));
+  TEST_ASSERT_EQUAL(before, allocations);
+
+  char tiny[16];
+  TEST_ASSERT_EQUAL(0, encodeShotJson(1, 1, 1, 0, 0, tiny, sizeof(tiny)));
+  TEST_ASSERT_EQUAL(0, encodeDriftJson("yaw", 3, 1, 3, tiny, sizeof(tiny)));
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_bandwidth_and_allocations);
+  RUN_TEST(test_keyframe_has_every_field);
+  RUN_TEST(test_delta_carries_only_changes);
+  RUN_TEST(test_angle_drift_accumulates);
+  RUN_TEST(test_overflow_returns_zero);
+  RUN_TEST(test_event_messages);
+  return UNITY_END();
+}
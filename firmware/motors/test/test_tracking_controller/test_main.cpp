@@ -0,0 +1,176 @@
+#include <unity.h>
+
+#include <math.h>
+
+#include "tracking_controller.h"
+
+// Closes the tracking loop against a simulated target: a camera reports the
+// aim error at frame rate, the controller runs at the 1 kHz motor rate and the
+// axes follow its velocity exactly.
+
+// Gains and limits as configured in main.cpp (run speed, jog acceleration)
+const TrackingGains YAW_GAINS = {4.0f, 0.5f, 0.0f, 1.0f, 0.5f, 200.0f, 5.0f, 135.0f, 562.5f};
+const TrackingGains TILT_GAINS = {4.0f, 0.5f, 0.0f, 1.0f, 0.5f, 200.0f, 5.0f, 57.8f, 481.8f};
+const uint32_t TIMEOUT_MS = 500;
+const uint32_t FRAME_MS = 66; // ~15 fps detector
+const float DT = 0.001f;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+struct Target
+{
+  float yaw0, yawRate;
+  float tilt0, tiltRate, tiltAmplitude, tiltPeriodMs;
+
+  float yaw(uint32_t ms) const { return yaw0 + yawRate * ms / 1000.0f; }
+  float tilt(uint32_t ms) const
+  {
+    float wave = tiltPeriodMs > 0.0f ? tiltAmplitude * sinf(2.0f * (float)M_PI * ms / tiltPeriodMs) : 0.0f;
+    return tilt0 + tiltRate * ms / 1000.0f + wave;
+  }
+};
+
+struct Loop
+{
+  TrackingController controller;
+  float yaw = 0.0f;
+  float tilt = 0.0f;
+  float peakYawVelocity = 0.0f;
+  float peakYawAccel = 0.0f;
+  float lastYawVelocity = 0.0f;
+
+  Loop() { controller.configure(YAW_GAINS, TILT_GAINS, TIMEOUT_MS); }
+
+  // Runs [fromMs, toMs); frames stop arriving at framesUntilMs
+  void run(const Target &target, uint32_t fromMs, uint32_t toMs, uint32_t framesUntilMs = UINT32_MAX)
+  {
+    for (uint32_t ms = fromMs; ms < toMs; ms++)
+    {
+      if (ms % FRAME_MS == 0 && ms < framesUntilMs)
+      {
+        controller.measure(target.yaw(ms) - yaw, target.tilt(ms) - tilt, yaw, tilt, ms);
+      }
+      TrackingOutput out = controller.update(yaw, tilt, ms, DT);
+      yaw += out.yawVelocity * DT;
+      tilt += out.tiltVelocity * DT;
+      peakYawVelocity = fmaxf(peakYawVelocity, fabsf(out.yawVelocity));
+      peakYawAccel = fmaxf(peakYawAccel, fabsf(out.yawVelocity - lastYawVelocity) / DT);
+      lastYawVelocity = out.yawVelocity;
+    }
+  }
+};
+
+static void test_locks_onto_constant_rate_target(void)
+{
+  Target target = {0.0f, 20.0f, 0.0f, -8.0f, 0.0f, 0.0f};
+  Loop loop;
+  loop.run(target, 0, 3000);
+
+  TEST_ASSERT_TRUE(loop.controller.active());
+  TEST_ASSERT_FLOAT_WITHIN(0.15f, target.yaw(3000), loop.yaw);
+  TEST_ASSERT_FLOAT_WITHIN(0.15f, target.tilt(3000), loop.tilt);
+  TEST_ASSERT_FLOAT_WITHIN(0.15f, 0.0f, loop.controller.yawError());
+  // Running on the rate estimate rather than on error: no lag behind the target
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 20.0f, loop.lastYawVelocity);
+}
+
+// Between frames the loop keeps closing on the predicted target, so the aim
+// error stays small at every control period, not just at frame times
+static void test_error_stays_small_between_frames(void)
+{
+  Target target = {0.0f, -30.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+  Loop loop;
+  loop.run(target, 0, 2000);
+  float worst = 0.0f;
+  for (uint32_t ms = 2000; ms < 3000; ms++)
+  {
+    loop.run(target, ms, ms + 1);
+    worst = fmaxf(worst, fabsf(target.yaw(ms + 1) - loop.yaw));
+  }
+  TEST_ASSERT_TRUE(worst < 0.2f);
+}
+
+static void test_follows_oscillating_target(void)
+{
+  Target target = {0.0f, 0.0f, 5.0f, 0.0f, 8.0f, 4000.0f};
+  Loop loop;
+  loop.run(target, 0, 2000);
+  float worst = 0.0f;
+  for (uint32_t ms = 2000; ms < 6000; ms++)
+  {
+    loop.run(target, ms, ms + 1);
+    worst = fmaxf(worst, fabsf(target.tilt(ms + 1) - loop.tilt));
+  }
+  // 8 deg at 0.25 Hz peaks at 12.6 deg/s; a lag of a frame would be 0.8 deg
+  TEST_ASSERT_TRUE(worst < 0.8f);
+}
+
+static void test_step_acquisition_within_limits(void)
+{
+  Target target = {40.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+  Loop loop;
+  uint32_t settledMs = 0;
+  for (uint32_t ms = 0; ms < 3000 && settledMs == 0; ms++)
+  {
+    loop.run(target, ms, ms + 1);
+    if (fabsf(target.yaw(ms) - loop.yaw) < 0.5f)
+    {
+      settledMs = ms;
+    }
+  }
+  TEST_ASSERT_GREATER_THAN(0, settledMs);
+  TEST_ASSERT_LESS_THAN(1500, settledMs);
+  TEST_ASSERT_TRUE(loop.peakYawVelocity <= YAW_GAINS.maxVelocity * 1.001f);
+  TEST_ASSERT_TRUE(loop.peakYawAccel <= YAW_GAINS.maxAccel * 1.01f);
+}
+
+// When frames stop, the prediction stops maxLeadMs past the last one. The aim
+// then comes to rest where feed-forward of the last rate estimate and the
+// proportional term cancel, rate / kp beyond that, until the timeout stops it.
+static void test_extrapolation_is_bounded(void)
+{
+  Target target = {0.0f, 20.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+  Loop loop;
+  loop.run(target, 0, 1980); // Last frame at 1914 ms
+  float lastSeen = target.yaw(1914);
+  loop.run(target, 1980, 1914 + TIMEOUT_MS, 0);
+  float predicted = lastSeen + 20.0f * YAW_GAINS.maxLeadMs / 1000.0f;
+  float rest = predicted + YAW_GAINS.kff * 20.0f / YAW_GAINS.kp;
+  TEST_ASSERT_TRUE(loop.yaw < rest + 0.5f);
+}
+
+static void test_times_out_without_frames(void)
+{
+  Target target = {5.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+  Loop loop;
+  loop.run(target, 0, 600, 100); // Last frame at 66 ms
+  TEST_ASSERT_FALSE(loop.controller.timedOut(66 + TIMEOUT_MS));
+  TEST_ASSERT_TRUE(loop.controller.timedOut(66 + TIMEOUT_MS + 1));
+
+  loop.controller.stop();
+  TEST_ASSERT_FALSE(loop.controller.active());
+  TrackingOutput out = loop.controller.update(loop.yaw, loop.tilt, 700, DT);
+  TEST_ASSERT_FALSE(out.active);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, out.yawVelocity);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, out.tiltVelocity);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_locks_onto_constant_rate_target);
+  RUN_TEST(test_error_stays_small_between_frames);
+  RUN_TEST(test_follows_oscillating_target);
+  RUN_TEST(test_step_acquisition_within_limits);
+  RUN_TEST(test_extrapolation_is_bounded);
+  RUN_TEST(test_times_out_without_frames);
+  return UNITY_END();
+}
@@ -0,0 +1,345 @@
+#include <unity.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "turret_protocol.h"
+
+// Round-trip, golden-byte and fuzz tests for the binary WebSocket protocol.
+// The golden frames are shared with ui/src/lib/turretProtocol.test.mjs so both
+// ends of the link agree on the wire format.
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static const uint8_t GOLDEN_JOYSTICK[] = {0xA5, 0x01, 0x01, 0x00, 0x40, 0x01, 0x80};
+static const uint8_t GOLDEN_MOVE_TO_ANGLE[] = {0xA5, 0x01, 0x02, 0x00, 0x00, 0xB5, 0x42, 0x00, 0x00, 0x44, 0xC1};
+static const uint8_t GOLDEN_FIRE_BURST[] = {0xA5, 0x01, 0x04, 0x01};
+static const uint8_t GOLDEN_HOME[] = {0xA5, 0x01, 0x05};
+static const uint8_t GOLDEN_POSE_HISTORY_REQUEST[] = {0xA5, 0x01, 0x07, 0xCB, 0x04, 0xFB, 0x71,
+                                                      0x1F, 0x01, 0x00, 0x00, 0x28, 0x00};
+static const uint8_t GOLDEN_INTERCEPT[] = {0xA5, 0x01, 0x08, 0x00, 0x00, 0x20, 0x41, 0x00, 0x00, 0xA0,
+                                           0x40, 0x00, 0x00, 0x20, 0xC0, 0x00, 0x00, 0x40, 0x3F, 0x40,
+                                           0x4B, 0x4C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x96, 0x00};
+static const uint8_t GOLDEN_FIRE_PATTERN[] = {0xA5, 0x01, 0x09, 0x03, 0xFA, 0x00, 0x2C, 0x01, 0x01, 0x28, 0x00};
+static const uint8_t GOLDEN_MOVE_TO_ANGLE_AND_FIRE[] = {0xA5, 0x01, 0x0A, 0x00, 0x00, 0x34, 0x42,
+                                                        0x00, 0x00, 0x20, 0xC1, 0x28, 0x00};
+static const uint8_t GOLDEN_STATUS[] = {0xA5, 0x01, 0x80, 0x05, 0x01, 0x00, 0x00, 0x48, 0x41, 0x00, 0x00,
+                                        0x50, 0xC0, 0xC0, 0x1D, 0xFE, 0xFF, 0xD2, 0x1E, 0x00, 0x00, 0x03};
+
+static TurretCommand command(FrameType type)
+{
+  TurretCommand cmd;
+  memset(&cmd, 0, sizeof(cmd));
+  cmd.type = type;
+  return cmd;
+}
+
+// Encodes cmd and checks the bytes against golden, then decodes them back
+static TurretCommand checkGolden(const TurretCommand &cmd, const uint8_t *golden, size_t goldenSize)
+{
+  uint8_t buf[PROTOCOL_MAX_FRAME_SIZE];
+  size_t n = encodeCommand(cmd, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL(goldenSize, n);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(golden, buf, n);
+
+  TurretCommand decoded;
+  TEST_ASSERT_EQUAL(DECODE_OK, decodeCommand(golden, goldenSize, decoded));
+  TEST_ASSERT_EQUAL(cmd.type, decoded.type);
+  return decoded;
+}
+
+static void test_golden_command_frames(void)
+{
+  TurretCommand cmd = command(FRAME_JOYSTICK);
+  cmd.x = 0.5f;
+  cmd.y = -1.0f;
+  TurretCommand d = checkGolden(cmd, GOLDEN_JOYSTICK, sizeof(GOLDEN_JOYSTICK));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.5f, d.x);
+  TEST_ASSERT_EQUAL_FLOAT(-1.0f, d.y);
+
+  cmd = command(FRAME_MOVE_TO_ANGLE);
+  cmd.horizontal = 90.5f;
+  cmd.vertical = -12.25f;
+  d = checkGolden(cmd, GOLDEN_MOVE_TO_ANGLE, sizeof(GOLDEN_MOVE_TO_ANGLE));
+  TEST_ASSERT_EQUAL_FLOAT(90.5f, d.horizontal);
+  TEST_ASSERT_EQUAL_FLOAT(-12.25f, d.vertical);
+
+  cmd = command(FRAME_FIRE);
+  cmd.fireMode = FIRE_BURST;
+  d = checkGolden(cmd, GOLDEN_FIRE_BURST, sizeof(GOLDEN_FIRE_BURST));
+  TEST_ASSERT_EQUAL(FIRE_BURST, d.fireMode);
+
+  checkGolden(command(FRAME_HOME), GOLDEN_HOME, sizeof(GOLDEN_HOME));
+
+  cmd = command(FRAME_POSE_HISTORY_REQUEST);
+  cmd.afterUs = 1234567890123ULL;
+  cmd.maxSamples = 40;
+  d = checkGolden(cmd, GOLDEN_POSE_HISTORY_REQUEST, sizeof(GOLDEN_POSE_HISTORY_REQUEST));
+  TEST_ASSERT_EQUAL_UINT64(1234567890123ULL, d.afterUs);
+  TEST_ASSERT_EQUAL(40, d.maxSamples);
+
+  cmd = command(FRAME_INTERCEPT);
+  cmd.horizontal = 10.0f;
+  cmd.vertical = 5.0f;
+  cmd.horizontalRate = -2.5f;
+  cmd.verticalRate = 0.75f;
+  cmd.targetUs = 5000000;
+  cmd.flightMs = 150;
+  d = checkGolden(cmd, GOLDEN_INTERCEPT, sizeof(GOLDEN_INTERCEPT));
+  TEST_ASSERT_EQUAL_FLOAT(-2.5f, d.horizontalRate);
+  TEST_ASSERT_EQUAL_UINT64(5000000, d.targetUs);
+  TEST_ASSERT_EQUAL(150, d.flightMs);
+
+  cmd = command(FRAME_FIRE_PATTERN);
+  cmd.firePattern = {3, 250, 300, true, 40};
+  d = checkGolden(cmd, GOLDEN_FIRE_PATTERN, sizeof(GOLDEN_FIRE_PATTERN));
+  TEST_ASSERT_EQUAL(3, d.firePattern.shots);
+  TEST_ASSERT_EQUAL(250, d.firePattern.intervalMs);
+  TEST_ASSERT_EQUAL(300, d.firePattern.maxRatePerMin);
+  TEST_ASSERT_TRUE(d.firePattern.onTarget);
+  TEST_ASSERT_EQUAL(40, d.firePattern.settleMs);
+
+  cmd = command(FRAME_MOVE_TO_ANGLE_AND_FIRE);
+  cmd.horizontal = 45.0f;
+  cmd.vertical = -10.0f;
+  cmd.firePattern.settleMs = 40;
+  d = checkGolden(cmd, GOLDEN_MOVE_TO_ANGLE_AND_FIRE, sizeof(GOLDEN_MOVE_TO_ANGLE_AND_FIRE));
+  TEST_ASSERT_EQUAL_FLOAT(45.0f, d.horizontal);
+  TEST_ASSERT_EQUAL(1, d.firePattern.shots);
+  TEST_ASSERT_TRUE(d.firePattern.onTarget);
+  TEST_ASSERT_EQUAL(40, d.firePattern.settleMs);
+}
+
+static void test_golden_status_frame(void)
+{
+  TurretStatus status = {STATUS_CALIBRATED | STATUS_ANGULAR_IN_PROGRESS | STATUS_MOVEMENT_COMPLETE,
+                         12.5f, -3.25f, -123456, 7890, 3};
+  uint8_t buf[PROTOCOL_MAX_FRAME_SIZE];
+  size_t n = encodeStatus(status, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL(sizeof(GOLDEN_STATUS), n);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(GOLDEN_STATUS, buf, n);
+
+  TurretStatus decoded;
+  TEST_ASSERT_EQUAL(DECODE_OK, decodeStatus(buf, n, decoded));
+  TEST_ASSERT_EQUAL(status.flags, decoded.flags);
+  TEST_ASSERT_EQUAL_FLOAT(12.5f, decoded.horizontalAngle);
+  TEST_ASSERT_EQUAL_FLOAT(-3.25f, decoded.verticalAngle);
+  TEST_ASSERT_EQUAL(-123456, decoded.horizontalPosition);
+  TEST_ASSERT_EQUAL(7890, decoded.verticalPosition);
+  TEST_ASSERT_EQUAL(3, decoded.errorCount);
+
+  // A status frame is not a command, and commands are not status
+  TurretCommand cmd;
+  TEST_ASSERT_EQUAL(DECODE_UNKNOWN_TYPE, decodeCommand(buf, n, cmd));
+  TEST_ASSERT_EQUAL(DECODE_UNKNOWN_TYPE, decodeStatus(GOLDEN_HOME, sizeof(GOLDEN_HOME), decoded));
+}
+
+static void test_joystick_clamps_and_rounds(void)
+{
+  const float inputs[] = {-2.0f, -1.0f, -0.3333f, 0.0f, 0.001f, 0.75f, 1.0f, 5.0f};
+  for (float x : inputs)
+  {
+    TurretCommand cmd = command(FRAME_JOYSTICK);
+    cmd.x = x;
+    cmd.y = -x;
+    uint8_t buf[PROTOCOL_MAX_FRAME_SIZE];
+    TurretCommand d;
+    TEST_ASSERT_EQUAL(DECODE_OK, decodeCommand(buf, encodeCommand(cmd, buf, sizeof(buf)), d));
+    float expected = x > 1.0f ? 1.0f : (x < -1.0f ? -1.0f : x);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f / 32767.0f, expected, d.x);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f / 32767.0f, -expected, d.y);
+  }
+
+  // The one wire value past full scale still decodes to -1
+  const uint8_t minimum[] = {0xA5, 0x01, 0x01, 0x00, 0x80, 0x00, 0x00};
+  TurretCommand d;
+  TEST_ASSERT_EQUAL(DECODE_OK, decodeCommand(minimum, sizeof(minimum), d));
+  TEST_ASSERT_EQUAL_FLOAT(-1.0f, d.x);
+}
+
+static void test_rejects_malformed_frames(void)
+{
+  TurretCommand cmd;
+  uint8_t frame[PROTOCOL_MAX_FRAME_SIZE + 1];
+  memcpy(frame, GOLDEN_MOVE_TO_ANGLE, sizeof(GOLDEN_MOVE_TO_ANGLE));
+
+  TEST_ASSERT_EQUAL(DECODE_TOO_SHORT, decodeCommand(nullptr, 0, cmd));
+  TEST_ASSERT_EQUAL(DECODE_TOO_SHORT, decodeCommand(frame, 2, cmd));
+  for (size_t len = PROTOCOL_HEADER_SIZE; len < sizeof(GOLDEN_MOVE_TO_ANGLE); len++)
+  {
+    TEST_ASSERT_EQUAL(DECODE_BAD_LENGTH, decodeCommand(frame, len, cmd));
+  }
+  TEST_ASSERT_EQUAL(DECODE_BAD_LENGTH, decodeCommand(frame, sizeof(GOLDEN_MOVE_TO_ANGLE) + 1, cmd));
+
+  frame[0] = 0x5A;
+  TEST_ASSERT_EQUAL(DECODE_BAD_MAGIC, decodeCommand(frame, sizeof(GOLDEN_MOVE_TO_ANGLE), cmd));
+  frame[0] = PROTOCOL_MAGIC;
+  frame[1] = PROTOCOL_VERSION + 1;
+  TEST_ASSERT_EQUAL(DECODE_BAD_VERSION, decodeCommand(frame, sizeof(GOLDEN_MOVE_TO_ANGLE), cmd));
+  frame[1] = PROTOCOL_VERSION;
+  frame[2] = 0x7F;
+  TEST_ASSERT_EQUAL(DECODE_UNKNOWN_TYPE, decodeCommand(frame, sizeof(GOLDEN_MOVE_TO_ANGLE), cmd));
+
+  // NaN horizontal angle
+  frame[2] = FRAME_MOVE_TO_ANGLE;
+  frame[3] = 0x00;
+  frame[4] = 0x00;
+  frame[5] = 0xC0;
+  frame[6] = 0x7F;
+  TEST_ASSERT_EQUAL(DECODE_BAD_VALUE, decodeCommand(frame, sizeof(GOLDEN_MOVE_TO_ANGLE), cmd));
+
+  const uint8_t badFireMode[] = {0xA5, 0x01, 0x04, 0x03};
+  TEST_ASSERT_EQUAL(DECODE_BAD_VALUE, decodeCommand(badFireMode, sizeof(badFireMode), cmd));
+  const uint8_t noShots[] = {0xA5, 0x01, 0x09, 0x00, 0xFA, 0x00, 0x2C, 0x01, 0x01, 0x28, 0x00};
+  TEST_ASSERT_EQUAL(DECODE_BAD_VALUE, decodeCommand(noShots, sizeof(noShots), cmd));
+  const uint8_t longSettle[] = {0xA5, 0x01, 0x0A, 0x00, 0x00, 0x34, 0x42, 0x00, 0x00, 0x20, 0xC1, 0xE9, 0x03};
+  TEST_ASSERT_EQUAL(DECODE_BAD_VALUE, decodeCommand(longSettle, sizeof(longSettle), cmd));
+
+  // Encoders refuse buffers that are too small rather than truncate
+  TurretCommand move = command(FRAME_MOVE_TO_ANGLE);
+  TEST_ASSERT_EQUAL(0, encodeCommand(move, frame, sizeof(GOLDEN_MOVE_TO_ANGLE) - 1));
+  TEST_ASSERT_EQUAL(0, encodeCommand(command(FRAME_STATUS), frame, sizeof(frame)));
+  TurretStatus status = {};
+  TEST_ASSERT_EQUAL(0, encodeStatus(status, frame, sizeof(GOLDEN_STATUS) - 1));
+}
+
+static void test_pose_history_round_trip(void)
+{
+  PoseSample samples[5];
+  for (int i = 0; i < 5; i++)
+  {
+    samples[i] = {5000000000ULL + (uint64_t)i * 2000, -1000 + i * 7, 300 - i, (int16_t)(i * -900), (int16_t)(i * 450)};
+  }
+  uint8_t buf[POSE_HISTORY_HEADER_SIZE + 5 * POSE_HISTORY_SAMPLE_SIZE];
+  size_t n = encodePoseHistory(samples, 5, POSE_HISTORY_MORE, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL(sizeof(buf), n);
+  TEST_ASSERT_EQUAL(0, encodePoseHistory(samples, 5, 0, buf, sizeof(buf) - 1));
+
+  PoseSample decoded[3];
+  uint8_t flags = 0;
+  size_t count = 0;
+  TEST_ASSERT_EQUAL(DECODE_OK, decodePoseHistory(buf, n, flags, count, decoded, 3));
+  TEST_ASSERT_EQUAL(POSE_HISTORY_MORE, flags);
+  TEST_ASSERT_EQUAL(5, count);
+  for (int i = 0; i < 3; i++)
+  {
+    TEST_ASSERT_EQUAL_UINT64(samples[i].timeUs, decoded[i].timeUs);
+    TEST_ASSERT_EQUAL(samples[i].yawSteps, decoded[i].yawSteps);
+    TEST_ASSERT_EQUAL(samples[i].tiltSteps, decoded[i].tiltSteps);
+    TEST_ASSERT_EQUAL(samples[i].yawStepsPerSec, decoded[i].yawStepsPerSec);
+    TEST_ASSERT_EQUAL(samples[i].tiltStepsPerSec, decoded[i].tiltStepsPerSec);
+  }
+  TEST_ASSERT_EQUAL(DECODE_BAD_LENGTH, decodePoseHistory(buf, n - 1, flags, count, decoded, 3));
+}
+
+static uint32_t rngState = 0x12345678;
+
+static uint32_t nextRandom()
+{
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+// Random byte strings, half of them with a valid header so the payload
+// checks get exercised. Each frame is decoded from an exactly-sized heap copy,
+// so an over-read shows up under a sanitizer. Whatever decodes must re-encode
+// to a frame of the same length that decodes to the same command.
+static void test_fuzz_decoder(void)
+{
+  const uint8_t types[] = {FRAME_JOYSTICK, FRAME_MOVE_TO_ANGLE, FRAME_MOVE_BY_ANGLE, FRAME_FIRE,
+                           FRAME_HOME, FRAME_CALIBRATE, FRAME_POSE_HISTORY_REQUEST, FRAME_INTERCEPT,
+                           FRAME_FIRE_PATTERN, FRAME_MOVE_TO_ANGLE_AND_FIRE, FRAME_STATUS, FRAME_POSE_HISTORY};
+  unsigned decoded = 0;
+  for (int i = 0; i < 200000; i++)
+  {
+    size_t len = nextRandom() % (PROTOCOL_MAX_FRAME_SIZE + 8);
+    std::vector<uint8_t> frame(len);
+    for (size_t k = 0; k < len; k++)
+    {
+      frame[k] = (uint8_t)nextRandom();
+    }
+    if (len >= PROTOCOL_HEADER_SIZE && (nextRandom() & 1))
+    {
+      frame[0] = PROTOCOL_MAGIC;
+      frame[1] = PROTOCOL_VERSION;
+      frame[2] = types[nextRandom() % sizeof(types)];
+    }
+    uint8_t *data = len ? (uint8_t *)malloc(len) : nullptr;
+    if (len)
+    {
+      memcpy(data, frame.data(), len);
+    }
+
+    TurretCommand cmd;
+    TurretStatus status;
+    PoseSample samples[2];
+    uint8_t flags;
+    size_t count;
+    decodeStatus(data, len, status);
+    decodePoseHistory(data, len, flags, count, samples, 2);
+    if (decodeCommand(data, len, cmd) == DECODE_OK)
+    {
+      decoded++;
+      uint8_t first[PROTOCOL_MAX_FRAME_SIZE];
+      uint8_t second[PROTOCOL_MAX_FRAME_SIZE];
+      size_t n = encodeCommand(cmd, first, sizeof(first));
+      TEST_ASSERT_EQUAL(len, n);
+      TurretCommand again;
+      TEST_ASSERT_EQUAL(DECODE_OK, decodeCommand(first, n, again));
+      TEST_ASSERT_EQUAL(n, encodeCommand(again, second, sizeof(second)));
+      TEST_ASSERT_EQUAL_HEX8_ARRAY(first, second, n);
+    }
+    free(data);
+  }
+  // The header bias must actually reach the payload decoders
+  TEST_ASSERT_GREATER_THAN(1000, decoded);
+}
+
+static void test_random_commands_round_trip(void)
+{
+  for (int i = 0; i < 20000; i++)
+  {
+    TurretCommand cmd = command(FRAME_MOVE_TO_ANGLE);
+    cmd.horizontal = (float)((int32_t)nextRandom() % 72000) / 100.0f;
+    cmd.vertical = (float)((int32_t)nextRandom() % 9000) / 100.0f;
+    uint8_t buf[PROTOCOL_MAX_FRAME_SIZE];
+    TurretCommand d;
+    TEST_ASSERT_EQUAL(DECODE_OK, decodeCommand(buf, encodeCommand(cmd, buf, sizeof(buf)), d));
+    TEST_ASSERT_EQUAL_MEMORY(&cmd.horizontal, &d.horizontal, sizeof(float));
+    TEST_ASSERT_EQUAL_MEMORY(&cmd.vertical, &d.vertical, sizeof(float));
+
+    TurretStatus status = {(uint16_t)nextRandom(), cmd.horizontal, cmd.vertical,
+                           (int32_t)nextRandom(), (int32_t)nextRandom(), (uint8_t)nextRandom()};
+    TurretStatus s;
+    TEST_ASSERT_EQUAL(DECODE_OK, decodeStatus(buf, encodeStatus(status, buf, sizeof(buf)), s));
+    TEST_ASSERT_EQUAL(status.flags, s.flags);
+    TEST_ASSERT_EQUAL(status.horizontalPosition, s.horizontalPosition);
+    TEST_ASSERT_EQUAL(status.verticalPosition, s.verticalPosition);
+    TEST_ASSERT_EQUAL(status.errorCount, s.errorCount);
+    TEST_ASSERT_EQUAL_MEMORY(&status.horizontalAngle, &s.horizontalAngle, sizeof(float));
+  }
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_golden_command_frames);
+  RUN_TEST(test_golden_status_frame);
+  RUN_TEST(test_joystick_clamps_and_rounds);
+  RUN_TEST(test_rejects_malformed_frames);
+  RUN_TEST(test_pose_history_round_trip);
+  RUN_TEST(test_fuzz_decoder);
+  RUN_TEST(test_random_commands_round_trip);
+  return UNITY_END();
+}
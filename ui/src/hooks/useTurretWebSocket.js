@@ -1,6 +1,7 @@
 "use client";
 
 import { useCallback, useEffect, useRef, useState } from "react";
+import { decodeStatus, encodeCommand, mergeStatusDelta } from "../lib/turretProtocol";
 
 const MAX_RECONNECT_ATTEMPTS = Infinity;
 const RECONNECT_BASE_DELAY_MS = 300;
@@ -16,6 +17,7 @@ export function useTurretWebSocket(url) {
   const [messages, setMessages] = useState([]);
 
   const wsRef = useRef(null);
+  const statusRef = useRef(null);
   const reconnectTimeoutRef = useRef(null);
   const reconnectAttemptsRef = useRef(0);
 
@@ -38,9 +40,11 @@ export function useTurretWebSocket(url) {
     setConnectionError(null);
 
     const socket = new WebSocket(url);
+    socket.binaryType = "arraybuffer";
     wsRef.current = socket;
 
     socket.onopen = () => {
+      statusRef.current = null;
       setConnected(true);
       setConnecting(false);
       reconnectAttemptsRef.current = 0;
@@ -71,12 +75,18 @@ export function useTurretWebSocket(url) {
 
     socket.onmessage = (event) => {
       try {
-        const data = JSON.parse(event.data);
-        if (data.status) {
-          setStatus(data.status);
-          if (data.status.angles) setCurrentAngles(data.status.angles);
-          if (data.status.movement) {
-            setIsMoving(!!data.status.movement.angularInProgress || !!data.status.movement.isMoving);
+        const data = typeof event.data === "string" ? JSON.parse(event.data) : decodeStatus(event.data);
+        if (!data) return;
+        // Full status on connect and periodically; only changed fields in between
+        const nextStatus = data.status ?? (data.statusDelta && statusRef.current
+          ? mergeStatusDelta(statusRef.current, data.statusDelta)
+          : null);
+        if (nextStatus) {
+          statusRef.current = nextStatus;
+          setStatus(nextStatus);
+          if (nextStatus.angles) setCurrentAngles(nextStatus.angles);
+          if (nextStatus.movement) {
+            setIsMoving(!!nextStatus.movement.angularInProgress || !!nextStatus.movement.isMoving);
           }
         }
         if (data.errors) {
@@ -104,7 +114,7 @@ export function useTurretWebSocket(url) {
   const sendCommand = useCallback(
     (payload) => {
       if (wsRef.current && wsRef.current.readyState === WebSocket.OPEN) {
-        wsRef.current.send(JSON.stringify(payload));
+        wsRef.current.send(encodeCommand(payload) ?? JSON.stringify(payload));
       }
     },
     []
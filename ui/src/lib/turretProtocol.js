@@ -0,0 +1,230 @@
+// Binary WebSocket protocol shared with firmware/motors/src/turret_protocol.h.
+// Header: magic, version, frame type. Little-endian fields, float32 angles.
+
+const MAGIC = 0xa5;
+const VERSION = 1;
+const HEADER_SIZE = 3;
+
+const FRAME = {
+  joystick: 0x01,
+  moveToAngle: 0x02,
+  moveByAngle: 0x03,
+  fire: 0x04,
+  home: 0x05,
+  calibrate: 0x06,
+  poseHistoryRequest: 0x07,
+  intercept: 0x08,
+  firePattern: 0x09,
+  moveToAngleAndFire: 0x0a,
+  status: 0x80,
+};
+
+const STATUS_FLAGS = {
+  calibrated: 1 << 0,
+  calibrating: 1 << 1,
+  angularInProgress: 1 << 2,
+  isMoving: 1 << 3,
+  yawHome: 1 << 4,
+  tiltUp: 1 << 5,
+  tiltDown: 1 << 6,
+  triggerActive: 1 << 7,
+  movementComplete: 1 << 8,
+  calibrationComplete: 1 << 9,
+  yawHomed: 1 << 10,
+  tiltCalibrated: 1 << 11,
+};
+const STATUS_PAYLOAD = 19;
+
+const FIRE_MODES = ["single", "burst", "cancel"];
+const FIRE_PATTERN_ON_TARGET = 1 << 0;
+// Limits and defaults of the firmware's JSON handlers (fire_control.h, main.cpp)
+const FIRE_MAX_SHOTS = 50;
+const FIRE_MAX_SETTLE_MS = 1000;
+const FIRE_ARRIVAL_SETTLE_MS = 20;
+
+function frame(type, payloadSize) {
+  const view = new DataView(new ArrayBuffer(HEADER_SIZE + payloadSize));
+  view.setUint8(0, MAGIC);
+  view.setUint8(1, VERSION);
+  view.setUint8(2, type);
+  return view;
+}
+
+const toJoystick = (v) => Math.round(Math.max(-1, Math.min(1, v)) * 32767);
+const isNumber = (v) => typeof v === "number" && Number.isFinite(v);
+
+const isUint = (v, max) => Number.isInteger(v) && v >= 0 && v <= max;
+const isOptional = (v, check) => v === undefined || check(v);
+
+// True if obj is a plain object with exactly these keys
+function hasExactKeys(obj, keys) {
+  if (!obj || typeof obj !== "object" || Array.isArray(obj)) return false;
+  const own = Object.keys(obj);
+  return own.length === keys.length && keys.every((key) => own.includes(key));
+}
+
+// True if obj is a plain object with all of required and nothing outside optional
+function hasKeys(obj, required, optional) {
+  if (!obj || typeof obj !== "object" || Array.isArray(obj)) return false;
+  const own = Object.keys(obj);
+  return required.every((key) => own.includes(key)) && own.every((key) => required.includes(key) || optional.includes(key));
+}
+
+// {"moveToAngle": {horizontal, vertical, fireOnArrival: true, settleMs?}}
+function encodeMoveToAngleAndFire(move) {
+  if (
+    !hasKeys(move, ["horizontal", "vertical", "fireOnArrival"], ["settleMs"]) ||
+    move.fireOnArrival !== true ||
+    !isNumber(move.horizontal) ||
+    !isNumber(move.vertical) ||
+    !isOptional(move.settleMs, (v) => isUint(v, FIRE_MAX_SETTLE_MS))
+  ) {
+    return null;
+  }
+  const view = frame(FRAME.moveToAngleAndFire, 10);
+  view.setFloat32(3, move.horizontal, true);
+  view.setFloat32(7, move.vertical, true);
+  view.setUint16(11, move.settleMs ?? FIRE_ARRIVAL_SETTLE_MS, true);
+  return view.buffer;
+}
+
+// {"fire": {shots?, intervalMs?, maxRate?, onTarget?, settleMs?}}, defaults as postFireCommand's
+function encodeFirePattern(pattern) {
+  if (
+    !hasKeys(pattern, [], ["shots", "intervalMs", "maxRate", "onTarget", "settleMs"]) ||
+    !isOptional(pattern.shots, (v) => isUint(v, FIRE_MAX_SHOTS) && v > 0) ||
+    !isOptional(pattern.intervalMs, (v) => isUint(v, 0xffff)) ||
+    !isOptional(pattern.maxRate, (v) => isUint(v, 0xffff)) ||
+    !isOptional(pattern.onTarget, (v) => typeof v === "boolean") ||
+    !isOptional(pattern.settleMs, (v) => isUint(v, FIRE_MAX_SETTLE_MS))
+  ) {
+    return null;
+  }
+  const view = frame(FRAME.firePattern, 8);
+  view.setUint8(3, pattern.shots ?? 1);
+  view.setUint16(4, pattern.intervalMs ?? 0, true);
+  view.setUint16(6, pattern.maxRate ?? 0, true);
+  view.setUint8(8, pattern.onTarget === false ? 0 : FIRE_PATTERN_ON_TARGET);
+  view.setUint16(9, pattern.settleMs ?? 0, true);
+  return view.buffer;
+}
+
+// {"intercept": {horizontal, vertical, horizontalRate?, verticalRate?, timeUs?, flightMs?}}
+function encodeIntercept(target) {
+  if (
+    !hasKeys(target, ["horizontal", "vertical"], ["horizontalRate", "verticalRate", "timeUs", "flightMs"]) ||
+    !isNumber(target.horizontal) ||
+    !isNumber(target.vertical) ||
+    !isOptional(target.horizontalRate, isNumber) ||
+    !isOptional(target.verticalRate, isNumber) ||
+    !isOptional(target.timeUs, (v) => isUint(v, Number.MAX_SAFE_INTEGER)) ||
+    !isOptional(target.flightMs, (v) => isUint(v, 0xffff))
+  ) {
+    return null;
+  }
+  const view = frame(FRAME.intercept, 26);
+  view.setFloat32(3, target.horizontal, true);
+  view.setFloat32(7, target.vertical, true);
+  view.setFloat32(11, target.horizontalRate ?? 0, true);
+  view.setFloat32(15, target.verticalRate ?? 0, true);
+  view.setBigUint64(19, BigInt(target.timeUs ?? 0), true);
+  view.setUint16(27, target.flightMs ?? 0, true);
+  return view.buffer;
+}
+
+// Returns an ArrayBuffer only for payloads whose every field the binary frame
+// carries, or null so the caller falls back to JSON (partial joystick updates,
+// extra options, text-only commands). Anything a frame can't represent exactly
+// must go as JSON rather than be silently dropped.
+export function encodeCommand(payload) {
+  if (hasExactKeys(payload, ["x", "y"]) && isNumber(payload.x) && isNumber(payload.y)) {
+    const view = frame(FRAME.joystick, 4);
+    view.setInt16(3, toJoystick(payload.x), true);
+    view.setInt16(5, toJoystick(payload.y), true);
+    return view.buffer;
+  }
+  if (!payload || typeof payload !== "object" || Object.keys(payload).length !== 1) return null;
+
+  const key = Object.keys(payload)[0];
+  const value = payload[key];
+  if (key === "moveToAngle" && value?.fireOnArrival !== undefined) {
+    return encodeMoveToAngleAndFire(value);
+  }
+  if (
+    (key === "moveToAngle" || key === "moveByAngle") &&
+    hasExactKeys(value, ["horizontal", "vertical"]) &&
+    isNumber(value.horizontal) &&
+    isNumber(value.vertical)
+  ) {
+    const view = frame(FRAME[key], 8);
+    view.setFloat32(3, value.horizontal, true);
+    view.setFloat32(7, value.vertical, true);
+    return view.buffer;
+  }
+  if (key === "fire" && FIRE_MODES.includes(value)) {
+    const view = frame(FRAME.fire, 1);
+    view.setUint8(3, FIRE_MODES.indexOf(value));
+    return view.buffer;
+  }
+  if (key === "fire") {
+    return encodeFirePattern(value);
+  }
+  if (key === "intercept") {
+    return encodeIntercept(value);
+  }
+  if ((key === "home" || key === "calibrate") && value === true) {
+    return frame(FRAME[key], 0).buffer;
+  }
+  return null;
+}
+
+// POSE_HISTORY_REQUEST has no JSON form: asks for the poses recorded after
+// afterUs (esp_timer time, a number or BigInt), maxSamples 0 = as many as fit.
+export function encodePoseHistoryRequest(afterUs, maxSamples = 0) {
+  const view = frame(FRAME.poseHistoryRequest, 10);
+  view.setBigUint64(3, BigInt(afterUs), true);
+  view.setUint16(11, maxSamples, true);
+  return view.buffer;
+}
+
+// Decodes a binary status frame into the same shape as the JSON status message.
+export function decodeStatus(buffer) {
+  if (!(buffer instanceof ArrayBuffer) || buffer.byteLength !== HEADER_SIZE + STATUS_PAYLOAD) return null;
+  const view = new DataView(buffer);
+  if (view.getUint8(0) !== MAGIC || view.getUint8(1) !== VERSION || view.getUint8(2) !== FRAME.status) {
+    return null;
+  }
+
+  const flags = view.getUint16(3, true);
+  const has = (flag) => (flags & STATUS_FLAGS[flag]) !== 0;
+  const message = {
+    status: {
+      calibrated: has("calibrated"),
+      calibrating: has("calibrating"),
+      angles: { horizontal: view.getFloat32(5, true), vertical: view.getFloat32(9, true) },
+      positions: { horizontal: view.getInt32(13, true), vertical: view.getInt32(17, true) },
+      movement: { angularInProgress: has("angularInProgress"), isMoving: has("isMoving") },
+      sensors: { yawHome: has("yawHome"), tiltUp: has("tiltUp"), tiltDown: has("tiltDown") },
+      triggerActive: has("triggerActive"),
+    },
+    errorCount: view.getUint8(21),
+  };
+  if (has("movementComplete")) message.movementComplete = true;
+  if (has("calibrationComplete")) {
+    message.calibrationComplete = true;
+    message.yawHomed = has("yawHomed");
+    message.tiltCalibrated = has("tiltCalibrated");
+  }
+  return message;
+}
+
+// Applies a {"statusDelta": {...}} update; nested groups are merged one level deep.
+export function mergeStatusDelta(status, delta) {
+  const next = { ...status };
+  for (const [key, value] of Object.entries(delta)) {
+    next[key] = value && typeof value === "object" && !Array.isArray(value)
+      ? { ...(status?.[key] ?? {}), ...value }
+      : value;
+  }
+  return next;
+}
@@ -0,0 +1,166 @@
+// Codec tests: node --test (npm test). The golden frames are the ones
+// firmware/motors/test/test_turret_protocol checks the C++ codec against.
+import test from "node:test";
+import assert from "node:assert/strict";
+
+import { decodeStatus, encodeCommand, encodePoseHistoryRequest, mergeStatusDelta } from "./turretProtocol.js";
+
+const bytes = (buffer) => [...new Uint8Array(buffer)];
+const buffer = (list) => new Uint8Array(list).buffer;
+
+const GOLDEN = {
+  joystick: [0xa5, 0x01, 0x01, 0x00, 0x40, 0x01, 0x80],
+  moveToAngle: [0xa5, 0x01, 0x02, 0x00, 0x00, 0xb5, 0x42, 0x00, 0x00, 0x44, 0xc1],
+  fireBurst: [0xa5, 0x01, 0x04, 0x01],
+  home: [0xa5, 0x01, 0x05],
+  poseHistoryRequest: [0xa5, 0x01, 0x07, 0xcb, 0x04, 0xfb, 0x71, 0x1f, 0x01, 0x00, 0x00, 0x28, 0x00],
+  intercept: [
+    0xa5, 0x01, 0x08, 0x00, 0x00, 0x20, 0x41, 0x00, 0x00, 0xa0, 0x40, 0x00, 0x00, 0x20, 0xc0,
+    0x00, 0x00, 0x40, 0x3f, 0x40, 0x4b, 0x4c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x96, 0x00,
+  ],
+  firePattern: [0xa5, 0x01, 0x09, 0x03, 0xfa, 0x00, 0x2c, 0x01, 0x01, 0x28, 0x00],
+  moveToAngleAndFire: [0xa5, 0x01, 0x0a, 0x00, 0x00, 0x34, 0x42, 0x00, 0x00, 0x20, 0xc1, 0x28, 0x00],
+  status: [
+    0xa5, 0x01, 0x80, 0x05, 0x01, 0x00, 0x00, 0x48, 0x41, 0x00, 0x00,
+    0x50, 0xc0, 0xc0, 0x1d, 0xfe, 0xff, 0xd2, 0x1e, 0x00, 0x00, 0x03,
+  ],
+};
+
+test("encodes the firmware's golden frames", () => {
+  assert.deepEqual(bytes(encodeCommand({ x: 0.5, y: -1 })), GOLDEN.joystick);
+  assert.deepEqual(bytes(encodeCommand({ moveToAngle: { horizontal: 90.5, vertical: -12.25 } })), GOLDEN.moveToAngle);
+  assert.deepEqual(bytes(encodeCommand({ fire: "burst" })), GOLDEN.fireBurst);
+  assert.deepEqual(bytes(encodeCommand({ home: true })), GOLDEN.home);
+  assert.deepEqual(bytes(encodeCommand({ calibrate: true })), [0xa5, 0x01, 0x06]);
+  assert.deepEqual(bytes(encodeCommand({ fire: "single" })), [0xa5, 0x01, 0x04, 0x00]);
+  assert.equal(encodeCommand({ moveByAngle: { vertical: 1, horizontal: -1 } }).byteLength, 11);
+});
+
+test("encodes the firmware's golden targeting and fire-control frames", () => {
+  assert.deepEqual(
+    bytes(encodeCommand({ moveToAngle: { horizontal: 45, vertical: -10, fireOnArrival: true, settleMs: 40 } })),
+    GOLDEN.moveToAngleAndFire,
+  );
+  assert.deepEqual(
+    bytes(encodeCommand({ fire: { shots: 3, intervalMs: 250, maxRate: 300, onTarget: true, settleMs: 40 } })),
+    GOLDEN.firePattern,
+  );
+  assert.deepEqual(
+    bytes(
+      encodeCommand({
+        intercept: { horizontal: 10, vertical: 5, horizontalRate: -2.5, verticalRate: 0.75, timeUs: 5000000, flightMs: 150 },
+      }),
+    ),
+    GOLDEN.intercept,
+  );
+  assert.deepEqual(bytes(encodePoseHistoryRequest(1234567890123, 40)), GOLDEN.poseHistoryRequest);
+  assert.deepEqual(bytes(encodePoseHistoryRequest(1234567890123n, 40)), GOLDEN.poseHistoryRequest);
+  assert.deepEqual(bytes(encodeCommand({ fire: "cancel" })), [0xa5, 0x01, 0x04, 0x02]);
+});
+
+// firmware/motors/sim/sim_main.cpp sends these bytes for its fire-on-arrival
+// step (UI_FIRE_ON_ARRIVAL_FRAME) and checks the C++ encoder against them
+test("encodes the simulator's fire-on-arrival move", () => {
+  assert.deepEqual(
+    bytes(encodeCommand({ moveToAngle: { horizontal: 30, vertical: -10, fireOnArrival: true, settleMs: 40 } })),
+    [0xa5, 0x01, 0x0a, 0x00, 0x00, 0xf0, 0x41, 0x00, 0x00, 0x20, 0xc1, 0x28, 0x00],
+  );
+});
+
+test("fills in the firmware's JSON defaults", () => {
+  // fireOnArrival without settleMs holds FIRE_ARRIVAL_SETTLE_MS (20 ms)
+  assert.deepEqual(
+    bytes(encodeCommand({ moveToAngle: { horizontal: 45, vertical: -10, fireOnArrival: true } })).slice(-2),
+    [0x14, 0x00],
+  );
+  // A pattern is one shot, on target, unless it says otherwise
+  assert.deepEqual(bytes(encodeCommand({ fire: {} })), [0xa5, 0x01, 0x09, 0x01, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00]);
+  assert.equal(new Uint8Array(encodeCommand({ fire: { shots: 2, onTarget: false } }))[8], 0x00);
+  const intercept = new DataView(encodeCommand({ intercept: { horizontal: 10, vertical: 5 } }));
+  assert.equal(intercept.byteLength, GOLDEN.intercept.length);
+  assert.equal(intercept.getFloat32(11, true), 0);
+  assert.equal(intercept.getBigUint64(19, true), 0n);
+  assert.equal(intercept.getUint16(27, true), 0);
+});
+
+test("clamps joystick axes to full scale", () => {
+  assert.deepEqual(bytes(encodeCommand({ x: 3, y: -3 })), [0xa5, 0x01, 0x01, 0xff, 0x7f, 0x01, 0x80]);
+});
+
+test("leaves payloads it can't represent exactly to JSON", () => {
+  const rejected = [
+    { x: 0.5 },
+    { x: 0.5, y: 0.5, z: 0 },
+    { x: "0.5", y: 0 },
+    { x: NaN, y: 0 },
+    { moveToAngle: { horizontal: 10 } },
+    { moveToAngle: { horizontal: 10, vertical: 5, extra: 1 } },
+    { moveToAngle: { horizontal: 10, vertical: Infinity } },
+    { moveToAngle: [10, 5] },
+    { moveByAngle: { horizontal: "10", vertical: 5 } },
+    { moveToAngle: { horizontal: 10, vertical: 5 }, home: true },
+    { moveToAngle: { horizontal: 10, vertical: 5, fireOnArrival: false } },
+    { moveToAngle: { horizontal: 10, vertical: 5, settleMs: 40 } },
+    { moveToAngle: { horizontal: 10, vertical: 5, fireOnArrival: true, settleMs: 1001 } },
+    { moveToAngle: { horizontal: 10, vertical: 5, fireOnArrival: true, settleMs: 40, shots: 2 } },
+    { moveToAngle: { horizontal: 10, vertical: 5, fireOnArrival: "yes" } },
+    { fire: "auto" },
+    { fire: { shots: 0 } },
+    { fire: { shots: 51 } },
+    { fire: { shots: 2.5 } },
+    { fire: { intervalMs: 70000 } },
+    { fire: { settleMs: -1 } },
+    { fire: { onTarget: 1 } },
+    { fire: { shots: 2, pattern: "ring" } },
+    { fire: null },
+    { intercept: false },
+    { intercept: { horizontal: 10 } },
+    { intercept: { horizontal: 10, vertical: 5, flightMs: 70000 } },
+    { intercept: { horizontal: 10, vertical: 5, timeUs: -1 } },
+    { intercept: { horizontal: 10, vertical: 5, horizontalRate: NaN } },
+    { intercept: { horizontal: 10, vertical: 5, extra: 1 } },
+    { home: false },
+    { calibrate: 1 },
+    { trigger: true },
+    { moveToCenter: true },
+    {},
+    null,
+  ];
+  for (const payload of rejected) {
+    assert.equal(encodeCommand(payload), null, JSON.stringify(payload));
+  }
+});
+
+test("decodes the firmware's golden status frame", () => {
+  assert.deepEqual(decodeStatus(buffer(GOLDEN.status)), {
+    status: {
+      calibrated: true,
+      calibrating: false,
+      angles: { horizontal: 12.5, vertical: -3.25 },
+      positions: { horizontal: -123456, vertical: 7890 },
+      movement: { angularInProgress: true, isMoving: false },
+      sensors: { yawHome: false, tiltUp: false, tiltDown: false },
+      triggerActive: false,
+    },
+    errorCount: 3,
+    movementComplete: true,
+  });
+});
+
+test("rejects status frames with a bad header or length", () => {
+  const badMagic = [...GOLDEN.status];
+  badMagic[0] = 0x5a;
+  assert.equal(decodeStatus(buffer(badMagic)), null);
+  assert.equal(decodeStatus(buffer(GOLDEN.status.slice(0, -1))), null);
+  assert.equal(decodeStatus(buffer(GOLDEN.home)), null);
+  assert.equal(decodeStatus(GOLDEN.status), null);
+});
+
+test("merges status deltas one level deep", () => {
+  const status = { calibrated: true, angles: { horizontal: 1, vertical: 2 } };
+  assert.deepEqual(mergeStatusDelta(status, { angles: { vertical: 5 }, isMoving: true }), {
+    calibrated: true,
+    angles: { horizontal: 1, vertical: 5 },
+    isMoving: true,
+  });
+});